@@ -1,6 +1,21 @@
 #define FASTLED_INTERNAL
 #include "FastLED.h"
 
+#if defined(NEED_CXX_BITS) && (FASTLED_PARALLEL == 1)
+// for vTaskDelay in the guard functions
+extern "C" {
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+}
+#endif
+
+
+#if defined(FASTLED_ESP32)
+// for light sleep while idle
+extern "C" {
+#include "esp_sleep.h"
+}
+#endif
 
 #if defined(__SAM3X8E__)
 volatile uint32_t fuckit;
@@ -14,7 +29,45 @@ CFastLED FastLED;
 
 CLEDController *CLEDController::m_pHead = NULL;
 CLEDController *CLEDController::m_pTail = NULL;
-static uint32_t lastshow = 0;
+#if (FASTLED_TRACE == 1)
+uint16_t CLEDController::m_nTraceCount = 0;
+#endif
+
+// cpu cycle counter for the controller timings, estimated from micros() where there's no cycle counter handy
+#if defined(FASTLED_ESP32) || defined(FASTLED_ESP8266)
+#define STATS_CYCLES() __clock_cycles()
+#else
+#define STATS_CYCLES() (micros() * (F_CPU / 1000000L))
+#endif
+
+#if (FASTLED_TRACE == 1)
+trace_func fastled_trace_func = NULL;
+void *fastled_trace_arg = NULL;
+
+void fastled_trace(uint8_t event, uint16_t arg) {
+	trace_func pFunc = fastled_trace_func;
+	if(pFunc == NULL) { return; }
+	TraceEvent e;
+	e.cycles = STATS_CYCLES();
+	e.event = event;
+	e.reserved = 0;
+	e.arg = arg;
+	(*pFunc)(e, fastled_trace_arg);
+}
+
+#define TRACE_CONTROLLER(EVENT, CONTROLLER) FASTLED_TRACE_EVENT(EVENT, (CONTROLLER)->m_nTraceIndex)
+#else
+#define TRACE_CONTROLLER(EVENT, CONTROLLER) do {} while(0)
+#endif
+
+// a controller's show, started at cycle count start, returned: time it, and if the controller is still writing the
+// frame out in the background, leave the wire time to whoever sees it finish
+void CFastLED::frameShown(CLEDController *pCur, uint32_t start) {
+	uint32_t now = STATS_CYCLES();
+	pCur->m_Stats.add(now - start);
+	if(pCur->isShowing()) { pCur->m_Stats.pending(start); }
+	else { pCur->m_Stats.addWire(now - start); }
+}
 
 uint32_t _frame_cnt=0;
 uint32_t _retry_cnt=0;
@@ -26,8 +79,21 @@ CFastLED::CFastLED() {
 	// m_nControllers = 0;
 	m_Scale = 255;
 	m_nFPS = 0;
+	m_nFPSFrames = 0;
+	m_nFPSMillis = 0;
+	for(int i = 0; i < FASTLED_SHOW_GROUPS; i++) { m_nLastShow[i] = 0; }
 	m_pPowerFunc = NULL;
 	m_nPowerData = 0xFFFFFFFF;
+	m_pShowCallback = NULL;
+	m_pShowCallbackArg = NULL;
+	m_pRecorder = NULL;
+	m_pGovernor = NULL;
+	m_nGovernorMark = 0;
+	m_bShowPending = false;
+	m_bYieldWhileThrottled = false;
+	m_bIdle = false;
+	m_nIdleMode = IDLE_SHOW;
+	m_nIdlePollMs = 20;
 }
 
 CLEDController &CFastLED::addLeds(CLEDController *pLed,
@@ -43,24 +109,285 @@ CLEDController &CFastLED::addLeds(CLEDController *pLed,
 }
 
 void CFastLED::show(uint8_t scale) {
+	showAsync(scale);
+	waitShow();
+}
+
+void CFastLED::showGroups(uint8_t groups, uint8_t scale) {
+	showGroupsAsync(groups, scale);
+	waitShow();
+}
+
+#ifdef FASTLED_ESP32_SHOW_TASK
+// The show task only ever runs startShow/waitFully for the frames handed to it by showAsync, and gives
+// sShowDone once a frame is out.  sShowBusy is only touched from the application's side.
+static TaskHandle_t sShowTask = NULL;
+static SemaphoreHandle_t sShowDone = NULL;
+static volatile uint8_t sShowScale;
+static volatile uint8_t sShowGroups;
+static bool sShowBusy = false;
+
+void CFastLED::showTask(void *) {
+	for(;;) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		FastLED.startShow(sShowScale, sShowGroups);
+		FastLED.waitFully();
+		xSemaphoreGive(sShowDone);
+	}
+}
+#endif
+
+void CFastLED::showAsync(uint8_t scale) {
+	showGroupsAsync(FASTLED_ALL_GROUPS, scale);
+}
+
+void CFastLED::showGroupsAsync(uint8_t groups, uint8_t scale) {
+	// the previous frame has to be out before its completion is reported and the next one starts
+	waitShow();
+	m_bShowPending = true;
+
+#ifdef FASTLED_ESP32_SHOW_TASK
+	if(sShowTask == NULL) {
+		sShowDone = xSemaphoreCreateBinary();
+		xTaskCreatePinnedToCore(showTask, "FastLED", FASTLED_ESP32_SHOW_TASK_STACK, NULL, FASTLED_ESP32_SHOW_TASK_PRIORITY, &sShowTask, FASTLED_ESP32_SHOW_TASK_CORE);
+	}
+	sShowScale = scale;
+	sShowGroups = groups;
+	sShowBusy = true;
+	xTaskNotifyGive(sShowTask);
+#else
+	startShow(scale, groups);
+#endif
+}
+
+uint32_t CFastLED::timeUntilNextShow(uint8_t groups) {
+	// the group that was shown most recently has the longest to wait
+	uint32_t now = micros();
+	uint32_t remaining = 0;
+	for(int i = 0; i < FASTLED_SHOW_GROUPS; i++) {
+		if(groups & (1 << i)) {
+			uint32_t elapsed = now - m_nLastShow[i];
+			if(m_nMinMicros > elapsed && (m_nMinMicros - elapsed) > remaining) { remaining = m_nMinMicros - elapsed; }
+		}
+	}
+	return remaining;
+}
+
+bool CFastLED::tryShow(uint8_t scale) {
+	if(isShowing() || timeUntilNextShow()) { return false; }
+	showAsync(scale);
+	return true;
+}
+
+void CFastLED::throttle(uint8_t groups) {
 	// guard against showing too rapidly
-	while(m_nMinMicros && ((micros()-lastshow) < m_nMinMicros));
-	lastshow = micros();
+	uint32_t start = micros();
+	uint32_t remaining;
+	while((remaining = timeUntilNextShow(groups)) > 0) {
+#if defined(ARDUINO)
+		if(m_bYieldWhileThrottled) {
+			// sleep through whole milliseconds (which lets other tasks run under an rtos) and hand
+			// the remainder to yield
+			if(remaining >= 1000) { ::delay(remaining / 1000); } else { yield(); }
+		}
+#endif
+	}
+	uint32_t now = micros();
+	for(int i = 0; i < FASTLED_SHOW_GROUPS; i++) {
+		if(groups & (1 << i)) { m_nLastShow[i] = now; }
+	}
+	m_Stats.throttleMicros += now - start;
+	// the frame before this one took from its start until this show was called
+	if(m_pGovernor && groups == FASTLED_ALL_GROUPS) {
+		if(m_nGovernorMark) { m_pGovernor->frame(start - m_nGovernorMark, m_nMinMicros); }
+		m_nGovernorMark = now;
+	}
+}
+
+void CFastLED::startShow(uint8_t scale, uint8_t groups) {
+	FASTLED_TRACE_EVENT(TRACE_SHOW_BEGIN, groups);
+	throttle(groups);
+	FASTLED_TRACE_EVENT(TRACE_THROTTLE_END, 0);
+
+	// Pick up the frames to show before computing power, so the power limit looks at the leds that actually go out.
+	// Whatever the power function and needsShow learn about a controller's leds comes from a single pass over them,
+	// which makes the sums whenever there's power to limit.
+	bool bRails = false;
+	CLEDController *pCur;
+	for(pCur = CLEDController::head(); pCur; pCur = pCur->next()) {
+		if(pCur->m_pPowerRail) { bRails = true; }
+	}
+	bool bSums = bRails || m_pPowerFunc;
+	pCur = CLEDController::head();
+	while(pCur) {
+		if(pCur->inGroups(groups)) { pCur->latchFrame(); }
+		pCur->releaseScan();
+		if(bSums) { pCur->channelSums(); }
+		pCur = pCur->next();
+	}
 
 	// If we have a function for computing power, use it!
 	if(m_pPowerFunc) {
+		FASTLED_TRACE_EVENT(TRACE_POWER_BEGIN, 0);
+		uint32_t start = micros();
 		scale = (*m_pPowerFunc)(scale, m_nPowerData);
+		m_Stats.powerMicros += micros() - start;
+		FASTLED_TRACE_EVENT(TRACE_POWER_END, scale);
 	}
 
-	CLEDController *pCur = CLEDController::head();
+	// Then hold the controllers on power rails to their rail's own limit, all rails estimated in the same pass
+	if(bRails) {
+		for(pCur = CLEDController::head(); pCur; pCur = pCur->next()) {
+			if(pCur->m_pPowerRail) { pCur->m_pPowerRail->resetDemand(); }
+		}
+		FASTLED_TRACE_EVENT(TRACE_POWER_BEGIN, 0);
+		uint32_t start = micros();
+		for(pCur = CLEDController::head(); pCur; pCur = pCur->next()) {
+			if(pCur->m_pPowerRail) {
+				pCur->m_pPowerRail->addDemand(calculate_power_mW(pCur->channelSums(), pCur->outputSize(), pCur->frameAdjustment(scale)));
+			}
+		}
+		m_Stats.powerMicros += micros() - start;
+		FASTLED_TRACE_EVENT(TRACE_POWER_END, scale);
+	}
+
+	// Start every controller before waiting on any of them, so that controllers that write out
+	// in the background (dma, rmt) all run at the same time
+	uint32_t now = millis();
+	uint32_t nowMicros = micros();
+	bool bRecord = m_pRecorder && m_pRecorder->beginFrame(nowMicros);
+	int nController = 0;
+	struct { CLEDController *pController; CRGB adjustment; } deferred[FASTLED_SHOW_DEFER];
+	int nDeferred = 0;
+	bool bShown = false;
+	pCur = CLEDController::head();
 	while(pCur) {
-		uint8_t d = pCur->getDither();
-		if(m_nFPS < 100) { pCur->setDither(0); }
-		pCur->showLeds(scale);
-		pCur->setDither(d);
+		if(!pCur->inGroups(groups)) {
+			if(bRecord) { m_pRecorder->repeatSection(nController); }
+			nController++;
+			pCur->releaseScan();
+			pCur = pCur->next();
+			continue;
+		}
+		CRGB adjustment = pCur->frameAdjustment(pCur->m_pPowerRail ? pCur->m_pPowerRail->limit(scale) : scale);
+		if(bRecord) {
+			uint8_t *pSection = m_pRecorder->section(nController, pCur->size());
+			if(pSection) { pCur->captureFrame(adjustment, pSection); } else { m_pRecorder->clearSection(nController); }
+		}
+		nController++;
+		if(pCur->needsShow(adjustment, now)) {
+			bShown = true;
+			// a strip still latching its previous frame waits its turn, so the others go out in the meantime
+			if(nDeferred < FASTLED_SHOW_DEFER && pCur->latchRemaining()) {
+				deferred[nDeferred].pController = pCur;
+				deferred[nDeferred].adjustment = adjustment;
+				nDeferred++;
+				pCur = pCur->next();
+				continue;
+			}
+			showController(pCur, adjustment, nowMicros);
+		}
+		pCur->releaseScan();
 		pCur = pCur->next();
 	}
+	if(bRecord) { m_pRecorder->endFrame(); }
+
+	// then the strips that were latching, whichever is ready soonest first
+	while(nDeferred) {
+		int next = 0;
+		uint16_t soonest = deferred[0].pController->latchRemaining();
+		for(int i = 1; i < nDeferred && soonest; i++) {
+			uint16_t remaining = deferred[i].pController->latchRemaining();
+			if(remaining < soonest) { soonest = remaining; next = i; }
+		}
+		pCur = deferred[next].pController;
+		showController(pCur, deferred[next].adjustment, nowMicros);
+		pCur->releaseScan();
+		deferred[next] = deferred[--nDeferred];
+	}
+	m_bIdle = !bShown;
+	if(m_bIdle) { m_Stats.idleFrames++; }
+	m_Stats.frames++;
 	countFPS();
+	FASTLED_TRACE_EVENT(TRACE_SHOW_END, 0);
+}
+
+void CFastLED::showController(CLEDController *pCur, const CRGB & adjustment, uint32_t nowMicros) {
+	pCur->updateDitherBits(nowMicros, maxDitherBits());
+	uint32_t cycles = STATS_CYCLES();
+	pCur->m_Stats.begin();
+	TRACE_CONTROLLER(TRACE_CONTROLLER_BEGIN, pCur);
+	pCur->showFrame(adjustment);
+	TRACE_CONTROLLER(TRACE_CONTROLLER_END, pCur);
+	frameShown(pCur, cycles);
+}
+
+void CFastLED::setRecorder(CFrameRecorder *pRecorder) {
+	if(pRecorder) { pRecorder->begin(); }
+	m_pRecorder = pRecorder;
+}
+
+bool CFastLED::isShowing() {
+#ifdef FASTLED_ESP32_SHOW_TASK
+	if(sShowBusy) {
+		if(xSemaphoreTake(sShowDone, 0) != pdTRUE) { return true; }
+		sShowBusy = false;
+	}
+#endif
+	CLEDController *pCur = CLEDController::head();
+	while(pCur) {
+		if(pCur->isShowing()) { return true; }
+		wireFinished(pCur);
+		pCur = pCur->next();
+	}
+	waitShow();
+	return false;
+}
+
+void CFastLED::waitShow() {
+#ifdef FASTLED_ESP32_SHOW_TASK
+	if(sShowBusy) {
+		xSemaphoreTake(sShowDone, portMAX_DELAY);
+		sShowBusy = false;
+	}
+#endif
+	waitFully();
+	if(m_bShowPending) {
+		m_bShowPending = false;
+		if(m_pShowCallback) { (*m_pShowCallback)(m_pShowCallbackArg); }
+	}
+}
+
+void CFastLED::waitFully() {
+	FASTLED_TRACE_EVENT(TRACE_WAIT_BEGIN, 0);
+	CLEDController *pCur = CLEDController::head();
+	while(pCur) {
+		pCur->waitFully();
+		wireFinished(pCur);
+		pCur = pCur->next();
+	}
+	FASTLED_TRACE_EVENT(TRACE_WAIT_END, 0);
+}
+
+void CFastLED::wireFinished(CLEDController *pCur) {
+	if(!pCur->m_Stats.wirePending) { return; }
+	pCur->m_Stats.finished(STATS_CYCLES());
+	TRACE_CONTROLLER(TRACE_WIRE_END, pCur);
+}
+
+const FastLEDStats & CFastLED::getStats() {
+	m_Stats.interruptRetries = _retry_cnt;
+	return m_Stats;
+}
+
+void CFastLED::resetStats() {
+	m_Stats = FastLEDStats();
+	_retry_cnt = 0;
+	CLEDController *pCur = CLEDController::head();
+	while(pCur) {
+		pCur->resetStats();
+		pCur = pCur->next();
+	}
 }
 
 int CFastLED::count() {
@@ -86,22 +413,32 @@ CLEDController & CFastLED::operator[](int x) {
 }
 
 void CFastLED::showColor(const struct CRGB & color, uint8_t scale) {
-	while(m_nMinMicros && ((micros()-lastshow) < m_nMinMicros));
-	lastshow = micros();
+	waitShow();
+	throttle();
 
 	// If we have a function for computing power, use it!
 	if(m_pPowerFunc) {
+		uint32_t start = micros();
 		scale = (*m_pPowerFunc)(scale, m_nPowerData);
+		m_Stats.powerMicros += micros() - start;
 	}
 
+	uint32_t nowMicros = micros();
 	CLEDController *pCur = CLEDController::head();
 	while(pCur) {
-		uint8_t d = pCur->getDither();
-		if(m_nFPS < 100) { pCur->setDither(0); }
-		pCur->showColor(color, scale);
-		pCur->setDither(d);
+		pCur->updateDitherBits(nowMicros, maxDitherBits());
+		uint32_t cycles = STATS_CYCLES();
+		pCur->m_Stats.begin();
+		pCur->showColor(color, pCur->m_nLeds, pCur->getAdjustment(scale));
+		frameShown(pCur, cycles);
+		// the strip no longer shows the controller's led data, so the next show can't skip it
+		pCur->markDirty();
+		pCur->releaseScan();
 		pCur = pCur->next();
 	}
+	m_bIdle = false;
+	waitFully();
+	m_Stats.frames++;
 	countFPS();
 }
 
@@ -129,6 +466,17 @@ void CFastLED::delay(unsigned long ms) {
 		::delay(1);
 #endif
 		show();
+		if(m_bIdle && m_nIdleMode != IDLE_SHOW) {
+			// nothing went out, and nothing will until the leds change or a keepalive comes due
+			unsigned long elapsed = millis() - start;
+			if(elapsed < ms) {
+				uint32_t wait = ms - elapsed;
+				uint32_t keepalive = timeUntilKeepalive();
+				if(keepalive < wait) { wait = keepalive; }
+				if(m_nIdlePollMs < wait) { wait = m_nIdlePollMs; }
+				idle(wait);
+			}
+		}
 #if defined(ARDUINO) && (ARDUINO > 150) && !defined(IS_BEAN) && !defined (ARDUINO_AVR_DIGISPARK)
 		yield();
 #endif
@@ -136,6 +484,29 @@ void CFastLED::delay(unsigned long ms) {
 	while((millis()-start) < ms);
 }
 
+uint32_t CFastLED::timeUntilKeepalive() {
+	uint32_t now = millis();
+	uint32_t soonest = 0xFFFFFFFF;
+	for(CLEDController *pCur = CLEDController::head(); pCur; pCur = pCur->next()) {
+		uint32_t remaining = pCur->timeUntilKeepalive(now);
+		if(remaining < soonest) { soonest = remaining; }
+	}
+	return soonest;
+}
+
+void CFastLED::idle(uint32_t ms) {
+	if(ms == 0) { return; }
+#if defined(FASTLED_ESP32)
+	if(m_nIdleMode == IDLE_LIGHT_SLEEP) {
+		// the rmt and i2s stop in light sleep, so the last frame has to be all the way out first
+		waitShow();
+		esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000);
+		if(esp_light_sleep_start() == ESP_OK) { return; }
+	}
+#endif
+	::delay(ms);
+}
+
 void CFastLED::setTemperature(const struct CRGB & temp) {
 	CLEDController *pCur = CLEDController::head();
 	while(pCur) {
@@ -206,15 +577,12 @@ extern int noise_min;
 extern int noise_max;
 
 void CFastLED::countFPS(int nFrames) {
-  static int br = 0;
-  static uint32_t lastframe = 0; // millis();
-
-  if(br++ >= nFrames) {
+  if(m_nFPSFrames++ >= nFrames) {
 		uint32_t now = millis();
-		now -= lastframe;
-		m_nFPS = (br * 1000) / now;
-    br = 0;
-    lastframe = millis();
+		now -= m_nFPSMillis;
+		m_nFPS = (m_nFPSFrames * 1000) / now;
+    m_nFPSFrames = 0;
+    m_nFPSMillis = millis();
   }
 }
 
@@ -250,6 +618,41 @@ namespace __cxxabiv1
 	extern "C" void __cxa_guard_release (__guard *) __attribute__((weak));
 	extern "C" void __cxa_guard_abort (__guard *) __attribute__((weak));
 
+#if (FASTLED_PARALLEL == 1)
+	// The first byte of a guard is set once its object has been constructed, the second word while a task is
+	// constructing it.  With tasks on two cores, a task that finds the object being constructed waits for that to
+	// finish (or be abandoned) instead of constructing it a second time.
+	static inline volatile int *guardBusy(__guard *g) { return ((volatile int *)g) + 1; }
+
+	extern "C" int __cxa_guard_acquire (__guard *g)
+	{
+		for(;;) {
+			if(__atomic_load_n((char *)g, __ATOMIC_ACQUIRE)) { return 0; }
+			int idle = 0;
+			if(__atomic_compare_exchange_n(guardBusy(g), &idle, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+				// the object may have been finished between the check and getting here
+				if(__atomic_load_n((char *)g, __ATOMIC_ACQUIRE)) {
+					__atomic_store_n(guardBusy(g), 0, __ATOMIC_RELEASE);
+					return 0;
+				}
+				return 1;
+			}
+			// let the constructing task run, even if it's on this core at a lower priority
+			vTaskDelay(1);
+		}
+	}
+
+	extern "C" void __cxa_guard_release (__guard *g)
+	{
+		__atomic_store_n((char *)g, 1, __ATOMIC_RELEASE);
+		__atomic_store_n(guardBusy(g), 0, __ATOMIC_RELEASE);
+	}
+
+	extern "C" void __cxa_guard_abort (__guard *g)
+	{
+		__atomic_store_n(guardBusy(g), 0, __ATOMIC_RELEASE);
+	}
+#else
 	extern "C" int __cxa_guard_acquire (__guard *g)
 	{
 		return !*(char *)(g);
@@ -264,6 +667,7 @@ namespace __cxxabiv1
 	{
 
 	}
+#endif
 }
 #endif
 
@@ -42,6 +42,7 @@
 
 #include "fastled_config.h"
 #include "led_sysdefs.h"
+#include "trace.h"
 
 #include "bitswap.h"
 #include "controller.h"
@@ -54,12 +55,27 @@
 
 #include "lib8tion.h"
 #include "pixeltypes.h"
+#include "xymap.h"
+#include "parallel.h"
 #include "hsv2rgb.h"
 #include "colorutils.h"
 #include "pixelset.h"
 #include "colorpalettes.h"
+#include "paletteleds.h"
+#include "stagedleds.h"
+#include "planarleds.h"
+#include "interpolator.h"
+#include "framestream.h"
+#include "framedelta.h"
+#include "governor.h"
 
 #include "noise.h"
+#include "fire.h"
+#include "sprite.h"
+#include "particles.h"
+#include "scheduler.h"
+#include "sync.h"
+#include "compositor.h"
 #include "power_mgt.h"
 
 #include "fastspi.h"
@@ -149,6 +165,13 @@ enum EBlockChipsets {
 	TM1803_PORTD,
 	UCS1903_PORTD,
 #endif
+#ifdef PORTPWM_FIRST_PIN
+	WS2811_PORTPWM,
+	WS2813_PORTPWM,
+	WS2811_400_PORTPWM,
+	TM1803_PORTPWM,
+	UCS1903_PORTPWM,
+#endif
 #ifdef HAS_PORTDC
 	WS2811_PORTDC,
 	WS2813_PORTDC,
@@ -165,6 +188,28 @@ enum EBlockChipsets {
 #endif
 
 typedef uint8_t (*power_func)(uint8_t scale, uint32_t data);
+typedef void (*show_callback)(void *pArg);
+
+/// What FastLED.delay does while the leds are idle (see CFastLED::setIdleMode)
+enum EIdleMode {
+	IDLE_SHOW = 0,			///< keep calling show, the default
+	IDLE_WAIT = 1,			///< sleep with ::delay, which hands the cpu to other tasks (and frequency scaling)
+	IDLE_LIGHT_SLEEP = 2	///< ESP32: light sleep, falling back to IDLE_WAIT elsewhere or if it can't be had
+};
+
+class CFrameRecorder;
+
+/// Runtime statistics collected by FastLED.show/showColor.  Per controller timings are kept by each
+/// controller, see CLEDController::getStats.
+struct FastLEDStats {
+	uint32_t frames;			///< number of frames shown
+	uint32_t interruptRetries;	///< frames that had to be restarted because an interrupt ran too long
+	uint32_t throttleMicros;	///< total time spent waiting to stay under the max refresh rate
+	uint32_t powerMicros;		///< total time spent in the power limiting function
+	uint32_t idleFrames;		///< frames that had nothing to write out, every controller skipping an unchanged frame
+
+	FastLEDStats() : frames(0), interruptRetries(0), throttleMicros(0), powerMicros(0), idleFrames(0) {}
+};
 
 /// High level controller interface for FastLED.  This class manages controllers, global settings and trackings
 /// such as brightness, and refresh rates, and provides access functions for driving led data to controllers
@@ -174,9 +219,49 @@ class CFastLED {
 	// int m_nControllers;
 	uint8_t  m_Scale; 				///< The current global brightness scale setting
 	uint16_t m_nFPS;					///< Tracking for current FPS value
+	int m_nFPSFrames;			///< frames counted by countFPS since m_nFPS was last updated
+	uint32_t m_nFPSMillis;		///< when countFPS last updated m_nFPS
+	uint32_t m_nLastShow[FASTLED_SHOW_GROUPS];	///< when the last frame of each show group was started, in micros
 	uint32_t m_nMinMicros;		///< minimum µs between frames, used for capping frame rates.
 	uint32_t m_nPowerData;		///< max power use parameter
 	power_func m_pPowerFunc;	///< function for overriding brightness when using FastLED.show();
+	show_callback m_pShowCallback;	///< function to call when a frame started by showAsync is fully written out
+	void *m_pShowCallbackArg;	///< argument passed to m_pShowCallback
+	CFrameRecorder *m_pRecorder;	///< where shown frames get recorded, see setRecorder
+	CFrameGovernor *m_pGovernor;	///< what gets told how long frames take, see setGovernor
+	uint32_t m_nGovernorMark;	///< when the last frame of all the show groups was started, for the governor
+	bool m_bShowPending;		///< set while a frame has been started and its completion not yet reported
+	FastLEDStats m_Stats;		///< runtime statistics, see getStats
+	bool m_bYieldWhileThrottled;	///< yield instead of spinning when show is called faster than the max refresh rate
+	bool m_bIdle;				///< set when the last show had nothing to write out
+	uint8_t m_nIdleMode;		///< what delay does while idle, an EIdleMode
+	uint16_t m_nIdlePollMs;		///< how often delay checks for changed led data while idle, in ms
+
+	/// Pass up to ms milliseconds in the idle mode, for delay
+	void idle(uint32_t ms);
+
+	/// Wait until the max refresh rate allows another frame of the given show groups, then mark the start of the
+	/// new frame
+	void throttle(uint8_t groups = FASTLED_ALL_GROUPS);
+
+	/// Start writing out the current led colors on the controllers in the given show groups - the work behind
+	/// show/showAsync/showGroups
+	void startShow(uint8_t scale, uint8_t groups);
+
+	/// Record the timing of a frame a controller was just told to show, starting at the given cycle count
+	static void frameShown(CLEDController *pCur, uint32_t start);
+
+	/// Record the end of a frame that was going out in the background on a controller, if one was
+	static void wireFinished(CLEDController *pCur);
+
+	/// The most dithering bits the controllers get to pick, fewer at a governor's lower quality levels
+	uint8_t maxDitherBits() const { return m_pGovernor ? m_pGovernor->maxDitherBits() : VIRTUAL_BITS; }
+
+	/// Write a frame out on a controller, keeping its dithering and stats up to date
+	void showController(CLEDController *pCur, const CRGB & adjustment, uint32_t nowMicros);
+
+	/// Body of the output task used when FASTLED_ESP32_SHOW_TASK is defined
+	static void showTask(void *pArg);
 
 public:
 	CFastLED();
@@ -431,6 +516,13 @@ public:
 				case TM1803_PORTD: return addLeds(new InlineBlockClocklessController<NUM_LANES, PORTD_FIRST_PIN, NS(700), NS(1100), NS(700), RGB_ORDER>(), data, nLedsOrOffset, nLedsIfOffset);
 				case UCS1903_PORTD: return addLeds(new InlineBlockClocklessController<NUM_LANES, PORTD_FIRST_PIN, NS(500), NS(1500), NS(500), RGB_ORDER>(), data, nLedsOrOffset, nLedsIfOffset);
 		#endif
+		#ifdef PORTPWM_FIRST_PIN
+				case WS2811_PORTPWM: return addLeds(new PWMBlockClocklessController<NUM_LANES, NS(320), NS(320), NS(640), RGB_ORDER>(), data, nLedsOrOffset, nLedsIfOffset);
+				case WS2811_400_PORTPWM: return addLeds(new PWMBlockClocklessController<NUM_LANES, NS(800), NS(800), NS(900), RGB_ORDER>(), data, nLedsOrOffset, nLedsIfOffset);
+				case WS2813_PORTPWM: return addLeds(new PWMBlockClocklessController<NUM_LANES, NS(320), NS(320), NS(640), RGB_ORDER, 0, false, 300>(), data, nLedsOrOffset, nLedsIfOffset);
+				case TM1803_PORTPWM: return addLeds(new PWMBlockClocklessController<NUM_LANES, NS(700), NS(1100), NS(700), RGB_ORDER>(), data, nLedsOrOffset, nLedsIfOffset);
+				case UCS1903_PORTPWM: return addLeds(new PWMBlockClocklessController<NUM_LANES, NS(500), NS(1500), NS(500), RGB_ORDER>(), data, nLedsOrOffset, nLedsIfOffset);
+		#endif
 		#ifdef HAS_PORTDC
 				case WS2811_PORTDC: return addLeds(new SixteenWayInlineBlockClocklessController<NUM_LANES,NS(320), NS(320), NS(640), RGB_ORDER>(), data, nLedsOrOffset, nLedsIfOffset);
 				case WS2811_400_PORTDC: return addLeds(new SixteenWayInlineBlockClocklessController<NUM_LANES,NS(800), NS(800), NS(900), RGB_ORDER>(), data, nLedsOrOffset, nLedsIfOffset);
@@ -472,6 +564,65 @@ public:
 	/// Update all our controllers with the current led colors
 	void show() { show(m_Scale); }
 
+	/// Start writing out the current led colors on all our controllers, using the passed in brightness, without
+	/// waiting for the output to finish.  Controllers that write out in the background (dma, rmt) return as soon
+	/// as their output is started; all others write their data out before this returns, same as with show.  Don't
+	/// modify the led data until isShowing returns false (or waitShow returns).
+	/// @param scale temporarily override the scale
+	void showAsync(uint8_t scale);
+
+	/// Start writing out the current led colors on all our controllers, without waiting for the output to finish
+	void showAsync() { showAsync(m_Scale); }
+
+	/// Update only the controllers in the given show groups (see CLEDController::setGroups), using the passed in
+	/// brightness.  Each group is held to the max refresh rate on its own, so e.g. a fast group and a slow one can
+	/// each be shown at their own rate without one waiting on the other.  Power limiting looks at all the
+	/// controllers - the ones that aren't being shown are still lit.
+	/// @param groups the show groups to update, one bit per group
+	/// @param scale temporarily override the scale
+	void showGroups(uint8_t groups, uint8_t scale);
+
+	/// Update only the controllers in the given show groups with the current led colors
+	void showGroups(uint8_t groups) { showGroups(groups, m_Scale); }
+
+	/// Start writing out the controllers in the given show groups, without waiting for the output to finish, see
+	/// showAsync and showGroups
+	void showGroupsAsync(uint8_t groups, uint8_t scale);
+
+	/// Start writing out the controllers in the given show groups, without waiting for the output to finish
+	void showGroupsAsync(uint8_t groups) { showGroupsAsync(groups, m_Scale); }
+
+	/// Check whether a frame started with showAsync is still being written out.  If the frame has finished, the
+	/// completion callback (if any) is called from here.
+	/// @returns true if any controller is still writing out led data
+	bool isShowing();
+
+	/// Wait for the frame started with showAsync to be fully written out, then call the completion callback (if any).
+	void waitShow();
+
+	/// Set a function to be called once a frame is fully written out.  The callback is run from isShowing, waitShow
+	/// or the next show, never from an interrupt, so it is safe to touch led data from it.
+	/// @param pCallback the function to call, or NULL for none
+	/// @param pArg argument handed to the callback
+	void setShowCallback(show_callback pCallback, void *pArg = NULL) { m_pShowCallback = pCallback; m_pShowCallbackArg = pArg; }
+
+	/// Record every frame show writes out, see CFrameRecorder.  The recorder's frames are laid out for the controllers
+	/// that have been added by the time this is called.
+	/// @param pRecorder the recorder, or NULL to stop recording
+	void setRecorder(CFrameRecorder *pRecorder);
+
+	/// Have a governor keep the frame rate at the max refresh rate (see CFrameGovernor and setMaxRefreshRate), by
+	/// telling it how long every frame takes.  The controllers' dithering depth follows its quality level.
+	/// @param pGovernor the governor, or NULL for none
+	void setGovernor(CFrameGovernor *pGovernor) { m_pGovernor = pGovernor; m_nGovernorMark = 0; }
+
+	/// The quality level effects should render at, see CFrameGovernor - 255 without a governor
+	uint8_t getQuality() const { return m_pGovernor ? m_pGovernor->quality() : 255; }
+
+	/// Wait for all controllers to finish writing out their led data.  Called at the end of show and
+	/// showColor, which start every controller before waiting on any of them.
+	void waitFully();
+
 	/// clear the leds, wiping the local array of data, optionally black out the leds as well
 	/// @param writeData whether or not to write out to the leds as well
 	void clear(boolean writeData = false);
@@ -490,7 +641,8 @@ public:
 
 	/// Delay for the given number of milliseconds.  Provided to allow the library to be used on platforms
 	/// that don't have a delay function (to allow code to be more portable).  Note: this will call show
- 	/// constantly to drive the dithering engine (and will call show at least once).
+ 	/// constantly to drive the dithering engine (and will call show at least once) - unless an idle mode is set
+	/// (see setIdleMode) and the leds are idle.
 	/// @param ms the number of milliseconds to pause for
 	void delay(unsigned long ms);
 
@@ -506,7 +658,10 @@ public:
 
 	/// Set the dithering mode.  Sets the dithering mode for all added led strips, overriding
 	/// whatever previous dithering option those controllers may have had.
-	/// @param ditherMode - what type of dithering to use, either BINARY_DITHER or DISABLE_DITHER
+	/// @param ditherMode - what type of dithering to use: BINARY_DITHER, SPATIAL_DITHER or DISABLE_DITHER.  With
+	/// BINARY_DITHER, each controller gets as many bits of dithering as its measured refresh rate allows without
+	/// visible flicker (none below 100fps, VIRTUAL_BITS at 400fps and up).  SPATIAL_DITHER adds SPATIAL_DITHER_BITS
+	/// more, from a pattern over neighbouring leds, at any refresh rate.
 	void setDither(uint8_t ditherMode = BINARY_DITHER);
 
 	/// Set the maximum refresh rate.  This is global for all leds.  Attempts to
@@ -518,6 +673,54 @@ public:
 	/// @param constrain - constrain refresh rate to the slowest speed yet set
 	void setMaxRefreshRate(uint16_t refresh, bool constrain=false);
 
+	/// The shortest time between frames the max refresh rate allows
+	/// @returns the frame period in microseconds, 0 without a max refresh rate
+	uint32_t getFramePeriod() const { return m_nMinMicros; }
+
+	/// How long until the max refresh rate allows the next frame to be shown.  show and showColor
+	/// wait this long before writing anything out.
+	/// @param groups the show groups about to be shown, all of them by default
+	/// @returns the number of microseconds until the next frame can go out, 0 if it can go out now
+	uint32_t timeUntilNextShow(uint8_t groups = FASTLED_ALL_GROUPS);
+
+	/// Start the next frame with showAsync if it can go out right away, otherwise don't wait at all.  Lets a
+	/// single threaded render loop use the time until the next frame instead of blocking in show.
+	/// @param scale temporarily override the scale
+	/// @returns true if the frame was started, false if the previous frame is still being written out or the
+	/// max refresh rate doesn't allow another frame yet
+	bool tryShow(uint8_t scale);
+
+	/// Start the next frame with showAsync if it can go out right away, otherwise don't wait at all.
+	/// @returns true if the frame was started
+	bool tryShow() { return tryShow(m_Scale); }
+
+	/// Choose what show does when called faster than the max refresh rate allows.  By default it spins until the
+	/// next frame is due; with yielding on it sleeps through whole milliseconds (handing the cpu to other tasks
+	/// under FreeRTOS) and calls yield for the rest.
+	/// @param yieldWhileThrottled whether to yield rather than spin
+	void setYieldWhileThrottled(bool yieldWhileThrottled) { m_bYieldWhileThrottled = yieldWhileThrottled; }
+
+	/// Choose what delay does while the leds are idle - once a show had nothing to write out, because every
+	/// controller skips unchanged frames (see CLEDController::setSkipUnchanged) and none of them had changed.  Nothing
+	/// goes out then until the led data changes or a keepalive comes due, so instead of calling show over and over,
+	/// delay sleeps until the next keepalive (or the end of the delay), waking up every pollMs to check for led data
+	/// changed by other tasks or interrupts.  For static signage on the ESP32, IDLE_WAIT lets esp-idf's power
+	/// management (CONFIG_PM_ENABLE) lower the clocks while idle, or go into light sleep on its own with automatic
+	/// light sleep configured; IDLE_LIGHT_SLEEP goes into light sleep directly, once the last frame is all the way out
+	/// (the rmt and i2s stop in light sleep).
+	/// @param mode what to do while idle
+	/// @param pollMs the longest to stay idle before checking the led data again
+	void setIdleMode(EIdleMode mode, uint16_t pollMs = 20) { m_nIdleMode = mode; m_nIdlePollMs = pollMs ? pollMs : 1; }
+
+	/// Whether the last show had nothing to write out, see setIdleMode
+	bool isIdle() const { return m_bIdle; }
+
+	/// How long until one of the controllers sends an unchanged frame anyway, to keep its leds from timing out
+	/// (see CLEDController::setSkipUnchanged)
+	/// @returns the number of milliseconds until the next keepalive, 0 if a controller sends every frame, 0xFFFFFFFF
+	/// if there are no keepalives
+	uint32_t timeUntilKeepalive();
+
 	/// for debugging, will keep track of time between calls to countFPS, and every
 	/// nFrames calls, it will update an internal counter for the current FPS.
 	/// @todo make this a rolling counter
@@ -528,6 +731,14 @@ public:
 	/// @returns the most recently computed FPS value
 	uint16_t getFPS() { return m_nFPS; }
 
+	/// Get the runtime statistics collected so far.  Timings for each controller come from that
+	/// controller's getStats, e.g. FastLED[0].getStats()
+	/// @returns the current statistics
+	const FastLEDStats & getStats();
+
+	/// Clear out the collected statistics, including every controller's timings
+	void resetStats();
+
 	/// Get how many controllers have been registered
   /// @returns the number of controllers (strips) that have been added with addLeds
 	int count();
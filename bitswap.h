@@ -11,7 +11,7 @@ FASTLED_NAMESPACE_BEGIN
 ///@defgroup Bitswap Bit swapping/rotate
 ///Functions for doing a rotation of bits/bytes used by parallel output
 ///@{
-#if defined(FASTLED_ARM) || defined(FASTLED_ESP8266)
+#if defined(FASTLED_ARM) || defined(FASTLED_ESP8266) || defined(FASTLED_ESP32)
 /// structure representing 8 bits of access
 typedef union {
   uint8_t raw;
@@ -268,6 +268,66 @@ __attribute__((always_inline)) inline void transpose8(unsigned char *A, unsigned
   // B[4*n]=y>>24;  B[5*n]=y>>16;  B[6*n]=y>>8;  B[7*n]=y>>0;
 }
 
+/// Transpose 16 lanes of 8 bits, for parallel output on 16 pins: B[i] gets bit 7-i of every lane (the MSBs first, like
+/// transpose8x1_MSB), with lane k in bit k.  The same delta swaps as the 8x8 transposes (see
+/// http://www.hackersdelight.org/hdcodetxt/transpose8.c.txt), done on four words of two half word rows each so that
+/// none of it has to be done 8 lanes at a time and shuffled back together.
+///@param A the lanes' bytes, A[k] for lane k
+///@param B the 8 16 bit words to write out, one per bit
+__attribute__((always_inline)) inline void transpose16x8(const unsigned char *A, uint16_t *B) {
+  uint32_t w0, w1, w2, w3, t;
+
+  // Load the lanes: word i gets lanes i and i+8 in its low half word, and lanes i+4 and i+12 in its high one
+  w0 = A[0] | (A[8]<<8)  | (A[4]<<16) | ((uint32_t)A[12]<<24);
+  w1 = A[1] | (A[9]<<8)  | (A[5]<<16) | ((uint32_t)A[13]<<24);
+  w2 = A[2] | (A[10]<<8) | (A[6]<<16) | ((uint32_t)A[14]<<24);
+  w3 = A[3] | (A[11]<<8) | (A[7]<<16) | ((uint32_t)A[15]<<24);
+
+  // swap 2 bit blocks between words 2 apart, then single bits between neighboring words
+  t = ((w0 >> 2) ^ w2) & 0x33333333;  w2 ^= t;  w0 ^= (t << 2);
+  t = ((w1 >> 2) ^ w3) & 0x33333333;  w3 ^= t;  w1 ^= (t << 2);
+  t = ((w0 >> 1) ^ w1) & 0x55555555;  w1 ^= t;  w0 ^= (t << 1);
+  t = ((w2 >> 1) ^ w3) & 0x55555555;  w3 ^= t;  w2 ^= (t << 1);
+
+  // swap nibbles between the half words, leaving bits 0-3 of the data in the low half words, bits 4-7 in the high ones
+  t = (w0 ^ (w0 >> 12)) & 0x0000F0F0;  w0 ^= t ^ (t << 12);
+  t = (w1 ^ (w1 >> 12)) & 0x0000F0F0;  w1 ^= t ^ (t << 12);
+  t = (w2 ^ (w2 >> 12)) & 0x0000F0F0;  w2 ^= t ^ (t << 12);
+  t = (w3 ^ (w3 >> 12)) & 0x0000F0F0;  w3 ^= t ^ (t << 12);
+
+  B[0] = w3 >> 16;  B[1] = w2 >> 16;  B[2] = w1 >> 16;  B[3] = w0 >> 16;
+  B[4] = w3;        B[5] = w2;        B[6] = w1;        B[7] = w0;
+}
+
+/// Transpose 32 lanes of 8 bits, for parallel output on 32 pins (or 24, with the top lanes' bytes left 0): B[i] gets
+/// bit 7-i of every lane (the MSBs first, like transpose8x1_MSB), with lane k in bit k.  The same delta swaps as the 8x8
+/// transposes, done on eight words of 4 lanes each.
+///@param A the lanes' bytes, A[k] for lane k
+///@param B the 8 32 bit words to write out, one per bit
+__attribute__((always_inline)) inline void transpose32x8(const unsigned char *A, uint32_t *B) {
+  uint32_t w[8], t;
+
+  // Load the lanes: word i gets lanes i, i+8, i+16 and i+24
+  for(int i = 0; i < 8; i++) {
+    w[i] = A[i] | (A[i+8]<<8) | (A[i+16]<<16) | ((uint32_t)A[i+24]<<24);
+  }
+
+  // swap nibbles between words 4 apart, 2 bit blocks between words 2 apart, then single bits between neighbors
+  for(int i = 0; i < 4; i++) {
+    t = ((w[i] >> 4) ^ w[i+4]) & 0x0F0F0F0F;  w[i+4] ^= t;  w[i] ^= (t << 4);
+  }
+  for(int i = 0; i < 8; i += 4) {
+    t = ((w[i] >> 2) ^ w[i+2]) & 0x33333333;  w[i+2] ^= t;  w[i] ^= (t << 2);
+    t = ((w[i+1] >> 2) ^ w[i+3]) & 0x33333333;  w[i+3] ^= t;  w[i+1] ^= (t << 2);
+  }
+  for(int i = 0; i < 8; i += 2) {
+    t = ((w[i] >> 1) ^ w[i+1]) & 0x55555555;  w[i+1] ^= t;  w[i] ^= (t << 1);
+  }
+
+  // word i now has bit i of every lane
+  for(int i = 0; i < 8; i++) { B[i] = w[7-i]; }
+}
+
 #endif
 
 FASTLED_NAMESPACE_END
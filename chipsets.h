@@ -31,6 +31,8 @@ class PixieController : public CPixelLEDController<RGB_ORDER> {
 public:
 	PixieController() : Serial(-1, DATA_PIN) {}
 
+	virtual uint16_t latchRemaining() { return mWait.remaining(); }
+
 protected:
 	virtual void init() {
 		Serial.begin(115200);
@@ -102,7 +104,7 @@ public:
 protected:
 
 	virtual void showPixels(PixelController<RGB_ORDER> & pixels) {
-		mSPI.template writePixels<0, LPD8806_ADJUST, RGB_ORDER>(pixels);
+		mSPI.template writePixels<FLAG_YIELD, LPD8806_ADJUST, RGB_ORDER>(pixels);
 	}
 };
 
@@ -149,6 +151,95 @@ class WS2803Controller : public WS2801Controller<DATA_PIN, CLOCK_PIN, RGB_ORDER,
 //
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Define this to have the APA102/SK9822 controllers do the bulk of the brightness scaling with the chips' 5 bit global
+// brightness, picked once per frame from the brightness/color correction scale, instead of scaling the color bytes down.
+// The color bytes keep (close to) their full 8 bits of resolution at low brightness, so dithering is turned off.
+// #define FASTLED_APA102_GLOBAL_BRIGHTNESS
+
+/// Pick the led header byte (0xE0 | 5 bit global brightness) for a frame.  With FASTLED_APA102_GLOBAL_BRIGHTNESS, the
+/// global brightness is the smallest one that covers the largest channel of the frame's scale, and the scale is
+/// stretched to make up the difference (and dithering is turned off); otherwise it's always full brightness.
+template<EOrder RGB_ORDER> uint8_t apa102FrameHeader(PixelController<RGB_ORDER> & pixels) {
+	// 16 bit data gets its global brightness picked per led, see apa102LoadLed
+	if(pixels.is16()) { return 0xFF; }
+#ifdef FASTLED_APA102_GLOBAL_BRIGHTNESS
+	uint8_t maxScale = pixels.mScale.raw[0];
+	if(pixels.mScale.raw[1] > maxScale) { maxScale = pixels.mScale.raw[1]; }
+	if(pixels.mScale.raw[2] > maxScale) { maxScale = pixels.mScale.raw[2]; }
+
+	uint8_t brightness = ((uint16_t)maxScale * 31 + 254) / 255;
+	if(brightness) {
+		for(int i = 0; i < 3; i++) {
+			uint16_t s = ((uint16_t)pixels.mScale.raw[i] * 31 + (brightness / 2)) / brightness;
+			pixels.mScale.raw[i] = (s > 255) ? 255 : s;
+		}
+	}
+	pixels.enable_dithering(DISABLE_DITHER);
+	return 0xE0 | brightness;
+#else
+	return 0xFF;
+#endif
+}
+
+/// Load the next led's header byte and color bytes.  For 16 bit data (CRGB16), the channels are scaled at 16 bits and
+/// split into the smallest 5 bit global brightness that covers the brightest of them and 8 bit color values relative
+/// to it, which keeps far more resolution at the low end than scaling 8 bit values down.  Dithering isn't needed then.
+/// @param header the frame's header byte from apa102FrameHeader, used as is for 8 bit data
+template<EOrder RGB_ORDER> __attribute__((always_inline)) inline uint8_t apa102LoadLed(PixelController<RGB_ORDER> & pixels, uint8_t header, uint8_t & b0, uint8_t & b1, uint8_t & b2) {
+	if(!pixels.is16()) {
+		b0 = pixels.loadAndScale0();
+		b1 = pixels.loadAndScale1();
+		b2 = pixels.loadAndScale2();
+#ifndef FASTLED_APA102_GLOBAL_BRIGHTNESS
+		pixels.stepDithering();
+#endif
+		return header;
+	}
+
+	uint16_t c0 = pixels.loadAndScale16_0();
+	uint16_t c1 = pixels.loadAndScale16_1();
+	uint16_t c2 = pixels.loadAndScale16_2();
+	uint16_t m = c0;
+	if(c1 > m) { m = c1; }
+	if(c2 > m) { m = c2; }
+
+	uint8_t brightness = ((uint32_t)m * 31 + 65534) / 65535;
+	if(brightness == 0) { b0 = b1 = b2 = 0; return 0xE0; }
+
+	// c * 31 / (brightness * 257) is at most 255 for every channel, done as one division per led plus multiplies
+	uint32_t recip = ((31UL << 16) + (brightness * 257 / 2)) / (brightness * 257);
+	uint32_t v;
+	v = ((uint32_t)c0 * recip + 0x8000) >> 16; b0 = (v > 255) ? 255 : v;
+	v = ((uint32_t)c1 * recip + 0x8000) >> 16; b1 = (v > 255) ? 255 : v;
+	v = ((uint32_t)c2 * recip + 0x8000) >> 16; b2 = (v > 255) ? 255 : v;
+	return 0xE0 | brightness;
+}
+
+#ifdef FASTLED_SPI_BLOCK_WRITES
+/// Encode a whole APA102/SK9822 frame - start boundary, leds, end boundary - into a block buffer
+/// @param endByte the first byte of each end boundary dword (0xFF for APA102, 0x00 for SK9822)
+/// @returns the number of bytes encoded, 0 if the buffer couldn't be allocated
+template<EOrder RGB_ORDER> int encodeAPA102Frame(PixelController<RGB_ORDER> & pixels, CSPIBlockBuffer & block, uint8_t endByte) {
+	uint8_t header = apa102FrameHeader(pixels);
+	int nEndDWords = (pixels.size()/32) + 1;
+	int len = 4 + (pixels.size() * 4) + (nEndDWords * 4);
+	uint8_t *p = block.reserve(len);
+	if(p == NULL) { return 0; }
+
+	*p++ = 0; *p++ = 0; *p++ = 0; *p++ = 0;
+	while(pixels.has(1)) {
+		uint8_t b0, b1, b2;
+		*p++ = apa102LoadLed(pixels, header, b0, b1, b2);
+		*p++ = b0;
+		*p++ = b1;
+		*p++ = b2;
+		pixels.advanceData();
+	}
+	while(nEndDWords--) { *p++ = endByte; *p++ = 0x00; *p++ = 0x00; *p++ = 0x00; }
+	return len;
+}
+#endif
+
 /// APA102 controller class.
 /// @tparam DATA_PIN the data pin for these leds
 /// @tparam CLOCK_PIN the clock pin for these leds
@@ -158,6 +249,9 @@ template <uint8_t DATA_PIN, uint8_t CLOCK_PIN, EOrder RGB_ORDER = RGB, uint8_t S
 class APA102Controller : public CPixelLEDController<RGB_ORDER> {
 	typedef SPIOutput<DATA_PIN, CLOCK_PIN, SPI_SPEED> SPI;
 	SPI mSPI;
+#ifdef FASTLED_SPI_BLOCK_WRITES
+	CSPIBlockBuffer mBlock;
+#endif
 
 	void startBoundary() { mSPI.writeWord(0); mSPI.writeWord(0); }
 	void endBoundary(int nLeds) { int nDWords = (nLeds/32); do { mSPI.writeByte(0xFF); mSPI.writeByte(0x00); mSPI.writeByte(0x00); mSPI.writeByte(0x00); } while(nDWords--); }
@@ -173,27 +267,43 @@ public:
 		mSPI.init();
 	}
 
+#ifdef FASTLED_SPI_BLOCK_WRITES
+	// block writes are left to go out in the background, so that controllers on different SPI buses run together
+	virtual void waitFully() { mSPI.waitFully(); }
+	virtual bool isShowing() { return mSPI.busy(); }
+#endif
+
 protected:
 
 	virtual void showPixels(PixelController<RGB_ORDER> & pixels) {
+#ifdef FASTLED_SPI_BLOCK_WRITES
+		// the previous frame may still be going out of the block buffer
+		mSPI.waitFully();
+		int len = encodeAPA102Frame(pixels, mBlock, 0xFF);
+		if(len) {
+			mSPI.writeBytes(mBlock.data(), len);
+			return;
+		}
+#endif
+		uint8_t header = apa102FrameHeader(pixels);
+		CSPIYield<FASTLED_SPI_CHUNK_LEDS> chunk;
 		mSPI.select();
 
 		startBoundary();
 		while(pixels.has(1)) {
+			uint8_t b0, b1, b2;
+			uint8_t h = apa102LoadLed(pixels, header, b0, b1, b2);
 #ifdef FASTLED_SPI_BYTE_ONLY
-			mSPI.writeByte(0xFF);
-			mSPI.writeByte(pixels.loadAndScale0());
-			mSPI.writeByte(pixels.loadAndScale1());
-			mSPI.writeByte(pixels.loadAndScale2());
+			mSPI.writeByte(h);
+			mSPI.writeByte(b0);
+			mSPI.writeByte(b1);
+			mSPI.writeByte(b2);
 #else
-			uint16_t b = 0xFF00 | (uint16_t)pixels.loadAndScale0();
-			mSPI.writeWord(b);
-			uint16_t w = pixels.loadAndScale1() << 8;
-			w |= pixels.loadAndScale2();
-			mSPI.writeWord(w);
+			mSPI.writeWord(((uint16_t)h << 8) | b0);
+			mSPI.writeWord(((uint16_t)b1 << 8) | b2);
 #endif
-			pixels.stepDithering();
 			pixels.advanceData();
+			chunk.step();
 		}
 		endBoundary(pixels.size());
 		mSPI.waitFully();
@@ -211,6 +321,9 @@ template <uint8_t DATA_PIN, uint8_t CLOCK_PIN, EOrder RGB_ORDER = RGB, uint8_t S
 class SK9822Controller : public CPixelLEDController<RGB_ORDER> {
 	typedef SPIOutput<DATA_PIN, CLOCK_PIN, SPI_SPEED> SPI;
 	SPI mSPI;
+#ifdef FASTLED_SPI_BLOCK_WRITES
+	CSPIBlockBuffer mBlock;
+#endif
 
 	void startBoundary() { mSPI.writeWord(0); mSPI.writeWord(0); }
 	void endBoundary(int nLeds) { int nLongWords = (nLeds/32); do { mSPI.writeByte(0x00); mSPI.writeByte(0x00); mSPI.writeByte(0x00); mSPI.writeByte(0x00); } while(nLongWords--); }
@@ -226,27 +339,43 @@ public:
 		mSPI.init();
 	}
 
+#ifdef FASTLED_SPI_BLOCK_WRITES
+	// block writes are left to go out in the background, so that controllers on different SPI buses run together
+	virtual void waitFully() { mSPI.waitFully(); }
+	virtual bool isShowing() { return mSPI.busy(); }
+#endif
+
 protected:
 
 	virtual void showPixels(PixelController<RGB_ORDER> & pixels) {
+#ifdef FASTLED_SPI_BLOCK_WRITES
+		// the previous frame may still be going out of the block buffer
+		mSPI.waitFully();
+		int len = encodeAPA102Frame(pixels, mBlock, 0x00);
+		if(len) {
+			mSPI.writeBytes(mBlock.data(), len);
+			return;
+		}
+#endif
+		uint8_t header = apa102FrameHeader(pixels);
+		CSPIYield<FASTLED_SPI_CHUNK_LEDS> chunk;
 		mSPI.select();
 
 		startBoundary();
 		while(pixels.has(1)) {
+			uint8_t b0, b1, b2;
+			uint8_t h = apa102LoadLed(pixels, header, b0, b1, b2);
 #ifdef FASTLED_SPI_BYTE_ONLY
-			mSPI.writeByte(0xFF);
-			mSPI.writeByte(pixels.loadAndScale0());
-			mSPI.writeByte(pixels.loadAndScale1());
-			mSPI.writeByte(pixels.loadAndScale2());
+			mSPI.writeByte(h);
+			mSPI.writeByte(b0);
+			mSPI.writeByte(b1);
+			mSPI.writeByte(b2);
 #else
-			uint16_t b = 0xFF00 | (uint16_t)pixels.loadAndScale0();
-			mSPI.writeWord(b);
-			uint16_t w = pixels.loadAndScale1() << 8;
-			w |= pixels.loadAndScale2();
-			mSPI.writeWord(w);
+			mSPI.writeWord(((uint16_t)h << 8) | b0);
+			mSPI.writeWord(((uint16_t)b1 << 8) | b2);
 #endif
-			pixels.stepDithering();
 			pixels.advanceData();
+			chunk.step();
 		}
 
 		endBoundary(pixels.size());
@@ -292,6 +421,7 @@ public:
 protected:
 
 	virtual void showPixels(PixelController<RGB_ORDER> & pixels) {
+		CSPIYield<FASTLED_SPI_CHUNK_LEDS> chunk;
 		mSPI.select();
 
 		writeBoundary();
@@ -299,6 +429,7 @@ protected:
 			writeLed(pixels.loadAndScale0(), pixels.loadAndScale1(), pixels.loadAndScale2());
 			pixels.advanceData();
 			pixels.stepDithering();
+			chunk.step();
 		}
 		writeBoundary();
 		mSPI.waitFully();
@@ -348,7 +479,7 @@ protected:
 		// Make sure the FLAG_START_BIT flag is set to ensure that an extra 1 bit is sent at the start
 		// of each triplet of bytes for rgb data
 		// writeHeader();
-		mSPI.template writePixels<FLAG_START_BIT, DATA_NOP, RGB_ORDER>( pixels );
+		mSPI.template writePixels<FLAG_START_BIT | FLAG_YIELD, DATA_NOP, RGB_ORDER>( pixels );
 		writeHeader();
 	}
 
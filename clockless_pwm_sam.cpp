@@ -0,0 +1,21 @@
+#define FASTLED_INTERNAL
+#include "FastLED.h"
+
+#if defined(__SAM3X8E__) && (FASTLED_SAM_PWM_DMA == 1)
+
+FASTLED_NAMESPACE_BEGIN
+
+// The arduino core links the library in as objects, not an archive, so with FASTLED_SAM_PWM_DMA on this PWM_Handler
+// is in every sketch, whether it has a PWMBlockClocklessController or not
+void (*SAMPWMInterrupt::sHandler)(void *pArg) = NULL;
+void *SAMPWMInterrupt::sArg = NULL;
+
+FASTLED_NAMESPACE_END
+
+FASTLED_USING_NAMESPACE
+
+extern "C" void PWM_Handler(void) {
+	if(SAMPWMInterrupt::sHandler) { (*SAMPWMInterrupt::sHandler)(SAMPWMInterrupt::sArg); }
+}
+
+#endif
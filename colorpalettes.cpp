@@ -155,6 +155,18 @@ extern const TProgmemRGBPalette16 HeatColors_p FL_PROGMEM =
 };
 
 
+#if (FASTLED_PALETTE_TABLES == 1)
+// worked out by the compiler from the palettes above, no code runs for these
+extern const TRGBPaletteTable CloudColors_t         FASTLED_PALETTE_TABLE_ATTR = PaletteTable( CloudColors_p);
+extern const TRGBPaletteTable LavaColors_t          FASTLED_PALETTE_TABLE_ATTR = PaletteTable( LavaColors_p);
+extern const TRGBPaletteTable OceanColors_t         FASTLED_PALETTE_TABLE_ATTR = PaletteTable( OceanColors_p);
+extern const TRGBPaletteTable ForestColors_t        FASTLED_PALETTE_TABLE_ATTR = PaletteTable( ForestColors_p);
+extern const TRGBPaletteTable RainbowColors_t       FASTLED_PALETTE_TABLE_ATTR = PaletteTable( RainbowColors_p);
+extern const TRGBPaletteTable RainbowStripeColors_t FASTLED_PALETTE_TABLE_ATTR = PaletteTable( RainbowStripeColors_p);
+extern const TRGBPaletteTable PartyColors_t         FASTLED_PALETTE_TABLE_ATTR = PaletteTable( PartyColors_p);
+extern const TRGBPaletteTable HeatColors_t          FASTLED_PALETTE_TABLE_ATTR = PaletteTable( HeatColors_p);
+#endif
+
 // Gradient palette "Rainbow_gp",
 // provided for situations where you're going
 // to use a number of other gradient palettes, AND
@@ -49,6 +49,20 @@ extern const TProgmemRGBPalette16 PartyColors_p FL_PROGMEM;
 extern const TProgmemRGBPalette16 HeatColors_p FL_PROGMEM;
 
 
+#if (FASTLED_PALETTE_TABLES == 1)
+/// The palettes above, expanded to 256 colors each at compile time (see
+/// TRGBPaletteTable), for ColorFromPalette lookups that don't touch flash
+/// or interpolate.  Only the ones a sketch uses end up in the build.
+extern const TRGBPaletteTable CloudColors_t;
+extern const TRGBPaletteTable LavaColors_t;
+extern const TRGBPaletteTable OceanColors_t;
+extern const TRGBPaletteTable ForestColors_t;
+extern const TRGBPaletteTable RainbowColors_t;
+extern const TRGBPaletteTable RainbowStripeColors_t;
+extern const TRGBPaletteTable PartyColors_t;
+extern const TRGBPaletteTable HeatColors_t;
+#endif
+
 DECLARE_GRADIENT_PALETTE( Rainbow_gp);
 
 FASTLED_NAMESPACE_END
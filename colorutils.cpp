@@ -9,14 +9,6 @@ FASTLED_NAMESPACE_BEGIN
 
 
 
-void fill_solid( struct CRGB * leds, int numToFill,
-                 const struct CRGB& color)
-{
-    for( int i = 0; i < numToFill; i++) {
-        leds[i] = color;
-    }
-}
-
 void fill_solid( struct CHSV * targetArray, int numToFill,
                  const struct CHSV& hsvColor)
 {
@@ -36,13 +28,29 @@ void fill_rainbow( struct CRGB * pFirstLED, int numToFill,
                   uint8_t initialhue,
                   uint8_t deltahue )
 {
-    CHSV hsv;
-    hsv.hue = initialhue;
-    hsv.val = 255;
-    hsv.sat = 240;
-    for( int i = 0; i < numToFill; i++) {
-        pFirstLED[i] = hsv;
-        hsv.hue += deltahue;
+    // The hues repeat every 256 / (the lowest set bit of deltahue)
+    // leds, so only the first cycle gets converted, a batch at a time
+    // (see hsv2rgb_rainbow), and the rest is copied from it.
+    int period = deltahue ? (256 / (deltahue & -deltahue)) : 1;
+    int converted = (numToFill < period) ? numToFill : period;
+
+    CHSV hsv[GRADIENT_BATCH];
+    uint8_t hue = initialhue;
+    for( int i = 0; i < converted; i += GRADIENT_BATCH) {
+        int count = converted - i;
+        if( count > GRADIENT_BATCH) count = GRADIENT_BATCH;
+        for( int j = 0; j < count; j++) {
+            hsv[j] = CHSV( hue, 240, 255);
+            hue += deltahue;
+        }
+        hsv2rgb_rainbow( hsv, pFirstLED + i, count);
+    }
+
+    for( int done = converted; done < numToFill; ) {
+        int count = numToFill - done;
+        if( count > done) count = done;
+        memcpy( (void*)(pFirstLED + done), (const void*)pFirstLED, count * sizeof(CRGB));
+        done += count;
     }
 }
 
@@ -168,13 +176,6 @@ void fill_gradient_RGB( CRGB* leds, uint16_t numLeds, const CRGB& c1, const CRGB
 
 
 
-void nscale8_video( CRGB* leds, uint16_t num_leds, uint8_t scale)
-{
-    for( uint16_t i = 0; i < num_leds; i++) {
-        leds[i].nscale8_video( scale);
-    }
-}
-
 void fade_video(CRGB* leds, uint16_t num_leds, uint8_t fadeBy)
 {
     nscale8_video( leds, num_leds, 255 - fadeBy);
@@ -201,11 +202,145 @@ void nscale8_raw( CRGB* leds, uint16_t num_leds, uint8_t scale)
     nscale8( leds, num_leds, scale);
 }
 
+// On 32 bit targets, the bulk scale and blend functions work on whole words,
+// four bytes at a time.  Every byte of a CRGB array gets the same treatment, so
+// the array is handled as plain bytes, with byte-at-a-time heads and tails to
+// get to (and past) the aligned words.  The even and odd bytes of a word are
+// spread out into 16 bit lanes, and the math is arranged so that no lane can
+// overflow into the next, which makes the results bit-identical to scale8 and
+// blend8 (fixed or not).
+#ifndef FASTLED_SWAR_MATH
+#if defined(__AVR__)
+#define FASTLED_SWAR_MATH 0
+#else
+#define FASTLED_SWAR_MATH 1
+#endif
+#endif
+
+#if (FASTLED_SWAR_MATH == 1)
+typedef uint32_t __attribute__((__may_alias__)) swar_word_t;
+
+#define SWAR_LANES 0x00FF00FFUL
+
+// per byte: (a * sa + b * sb) >> 8, with sa + sb <= 257 (so 255 * 257 still fits a lane)
+LIB8STATIC_ALWAYS_INLINE uint32_t swar_blend8( uint32_t a, uint32_t b, uint16_t sa, uint16_t sb)
+{
+    uint32_t even = (((a & SWAR_LANES) * sa) + ((b & SWAR_LANES) * sb)) >> 8;
+    uint32_t odd  = (((a >> 8) & SWAR_LANES) * sa) + (((b >> 8) & SWAR_LANES) * sb);
+    return (even & SWAR_LANES) | (odd & ~SWAR_LANES);
+}
+
+// scale8 (or scale8_video) every byte, with scale8x4 (scale8x4_video) doing
+// the aligned words
+template<bool VIDEO>
+static void swar_nscale8( uint8_t* p, uint32_t bytes, uint8_t s)
+{
+    while( bytes && ((uintptr_t)p & 0x03)) {
+        *p = VIDEO ? scale8_video( *p, s) : scale8( *p, s);
+        p++; bytes--;
+    }
+    // four pixels (three words) per pass
+    while( bytes >= 12) {
+        swar_word_t* w = (swar_word_t*)p;
+        w[0] = VIDEO ? scale8x4_video( w[0], s) : scale8x4( w[0], s);
+        w[1] = VIDEO ? scale8x4_video( w[1], s) : scale8x4( w[1], s);
+        w[2] = VIDEO ? scale8x4_video( w[2], s) : scale8x4( w[2], s);
+        p += 12; bytes -= 12;
+    }
+    while( bytes >= 4) {
+        *(swar_word_t*)p = VIDEO ? scale8x4_video( *(swar_word_t*)p, s) : scale8x4( *(swar_word_t*)p, s);
+        p += 4; bytes -= 4;
+    }
+    while( bytes--) {
+        *p = VIDEO ? scale8_video( *p, s) : scale8( *p, s);
+        p++;
+    }
+}
+
+// three words hold four pixels, so once p is word aligned the color is
+// written out as a repeating pattern of three words
+static void swar_fill( uint8_t* p, uint32_t bytes, const CRGB& color)
+{
+    uint8_t c = 0;
+    while( bytes && ((uintptr_t)p & 0x03)) {
+        *p++ = color.raw[c];
+        if( ++c == 3) { c = 0; }
+        bytes--;
+    }
+    // the words of the pattern are built as words, so they're aligned
+    union { uint32_t words[3]; uint8_t raw[12]; } pattern;
+    for( uint8_t i = 0; i < 12; i++) {
+        pattern.raw[i] = color.raw[c];
+        if( ++c == 3) { c = 0; }
+    }
+    uint32_t w0 = pattern.words[0], w1 = pattern.words[1], w2 = pattern.words[2];
+    while( bytes >= 12) {
+        swar_word_t* w = (swar_word_t*)p;
+        w[0] = w0;
+        w[1] = w1;
+        w[2] = w2;
+        p += 12; bytes -= 12;
+    }
+    for( uint8_t i = 0; i < bytes; i++) {
+        p[i] = pattern.raw[i];
+    }
+}
+
+static void swar_blend8( const uint8_t* a, const uint8_t* b, uint8_t* out, uint32_t bytes, uint16_t sa, uint16_t sb)
+{
+    // words only work out if all three arrays are equally (mis)aligned
+    if( (((uintptr_t)a ^ (uintptr_t)b) | ((uintptr_t)a ^ (uintptr_t)out)) & 0x03) {
+        while( bytes--) { *out++ = ((*a++ * sa) + (*b++ * sb)) >> 8; }
+        return;
+    }
+    while( bytes && ((uintptr_t)a & 0x03)) {
+        *out++ = ((*a++ * sa) + (*b++ * sb)) >> 8;
+        bytes--;
+    }
+    while( bytes >= 4) {
+        *(swar_word_t*)out = swar_blend8( *(const swar_word_t*)a, *(const swar_word_t*)b, sa, sb);
+        a += 4; b += 4; out += 4; bytes -= 4;
+    }
+    while( bytes--) {
+        *out++ = ((*a++ * sa) + (*b++ * sb)) >> 8;
+    }
+}
+#endif
+
+void fill_solid( struct CRGB * leds, int numToFill,
+                 const struct CRGB& color)
+{
+#if (FASTLED_SWAR_MATH == 1)
+    if( numToFill > 0) {
+        swar_fill( (uint8_t*)leds, numToFill * 3UL, color);
+    }
+#else
+    for( int i = 0; i < numToFill; i++) {
+        leds[i] = color;
+    }
+#endif
+}
+
+void nscale8_video( CRGB* leds, uint16_t num_leds, uint8_t scale)
+{
+#if (FASTLED_SWAR_MATH == 1)
+    swar_nscale8<true>( (uint8_t*)leds, num_leds * 3UL, scale);
+#else
+    for( uint16_t i = 0; i < num_leds; i++) {
+        leds[i].nscale8_video( scale);
+    }
+#endif
+}
+
 void nscale8( CRGB* leds, uint16_t num_leds, uint8_t scale)
 {
+#if (FASTLED_SWAR_MATH == 1)
+    swar_nscale8<false>( (uint8_t*)leds, num_leds * 3UL, scale);
+#else
     for( uint16_t i = 0; i < num_leds; i++) {
         leds[i].nscale8( scale);
     }
+#endif
 }
 
 void fadeUsingColor( CRGB* leds, uint16_t numLeds, const CRGB& colormask)
@@ -258,8 +393,35 @@ CRGB& nblend( CRGB& existing, const CRGB& overlay, fract8 amountOfOverlay )
 
 
 
+#if (FASTLED_SWAR_MATH == 1) && (FASTLED_BLEND_FIXED == 1)
+// blend8, for a whole array: dest = src1 blended towards src2
+static void blendArrays( const CRGB* src1, const CRGB* src2, CRGB* dest, uint16_t count, fract8 amountOfsrc2)
+{
+#if (FASTLED_SCALE8_FIXED == 1)
+    uint16_t sa = 256 - amountOfsrc2;
+    uint16_t sb = amountOfsrc2 + 1;
+#else
+    uint16_t sa = 255 - amountOfsrc2;
+    uint16_t sb = amountOfsrc2;
+#endif
+    swar_blend8( (const uint8_t*)src1, (const uint8_t*)src2, (uint8_t*)dest, count * 3UL, sa, sb);
+}
+#endif
+
 void nblend( CRGB* existing, CRGB* overlay, uint16_t count, fract8 amountOfOverlay)
 {
+#if (FASTLED_SWAR_MATH == 1) && (FASTLED_BLEND_FIXED == 1)
+    // same early outs as the single pixel nblend
+    if( amountOfOverlay == 0) {
+        return;
+    }
+    if( amountOfOverlay == 255) {
+        for( uint16_t i = 0; i < count; i++) { existing[i] = overlay[i]; }
+        return;
+    }
+    blendArrays( existing, overlay, existing, count, amountOfOverlay);
+    return;
+#endif
     for( uint16_t i = count; i; i--) {
         nblend( *existing, *overlay, amountOfOverlay);
         existing++;
@@ -276,6 +438,18 @@ CRGB blend( const CRGB& p1, const CRGB& p2, fract8 amountOfP2 )
 
 CRGB* blend( const CRGB* src1, const CRGB* src2, CRGB* dest, uint16_t count, fract8 amountOfsrc2 )
 {
+#if (FASTLED_SWAR_MATH == 1) && (FASTLED_BLEND_FIXED == 1)
+    if( amountOfsrc2 == 0) {
+        for( uint16_t i = 0; i < count; i++) { dest[i] = src1[i]; }
+        return dest;
+    }
+    if( amountOfsrc2 == 255) {
+        for( uint16_t i = 0; i < count; i++) { dest[i] = src2[i]; }
+        return dest;
+    }
+    blendArrays( src1, src2, dest, count, amountOfsrc2);
+    return dest;
+#endif
     for( uint16_t i = 0; i < count; i++) {
         dest[i] = blend(src1[i], src2[i], amountOfsrc2);
     }
@@ -402,10 +576,17 @@ void blur2d( CRGB* leds, uint8_t width, uint8_t height, fract8 blur_amount)
     blurColumns(leds, width, height, blur_amount);
 }
 
+void blur2d( CRGB* leds, uint16_t width, uint16_t height, fract8 blur_amount, TXYLayout layout)
+{
+    // a row reads the same either way round, so serpentine rows blur like plain ones
+    blurRows(leds, width, height, blur_amount);
+    blurColumns(leds, width, height, blur_amount, layout);
+}
+
 // blurRows: perform a blur1d on every row of a rectangular matrix
-void blurRows( CRGB* leds, uint8_t width, uint8_t height, fract8 blur_amount)
+void blurRows( CRGB* leds, uint16_t width, uint16_t height, fract8 blur_amount)
 {
-    for( uint8_t row = 0; row < height; row++) {
+    for( uint16_t row = 0; row < height; row++) {
         CRGB* rowbase = leds + (row * width);
         blur1d( rowbase, width, blur_amount);
     }
@@ -434,6 +615,340 @@ void blurColumns(CRGB* leds, uint8_t width, uint8_t height, fract8 blur_amount)
 
 
 
+// blurColumns for a known layout: walks the matrix a row at a time, blurring
+// BLUR_COLUMNS_PER_PASS columns side by side, so there are no XY() calls and
+// the memory for each step is (mostly) contiguous.
+// COORD is the type used for the loop counters, uint8_t where the matrix allows.
+#define BLUR_COLUMNS_PER_PASS 8
+template<typename COORD>
+static void blurColumnsLayout(CRGB* leds, COORD width, COORD height, fract8 blur_amount, TXYLayout layout)
+{
+    uint8_t keep = 255 - blur_amount;
+    uint8_t seep = blur_amount >> 1;
+    CRGB carryover[BLUR_COLUMNS_PER_PASS];
+    CRGB* prev[BLUR_COLUMNS_PER_PASS];
+
+    COORD cols;
+    for( COORD col0 = 0; col0 < width; col0 += cols) {
+        cols = width - col0;
+        if( cols > BLUR_COLUMNS_PER_PASS) cols = BLUR_COLUMNS_PER_PASS;
+
+        for( uint8_t c = 0; c < cols; c++) { carryover[c] = CRGB::Black; }
+
+        CRGB* rowbase = leds;
+        for( COORD i = 0; i < height; i++) {
+            // on the odd rows of a serpentine layout, columns run right to left
+            bool reversed = (layout == XY_SERPENTINE) && (i & 0x01);
+            for( uint8_t c = 0; c < cols; c++) {
+                COORD col = col0 + c;
+                CRGB* pCur = rowbase + (reversed ? (width - 1 - col) : col);
+                CRGB cur = *pCur;
+                CRGB part = cur;
+                part.nscale8( seep);
+                cur.nscale8( keep);
+                cur += carryover[c];
+                if( i) *(prev[c]) += part;
+                *pCur = cur;
+                carryover[c] = part;
+                prev[c] = pCur;
+            }
+            rowbase += width;
+        }
+    }
+}
+
+void blurColumns(CRGB* leds, uint16_t width, uint16_t height, fract8 blur_amount, TXYLayout layout)
+{
+    if( width <= 255 && height <= 255) {
+        blurColumnsLayout<uint8_t>( leds, width, height, blur_amount, layout);
+    } else {
+        blurColumnsLayout<uint16_t>( leds, width, height, blur_amount, layout);
+    }
+}
+
+// blur1d over the leds at pIndex[0], pIndex[step], pIndex[2*step] ... - a row
+// or a column of an XYMap's table
+static void blurIndexed( CRGB* leds, const uint16_t* pIndex, uint16_t count, uint16_t step, fract8 blur_amount)
+{
+    uint8_t keep = 255 - blur_amount;
+    uint8_t seep = blur_amount >> 1;
+    CRGB carryover = CRGB::Black;
+    CRGB* prev = 0;
+    for( uint16_t i = 0; i < count; i++) {
+        CRGB* pCur = leds + *pIndex;
+        CRGB cur = *pCur;
+        CRGB part = cur;
+        part.nscale8( seep);
+        cur.nscale8( keep);
+        cur += carryover;
+        if( i) *prev += part;
+        *pCur = cur;
+        carryover = part;
+        prev = pCur;
+        pIndex += step;
+    }
+}
+
+void blur2d( CRGB* leds, const XYMap& map, fract8 blur_amount)
+{
+    blurRows(leds, map, blur_amount);
+    blurColumns(leds, map, blur_amount);
+}
+
+void blurRows( CRGB* leds, const XYMap& map, fract8 blur_amount)
+{
+    for( uint16_t row = 0; row < map.height(); row++) {
+        blurIndexed( leds, map.row(row), map.width(), 1, blur_amount);
+    }
+}
+
+void blurColumns( CRGB* leds, const XYMap& map, fract8 blur_amount)
+{
+    const uint16_t* pTable = map.row(0);
+    for( uint16_t col = 0; col < map.width(); col++) {
+        blurIndexed( leds, pTable + col, map.height(), map.width(), blur_amount);
+    }
+}
+
+// every row (and every column) of an XYMap covers its own leds, so they can be
+// blurred on different cores
+struct CBlurJob {
+    CRGB* leds;
+    const XYMap* map;
+    fract8 blur_amount;
+};
+
+static void blurRowsRange( void* pArg, uint16_t start, uint16_t end)
+{
+    const CBlurJob& job = *(const CBlurJob*)pArg;
+    for( uint16_t row = start; row < end; row++) {
+        blurIndexed( job.leds, job.map->row(row), job.map->width(), 1, job.blur_amount);
+    }
+}
+
+static void blurColumnsRange( void* pArg, uint16_t start, uint16_t end)
+{
+    const CBlurJob& job = *(const CBlurJob*)pArg;
+    const uint16_t* pTable = job.map->row(0);
+    for( uint16_t col = start; col < end; col++) {
+        blurIndexed( job.leds, pTable + col, job.map->height(), job.map->width(), job.blur_amount);
+    }
+}
+
+void blur2d_parallel( CRGB* leds, const XYMap& map, fract8 blur_amount)
+{
+    CBlurJob job = { leds, &map, blur_amount };
+    parallel_for( map.height(), blurRowsRange, &job);
+    parallel_for( map.width(), blurColumnsRange, &job);
+}
+
+// The wide blurs slide a box of 2 * radius + 1 leds along each line, with a
+// running sum per channel that takes in the led coming into the box and drops
+// the one leaving it, so the cost doesn't depend on the radius.  The line is
+// mirrored at its ends, so the light that would spill off them comes back in
+// and the total stays the same, up to rounding.  The sums need the leds the box
+// has already gone past, so every line gets copied into pLine first.
+struct CBlurLine {
+    uint16_t operator()( uint16_t i) const { return i; }
+};
+
+struct CBlurTableLine {
+    const uint16_t* pIndex;
+    uint16_t step;
+    uint16_t operator()( uint16_t i) const { return pIndex[i * step]; }
+};
+
+// the average of a box, from its sum and 2^23 / its width
+static inline uint8_t boxAverage( uint32_t sum, uint32_t recip)
+{
+    uint32_t v = ((sum * recip) + (1UL << 22)) >> 23;
+    return (v > 255) ? 255 : v;
+}
+
+template<class INDEX>
+static void boxBlurLine( CRGB* leds, const INDEX& index, uint16_t count, uint16_t radius, CRGB* pLine)
+{
+    if( count < 2 || radius == 0) return;
+    // a box any wider covers the leds more than once
+    if( radius >= count) radius = count - 1;
+    for( uint16_t i = 0; i < count; i++) { pLine[i] = leds[index(i)]; }
+
+    uint32_t width = (2 * (uint32_t)radius) + 1;
+    uint32_t recip = ((1UL << 23) + (width >> 1)) / width;
+
+    // the box around the first led: leds 0 to radius, and the mirror images of
+    // leds 0 to radius-1 before it
+    uint32_t r = pLine[radius].r, g = pLine[radius].g, b = pLine[radius].b;
+    for( uint16_t i = 0; i < radius; i++) {
+        r += 2 * pLine[i].r; g += 2 * pLine[i].g; b += 2 * pLine[i].b;
+    }
+
+    for( uint16_t i = 0; i < count; i++) {
+        leds[index(i)] = CRGB( boxAverage( r, recip), boxAverage( g, recip), boxAverage( b, recip));
+
+        // move the box along a led, mirroring the ends of the line
+        int32_t in = (int32_t)i + radius + 1;
+        if( in >= count) in = (2 * (int32_t)count) - 1 - in;
+        int32_t out = (int32_t)i - radius;
+        if( out < 0) out = -out - 1;
+        const CRGB& entering = pLine[in];
+        const CRGB& leaving = pLine[out];
+        r = r + entering.r - leaving.r;
+        g = g + entering.g - leaving.g;
+        b = b + entering.b - leaving.b;
+    }
+}
+
+// three box blurs make a close approximation of a gaussian blur
+template<class INDEX>
+static void gaussianBlurLine( CRGB* leds, const INDEX& index, uint16_t count, uint16_t radius, CRGB* pLine)
+{
+    boxBlurLine( leds, index, count, radius, pLine);
+    boxBlurLine( leds, index, count, radius, pLine);
+    boxBlurLine( leds, index, count, radius, pLine);
+}
+
+void boxBlur1d( CRGB* leds, uint16_t numLeds, uint16_t radius)
+{
+    if( numLeds < 2) return;
+    CRGB line[numLeds];
+    boxBlurLine( leds, CBlurLine(), numLeds, radius, line);
+}
+
+void gaussianBlur1d( CRGB* leds, uint16_t numLeds, uint16_t radius)
+{
+    if( numLeds < 2) return;
+    CRGB line[numLeds];
+    gaussianBlurLine( leds, CBlurLine(), numLeds, radius, line);
+}
+
+template<bool GAUSSIAN>
+static void wideBlur2d( CRGB* leds, const XYMap& map, uint16_t radius)
+{
+    uint16_t width = map.width();
+    uint16_t height = map.height();
+    if( width == 0 || height == 0) return;
+    CRGB line[(width > height) ? width : height];
+    for( uint16_t row = 0; row < height; row++) {
+        CBlurTableLine index = { map.row(row), 1 };
+        if( GAUSSIAN) gaussianBlurLine( leds, index, width, radius, line);
+        else boxBlurLine( leds, index, width, radius, line);
+    }
+    for( uint16_t col = 0; col < width; col++) {
+        CBlurTableLine index = { map.row(0) + col, width };
+        if( GAUSSIAN) gaussianBlurLine( leds, index, height, radius, line);
+        else boxBlurLine( leds, index, height, radius, line);
+    }
+}
+
+void boxBlur2d( CRGB* leds, const XYMap& map, uint16_t radius)
+{
+    wideBlur2d<false>( leds, map, radius);
+}
+
+void gaussianBlur2d( CRGB* leds, const XYMap& map, uint16_t radius)
+{
+    wideBlur2d<true>( leds, map, radius);
+}
+
+// upscale lines the pixel centers of the image up with the led centers, so
+// the image pixel for led n sits at (n + 1/2) * step - 1/2, step being the
+// image size over the matrix size in 16.16.  upscalePos gives that as the
+// pixel before it and how far it is on towards the next one, in 256ths - the
+// half pixel at either edge just repeats the edge pixel.
+static void upscalePos( uint16_t n, uint32_t step, uint16_t size, uint16_t& index, uint8_t& frac)
+{
+    uint32_t pos = (n * step) + (step >> 1);
+    if( pos <= 0x8000) { index = 0; frac = 0; return; }
+    pos -= 0x8000;
+    index = pos >> 16;
+    frac = pos >> 8;
+    if( index >= size - 1) { index = size - 1; frac = 0; }
+}
+
+// a and b mixed weight/2^shift of the way towards b, rounded
+static inline CRGB upscaleMix( const CRGB& a, const CRGB& b, uint8_t weight, uint8_t shift)
+{
+    uint16_t wa = (1 << shift) - weight;
+    uint16_t half = (1 << shift) >> 1;
+    return CRGB( ((a.r * wa) + (b.r * weight) + half) >> shift,
+                 ((a.g * wa) + (b.g * weight) + half) >> shift,
+                 ((a.b * wa) + (b.b * weight) + half) >> shift);
+}
+
+// one row of the matrix, interpolated along a (vertically interpolated
+// already) row of the image
+static void upscaleRow( CRGB* leds, const uint16_t* pIndex, uint16_t width, const CRGB* pSrc, uint16_t srcWidth, uint32_t step)
+{
+    uint16_t k = width / srcWidth;
+    if( (k == 2 || k == 4) && (width == (k * srcWidth)) && srcWidth > 1) {
+        // stretching by exactly 2 or 4, the leds in between two image pixels
+        // are always the same 1/4, 3/4 (or 1/8, 3/8 ...) of the way between them
+        uint8_t shift = (k == 2) ? 2 : 3;
+        uint16_t x = 0;
+        for( ; x < (k >> 1); x++) { leds[pIndex[x]] = pSrc[0]; }
+        for( uint16_t i = 0; i < srcWidth - 1; i++) {
+            for( uint8_t j = 0; j < k; j++) {
+                leds[pIndex[x++]] = upscaleMix( pSrc[i], pSrc[i+1], (2 * j) + 1, shift);
+            }
+        }
+        for( ; x < width; x++) { leds[pIndex[x]] = pSrc[srcWidth - 1]; }
+        return;
+    }
+
+    for( uint16_t x = 0; x < width; x++) {
+        uint16_t i;
+        uint8_t frac;
+        upscalePos( x, step, srcWidth, i, frac);
+        leds[pIndex[x]] = frac ? upscaleMix( pSrc[i], pSrc[i+1], frac, 8) : pSrc[i];
+    }
+}
+
+void upscale( CRGB* leds, const XYMap& map, const CRGB* src, uint16_t width, uint16_t height, TBlendType blendType)
+{
+    uint16_t mapWidth = map.width();
+    uint16_t mapHeight = map.height();
+    if( mapWidth == 0 || mapHeight == 0 || width == 0 || height == 0) return;
+    uint32_t stepx = (((uint32_t)width << 16) + (mapWidth >> 1)) / mapWidth;
+    uint32_t stepy = (((uint32_t)height << 16) + (mapHeight >> 1)) / mapHeight;
+
+    if( blendType == NOBLEND) {
+        // the image pixel each led's center falls in
+        for( uint16_t y = 0; y < mapHeight; y++) {
+            uint16_t i = ((y * stepy) + (stepy >> 1)) >> 16;
+            const CRGB* pSrc = src + (((i < height) ? i : (height - 1)) * width);
+            const uint16_t* pIndex = map.row(y);
+            uint32_t pos = stepx >> 1;
+            for( uint16_t x = 0; x < mapWidth; x++, pos += stepx) {
+                uint16_t j = pos >> 16;
+                leds[pIndex[x]] = pSrc[(j < width) ? j : (width - 1)];
+            }
+        }
+        return;
+    }
+
+    // the image rows get mixed first, once per matrix row, then every led is
+    // mixed from the two pixels of that on either side of it
+    CRGB line[width];
+    uint16_t lineRow = 0xFFFF;
+    uint8_t lineFrac = 0;
+    for( uint16_t y = 0; y < mapHeight; y++) {
+        uint16_t i;
+        uint8_t frac;
+        upscalePos( y, stepy, height, i, frac);
+        const CRGB* pSrc = src + (i * width);
+        if( frac) {
+            if( i != lineRow || frac != lineFrac) {
+                for( uint16_t x = 0; x < width; x++) { line[x] = upscaleMix( pSrc[x], pSrc[x + width], frac, 8); }
+                lineRow = i;
+                lineFrac = frac;
+            }
+            pSrc = line;
+        }
+        upscaleRow( leds, map.row(y), mapWidth, pSrc, width, stepx);
+    }
+}
+
 // CRGB HeatColor( uint8_t temperature)
 //
 // Approximates a 'black body radiation' spectrum for
@@ -443,8 +958,44 @@ void blurColumns(CRGB* leds, uint8_t width, uint8_t height, fract8 blur_amount)
 // spectrum, but it's surprisingly close, and it's fast and small.
 //
 // On AVR/Arduino, this typically takes around 70 bytes of program memory,
-// versus 768 bytes for a full 256-entry RGB lookup table.
+// versus 768 bytes for a full 256-entry RGB lookup table - which is what
+// the other platforms get, see FASTLED_HEATCOLOR_TABLE.
+
+#if (FASTLED_HEATCOLOR_TABLE == 1)
+// the code below at compile time
+constexpr TRGBPaletteTableEntry heatColorEntry( uint8_t t192)
+{
+    return (t192 & 0x80) ? TRGBPaletteTableEntry{ 255, 255, (uint8_t)((t192 & 0x3F) << 2) }
+         : (t192 & 0x40) ? TRGBPaletteTableEntry{ 255, (uint8_t)((t192 & 0x3F) << 2), 0 }
+         :                 TRGBPaletteTableEntry{ (uint8_t)((t192 & 0x3F) << 2), 0, 0 };
+}
+
+// scale8_video( t, 191)
+template<int... I>
+constexpr TRGBPaletteTable heatColorTable( CPaletteTableIndices<I...>)
+{
+    return {{ heatColorEntry( ((I * 191) >> 8) + (I ? 1 : 0))... }};
+}
+
+FASTLED_PALETTE_TABLE_ATTR const TRGBPaletteTable HeatColorsLUT = heatColorTable( CPaletteTableIndexRange<256>::type());
 
+CRGB HeatColor( uint8_t temperature)
+{
+    const TRGBPaletteTableEntry& entry = HeatColorsLUT.entries[temperature];
+    return CRGB( entry.r, entry.g, entry.b);
+}
+
+void map_heat_to_rgb( const uint8_t* heat, CRGB* leds, uint16_t numLeds)
+{
+    const TRGBPaletteTableEntry* entries = HeatColorsLUT.entries;
+    for( uint16_t i = 0; i < numLeds; i++) {
+        const TRGBPaletteTableEntry& entry = entries[heat[i]];
+        leds[i].r = entry.r;
+        leds[i].g = entry.g;
+        leds[i].b = entry.b;
+    }
+}
+#else
 CRGB HeatColor( uint8_t temperature)
 {
     CRGB heatcolor;
@@ -482,6 +1033,14 @@ CRGB HeatColor( uint8_t temperature)
     return heatcolor;
 }
 
+void map_heat_to_rgb( const uint8_t* heat, CRGB* leds, uint16_t numLeds)
+{
+    for( uint16_t i = 0; i < numLeds; i++) {
+        leds[i] = HeatColor( heat[i]);
+    }
+}
+#endif
+
 
 // lsrX4: helper function to divide a number by 16, aka four LSR's.
 // On avr-gcc, "u8 >> 4" generates a loop, which is big, and slow.
@@ -502,7 +1061,75 @@ inline uint8_t lsrX4( uint8_t dividend)
 }
 
 
-CRGB ColorFromPalette( const CRGBPalette16& pal, uint8_t index, uint8_t brightness, TBlendType blendType)
+static CRGB interpolatePalette16( const CRGBPalette16& pal, uint8_t index, uint8_t brightness, TBlendType blendType);
+
+#if (FASTLED_PALETTE16_CACHE == 1)
+uint32_t gPalette16Generation = 0;
+
+// A CRGBPalette16 expanded to 256 entries with LINEARBLEND, valid for as long as
+// gPalette16Generation hasn't moved on from the value it was expanded at.
+struct CPalette16CacheSlot {
+    const CRGBPalette16* pal;
+    uint32_t generation;
+    CRGB entries[256];
+};
+
+static CPalette16CacheSlot sPalette16Cache[FASTLED_PALETTE16_CACHE_SLOTS];
+static uint8_t sPalette16CacheNext = 0;
+// Palettes that missed the cache since the last hit (or palette change).  A palette only
+// gets expanded on its second miss, so one-off lookups don't cost a 256 entry expansion,
+// and code that switches between more palettes than there are slots on every pixel keeps
+// the ones it has instead of re-expanding palettes all the time.
+static const CRGBPalette16* sPalette16Missed[FASTLED_PALETTE16_CACHE_SLOTS];
+static uint8_t sPalette16MissedCount = 0;
+static uint32_t sPalette16MissedGeneration = 0;
+
+// Find (or make) the 256 entry expansion of a palette, NULL if it isn't worth it (yet)
+static const CRGB* cachedPalette16( const CRGBPalette16& pal)
+{
+    for( uint8_t i = 0; i < FASTLED_PALETTE16_CACHE_SLOTS; i++) {
+        CPalette16CacheSlot& slot = sPalette16Cache[i];
+        if( slot.pal == &pal && slot.generation == gPalette16Generation) {
+            sPalette16MissedCount = 0;
+            return slot.entries;
+        }
+    }
+
+    if( sPalette16MissedGeneration != gPalette16Generation) {
+        sPalette16MissedGeneration = gPalette16Generation;
+        sPalette16MissedCount = 0;
+    }
+    uint8_t missed = 0;
+    while( missed < sPalette16MissedCount && sPalette16Missed[missed] != &pal) { missed++; }
+    if( missed == sPalette16MissedCount) {
+        if( sPalette16MissedCount < FASTLED_PALETTE16_CACHE_SLOTS) {
+            sPalette16Missed[sPalette16MissedCount++] = &pal;
+        }
+        return NULL;
+    }
+
+    // prefer a slot that doesn't hold anything valid anymore
+    CPalette16CacheSlot* pSlot = NULL;
+    for( uint8_t i = 0; i < FASTLED_PALETTE16_CACHE_SLOTS; i++) {
+        if( sPalette16Cache[i].generation != gPalette16Generation || sPalette16Cache[i].pal == NULL) {
+            pSlot = &sPalette16Cache[i];
+        }
+    }
+    if( pSlot == NULL) {
+        pSlot = &sPalette16Cache[sPalette16CacheNext];
+        sPalette16CacheNext = (sPalette16CacheNext + 1) % FASTLED_PALETTE16_CACHE_SLOTS;
+    }
+
+    for( uint16_t i = 0; i < 256; i++) {
+        pSlot->entries[i] = interpolatePalette16( pal, i, 255, LINEARBLEND);
+    }
+    pSlot->pal = &pal;
+    pSlot->generation = gPalette16Generation;
+    return pSlot->entries;
+}
+#endif
+
+static CRGB interpolatePalette16( const CRGBPalette16& pal, uint8_t index, uint8_t brightness, TBlendType blendType)
 {
     //      hi4 = index >> 4;
     uint8_t hi4 = lsrX4(index);
@@ -556,8 +1183,48 @@ CRGB ColorFromPalette( const CRGBPalette16& pal, uint8_t index, uint8_t brightne
     if( brightness != 255) {
         if( brightness ) {
             brightness++; // adjust for rounding
-            // Now, since brightness is nonzero, we don't need the full scale8_video logic;
-            // we can just to scale8 and then add one (unless scale8 fixed) to all nonzero inputs.
+            // Now, since brightness is nonzero, we don't need the full scale8_video logic;
+            // we can just to scale8 and then add one (unless scale8 fixed) to all nonzero inputs.
+            if( red1 )   {
+                red1 = scale8_LEAVING_R1_DIRTY( red1, brightness);
+#if !(FASTLED_SCALE8_FIXED==1)
+                red1++;
+#endif
+            }
+            if( green1 ) {
+                green1 = scale8_LEAVING_R1_DIRTY( green1, brightness);
+#if !(FASTLED_SCALE8_FIXED==1)
+                green1++;
+#endif
+            }
+            if( blue1 )  {
+                blue1 = scale8_LEAVING_R1_DIRTY( blue1, brightness);
+#if !(FASTLED_SCALE8_FIXED==1)
+                blue1++;
+#endif
+            }
+            cleanup_R1();
+        } else {
+            red1 = 0;
+            green1 = 0;
+            blue1 = 0;
+        }
+    }
+    
+    return CRGB( red1, green1, blue1);
+}
+
+// Apply a ColorFromPalette brightness to a color, the same way the CRGBPalette16
+// lookup does.
+static inline CRGB scalePaletteColor( const CRGB& color, uint8_t brightness)
+{
+    uint8_t red1   = color.red;
+    uint8_t green1 = color.green;
+    uint8_t blue1  = color.blue;
+
+    if( brightness != 255) {
+        if( brightness ) {
+            brightness++; // adjust for rounding
             if( red1 )   {
                 red1 = scale8_LEAVING_R1_DIRTY( red1, brightness);
 #if !(FASTLED_SCALE8_FIXED==1)
@@ -583,10 +1250,23 @@ CRGB ColorFromPalette( const CRGBPalette16& pal, uint8_t index, uint8_t brightne
             blue1 = 0;
         }
     }
-    
+
     return CRGB( red1, green1, blue1);
 }
 
+CRGB ColorFromPalette( const CRGBPalette16& pal, uint8_t index, uint8_t brightness, TBlendType blendType)
+{
+#if (FASTLED_PALETTE16_CACHE == 1)
+    if( blendType != NOBLEND) {
+        const CRGB* lut = cachedPalette16( pal);
+        if( lut) {
+            return scalePaletteColor( lut[index], brightness);
+        }
+    }
+#endif
+    return interpolatePalette16( pal, index, brightness, blendType);
+}
+
 CRGB ColorFromPalette( const TProgmemRGBPalette16& pal, uint8_t index, uint8_t brightness, TBlendType blendType)
 {
     //      hi4 = index >> 4;
@@ -666,6 +1346,17 @@ CRGB ColorFromPalette( const TProgmemRGBPalette16& pal, uint8_t index, uint8_t b
 }
 
 
+#if (FASTLED_PALETTE_TABLES == 1)
+CRGB ColorFromPalette( const TRGBPaletteTable& pal, uint8_t index, uint8_t brightness, TBlendType blendType)
+{
+    // without blending, the table entries at multiples of 16 are the palette's own colors
+    if( blendType == NOBLEND) { index &= 0xF0; }
+    const TRGBPaletteTableEntry& entry = pal.entries[index];
+    return scalePaletteColor( CRGB( entry.r, entry.g, entry.b), brightness);
+}
+#endif
+
+
 CRGB ColorFromPalette( const CRGBPalette32& pal, uint8_t index, uint8_t brightness, TBlendType blendType)
 {
     uint8_t hi5 = index;
@@ -1047,6 +1738,413 @@ CHSV ColorFromPalette( const struct CHSVPalette256& pal, uint8_t index, uint8_t
 }
 
 
+// Shared body of the 16 and 32 entry fill_from_palette functions.  Produces exactly
+// what ColorFromPalette would for each index, but the blend and brightness decisions
+// are made once for the whole buffer instead of once per pixel, and the (compile
+// time) palette size turns the index split and wrap-around into plain shifts and masks.
+template<uint8_t BITS>
+static void fill_from_palette_entries( CRGB* out, const uint8_t* indices, uint16_t count,
+                                       const CRGB* entries, uint8_t brightness, TBlendType blendType)
+{
+    if( brightness == 0) {
+        fill_solid( out, count, CRGB::Black);
+        return;
+    }
+
+    const uint8_t blend = (blendType != NOBLEND);
+    const uint8_t scale = (brightness != 255);
+    const uint8_t bright = brightness + 1; // adjust for rounding
+
+    for( uint16_t i = 0; i < count; i++) {
+        uint8_t index = indices[i];
+        uint8_t hi = index >> (8 - BITS);
+        uint8_t lo = index & ((1 << (8 - BITS)) - 1);
+
+        const CRGB& entry1 = entries[hi];
+        uint8_t red1   = entry1.red;
+        uint8_t green1 = entry1.green;
+        uint8_t blue1  = entry1.blue;
+
+        if( blend && lo) {
+            const CRGB& entry2 = entries[(hi + 1) & ((1 << BITS) - 1)];
+            uint8_t f2 = lo << BITS;
+            uint8_t f1 = 255 - f2;
+
+            red1   = scale8_LEAVING_R1_DIRTY( red1,   f1) + scale8_LEAVING_R1_DIRTY( entry2.red,   f2);
+            green1 = scale8_LEAVING_R1_DIRTY( green1, f1) + scale8_LEAVING_R1_DIRTY( entry2.green, f2);
+            blue1  = scale8_LEAVING_R1_DIRTY( blue1,  f1) + scale8_LEAVING_R1_DIRTY( entry2.blue,  f2);
+        }
+
+        if( scale) {
+            if( red1 )   {
+                red1 = scale8_LEAVING_R1_DIRTY( red1, bright);
+#if !(FASTLED_SCALE8_FIXED==1)
+                red1++;
+#endif
+            }
+            if( green1 ) {
+                green1 = scale8_LEAVING_R1_DIRTY( green1, bright);
+#if !(FASTLED_SCALE8_FIXED==1)
+                green1++;
+#endif
+            }
+            if( blue1 )  {
+                blue1 = scale8_LEAVING_R1_DIRTY( blue1, bright);
+#if !(FASTLED_SCALE8_FIXED==1)
+                blue1++;
+#endif
+            }
+        }
+        cleanup_R1();
+
+        out[i] = CRGB( red1, green1, blue1);
+    }
+}
+
+void fill_from_palette( CRGB* out, const uint8_t* indices, uint16_t count,
+                        const CRGBPalette16& pal, uint8_t brightness, TBlendType blendType)
+{
+#if (FASTLED_PALETTE16_CACHE == 1)
+    if( blendType != NOBLEND) {
+        const CRGB* lut = cachedPalette16( pal);
+        if( lut) {
+            for( uint16_t i = 0; i < count; i++) {
+                out[i] = scalePaletteColor( lut[indices[i]], brightness);
+            }
+            return;
+        }
+    }
+#endif
+    fill_from_palette_entries<4>( out, indices, count, &(pal[0]), brightness, blendType);
+}
+
+void fill_from_palette( CRGB* out, const uint8_t* indices, uint16_t count,
+                        const CRGBPalette32& pal, uint8_t brightness, TBlendType blendType)
+{
+    fill_from_palette_entries<5>( out, indices, count, &(pal[0]), brightness, blendType);
+}
+
+void fill_from_palette( CRGB* out, const uint8_t* indices, uint16_t count,
+                        const CRGBPalette256& pal, uint8_t brightness, TBlendType)
+{
+    const CRGB* entries = &(pal[0]);
+
+    if( brightness == 255) {
+        for( uint16_t i = 0; i < count; i++) {
+            out[i] = entries[indices[i]];
+        }
+        return;
+    }
+
+    const uint8_t bright = brightness + 1; // adjust for rounding
+    for( uint16_t i = 0; i < count; i++) {
+        const CRGB& entry = entries[indices[i]];
+        uint8_t red   = scale8_video_LEAVING_R1_DIRTY( entry.red,   bright);
+        uint8_t green = scale8_video_LEAVING_R1_DIRTY( entry.green, bright);
+        uint8_t blue  = scale8_video_LEAVING_R1_DIRTY( entry.blue,  bright);
+        cleanup_R1();
+        out[i] = CRGB( red, green, blue);
+    }
+}
+
+
+// Bake the controller-side scaling into a table, the same way PixelController
+// would scale each byte on its way out
+static void scalePaletteLUT( CRGB* entries, const CRGB& adjustment)
+{
+    if( adjustment.red == 255 && adjustment.green == 255 && adjustment.blue == 255) { return; }
+    for( uint16_t i = 0; i < 256; i++) {
+        entries[i].red   = scale8_LEAVING_R1_DIRTY( entries[i].red,   adjustment.red);
+        entries[i].green = scale8_LEAVING_R1_DIRTY( entries[i].green, adjustment.green);
+        entries[i].blue  = scale8_LEAVING_R1_DIRTY( entries[i].blue,  adjustment.blue);
+        cleanup_R1();
+    }
+}
+
+void CRGBPaletteLUT::load( const CRGBPalette16& pal, const CRGB& adjustment, uint8_t brightness, TBlendType blendType)
+{
+    for( uint16_t i = 0; i < 256; i++) {
+        entries[i] = ColorFromPalette( pal, i, brightness, blendType);
+    }
+    scalePaletteLUT( entries, adjustment);
+}
+
+void CRGBPaletteLUT::load( const CRGBPalette32& pal, const CRGB& adjustment, uint8_t brightness, TBlendType blendType)
+{
+    for( uint16_t i = 0; i < 256; i++) {
+        entries[i] = ColorFromPalette( pal, i, brightness, blendType);
+    }
+    scalePaletteLUT( entries, adjustment);
+}
+
+void CRGBPaletteLUT::load( const CRGBPalette256& pal, const CRGB& adjustment, uint8_t brightness)
+{
+    for( uint16_t i = 0; i < 256; i++) {
+        entries[i] = ColorFromPalette( pal, i, brightness);
+    }
+    scalePaletteLUT( entries, adjustment);
+}
+
+void CRGBPaletteTransition::blended( CRGBPalette16& pal) const
+{
+    for( uint8_t i = 0; i < 16; i++) {
+        pal.entries[i] = blend( m_From.entries[i], m_Target.entries[i], m_nAmount);
+    }
+    FASTLED_PALETTE16_CHANGED();
+}
+
+void CRGBPaletteTransition::start( const CRGBPalette16& target)
+{
+    if( m_nAmount) {
+        if( m_nAmount == 255) {
+            m_From = m_Target;
+        } else {
+            blended( m_From);
+        }
+    }
+    m_Target = target;
+    m_nAmount = 0;
+    m_bDirty = true;
+}
+
+void CRGBPaletteTransition::update()
+{
+    if( m_nAmount == 0) {
+        m_LUT.load( m_From, m_Adjustment, m_nBrightness, m_BlendType);
+    } else if( m_nAmount == 255) {
+        m_LUT.load( m_Target, m_Adjustment, m_nBrightness, m_BlendType);
+    } else {
+        // blend the 16 entries, then expand - rather than blending 256
+        CRGBPalette16 pal;
+        blended( pal);
+        m_LUT.load( pal, m_Adjustment, m_nBrightness, m_BlendType);
+    }
+    m_bDirty = false;
+}
+
+void fill_from_palette( CRGB* out, const uint8_t* indices, uint16_t count, const CRGBPaletteLUT& lut)
+{
+    for( uint16_t i = 0; i < count; i++) {
+        out[i] = lut.entries[indices[i]];
+    }
+}
+
+// The parallel versions hand each core its own slice of the buffer.  The palette
+// cache isn't safe to use from two cores at once, so the 256 entry expansion (if
+// any) is looked up once, on the calling core, and the slices only read it.
+struct CPaletteFillJob {
+    CRGB* out;
+    const uint8_t* indices;
+    const CRGB* entries;
+    uint8_t brightness;
+    TBlendType blendType;
+};
+
+static void fillFromPaletteRange( void* pArg, uint16_t start, uint16_t end)
+{
+    const CPaletteFillJob& job = *(const CPaletteFillJob*)pArg;
+    fill_from_palette_entries<4>( job.out + start, job.indices + start, end - start, job.entries, job.brightness, job.blendType);
+}
+
+#if (FASTLED_PALETTE16_CACHE == 1)
+static void fillFromPaletteCachedRange( void* pArg, uint16_t start, uint16_t end)
+{
+    const CPaletteFillJob& job = *(const CPaletteFillJob*)pArg;
+    for( uint16_t i = start; i < end; i++) {
+        job.out[i] = scalePaletteColor( job.entries[job.indices[i]], job.brightness);
+    }
+}
+#endif
+
+static void fillFromPaletteLUTRange( void* pArg, uint16_t start, uint16_t end)
+{
+    const CPaletteFillJob& job = *(const CPaletteFillJob*)pArg;
+    for( uint16_t i = start; i < end; i++) {
+        job.out[i] = job.entries[job.indices[i]];
+    }
+}
+
+void fill_from_palette_parallel( CRGB* out, const uint8_t* indices, uint16_t count,
+                                 const CRGBPalette16& pal, uint8_t brightness, TBlendType blendType)
+{
+    CPaletteFillJob job = { out, indices, &(pal[0]), brightness, blendType };
+#if (FASTLED_PALETTE16_CACHE == 1)
+    if( blendType != NOBLEND) {
+        // a whole buffer is always worth expanding the palette for, so don't wait for a second miss
+        const CRGB* lut = cachedPalette16( pal);
+        if( lut == NULL) { lut = cachedPalette16( pal); }
+        if( lut) {
+            job.entries = lut;
+            parallel_for( count, fillFromPaletteCachedRange, &job);
+            return;
+        }
+    }
+#endif
+    parallel_for( count, fillFromPaletteRange, &job);
+}
+
+void fill_from_palette_parallel( CRGB* out, const uint8_t* indices, uint16_t count, const CRGBPaletteLUT& lut)
+{
+    CPaletteFillJob job = { out, indices, lut.entries, 255, NOBLEND };
+    parallel_for( count, fillFromPaletteLUTRange, &job);
+}
+
+// Planar led data (see planarleds.h) - every plane is a plain byte array, word
+// aligned and padded to whole words, so the word at a time helpers above get
+// to run over all of it without heads or tails.
+void fill_solid( CPlanarLeds& leds, const CRGB& color)
+{
+    for( uint8_t c = 0; c < 3; c++) {
+        memset8( leds.plane(c), color.raw[c], leds.size());
+    }
+}
+
+void nscale8( CPlanarLeds& leds, uint8_t scale)
+{
+    for( uint8_t c = 0; c < 3; c++) {
+#if (FASTLED_SWAR_MATH == 1)
+        swar_nscale8<false>( leds.plane(c), leds.size(), scale);
+#else
+        uint8_t* p = leds.plane(c);
+        for( int i = 0; i < leds.size(); i++) { p[i] = scale8( p[i], scale); }
+#endif
+    }
+}
+
+void fadeToBlackBy( CPlanarLeds& leds, uint8_t fadeBy)
+{
+    nscale8( leds, 255 - fadeBy);
+}
+
+void nblend( CPlanarLeds& existing, const CPlanarLeds& overlay, fract8 amountOfOverlay)
+{
+    int count = existing.size() < overlay.size() ? existing.size() : overlay.size();
+    // same early outs as the single pixel nblend
+    if( amountOfOverlay == 0) {
+        return;
+    }
+    for( uint8_t c = 0; c < 3; c++) {
+        uint8_t* a = existing.plane(c);
+        const uint8_t* b = overlay.plane(c);
+        if( amountOfOverlay == 255) {
+            memcpy8( a, b, count);
+            continue;
+        }
+#if (FASTLED_SWAR_MATH == 1) && (FASTLED_BLEND_FIXED == 1)
+#if (FASTLED_SCALE8_FIXED == 1)
+        swar_blend8( a, b, a, count, 256 - amountOfOverlay, amountOfOverlay + 1);
+#else
+        swar_blend8( a, b, a, count, 255 - amountOfOverlay, amountOfOverlay);
+#endif
+#else
+        for( int i = 0; i < count; i++) { a[i] = blend8( a[i], b[i], amountOfOverlay); }
+#endif
+    }
+}
+
+// blur1d over one plane.  A word holds four neighboring leds, so the part each
+// led gives to its neighbors is the word's scaled copy shifted a byte either
+// way, with the end bytes coming from the words before and after it.  The
+// shifts need the first led of a word in its low byte (little endian).
+static void blurPlane( uint8_t* p, int numLeds, uint8_t keep, uint8_t seep)
+{
+#if (FASTLED_SWAR_MATH == 1) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    swar_word_t* w = (swar_word_t*)p;
+    int words = (numLeds + 3) >> 2;
+    if( words == 0) { return; }
+    uint32_t cur = w[0];
+    uint32_t part = scale8x4( cur, seep);
+    uint32_t prevPart = 0;
+    cur = scale8x4( cur, keep);
+    for( int i = 0; i < words; i++) {
+        uint32_t next = (i + 1 < words) ? (uint32_t)w[i+1] : 0;
+        uint32_t nextPart = scale8x4( next, seep);
+        w[i] = qadd8x4( qadd8x4( cur, (part << 8) | (prevPart >> 24)), (part >> 8) | (nextPart << 24));
+        prevPart = part;
+        part = nextPart;
+        cur = scale8x4( next, keep);
+    }
+    // the padding past the last led has to stay black
+    if( numLeds & 0x03) {
+        w[words-1] &= 0xFFFFFFFFUL >> (8 * (4 - (numLeds & 0x03)));
+    }
+#else
+    uint8_t carryover = 0;
+    for( int i = 0; i < numLeds; i++) {
+        uint8_t part = scale8( p[i], seep);
+        uint8_t cur = qadd8( scale8( p[i], keep), carryover);
+        if( i) p[i-1] = qadd8( p[i-1], part);
+        p[i] = cur;
+        carryover = part;
+    }
+#endif
+}
+
+void blur1d( CPlanarLeds& leds, fract8 blur_amount)
+{
+    uint8_t keep = 255 - blur_amount;
+    uint8_t seep = blur_amount >> 1;
+    for( uint8_t c = 0; c < 3; c++) {
+        blurPlane( leds.plane(c), leds.size(), keep, seep);
+    }
+}
+
+// the palette lookups go through a few CRGBs at a time, and get split out into
+// the planes from there
+#define PLANAR_PALETTE_CHUNK 16
+
+template<typename PALETTE>
+static void fill_from_palette_planar( CPlanarLeds& leds, const uint8_t* indices, const PALETTE& pal,
+                                      uint8_t brightness, TBlendType blendType)
+{
+    CRGB chunk[PLANAR_PALETTE_CHUNK];
+    uint8_t* r = leds.r();
+    uint8_t* g = leds.g();
+    uint8_t* b = leds.b();
+    for( int start = 0; start < leds.size(); start += PLANAR_PALETTE_CHUNK) {
+        int count = leds.size() - start;
+        if( count > PLANAR_PALETTE_CHUNK) { count = PLANAR_PALETTE_CHUNK; }
+        fill_from_palette( chunk, indices + start, count, pal, brightness, blendType);
+        for( int i = 0; i < count; i++) {
+            r[start + i] = chunk[i].r;
+            g[start + i] = chunk[i].g;
+            b[start + i] = chunk[i].b;
+        }
+    }
+}
+
+void fill_from_palette( CPlanarLeds& leds, const uint8_t* indices, const CRGBPalette16& pal,
+                        uint8_t brightness, TBlendType blendType)
+{
+    fill_from_palette_planar( leds, indices, pal, brightness, blendType);
+}
+
+void fill_from_palette( CPlanarLeds& leds, const uint8_t* indices, const CRGBPalette32& pal,
+                        uint8_t brightness, TBlendType blendType)
+{
+    fill_from_palette_planar( leds, indices, pal, brightness, blendType);
+}
+
+void fill_from_palette( CPlanarLeds& leds, const uint8_t* indices, const CRGBPalette256& pal,
+                        uint8_t brightness, TBlendType blendType)
+{
+    fill_from_palette_planar( leds, indices, pal, brightness, blendType);
+}
+
+void fill_from_palette( CPlanarLeds& leds, const uint8_t* indices, const CRGBPaletteLUT& lut)
+{
+    // the table's entries are ready to go, so they go straight into the planes
+    uint8_t* r = leds.r();
+    uint8_t* g = leds.g();
+    uint8_t* b = leds.b();
+    for( int i = 0; i < leds.size(); i++) {
+        const CRGB& color = lut.entries[indices[i]];
+        r[i] = color.r;
+        g[i] = color.g;
+        b[i] = color.b;
+    }
+}
+
 void UpscalePalette(const struct CRGBPalette16& srcpal16, struct CRGBPalette256& destpal256)
 {
     for( int i = 0; i < 256; i++) {
@@ -1133,6 +2231,9 @@ void nblendPaletteTowardPalette( CRGBPalette16& current, CRGBPalette16& target,
         // if we've hit the maximum number of changes, exit
         if( changes >= maxChanges) { break; }
     }
+
+    // the entries were changed in place, drop any cached expansion of the palette
+    if( changes) { FASTLED_PALETTE16_CHANGED(); }
 }
 
 
@@ -1179,8 +2280,85 @@ CRGB& napplyGamma_video( CRGB& rgb, float gammaR, float gammaG, float gammaB)
     return rgb;
 }
 
+void CGammaLUT::load( float gamma)
+{
+    for( uint16_t i = 0; i < 256; i++) {
+        entries[i] = applyGamma_video( (uint8_t)i, gamma);
+    }
+}
+
+void CRGBGammaLUT::load( float gammaR, float gammaG, float gammaB)
+{
+    r.load( gammaR);
+    if( gammaG == gammaR) { g = r; } else { g.load( gammaG); }
+    if( gammaB == gammaR) { b = r; } else if( gammaB == gammaG) { b = g; } else { b.load( gammaB); }
+}
+
+void napplyGamma_video( CRGB* rgbarray, uint16_t count, const CGammaLUT& lut)
+{
+    for( uint16_t i = 0; i < count; i++) {
+        CRGB& rgb = rgbarray[i];
+        rgb.r = lut[rgb.r];
+        rgb.g = lut[rgb.g];
+        rgb.b = lut[rgb.b];
+    }
+}
+
+void napplyGamma_video( CRGB* rgbarray, uint16_t count, const CRGBGammaLUT& lut)
+{
+    for( uint16_t i = 0; i < count; i++) {
+        rgbarray[i] = lut( rgbarray[i]);
+    }
+}
+
+// Tables for the last gammas the float array functions were called with.  Not
+// worth the ram on AVR, nor a table's 256 pow() calls for less than 256 values.
+#ifndef FASTLED_GAMMA_CACHE
+#if defined(__AVR__)
+#define FASTLED_GAMMA_CACHE 0
+#else
+#define FASTLED_GAMMA_CACHE 1
+#endif
+#endif
+
+#if (FASTLED_GAMMA_CACHE == 1)
+static CGammaLUT sGammaCache;
+static float sGammaCacheGamma = -1;
+static CRGBGammaLUT sRGBGammaCache;
+static float sRGBGammaCacheGamma[3] = { -1, -1, -1 };
+
+static const CGammaLUT* cachedGamma( uint16_t count, float gamma)
+{
+    if( count * 3UL < 256) { return NULL; }
+    if( sGammaCacheGamma != gamma) {
+        sGammaCache.load( gamma);
+        sGammaCacheGamma = gamma;
+    }
+    return &sGammaCache;
+}
+
+static const CRGBGammaLUT* cachedGamma( uint16_t count, float gammaR, float gammaG, float gammaB)
+{
+    if( count * 3UL < 256) { return NULL; }
+    if( sRGBGammaCacheGamma[0] != gammaR || sRGBGammaCacheGamma[1] != gammaG || sRGBGammaCacheGamma[2] != gammaB) {
+        sRGBGammaCache.load( gammaR, gammaG, gammaB);
+        sRGBGammaCacheGamma[0] = gammaR;
+        sRGBGammaCacheGamma[1] = gammaG;
+        sRGBGammaCacheGamma[2] = gammaB;
+    }
+    return &sRGBGammaCache;
+}
+#endif
+
 void napplyGamma_video( CRGB* rgbarray, uint16_t count, float gamma)
 {
+#if (FASTLED_GAMMA_CACHE == 1)
+    const CGammaLUT* lut = cachedGamma( count, gamma);
+    if( lut) {
+        napplyGamma_video( rgbarray, count, *lut);
+        return;
+    }
+#endif
     for( uint16_t i = 0; i < count; i++) {
         rgbarray[i] = applyGamma_video( rgbarray[i], gamma);
     }
@@ -1188,10 +2366,68 @@ void napplyGamma_video( CRGB* rgbarray, uint16_t count, float gamma)
 
 void napplyGamma_video( CRGB* rgbarray, uint16_t count, float gammaR, float gammaG, float gammaB)
 {
+#if (FASTLED_GAMMA_CACHE == 1)
+    const CRGBGammaLUT* lut = cachedGamma( count, gammaR, gammaG, gammaB);
+    if( lut) {
+        napplyGamma_video( rgbarray, count, *lut);
+        return;
+    }
+#endif
     for( uint16_t i = 0; i < count; i++) {
         rgbarray[i] = applyGamma_video( rgbarray[i], gammaR, gammaG, gammaB);
     }
 }
 
 
+// The float versions look their table up on the calling core (the cache isn't
+// safe to use from two cores at once), and the slices only read it.  Without
+// the cache they don't split the work, there's no table to share.
+struct CGammaJob {
+    CRGB* rgbarray;
+    const CGammaLUT* lut;
+    const CRGBGammaLUT* rgbLut;
+};
+
+static void gammaRange( void* pArg, uint16_t start, uint16_t end)
+{
+    const CGammaJob& job = *(const CGammaJob*)pArg;
+    if( job.lut) {
+        napplyGamma_video( job.rgbarray + start, end - start, *job.lut);
+    } else {
+        napplyGamma_video( job.rgbarray + start, end - start, *job.rgbLut);
+    }
+}
+
+void napplyGamma_video_parallel( CRGB* rgbarray, uint16_t count, const CGammaLUT& lut)
+{
+    CGammaJob job = { rgbarray, &lut, NULL };
+    parallel_for( count, gammaRange, &job);
+}
+
+void napplyGamma_video_parallel( CRGB* rgbarray, uint16_t count, const CRGBGammaLUT& lut)
+{
+    CGammaJob job = { rgbarray, NULL, &lut };
+    parallel_for( count, gammaRange, &job);
+}
+
+void napplyGamma_video_parallel( CRGB* rgbarray, uint16_t count, float gamma)
+{
+#if (FASTLED_GAMMA_CACHE == 1)
+    const CGammaLUT* lut = cachedGamma( 0xFFFF, gamma);
+    napplyGamma_video_parallel( rgbarray, count, *lut);
+#else
+    napplyGamma_video( rgbarray, count, gamma);
+#endif
+}
+
+void napplyGamma_video_parallel( CRGB* rgbarray, uint16_t count, float gammaR, float gammaG, float gammaB)
+{
+#if (FASTLED_GAMMA_CACHE == 1)
+    const CRGBGammaLUT* lut = cachedGamma( 0xFFFF, gammaR, gammaG, gammaB);
+    napplyGamma_video_parallel( rgbarray, count, *lut);
+#else
+    napplyGamma_video( rgbarray, count, gammaR, gammaG, gammaB);
+#endif
+}
+
 FASTLED_NAMESPACE_END
@@ -7,6 +7,7 @@
 #include "FastLED.h"
 #include "pixeltypes.h"
 #include "fastled_progmem.h"
+#include "xymap.h"
 
 FASTLED_NAMESPACE_BEGIN
 ///@defgroup Colorutils Color utility functions
@@ -90,6 +91,24 @@ typedef enum { FORWARD_HUES, BACKWARD_HUES, SHORTEST_HUES, LONGEST_HUES } TGradi
 ///   In the case of writing into a CRGB array, the gradient is
 ///   computed in HSV space, and then HSV values are converted to RGB
 ///   as they're written into the RGB array.
+
+// fill_gradient and fill_rainbow work out their colors this many at a
+// time, so writing into a CRGB array can convert them in a batch
+#define GRADIENT_BATCH 16
+
+template <typename T>
+inline void write_gradient( T* targetArray, const CHSV* hsv, uint16_t count)
+{
+    for( uint16_t i = 0; i < count; i++) {
+        targetArray[i] = hsv[i];
+    }
+}
+
+inline void write_gradient( CRGB* targetArray, const CHSV* hsv, uint16_t count)
+{
+    hsv2rgb_rainbow( hsv, targetArray, count);
+}
+
 template <typename T>
 void fill_gradient( T* targetArray,
                     uint16_t startpos, CHSV startcolor,
@@ -168,11 +187,17 @@ void fill_gradient( T* targetArray,
     accum88 hue88 = startcolor.hue << 8;
     accum88 sat88 = startcolor.sat << 8;
     accum88 val88 = startcolor.val << 8;
-    for( uint16_t i = startpos; i <= endpos; i++) {
-        targetArray[i] = CHSV( hue88 >> 8, sat88 >> 8, val88 >> 8);
-        hue88 += huedelta87;
-        sat88 += satdelta87;
-        val88 += valdelta87;
+    CHSV hsv[GRADIENT_BATCH];
+    for( uint32_t i = startpos; i <= endpos; i += GRADIENT_BATCH) {
+        uint16_t count = (endpos - i) + 1;
+        if( count > GRADIENT_BATCH) count = GRADIENT_BATCH;
+        for( uint16_t j = 0; j < count; j++) {
+            hsv[j] = CHSV( hue88 >> 8, sat88 >> 8, val88 >> 8);
+            hue88 += huedelta87;
+            sat88 += satdelta87;
+            val88 += valdelta87;
+        }
+        write_gradient( targetArray + i, hsv, count);
     }
 }
 
@@ -317,13 +342,49 @@ void  nblend( CHSV* existing, CHSV* overlay, uint16_t count, fract8 amountOfOver
 //         eventually all the way to black; this is by design so that
 //         it can be used to (slowly) clear the LEDs to black.
 void blur1d( CRGB* leds, uint16_t numLeds, fract8 blur_amount);
+//
+// blur2d and blurColumns without a layout go through the sketch's
+// XY(uint8_t,uint8_t), so they're limited to 255x255; use the TXYLayout or
+// XYMap versions below for anything bigger.
 void blur2d( CRGB* leds, uint8_t width, uint8_t height, fract8 blur_amount);
 
 // blurRows: perform a blur1d on every row of a rectangular matrix
-void blurRows( CRGB* leds, uint8_t width, uint8_t height, fract8 blur_amount);
+void blurRows( CRGB* leds, uint16_t width, uint16_t height, fract8 blur_amount);
 // blurColumns: perform a blur1d on each column of a rectangular matrix
 void blurColumns(CRGB* leds, uint8_t width, uint8_t height, fract8 blur_amount);
 
+// blur2d/blurColumns for a matrix with a known layout (see TXYLayout in xymap.h).
+// These walk the led memory directly, several columns at a time, rather than
+// calling XY().  Matrices up to 255x255 take an 8-bit path.
+void blur2d( CRGB* leds, uint16_t width, uint16_t height, fract8 blur_amount, TXYLayout layout);
+void blurColumns(CRGB* leds, uint16_t width, uint16_t height, fract8 blur_amount, TXYLayout layout);
+
+// blur2d/blurRows/blurColumns for a matrix described by an XYMap, which covers
+// rotated and arbitrary layouts, and matrices more than 255 pixels wide or high.
+void blur2d( CRGB* leds, const XYMap& map, fract8 blur_amount);
+void blurRows( CRGB* leds, const XYMap& map, fract8 blur_amount);
+void blurColumns( CRGB* leds, const XYMap& map, fract8 blur_amount);
+
+// blur2d_parallel: blur2d for an XYMap, with the rows (and then the columns)
+// split between cores where the platform has more than one (see parallel.h)
+void blur2d_parallel( CRGB* leds, const XYMap& map, fract8 blur_amount);
+
+// boxBlur1d/boxBlur2d: wide blurs, averaging every led with the radius leds on
+// either side of it (and, in 2d, above and below it).  A running sum slides
+// along each row and column, so a wide glow costs the same as a narrow one,
+// rather than needing blur1d/blur2d over and over.
+// gaussianBlur1d/gaussianBlur2d: three box blurs, which come out very close to
+// a gaussian blur with a standard deviation of about radius + 1/2.
+//
+//         The ends of the lines act as mirrors, so unlike blur1d/blur2d the
+//         total light is conserved, up to rounding.  Radii past the length of
+//         a line are cut down to it.  These need a copy of a row or column
+//         (whichever is longer) on the stack.
+void boxBlur1d( CRGB* leds, uint16_t numLeds, uint16_t radius);
+void gaussianBlur1d( CRGB* leds, uint16_t numLeds, uint16_t radius);
+void boxBlur2d( CRGB* leds, const XYMap& map, uint16_t radius);
+void gaussianBlur2d( CRGB* leds, const XYMap& map, uint16_t radius);
+
 
 // CRGB HeatColor( uint8_t temperature)
 //
@@ -332,8 +393,14 @@ void blurColumns(CRGB* leds, uint8_t width, uint8_t height, fract8 blur_amount);
 // Heat is specified as an arbitrary scale from 0 (cool) to 255 (hot).
 // This is NOT a chromatically correct 'black body radiation'
 // spectrum, but it's surprisingly close, and it's fast and small.
+// Where FASTLED_HEATCOLOR_TABLE is set (see below) it's a single load
+// from HeatColorsLUT instead.
 CRGB HeatColor( uint8_t temperature);
 
+// map_heat_to_rgb - HeatColor for a whole array of heat values,
+//                   e.g. the cells of a fire simulation
+void map_heat_to_rgb( const uint8_t* heat, CRGB* leds, uint16_t numLeds);
+
 
 // Palettes
 //
@@ -404,6 +471,84 @@ typedef uint32_t TProgmemRGBPalette32[32];
 typedef uint32_t TProgmemHSVPalette32[32];
 #define TProgmemPalette32 TProgmemRGBPalette32
 
+// TRGBPaletteTable - a TProgmemRGBPalette16 expanded to all 256 of its
+//      LINEARBLEND colors by the compiler, so ColorFromPalette is a single
+//      table read with no flash access or interpolation at run time.  The
+//      built-in palettes come with one each (RainbowColors_t etc, see
+//      colorpalettes.h), and any constant palette can be expanded with
+//
+//        const TRGBPaletteTable myTable = PaletteTable( myPalette_p);
+//
+//      which needs C++11, so it isn't available on AVR (where the 768 bytes
+//      would have to come out of ram anyway).  Lookups come out exactly the
+//      same as from the TProgmemRGBPalette16 the table was made from.
+#ifndef FASTLED_PALETTE_TABLES
+#if defined(__AVR__) || (__cplusplus <= 199711L)
+#define FASTLED_PALETTE_TABLES 0
+#else
+#define FASTLED_PALETTE_TABLES 1
+#endif
+#endif
+
+// where the built-in tables go, e.g. DRAM_ATTR on the esp32, to keep lookups
+// from stalling on the flash cache
+#ifndef FASTLED_PALETTE_TABLE_ATTR
+#define FASTLED_PALETTE_TABLE_ATTR
+#endif
+
+#if (FASTLED_PALETTE_TABLES == 1)
+struct TRGBPaletteTableEntry { uint8_t r, g, b; };
+struct TRGBPaletteTable { TRGBPaletteTableEntry entries[256]; };
+
+// compile time versions of the scale8 and LINEARBLEND math in
+// ColorFromPalette( const TProgmemRGBPalette16&, ...)
+constexpr uint8_t paletteTableScale8( uint8_t i, uint8_t scale)
+{
+    return (FASTLED_SCALE8_FIXED == 1) ? (((uint16_t)i * (1 + (uint16_t)scale)) >> 8) : (((uint16_t)i * scale) >> 8);
+}
+
+constexpr uint8_t paletteTableChannel( uint32_t c1, uint32_t c2, uint8_t lo4, uint8_t shift)
+{
+    return lo4 ? (uint8_t)(paletteTableScale8( c1 >> shift, 255 - (lo4 << 4)) + paletteTableScale8( c2 >> shift, lo4 << 4))
+               : (uint8_t)(c1 >> shift);
+}
+
+constexpr TRGBPaletteTableEntry paletteTableEntry( const TProgmemRGBPalette16& pal, uint8_t hi4, uint8_t lo4)
+{
+    return { paletteTableChannel( pal[hi4], pal[(hi4 + 1) & 0x0F], lo4, 16),
+             paletteTableChannel( pal[hi4], pal[(hi4 + 1) & 0x0F], lo4, 8),
+             paletteTableChannel( pal[hi4], pal[(hi4 + 1) & 0x0F], lo4, 0) };
+}
+
+// the indices 0..N-1 as a parameter pack, built by doubling so the template
+// nesting stays shallow
+template<int... I> struct CPaletteTableIndices { typedef CPaletteTableIndices<I..., (I + (int)sizeof...(I))...> doubled; };
+template<int N> struct CPaletteTableIndexRange { typedef typename CPaletteTableIndexRange<N / 2>::type::doubled type; };
+template<> struct CPaletteTableIndexRange<1> { typedef CPaletteTableIndices<0> type; };
+
+template<int... I>
+constexpr TRGBPaletteTable paletteTable( const TProgmemRGBPalette16& pal, CPaletteTableIndices<I...>)
+{
+    return {{ paletteTableEntry( pal, I >> 4, I & 0x0F)... }};
+}
+
+constexpr TRGBPaletteTable PaletteTable( const TProgmemRGBPalette16& pal)
+{
+    return paletteTable( pal, CPaletteTableIndexRange<256>::type());
+}
+#endif
+
+// HeatColor as a table, for every temperature: 768 bytes that make HeatColor
+// and map_heat_to_rgb table loads rather than the small, branchy code AVR
+// wants.  Needs the palette tables, and is on wherever they are.
+#ifndef FASTLED_HEATCOLOR_TABLE
+#define FASTLED_HEATCOLOR_TABLE FASTLED_PALETTE_TABLES
+#endif
+
+#if (FASTLED_HEATCOLOR_TABLE == 1)
+extern const TRGBPaletteTable HeatColorsLUT;
+#endif
+
 typedef const uint8_t TProgmemRGBGradientPalette_byte ;
 typedef const TProgmemRGBGradientPalette_byte *TProgmemRGBGradientPalette_bytes;
 typedef TProgmemRGBGradientPalette_bytes TProgmemRGBGradientPalettePtr;
@@ -643,15 +788,27 @@ public:
     }
 };
 
+#if (FASTLED_PALETTE16_CACHE == 1)
+// Bumped whenever a CRGBPalette16 is created or handed out for changing (assignment, non-const
+// [] or CRGB* access), which invalidates the 256 entry expansions that ColorFromPalette keeps
+// of recently used palettes.  Writing to a palette's entries[] directly bypasses this; call
+// FASTLED_PALETTE16_CHANGED() after doing that.
+extern uint32_t gPalette16Generation;
+#define FASTLED_PALETTE16_CHANGED() (gPalette16Generation++)
+#else
+#define FASTLED_PALETTE16_CHANGED()
+#endif
+
 class CRGBPalette16 {
 public:
     CRGB entries[16];
-    CRGBPalette16() {};
+    CRGBPalette16() { FASTLED_PALETTE16_CHANGED(); };
     CRGBPalette16( const CRGB& c00,const CRGB& c01,const CRGB& c02,const CRGB& c03,
                     const CRGB& c04,const CRGB& c05,const CRGB& c06,const CRGB& c07,
                     const CRGB& c08,const CRGB& c09,const CRGB& c10,const CRGB& c11,
                     const CRGB& c12,const CRGB& c13,const CRGB& c14,const CRGB& c15 )
     {
+        FASTLED_PALETTE16_CHANGED();
         entries[0]=c00; entries[1]=c01; entries[2]=c02; entries[3]=c03;
         entries[4]=c04; entries[5]=c05; entries[6]=c06; entries[7]=c07;
         entries[8]=c08; entries[9]=c09; entries[10]=c10; entries[11]=c11;
@@ -660,37 +817,44 @@ public:
 
     CRGBPalette16( const CRGBPalette16& rhs)
     {
+        FASTLED_PALETTE16_CHANGED();
         memmove8( &(entries[0]), &(rhs.entries[0]), sizeof( entries));
     }
     CRGBPalette16( const CRGB rhs[16])
     {
+        FASTLED_PALETTE16_CHANGED();
         memmove8( &(entries[0]), &(rhs[0]), sizeof( entries));
     }
     CRGBPalette16& operator=( const CRGBPalette16& rhs)
     {
+        FASTLED_PALETTE16_CHANGED();
         memmove8( &(entries[0]), &(rhs.entries[0]), sizeof( entries));
         return *this;
     }
     CRGBPalette16& operator=( const CRGB rhs[16])
     {
+        FASTLED_PALETTE16_CHANGED();
         memmove8( &(entries[0]), &(rhs[0]), sizeof( entries));
         return *this;
     }
 
     CRGBPalette16( const CHSVPalette16& rhs)
     {
+        FASTLED_PALETTE16_CHANGED();
         for( uint8_t i = 0; i < 16; i++) {
     		entries[i] = rhs.entries[i]; // implicit HSV-to-RGB conversion
         }
     }
     CRGBPalette16( const CHSV rhs[16])
     {
+        FASTLED_PALETTE16_CHANGED();
         for( uint8_t i = 0; i < 16; i++) {
             entries[i] = rhs[i]; // implicit HSV-to-RGB conversion
         }
     }
     CRGBPalette16& operator=( const CHSVPalette16& rhs)
     {
+        FASTLED_PALETTE16_CHANGED();
         for( uint8_t i = 0; i < 16; i++) {
     		entries[i] = rhs.entries[i]; // implicit HSV-to-RGB conversion
         }
@@ -698,6 +862,7 @@ public:
     }
     CRGBPalette16& operator=( const CHSV rhs[16])
     {
+        FASTLED_PALETTE16_CHANGED();
         for( uint8_t i = 0; i < 16; i++) {
             entries[i] = rhs[i]; // implicit HSV-to-RGB conversion
         }
@@ -706,12 +871,14 @@ public:
 
     CRGBPalette16( const TProgmemRGBPalette16& rhs)
     {
+        FASTLED_PALETTE16_CHANGED();
         for( uint8_t i = 0; i < 16; i++) {
             entries[i] =  FL_PGM_READ_DWORD_NEAR( rhs + i);
         }
     }
     CRGBPalette16& operator=( const TProgmemRGBPalette16& rhs)
     {
+        FASTLED_PALETTE16_CHANGED();
         for( uint8_t i = 0; i < 16; i++) {
             entries[i] =  FL_PGM_READ_DWORD_NEAR( rhs + i);
         }
@@ -737,6 +904,7 @@ public:
     
     inline CRGB& operator[] (uint8_t x) __attribute__((always_inline))
     {
+        FASTLED_PALETTE16_CHANGED();
         return entries[x];
     }
     inline const CRGB& operator[] (uint8_t x) const __attribute__((always_inline))
@@ -746,6 +914,7 @@ public:
 
     inline CRGB& operator[] (int x) __attribute__((always_inline))
     {
+        FASTLED_PALETTE16_CHANGED();
         return entries[(uint8_t)x];
     }
     inline const CRGB& operator[] (int x) const __attribute__((always_inline))
@@ -755,40 +924,49 @@ public:
 
     operator CRGB*()
     {
+        FASTLED_PALETTE16_CHANGED();
         return &(entries[0]);
     }
 
     CRGBPalette16( const CHSV& c1)
     {
+        FASTLED_PALETTE16_CHANGED();
         fill_solid( &(entries[0]), 16, c1);
     }
     CRGBPalette16( const CHSV& c1, const CHSV& c2)
     {
+        FASTLED_PALETTE16_CHANGED();
         fill_gradient( &(entries[0]), 16, c1, c2);
     }
     CRGBPalette16( const CHSV& c1, const CHSV& c2, const CHSV& c3)
     {
+        FASTLED_PALETTE16_CHANGED();
         fill_gradient( &(entries[0]), 16, c1, c2, c3);
     }
     CRGBPalette16( const CHSV& c1, const CHSV& c2, const CHSV& c3, const CHSV& c4)
     {
+        FASTLED_PALETTE16_CHANGED();
         fill_gradient( &(entries[0]), 16, c1, c2, c3, c4);
     }
 
     CRGBPalette16( const CRGB& c1)
     {
+        FASTLED_PALETTE16_CHANGED();
         fill_solid( &(entries[0]), 16, c1);
     }
     CRGBPalette16( const CRGB& c1, const CRGB& c2)
     {
+        FASTLED_PALETTE16_CHANGED();
         fill_gradient_RGB( &(entries[0]), 16, c1, c2);
     }
     CRGBPalette16( const CRGB& c1, const CRGB& c2, const CRGB& c3)
     {
+        FASTLED_PALETTE16_CHANGED();
         fill_gradient_RGB( &(entries[0]), 16, c1, c2, c3);
     }
     CRGBPalette16( const CRGB& c1, const CRGB& c2, const CRGB& c3, const CRGB& c4)
     {
+        FASTLED_PALETTE16_CHANGED();
         fill_gradient_RGB( &(entries[0]), 16, c1, c2, c3, c4);
     }
 
@@ -817,10 +995,12 @@ public:
     // the exact stripe widths at the expense of dropping some colors.
     CRGBPalette16( TProgmemRGBGradientPalette_bytes progpal )
     {
+        FASTLED_PALETTE16_CHANGED();
         *this = progpal;
     }
     CRGBPalette16& operator=( TProgmemRGBGradientPalette_bytes progpal )
     {
+        FASTLED_PALETTE16_CHANGED();
         TRGBGradientPaletteEntryUnion* progent = (TRGBGradientPaletteEntryUnion*)(progpal);
         TRGBGradientPaletteEntryUnion u;
 
@@ -863,6 +1043,7 @@ public:
     }
     CRGBPalette16& loadDynamicGradientPalette( TDynamicRGBGradientPalette_bytes gpal )
     {
+        FASTLED_PALETTE16_CHANGED();
         TRGBGradientPaletteEntryUnion* ent = (TRGBGradientPaletteEntryUnion*)(gpal);
         TRGBGradientPaletteEntryUnion u;
 
@@ -1525,6 +1706,13 @@ CRGB ColorFromPalette( const CRGBPalette256& pal,
                        uint8_t brightness=255,
                        TBlendType blendType=NOBLEND );
 
+#if (FASTLED_PALETTE_TABLES == 1)
+CRGB ColorFromPalette( const TRGBPaletteTable& pal,
+                       uint8_t index,
+                       uint8_t brightness=255,
+                       TBlendType blendType=LINEARBLEND);
+#endif
+
 CHSV ColorFromPalette( const CHSVPalette16& pal,
                        uint8_t index,
                        uint8_t brightness=255,
@@ -1551,6 +1739,161 @@ CHSV ColorFromPalette( const CHSVPalette32& pal,
                       TBlendType blendType=LINEARBLEND);
 
 
+// fill_from_palette - look up a whole buffer of palette indices at once:
+//
+//      out[i] = ColorFromPalette( pal, indices[i], brightness, blendType);
+//
+//      for i = 0..count-1, with the same results, but the per-call setup (blend
+//      and brightness checks) is hoisted out of the loop, which makes a
+//      difference when mapping thousands of pixels per frame.
+void fill_from_palette( CRGB* out, const uint8_t* indices, uint16_t count,
+                        const CRGBPalette16& pal,
+                        uint8_t brightness=255,
+                        TBlendType blendType=LINEARBLEND);
+
+void fill_from_palette( CRGB* out, const uint8_t* indices, uint16_t count,
+                        const CRGBPalette32& pal,
+                        uint8_t brightness=255,
+                        TBlendType blendType=LINEARBLEND);
+
+void fill_from_palette( CRGB* out, const uint8_t* indices, uint16_t count,
+                        const CRGBPalette256& pal,
+                        uint8_t brightness=255,
+                        TBlendType blendType=NOBLEND);
+
+// CRGBPaletteLUT - a 256 entry palette with brightness and color adjustment baked in.
+//
+//      When a whole frame uses one palette at one brightness, loading the palette
+//      into one of these once per frame does the interpolation, brightness scaling
+//      and color correction/temperature scaling up front, so each pixel is a single
+//      table read:
+//
+//        lut.load( myPalette, FastLED[0].getAdjustment( FastLED.getBrightness()));
+//        FastLED[0].setPrescaled( true);   // once, in setup
+//        for( int i = 0; i < NUM_LEDS; i++) { leds[i] = lut[ index[i] ]; }
+//
+//      setPrescaled tells the controller not to scale (or dither) the led data
+//      again when it's written out.
+class CRGBPaletteLUT {
+public:
+    CRGB entries[256];
+
+    // fill the table from a palette
+    //   adjustment - the per-channel scale to bake in, usually a controller's getAdjustment()
+    //   brightness - the ColorFromPalette brightness to apply before that
+    void load( const CRGBPalette16& pal, const CRGB& adjustment, uint8_t brightness=255, TBlendType blendType=LINEARBLEND);
+    void load( const CRGBPalette32& pal, const CRGB& adjustment, uint8_t brightness=255, TBlendType blendType=LINEARBLEND);
+    void load( const CRGBPalette256& pal, const CRGB& adjustment, uint8_t brightness=255);
+
+    inline const CRGB& operator[] (uint8_t x) const __attribute__((always_inline))
+    {
+        return entries[x];
+    }
+};
+
+// CRGBPaletteTransition - a cross-fade from one palette to another, as a CRGBPaletteLUT.
+//
+//      Tracks how far the fade has got (0 = all 'from', 255 = all 'target') and
+//      only redoes the blend and the 256 entry expansion when that, or the scaling,
+//      changes - so any number of effects can look their colors up in lut() every
+//      frame, instead of each one calling nblendPaletteTowardPalette and
+//      ColorFromPalette on a palette that changes under it:
+//
+//        fade.start( OceanColors_p);              // fade from whatever's showing now
+//        ...
+//        EVERY_N_MILLISECONDS( 20) { fade.advance( 2); }
+//        fill_from_palette( leds, indices, NUM_LEDS, fade.lut());
+//
+//      Starting a new fade halfway through another one fades from the colors
+//      that are showing at that point.
+class CRGBPaletteTransition {
+    CRGBPalette16 m_From;
+    CRGBPalette16 m_Target;
+    CRGB m_Adjustment;
+    fract8 m_nAmount;
+    uint8_t m_nBrightness;
+    TBlendType m_BlendType;
+    bool m_bDirty;
+    CRGBPaletteLUT m_LUT;
+
+public:
+    // settle on a palette, with nothing to fade to yet
+    //   adjustment, brightness, blendType - as for CRGBPaletteLUT::load
+    CRGBPaletteTransition( const CRGBPalette16& pal,
+                           const CRGB& adjustment=CRGB(255,255,255),
+                           uint8_t brightness=255,
+                           TBlendType blendType=LINEARBLEND)
+        : m_From( pal), m_Target( pal), m_Adjustment( adjustment), m_nAmount( 255),
+          m_nBrightness( brightness), m_BlendType( blendType), m_bDirty( true) {}
+
+    // fade from the colors showing now to a new palette, starting at amount 0
+    void start( const CRGBPalette16& target);
+
+    // jump to a point in the fade
+    // returns true if the colors changed
+    bool setAmount( fract8 amount)
+    {
+        if( amount == m_nAmount) { return false; }
+        m_nAmount = amount;
+        m_bDirty = true;
+        return true;
+    }
+
+    // move the fade toward the target palette by step
+    // returns true if the colors changed
+    bool advance( uint8_t step) { return setAmount( qadd8( m_nAmount, step)); }
+
+    // how far the fade has got
+    fract8 amount() const { return m_nAmount; }
+    // whether the target palette has been reached
+    bool done() const { return m_nAmount == 255; }
+
+    // change the scaling baked into the table, as for CRGBPaletteLUT::load
+    void setScaling( const CRGB& adjustment, uint8_t brightness=255)
+    {
+        m_Adjustment = adjustment;
+        m_nBrightness = brightness;
+        m_bDirty = true;
+    }
+
+    // the colors at the current point in the fade, recalculated only if
+    // something changed since the last call
+    const CRGBPaletteLUT& lut()
+    {
+        if( m_bDirty) { update(); }
+        return m_LUT;
+    }
+
+private:
+    void blended( CRGBPalette16& pal) const;
+    void update();
+};
+
+// look up a whole buffer of indices in a CRGBPaletteLUT
+void fill_from_palette( CRGB* out, const uint8_t* indices, uint16_t count,
+                        const CRGBPaletteLUT& lut);
+
+// fill_from_palette_parallel - fill_from_palette with the buffer split between
+// cores where the platform has more than one (see parallel.h)
+void fill_from_palette_parallel( CRGB* out, const uint8_t* indices, uint16_t count,
+                                 const CRGBPalette16& pal,
+                                 uint8_t brightness=255,
+                                 TBlendType blendType=LINEARBLEND);
+void fill_from_palette_parallel( CRGB* out, const uint8_t* indices, uint16_t count,
+                                 const CRGBPaletteLUT& lut);
+
+// upscale - stretch a smaller image over a whole matrix:
+//
+//      the image is width x height CRGBs, row after row, and gets drawn onto
+//      the leds of an XYMap of any size, so smooth effects like noise or
+//      plasma can be rendered at a half or a quarter of the resolution for a
+//      fraction of the cost.  NOBLEND repeats the image pixel each led falls
+//      in, LINEARBLEND interpolates between the four image pixels around it.
+//      Stretching the rows by exactly 2 or 4 takes a faster path.  The
+//      interpolation keeps a row of the image on the stack.
+void upscale( CRGB* leds, const XYMap& map, const CRGB* src, uint16_t width, uint16_t height,
+              TBlendType blendType=LINEARBLEND);
+
 // Fill a range of LEDs with a sequece of entryies from a palette
 template <typename PALETTE>
 void fill_palette(CRGB* L, uint16_t N, uint8_t startIndex, uint8_t incIndex,
@@ -1696,6 +2039,72 @@ CRGB&  napplyGamma_video( CRGB& rgb, float gamma);
 CRGB&  napplyGamma_video( CRGB& rgb, float gammaR, float gammaG, float gammaB);
 void   napplyGamma_video( CRGB* rgbarray, uint16_t count, float gamma);
 void   napplyGamma_video( CRGB* rgbarray, uint16_t count, float gammaR, float gammaG, float gammaB);
+// The same, with the array split between cores where the platform has more
+// than one (see parallel.h)
+void   napplyGamma_video_parallel( CRGB* rgbarray, uint16_t count, float gamma);
+void   napplyGamma_video_parallel( CRGB* rgbarray, uint16_t count, float gammaR, float gammaG, float gammaB);
+
+// CGammaLUT - applyGamma_video for one gamma, worked out once for all 256
+// values, so that applying it is a table read instead of a pow():
+//
+//      CGammaLUT gamma( 2.2);
+//      napplyGamma_video( leds, NUM_LEDS, gamma);
+//
+// or, on platforms that support it (FASTLED_GAMMA_OUTPUT), applied as the led
+// data is written out, without a separate pass over the leds, and without
+// touching the (linear) led data itself:
+//
+//      FastLED[0].setGamma( gamma);       // a CGammaLUT or a CRGBGammaLUT
+//
+// The array versions of napplyGamma_video that take a float keep tables for the
+// last gamma(s) they were called with on 32 bit platforms, so calling them with
+// the same gamma every frame only pays for the pow() calls once.
+class CGammaLUT {
+public:
+    uint8_t entries[256];
+
+    CGammaLUT() {}
+    explicit CGammaLUT( float gamma) { load( gamma); }
+
+    void load( float gamma);
+
+    inline uint8_t operator[] (uint8_t x) const __attribute__((always_inline))
+    {
+        return entries[x];
+    }
+
+    inline operator const uint8_t* () const { return entries; }
+};
+
+// CRGBGammaLUT - one CGammaLUT per channel
+class CRGBGammaLUT {
+public:
+    CGammaLUT r, g, b;
+
+    CRGBGammaLUT() {}
+    explicit CRGBGammaLUT( float gamma) { load( gamma); }
+    CRGBGammaLUT( float gammaR, float gammaG, float gammaB) { load( gammaR, gammaG, gammaB); }
+
+    void load( float gamma) { load( gamma, gamma, gamma); }
+    void load( float gammaR, float gammaG, float gammaB);
+
+    inline CRGB operator() (const CRGB& orig) const __attribute__((always_inline))
+    {
+        return CRGB( r[orig.r], g[orig.g], b[orig.b]);
+    }
+};
+
+#if (FASTLED_GAMMA_OUTPUT == 1)
+inline CLEDController & CLEDController::setGamma( const CRGBGammaLUT & lut)
+{
+    return setGamma( lut.r, lut.g, lut.b);
+}
+#endif
+
+void   napplyGamma_video( CRGB* rgbarray, uint16_t count, const CGammaLUT& lut);
+void   napplyGamma_video( CRGB* rgbarray, uint16_t count, const CRGBGammaLUT& lut);
+void   napplyGamma_video_parallel( CRGB* rgbarray, uint16_t count, const CGammaLUT& lut);
+void   napplyGamma_video_parallel( CRGB* rgbarray, uint16_t count, const CRGBGammaLUT& lut);
 
 
 FASTLED_NAMESPACE_END
@@ -0,0 +1,128 @@
+#define FASTLED_INTERNAL
+#include "FastLED.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+int8_t LayerCompositor::add(const CRGB *pLeds, TCompositeLayerFunction pFunction, void *pArg, TCompositeMode mode, fract8 opacity) {
+	if(m_nLayers == m_nMaxLayers) { return -1; }
+	CompositeLayer &layer = m_pLayers[m_nLayers];
+	layer.pLeds = pLeds;
+	layer.pFunction = pFunction;
+	layer.pArg = pArg;
+	layer.mode = mode;
+	layer.opacity = opacity;
+	return m_nLayers++;
+}
+
+// Every mode treats all the bytes the same, so a tile is combined as plain bytes.  Add and subtract scale the layer
+// by the opacity first, the others work out the combined value and then blend toward it; at full opacity neither
+// happens, so a layer at 255 is exactly +=, |= etc.
+template<bool SCALED>
+static void compositeAdd(uint8_t *d, const uint8_t *s, uint16_t bytes, uint8_t opacity) {
+	for(uint16_t i = 0; i < bytes; i++) { d[i] = qadd8(d[i], SCALED ? scale8(s[i], opacity) : s[i]); }
+}
+
+template<bool SCALED>
+static void compositeSubtract(uint8_t *d, const uint8_t *s, uint16_t bytes, uint8_t opacity) {
+	for(uint16_t i = 0; i < bytes; i++) { d[i] = qsub8(d[i], SCALED ? scale8(s[i], opacity) : s[i]); }
+}
+
+static inline uint8_t compositeValue(TCompositeMode mode, uint8_t d, uint8_t s) {
+	switch(mode) {
+		case COMPOSITE_LIGHTEN:  return d > s ? d : s;
+		case COMPOSITE_DARKEN:   return d < s ? d : s;
+		case COMPOSITE_MULTIPLY: return scale8(d, s);
+		case COMPOSITE_SCREEN:   return 255 - scale8(255 - d, 255 - s);
+		default:                 return s;
+	}
+}
+
+template<TCompositeMode MODE, bool SCALED>
+static void compositeValues(uint8_t *d, const uint8_t *s, uint16_t bytes, uint8_t opacity) {
+	for(uint16_t i = 0; i < bytes; i++) {
+		uint8_t v = compositeValue(MODE, d[i], s[i]);
+		d[i] = SCALED ? blend8(d[i], v, opacity) : v;
+	}
+}
+
+template<TCompositeMode MODE>
+static void compositeValues(uint8_t *d, const uint8_t *s, uint16_t bytes, uint8_t opacity) {
+	if(opacity == 255) {
+		compositeValues<MODE, false>(d, s, bytes, opacity);
+	} else {
+		compositeValues<MODE, true>(d, s, bytes, opacity);
+	}
+}
+
+static void composite(CRGB *dst, const CRGB *src, uint16_t count, TCompositeMode mode, uint8_t opacity) {
+	uint8_t *d = dst->raw;
+	const uint8_t *s = src->raw;
+	uint16_t bytes = count * 3;
+	bool full = (opacity == 255);
+	switch(mode) {
+		case COMPOSITE_ADD:
+			if(full) { compositeAdd<false>(d, s, bytes, opacity); } else { compositeAdd<true>(d, s, bytes, opacity); }
+			break;
+		case COMPOSITE_SUBTRACT:
+			if(full) { compositeSubtract<false>(d, s, bytes, opacity); } else { compositeSubtract<true>(d, s, bytes, opacity); }
+			break;
+		case COMPOSITE_LIGHTEN:  compositeValues<COMPOSITE_LIGHTEN>(d, s, bytes, opacity); break;
+		case COMPOSITE_DARKEN:   compositeValues<COMPOSITE_DARKEN>(d, s, bytes, opacity); break;
+		case COMPOSITE_MULTIPLY: compositeValues<COMPOSITE_MULTIPLY>(d, s, bytes, opacity); break;
+		case COMPOSITE_SCREEN:   compositeValues<COMPOSITE_SCREEN>(d, s, bytes, opacity); break;
+		default:
+			// the bulk blend, which works a word at a time where it can
+			if(full) { memmove8((void*)dst, src, bytes); } else { blend(dst, src, dst, count, opacity); }
+			break;
+	}
+}
+
+void LayerCompositor::render(CRGB *leds, uint16_t count) const {
+	CRGB scratch[FASTLED_COMPOSITE_TILE];
+
+	// 32 bits, so the last step past a count near 65535 can't wrap back around to the start
+	for(uint32_t start = 0; start < count; start += FASTLED_COMPOSITE_TILE) {
+		uint16_t n = count - start;
+		if(n > FASTLED_COMPOSITE_TILE) { n = FASTLED_COMPOSITE_TILE; }
+		CRGB *tile = leds + start;
+		bool covered = false;
+
+		for(uint8_t l = 0; l < m_nLayers; l++) {
+			const CompositeLayer &layer = m_pLayers[l];
+			if(layer.opacity == 0) { continue; }
+
+			// an opaque normal layer with nothing under it goes straight into the output
+			bool direct = !covered && layer.mode == COMPOSITE_NORMAL && layer.opacity == 255;
+			const CRGB *src = NULL;
+			if(layer.pLeds) {
+				src = layer.pLeds + start;
+				if(direct) {
+					if(src != tile) { memmove8((void*)tile, src, n * sizeof(CRGB)); }
+					covered = true;
+					continue;
+				}
+				// a bottom layer that is the output gets moved out of the way of the black it goes on top of
+				if(!covered && src == tile) {
+					memmove8((void*)scratch, src, n * sizeof(CRGB));
+					src = scratch;
+				}
+			}
+			if(!covered && !direct) { memset8((void*)tile, 0, n * sizeof(CRGB)); }
+			covered = true;
+
+			if(!layer.pLeds) {
+				if(direct) {
+					layer.pFunction(layer.pArg, tile, start, n);
+					continue;
+				}
+				layer.pFunction(layer.pArg, scratch, start, n);
+				src = scratch;
+			}
+			composite(tile, src, n, layer.mode, layer.opacity);
+		}
+
+		if(!covered) { memset8((void*)tile, 0, n * sizeof(CRGB)); }
+	}
+}
+
+FASTLED_NAMESPACE_END
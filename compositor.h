@@ -0,0 +1,119 @@
+#ifndef __INC_COMPOSITOR_H
+#define __INC_COMPOSITOR_H
+
+#include "FastLED.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+///@file compositor.h
+/// stacking effect layers into one led buffer in a single pass
+
+///@defgroup Compositor Layer compositing
+///@{
+
+/// How a layer is combined with the layers below it.  All of them work on each channel separately.
+///   COMPOSITE_NORMAL   - the layer covers what's below (nblend)
+///   COMPOSITE_ADD      - the layer is added to what's below, saturating (+=)
+///   COMPOSITE_SUBTRACT - the layer is taken away from what's below, saturating (-=)
+///   COMPOSITE_LIGHTEN  - the brighter of the layer and what's below (|=)
+///   COMPOSITE_DARKEN   - the dimmer of the layer and what's below (&=)
+///   COMPOSITE_MULTIPLY - what's below scaled by the layer, so white leaves it alone and black blacks it out
+///   COMPOSITE_SCREEN   - the opposite of multiply: black leaves what's below alone and white makes it white
+typedef enum {
+	COMPOSITE_NORMAL=0, COMPOSITE_ADD, COMPOSITE_SUBTRACT, COMPOSITE_LIGHTEN, COMPOSITE_DARKEN, COMPOSITE_MULTIPLY, COMPOSITE_SCREEN
+} TCompositeMode;
+
+/// A function that renders part of a layer: pixels start to start + count - 1 of it go into leds[0] to
+/// leds[count - 1].  pArg is whatever was handed to LayerCompositor::addLayer along with it.
+typedef void (*TCompositeLayerFunction)(void *pArg, CRGB *leds, uint16_t start, uint16_t count);
+
+/// One layer of a LayerCompositor: either a buffer or a function that renders it, and how it goes on top of the
+/// layers below
+struct CompositeLayer {
+	/// the layer's pixels, or NULL if pFunction renders them
+	const CRGB *pLeds;
+	/// renders the layer's pixels if pLeds is NULL
+	TCompositeLayerFunction pFunction;
+	/// handed to pFunction
+	void *pArg;
+	/// how the layer is combined with the ones below it
+	TCompositeMode mode;
+	/// how much of the layer to use, 0 turns the layer off
+	fract8 opacity;
+};
+
+#ifndef FASTLED_COMPOSITE_TILE
+#if defined(__AVR__)
+#define FASTLED_COMPOSITE_TILE 16
+#else
+#define FASTLED_COMPOSITE_TILE 64
+#endif
+#endif
+
+/// Stacks a list of layers into one led buffer, bottom (the first layer added) to top.  Rather than making a pass
+/// over the whole buffer for every layer, the buffer is done a tile of FASTLED_COMPOSITE_TILE leds at a time: every
+/// layer is applied to the tile while it's still in the cache, and layers that come from a function are rendered a
+/// tile at a time too, into a tile sized buffer on the stack, so they don't need a buffer of their own.
+///
+/// The bottom layer goes on top of black.  The output can be a controller's own led buffer, e.g.
+/// render(FastLED[0]), and a layer's buffer may be the output buffer itself, as long as it's the bottom layer.
+///
+/// The list of layers needs storage for up to maxLayers entries, see CLayerCompositor for a compositor that carries
+/// its own.
+class LayerCompositor {
+	CompositeLayer *m_pLayers;
+	uint8_t m_nMaxLayers;
+	uint8_t m_nLayers;
+
+	int8_t add(const CRGB *pLeds, TCompositeLayerFunction pFunction, void *pArg, TCompositeMode mode, fract8 opacity);
+
+public:
+	/// create a compositor over caller provided storage for its list of layers
+	LayerCompositor(CompositeLayer *pLayers, uint8_t maxLayers) : m_pLayers(pLayers), m_nMaxLayers(maxLayers), m_nLayers(0) {}
+
+	/// put a buffer on top of the layers so far.  The buffer has to stay around, and has to be at least as long as
+	/// the output.
+	/// @returns the layer's index, or -1 if there's no room for another layer
+	int8_t addLayer(const CRGB *pLeds, TCompositeMode mode = COMPOSITE_NORMAL, fract8 opacity = 255) {
+		return add(pLeds, NULL, NULL, mode, opacity);
+	}
+
+	/// put a layer rendered by a function on top of the layers so far
+	/// @returns the layer's index, or -1 if there's no room for another layer
+	int8_t addLayer(TCompositeLayerFunction pFunction, void *pArg, TCompositeMode mode = COMPOSITE_NORMAL, fract8 opacity = 255) {
+		return add(NULL, pFunction, pArg, mode, opacity);
+	}
+
+	/// remove all the layers
+	void clear() { m_nLayers = 0; }
+
+	/// the number of layers
+	uint8_t layers() const { return m_nLayers; }
+
+	/// a layer, to change its mode, opacity or source.  No range checking is done.
+	CompositeLayer &layer(uint8_t index) { return m_pLayers[index]; }
+
+	/// set how much of a layer to use
+	void setOpacity(uint8_t index, fract8 opacity) { m_pLayers[index].opacity = opacity; }
+
+	/// stack the layers into count leds
+	void render(CRGB *leds, uint16_t count) const;
+
+	/// stack the layers into a controller's led buffer
+	void render(CLEDController &controller) const { render(controller.leds(), controller.size()); }
+};
+
+/// A LayerCompositor that carries the storage for its list of layers with it
+/// @tparam LAYERS the most layers it can hold
+template<uint8_t LAYERS>
+class CLayerCompositor : public LayerCompositor {
+	CompositeLayer m_Layers[LAYERS];
+public:
+	CLayerCompositor() : LayerCompositor(m_Layers, LAYERS) {}
+};
+
+///@}
+
+FASTLED_NAMESPACE_END
+
+#endif
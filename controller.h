@@ -8,9 +8,16 @@
 #include "led_sysdefs.h"
 #include "pixeltypes.h"
 #include "color.h"
+#include "framequeue.h"
+#include "power_mgt.h"
 
 FASTLED_NAMESPACE_BEGIN
 
+class CRGBGammaLUT;
+class CPaletteLeds;
+class CStagedLeds;
+class CPlanarLeds;
+
 #define RO(X) RGB_BYTE(RGB_ORDER, X)
 #define RGB_BYTE(RO,X) (((RO)>>(3*(2-(X)))) & 0x3)
 
@@ -20,16 +27,182 @@ FASTLED_NAMESPACE_BEGIN
 
 // operator byte *(struct CRGB[] arr) { return (byte*)arr; }
 
+// Output features that cost the controllers work on every pixel (or byte) they write out.  Each is off unless the
+// platform's led_sysdefs turns it on, which platforms with the cycles to spare do.
+
+// look each byte up in a gamma table as it's written out, see CLEDController::setGamma
+#ifndef FASTLED_GAMMA_OUTPUT
+#define FASTLED_GAMMA_OUTPUT 0
+#endif
+
+// generate led data while it's being written out, see CLEDController::setGenerator
+#ifndef FASTLED_PIXEL_GENERATORS
+#define FASTLED_PIXEL_GENERATORS 0
+#endif
+
+// reverse, mirror and rotate led data as it's written out, see CLEDController::setReverse
+#ifndef FASTLED_OUTPUT_MAPPING
+#define FASTLED_OUTPUT_MAPPING 0
+#endif
+
+// let the lanes of multi lane (block) controllers have lengths of their own, see CLEDController::setLaneLengths
+#ifndef FASTLED_LANE_LENGTHS
+#define FASTLED_LANE_LENGTHS 0
+#endif
+
+// give stretches of a controller's leds color adjustments of their own, see CLEDController::setSegments
+#ifndef FASTLED_SEGMENTS
+#define FASTLED_SEGMENTS 0
+#endif
+
+// dither over neighbouring leds as well as over time, see SPATIAL_DITHER
+#ifndef FASTLED_SPATIAL_DITHER
+#define FASTLED_SPATIAL_DITHER 0
+#endif
+
+/// A function that generates led data on demand: fill count leds into pLeds, the colors of leds start to
+/// start + count - 1 of the controller it's attached to.  Same signature as a compositor layer function.
+typedef void (*TPixelGenerator)(void *pArg, CRGB *pLeds, uint16_t start, uint16_t count);
+
+/// A stretch of a controller's leds with a color adjustment of its own (see CLEDController::setSegments) - e.g. the
+/// part of a strip running through a fixture with leds from a different bin.
+struct CLEDSegment {
+    /// the number of leds in the segment
+    uint16_t nLeds;
+    /// the segment's scale, applied on top of the controller's brightness, color correction and temperature
+    CRGB adjustment;
+
+    /// a segment with a color correction, temperature and brightness of its own (see CLEDController::setCorrection and
+    /// setTemperature), on top of the controller's
+    CLEDSegment(uint16_t n, const CRGB & correction = CRGB(255, 255, 255), const CRGB & temperature = CRGB(255, 255, 255), uint8_t brightness = 255);
+};
+
+// the bits of dithering SPATIAL_DITHER's pattern adds, and the number of leds it runs over
+#define SPATIAL_DITHER_BITS 3
+#define SPATIAL_DITHER_STEPS (1 << SPATIAL_DITHER_BITS)
+
 #define DISABLE_DITHER 0x00
 #define BINARY_DITHER 0x01
+// Dither over runs of SPATIAL_DITHER_STEPS neighbouring leds with an ordered pattern, on top of dithering over time
+// like BINARY_DITHER - so the leds still get SPATIAL_DITHER_BITS bits of dithering at refresh rates too low for any
+// over time.  BINARY_DITHER where FASTLED_SPATIAL_DITHER is off.
+#define SPATIAL_DITHER 0x02
 typedef uint8_t EDitherMode;
 
+// The most 'virtual bits' of dithering to use, and the lowest rate a full dither cycle (2^bits frames) may repeat at
+// before it shows up as flicker.  Each controller picks its dithering depth from its measured refresh rate, up to
+// VIRTUAL_BITS - see CLEDController::getDitherBits.
+#define MAX_LIKELY_UPDATE_RATE_HZ     400
+#define MIN_ACCEPTABLE_DITHER_RATE_HZ  50
+#define UPDATES_PER_FULL_DITHER_CYCLE (MAX_LIKELY_UPDATE_RATE_HZ / MIN_ACCEPTABLE_DITHER_RATE_HZ)
+#define RECOMMENDED_VIRTUAL_BITS ((UPDATES_PER_FULL_DITHER_CYCLE>1) + \
+                                  (UPDATES_PER_FULL_DITHER_CYCLE>2) + \
+                                  (UPDATES_PER_FULL_DITHER_CYCLE>4) + \
+                                  (UPDATES_PER_FULL_DITHER_CYCLE>8) + \
+                                  (UPDATES_PER_FULL_DITHER_CYCLE>16) + \
+                                  (UPDATES_PER_FULL_DITHER_CYCLE>32) + \
+                                  (UPDATES_PER_FULL_DITHER_CYCLE>64) + \
+                                  (UPDATES_PER_FULL_DITHER_CYCLE>128) )
+#define VIRTUAL_BITS RECOMMENDED_VIRTUAL_BITS
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // LED Controller interface definition
 //
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/// Timing statistics for the frames a controller has written out through FastLED.show/showColor, in cpu
+/// cycles.  The cycles counts are how long show kept the cpu busy with the controller - for controllers that write
+/// out in the background (dma, rmt) that's the time taken to start the output, not to finish it.  The wire counts
+/// are how long the frames took from the start of the output until they were out, and the blocked counts how long
+/// the controller held interrupts off while writing them (for the controllers that report that, the clockless
+/// controllers that have a cycle counter to time it by).  Between them they show where a frame's time goes:
+/// the difference between the wire and cycles counts is time left for other code and tasks while the leds update.
+struct LEDControllerStats {
+    uint32_t frames;        ///< number of frames timed
+    uint32_t lastCycles;    ///< cycles taken by the most recent frame
+    uint32_t minCycles;     ///< fewest cycles taken by any frame
+    uint32_t maxCycles;     ///< most cycles taken by any frame
+    uint64_t totalCycles;   ///< cycles taken by all frames, for averaging
+    uint32_t lastWireCycles;    ///< cycles from the start of the most recent frame's output until it was out
+    uint64_t totalWireCycles;   ///< wire cycles of all frames, for averaging
+    uint32_t lastBlockedCycles; ///< cycles the most recent frame kept interrupts off for
+    uint32_t maxBlockedCycles;  ///< the longest single stretch interrupts were kept off for, by any frame
+    uint64_t totalBlockedCycles;    ///< cycles all frames kept interrupts off for, for averaging
+    uint32_t retries;       ///< frames that had to be started over because an interrupt ran too long
+    uint16_t interruptSpacing;  ///< for clockless controllers that let interrupts in between pixels: how many pixels
+                                ///< they currently write between interrupt windows (see FASTLED_INTERRUPT_MAX_SPACING)
+    uint32_t wireStart;     ///< when the frame that's still being written out in the background was started
+    bool wirePending;       ///< whether a frame is still being written out in the background
+
+    LEDControllerStats() { reset(); }
+
+    /// clear out all the collected timings
+    void reset() {
+        frames = 0; lastCycles = 0; minCycles = 0xFFFFFFFF; maxCycles = 0; totalCycles = 0;
+        lastWireCycles = 0; totalWireCycles = 0; lastBlockedCycles = 0; maxBlockedCycles = 0; totalBlockedCycles = 0;
+        retries = 0; interruptSpacing = 0; wirePending = false;
+    }
+
+    /// start timing a frame
+    void begin() { lastBlockedCycles = 0; }
+
+    /// for the controllers that report it: add a stretch of the current frame that interrupts were kept off for
+    __attribute__((always_inline)) inline void blocked(uint32_t cycles) {
+        lastBlockedCycles += cycles;
+        if(cycles > maxBlockedCycles) { maxBlockedCycles = cycles; }
+    }
+
+    /// add a frame's timing
+    void add(uint32_t cycles) {
+        frames++;
+        lastCycles = cycles;
+        if(cycles < minCycles) { minCycles = cycles; }
+        if(cycles > maxCycles) { maxCycles = cycles; }
+        totalCycles += cycles;
+        totalBlockedCycles += lastBlockedCycles;
+    }
+
+    /// add the time a frame took to get out, from the start of its output
+    void addWire(uint32_t cycles) {
+        lastWireCycles = cycles;
+        totalWireCycles += cycles;
+    }
+
+    /// note that the frame started at cycle count start is still being written out in the background
+    void pending(uint32_t start) { wireStart = start; wirePending = true; }
+
+    /// the frame that was still being written out in the background was found to be out at cycle count now
+    void finished(uint32_t now) {
+        if(wirePending) { wirePending = false; addWire(now - wireStart); }
+    }
+
+    /// average cycles per frame
+    uint32_t avgCycles() const { return frames ? (uint32_t)(totalCycles / frames) : 0; }
+
+    /// average wire cycles per frame
+    uint32_t avgWireCycles() const { return frames ? (uint32_t)(totalWireCycles / frames) : 0; }
+
+    /// average cycles per frame with interrupts kept off
+    uint32_t avgBlockedCycles() const { return frames ? (uint32_t)(totalBlockedCycles / frames) : 0; }
+
+    /// average cycles per frame the cpu was free for other work while the frame was being written out
+    uint32_t avgFreeCycles() const { uint32_t wire = avgWireCycles(), busy = avgCycles(); return (wire > busy) ? (wire - busy) : 0; }
+};
+
+/// The show groups a controller is in by default, see CLEDController::setGroups
+#define FASTLED_DEFAULT_GROUP 0x01
+/// Every show group, what FastLED.show shows
+#define FASTLED_ALL_GROUPS 0xFF
+/// The number of show groups, one per bit of a group mask
+#define FASTLED_SHOW_GROUPS 8
+
+/// The most controllers still latching their previous frame that FastLED.show holds back until after the others
+/// (see CLEDController::latchRemaining) - any more just wait for their latch in turn
+#ifndef FASTLED_SHOW_DEFER
+#define FASTLED_SHOW_DEFER 8
+#endif
+
 /// Base definition for an LED controller.  Pretty much the methods that every LED controller object will make available.
 /// Note that the showARGB method is not impelemented for all controllers yet.   Note also the methods for eventual checking
 /// of background writing of data (I'm looking at you, teensy 3.0 DMA controller!).  If you want to pass LED controllers around
@@ -39,14 +212,87 @@ class CLEDController {
 protected:
     friend class CFastLED;
     CRGB *m_Data;
+    CRGB *m_pShowBuffer;
+    CFrameQueue *m_pFrameQueue;
+    const uint8_t *m_pRawData;
+    EOrder m_RawOrder;
+    uint8_t m_nRawStride;
+    bool m_bRawWhite;
+    bool m_bRaw16;
     CLEDController *m_pNext;
     CRGB m_ColorCorrection;
     CRGB m_ColorTemperature;
     EDitherMode m_DitherMode;
     int m_nLeds;
+    bool m_bSkipUnchanged;
+    bool m_bDirty;
+    uint16_t m_nKeepaliveMs;
+    uint32_t m_nLastShowMs;
+    uint32_t m_nLastHash;
+    uint32_t m_nDataHash;
+    uint32_t m_ChannelSums[3];
+    bool m_bScanned;
+    bool m_bSummed;
+    CPowerRail *m_pPowerRail;
+    uint8_t m_nGroups;
+    uint32_t m_nLastFrameMicros;
+    uint32_t m_nFrameMicros;
+    uint8_t m_nDitherBits;
+    bool m_bPrescaled;
+#if (FASTLED_GAMMA_OUTPUT == 1)
+    const uint8_t *m_pGamma[3];
+#endif
+#if (FASTLED_PIXEL_GENERATORS == 1)
+    TPixelGenerator m_pGenerator;
+    void *m_pGeneratorArg;
+    CRGB *m_pTile;
+    uint16_t m_nTileLeds;
+#endif
+#if (FASTLED_OUTPUT_MAPPING == 1)
+    bool m_bReverse;
+    bool m_bMirror;
+    uint16_t m_nOffset;
+#endif
+#if (FASTLED_LANE_LENGTHS == 1)
+    const uint16_t *m_pLaneLengths;
+#endif
+#if (FASTLED_SEGMENTS == 1)
+    const CLEDSegment *m_pSegments;
+    uint8_t m_nSegments;
+#endif
+#if (FASTLED_TRACE == 1)
+    uint16_t m_nTraceIndex;
+    static uint16_t m_nTraceCount;
+#endif
+    LEDControllerStats m_Stats;
     static CLEDController *m_pHead;
     static CLEDController *m_pTail;
 
+    /// add a controller to the end of the chain.  Where there's more than one core, controllers may get created by
+    /// tasks on both at once: the tail is swapped atomically, and the new controller is then linked in from whichever
+    /// controller was the tail before it (or made the head), so walking the chain never sees a half added one.
+    /// With FASTLED_TRACE on it also gets the index its trace events carry, the order controllers were added in.
+    static void append(CLEDController *pLed) {
+#if (FASTLED_PARALLEL == 1)
+#if (FASTLED_TRACE == 1)
+        pLed->m_nTraceIndex = __atomic_fetch_add(&m_nTraceCount, 1, __ATOMIC_RELAXED);
+#endif
+        CLEDController *pPrev = __atomic_exchange_n(&m_pTail, pLed, __ATOMIC_ACQ_REL);
+        if(pPrev == NULL) {
+            __atomic_store_n(&m_pHead, pLed, __ATOMIC_RELEASE);
+        } else {
+            __atomic_store_n(&pPrev->m_pNext, pLed, __ATOMIC_RELEASE);
+        }
+#else
+#if (FASTLED_TRACE == 1)
+        pLed->m_nTraceIndex = m_nTraceCount++;
+#endif
+        if(m_pHead==NULL) { m_pHead = pLed; }
+        if(m_pTail != NULL) { m_pTail->m_pNext = pLed; }
+        m_pTail = pLed;
+#endif
+    }
+
     /// set all the leds on the controller to a given color
     ///@param data the crgb color to set the leds to
     ///@param nLeds the numner of leds to set to this color
@@ -59,13 +305,245 @@ protected:
 	///@param scale the rgb scaling to apply to each led before writing it out
     virtual void show(const struct CRGB *data, int nLeds, CRGB scale) = 0;
 
+	/// write raw channel data out to the leds managed by this controller, see setLeds(const uint8_t*, int, EOrder, uint8_t).
+	/// Controllers that don't support raw data write nothing.
+	///@param data the first byte of the first pixel
+	///@param nLeds the number of leds being written out
+	///@param stride the number of bytes from the start of one pixel to the start of the next
+	///@param scale the rgb scaling to apply to each led, already reordered to match the order the channels are in
+    virtual void showRaw(const uint8_t *data, int nLeds, uint8_t stride, CRGB scale) {}
+
+#if (FASTLED_PIXEL_GENERATORS == 1)
+	/// write out led data made by a generator as it goes, see setGenerator.  Controllers that don't support generators
+	/// write nothing.
+	///@param pGenerator, pArg the generator and the argument it gets called with
+	///@param pTile, nTileLeds the leds the generator fills in, a few at a time
+	///@param nLeds the number of leds being written out
+	///@param scale the rgb scaling to apply to each led before writing it out
+    virtual void showGenerated(TPixelGenerator pGenerator, void *pArg, CRGB *pTile, uint16_t nTileLeds, int nLeds, CRGB scale) {}
+
+    bool generated() const { return m_pGenerator != NULL; }
+#else
+    bool generated() const { return false; }
+#endif
+
+    /// one pass over the led data that both hashes it (for setSkipUnchanged) and sums up each color's channel values
+    /// (for power limiting), so that FastLED.show with both turned on reads the leds only once before writing them
+    /// out.  Without setSkipUnchanged only the sums are made, word at a time (see calculate_channel_sums).  The results
+    /// are kept until the frame was shown, or, for a frame queue, until a new frame gets picked up, since published
+    /// frames can't change anymore.
+    /// @param bSums whether to make the sums too, for a FastLED.show that limits power
+    void scanFrame(bool bSums) {
+        uint32_t hash = 2166136261UL;
+        uint32_t r = 0, g = 0, b = 0;
+        bool bHash = m_bSkipUnchanged;
+        if(generated()) {
+            // nothing to read until the frame is written out
+        } else if(m_pRawData) {
+            const uint8_t *pData = m_pRawData;
+            int nBytes = bHash ? size() * m_nRawStride : 0;
+            for(int i = 0; i < nBytes; i++) { hash = (hash ^ pData[i]) * 16777619UL; }
+        } else if(!bHash) {
+            // nothing needs the hash, so the channels can be added up a word at a time
+            if(bSums) {
+                calculate_channel_sums(m_Data, size(), m_ChannelSums);
+                r = m_ChannelSums[0];
+                g = m_ChannelSums[1];
+                b = m_ChannelSums[2];
+            }
+        } else {
+            const uint8_t *pData = (const uint8_t*)m_Data;
+            if(bSums) {
+                for(int i = size(); i > 0; i--) {
+                    hash = (hash ^ pData[0]) * 16777619UL; r += pData[0];
+                    hash = (hash ^ pData[1]) * 16777619UL; g += pData[1];
+                    hash = (hash ^ pData[2]) * 16777619UL; b += pData[2];
+                    pData += 3;
+                }
+            } else {
+                for(int i = size() * 3; i > 0; i--) { hash = (hash ^ *pData++) * 16777619UL; }
+            }
+        }
+#if (FASTLED_OUTPUT_MAPPING == 1)
+        // mirrored leds are all written out twice
+        if(m_bMirror) { r *= 2; g *= 2; b *= 2; }
+#endif
+        m_nDataHash = hash;
+        m_ChannelSums[0] = r;
+        m_ChannelSums[1] = g;
+        m_ChannelSums[2] = b;
+        m_bScanned = true;
+        m_bSummed = bSums;
+    }
+
+    /// forget the results of scanFrame once the led data may have changed.  Frames taken from a frame queue stay
+    /// the same until latchFrame picks up a new one.
+    void releaseScan() { if(m_pFrameQueue == NULL) { m_bScanned = false; } }
+
+    /// FNV-1a hash of the led data and the adjustment it would be written out with
+    uint32_t hashFrame(const CRGB & adjustment) {
+        if(!m_bScanned) { scanFrame(false); }
+        uint32_t hash = m_nDataHash;
+        for(int i = 0; i < 3; i++) { hash = (hash ^ adjustment.raw[i]) * 16777619UL; }
+#if (FASTLED_GAMMA_OUTPUT == 1)
+        for(int i = 0; i < 3; i++) { hash = (hash ^ (uint32_t)(uintptr_t)m_pGamma[i]) * 16777619UL; }
+#endif
+        return hash;
+    }
+
+    /// Whether FastLED.show should write out this controller's leds.  Always true unless setSkipUnchanged
+    /// was turned on, in which case a frame is only sent if it was marked dirty, its data or adjustment
+    /// changed since the last frame sent, or the keepalive interval ran out.
+    /// @param now the current time in milliseconds
+    bool needsShow(const CRGB & adjustment, uint32_t now) {
+        // generated frames can't be compared before they're made, so they always go out
+        if(!m_bSkipUnchanged || generated()) { return true; }
+        uint32_t hash = hashFrame(adjustment);
+        if(m_bDirty || hash != m_nLastHash || (m_nKeepaliveMs && (now - m_nLastShowMs) >= m_nKeepaliveMs)) {
+            m_bDirty = false;
+            m_nLastHash = hash;
+            m_nLastShowMs = now;
+            return true;
+        }
+        return false;
+    }
+
+    /// how long until needsShow sends an unchanged frame anyway, for the keepalive
+    /// @param now the current time in milliseconds
+    /// @returns the number of milliseconds until then, 0 if every frame gets sent and 0xFFFFFFFF if unchanged frames
+    /// never are
+    uint32_t timeUntilKeepalive(uint32_t now) {
+        if(!m_bSkipUnchanged || generated() || m_bDirty) { return 0; }
+        if(m_nKeepaliveMs == 0) { return 0xFFFFFFFF; }
+        uint32_t elapsed = now - m_nLastShowMs;
+        return (elapsed < m_nKeepaliveMs) ? (m_nKeepaliveMs - elapsed) : 0;
+    }
+
+    /// measure the time since this controller's previous frame and pick the dithering depth from it: as many bits as
+    /// keep a full dither cycle repeating at MIN_ACCEPTABLE_DITHER_RATE_HZ or faster, none below 100fps.  The interval
+    /// is smoothed over a few frames so a single slow frame doesn't make the depth jump around.
+    /// @param now the current time in microseconds
+    /// @param maxBits the most bits to pick, e.g. fewer at a governor's lower quality levels (see CFrameGovernor)
+    void updateDitherBits(uint32_t now, uint8_t maxBits = VIRTUAL_BITS) {
+        if(m_nLastFrameMicros) {
+            uint32_t interval = now - m_nLastFrameMicros;
+            if(interval > 1000000UL) { interval = 1000000UL; }
+            m_nFrameMicros = m_nFrameMicros ? ((m_nFrameMicros * 3) + interval) / 4 : interval;
+        }
+        m_nLastFrameMicros = now;
+
+        uint8_t bits = 0;
+        if(m_nFrameMicros) {
+            while(bits < maxBits && (m_nFrameMicros * ((uint32_t)MIN_ACCEPTABLE_DITHER_RATE_HZ << (bits + 1))) <= 1000000UL) { bits++; }
+        }
+        m_nDitherBits = bits;
+    }
+
+    /// when a frame queue is attached, switch the led data over to the newest frame published to it (if there is one).
+    /// The frame that was being shown goes back to the producer, so this waits for it to be written out first.
+    void latchFrame() {
+        if(m_pFrameQueue != NULL && m_pFrameQueue->hasFrame()) {
+            waitFully();
+            m_pFrameQueue->acquire();
+            m_Data = m_pFrameQueue->front();
+            m_bDirty = true;
+            m_bScanned = false;
+        }
+    }
+
+    /// the led data to write out for this frame.  When double buffering, this waits for the previous frame to
+    /// finish and then snapshots the user's led data into the show buffer, so the user's array can be changed
+    /// while the frame is written out in the background.
+    const struct CRGB *frameData() {
+        if(m_pShowBuffer == NULL || m_pFrameQueue != NULL) { return m_Data; }
+        waitFully();
+        memcpy8((void*)m_pShowBuffer, (const void*)m_Data, sizeof(struct CRGB) * size());
+        return m_pShowBuffer;
+    }
+
+    /// write the colors this controller's leds go out with - after gamma, brightness and color correction, without
+    /// dithering or the output mapping - into pOut, three bytes (r, g, b) per led, for recording frames (see
+    /// CFrameRecorder).  Generated led data isn't made a second time, it comes out black.
+    void captureFrame(const CRGB & adjustment, uint8_t *pOut) {
+        int n = size();
+        const uint8_t *pData = (const uint8_t*)m_Data;
+        uint8_t stride = 3;
+        // the data byte holding each color
+        uint8_t channel[3] = { 0, 1, 2 };
+        if(m_pRawData) {
+            pData = m_pRawData;
+            stride = m_nRawStride;
+            for(int i = 0; i < 3; i++) { channel[RGB_BYTE(m_RawOrder, i)] = i; }
+            if(m_bRaw16) {
+                // 16 bit leds are CRGB16s, six bytes each: the high bytes of red, green and blue (hi[]) and then the
+                // low bytes (lo[]).  Only the high bytes are recorded, they're what 8 bit output writes out too.
+                for(int c = 0; c < 3; c++) { channel[c] = c; }
+                stride = sizeof(CRGB16);
+            }
+        }
+        if(pData == NULL || generated()) { memset8((void*)pOut, 0, n * 3); return; }
+        for(int i = 0; i < n; i++) {
+            for(int c = 0; c < 3; c++) {
+                uint8_t v = pData[channel[c]];
+#if (FASTLED_GAMMA_OUTPUT == 1)
+                if(m_pGamma[c]) { v = m_pGamma[c][v]; }
+#endif
+                *pOut++ = scale8(v, adjustment.raw[c]);
+            }
+            pData += stride;
+        }
+    }
+
+    /// for controllers with a FLIP template parameter, to start out reversed (see setReverse) when it's set.  FLIP
+    /// does nothing without FASTLED_OUTPUT_MAPPING.
+    void initFlip(bool flip) {
+#if (FASTLED_OUTPUT_MAPPING == 1)
+        m_bReverse = flip;
+#endif
+    }
+
+    /// write out the led data attached to this controller, whether it's a CRGB array or raw channel data
+    void showFrame(const CRGB & adjustment) {
+#if (FASTLED_PIXEL_GENERATORS == 1)
+        if(m_pGenerator) {
+            showGenerated(m_pGenerator, m_pGeneratorArg, m_pTile, m_nTileLeds, m_nLeds, adjustment);
+            return;
+        }
+#endif
+        if(m_pRawData) {
+            // the adjustment is per color, move it over to the channel each color is stored in
+            CRGB rawAdjustment;
+            for(int i = 0; i < 3; i++) { rawAdjustment.raw[i] = adjustment.raw[RGB_BYTE(m_RawOrder, i)]; }
+            showRaw(m_pRawData, m_nLeds, m_nRawStride, rawAdjustment);
+        } else {
+            show(frameData(), m_nLeds, adjustment);
+        }
+    }
+
 public:
 	/// create an led controller object, add it to the chain of controllers
-    CLEDController() : m_Data(NULL), m_ColorCorrection(UncorrectedColor), m_ColorTemperature(UncorrectedTemperature), m_DitherMode(BINARY_DITHER), m_nLeds(0) {
+    CLEDController() : m_Data(NULL), m_pShowBuffer(NULL), m_pFrameQueue(NULL), m_pRawData(NULL), m_RawOrder(RGB), m_nRawStride(3), m_bRawWhite(false), m_bRaw16(false), m_ColorCorrection(UncorrectedColor), m_ColorTemperature(UncorrectedTemperature), m_DitherMode(BINARY_DITHER), m_nLeds(0),
+                       m_bSkipUnchanged(false), m_bDirty(true), m_nKeepaliveMs(0), m_nLastShowMs(0), m_nLastHash(0),
+                       m_nDataHash(0), m_bScanned(false), m_bSummed(false), m_pPowerRail(NULL), m_nGroups(FASTLED_DEFAULT_GROUP), m_nLastFrameMicros(0), m_nFrameMicros(0), m_nDitherBits(0), m_bPrescaled(false) {
         m_pNext = NULL;
-        if(m_pHead==NULL) { m_pHead = this; }
-        if(m_pTail != NULL) { m_pTail->m_pNext = this; }
-        m_pTail = this;
+#if (FASTLED_GAMMA_OUTPUT == 1)
+        m_pGamma[0] = m_pGamma[1] = m_pGamma[2] = NULL;
+#endif
+#if (FASTLED_PIXEL_GENERATORS == 1)
+        m_pGenerator = NULL;
+#endif
+#if (FASTLED_OUTPUT_MAPPING == 1)
+        m_bReverse = m_bMirror = false;
+        m_nOffset = 0;
+#endif
+#if (FASTLED_LANE_LENGTHS == 1)
+        m_pLaneLengths = NULL;
+#endif
+#if (FASTLED_SEGMENTS == 1)
+        m_pSegments = NULL;
+        m_nSegments = 0;
+#endif
+        append(this);
     }
 
 	///initialize the LED controller
@@ -76,36 +554,332 @@ public:
 
     /// show function w/integer brightness, will scale for color correction and temperature
     void show(const struct CRGB *data, int nLeds, uint8_t brightness) {
+        updateDitherBits(micros());
         show(data, nLeds, getAdjustment(brightness));
     }
 
     /// show function w/integer brightness, will scale for color correction and temperature
     void showColor(const struct CRGB &data, int nLeds, uint8_t brightness) {
+        updateDitherBits(micros());
         showColor(data, nLeds, getAdjustment(brightness));
     }
 
     /// show function using the "attached to this controller" led data
     void showLeds(uint8_t brightness=255) {
-        show(m_Data, m_nLeds, getAdjustment(brightness));
+        updateDitherBits(micros());
+        latchFrame();
+        showFrame(frameAdjustment(brightness));
+        waitFully();
+    }
+
+#if (FASTLED_GAMMA_OUTPUT == 1)
+    /// look every color byte up in a gamma table (e.g. a CGammaLUT, see colorutils.h) as the led data is written out,
+    /// before brightness, color correction and dithering are applied - gamma correction without a separate pass over
+    /// the leds.  The table is read on every show, so it has to stay around; call setGamma again after changing its
+    /// contents, so a controller that skips unchanged frames sends the next one.  White channels aren't gamma
+    /// corrected, and controllers writing out 16 bit data ignore the tables.  Pass NULL to turn it off again.
+    CLEDController & setGamma(const uint8_t *pTable) { return setGamma(pTable, pTable, pTable); }
+
+    /// look the red, green and blue bytes up in their own gamma tables as the led data is written out (e.g. the r, g
+    /// and b tables of a CRGBGammaLUT), see setGamma(const uint8_t*)
+    CLEDController & setGamma(const uint8_t *pRed, const uint8_t *pGreen, const uint8_t *pBlue) {
+        m_pGamma[0] = pRed;
+        m_pGamma[1] = pGreen;
+        m_pGamma[2] = pBlue;
+        m_bDirty = true;
+        return *this;
+    }
+
+    /// look the led data up in a CRGBGammaLUT as it's written out (one 256 entry table per color), see
+    /// setGamma(const uint8_t*).  Defined in colorutils.h, along with the table.
+    CLEDController & setGamma(const CRGBGammaLUT & lut);
+
+    /// the gamma table for a color (0 = red, 1 = green, 2 = blue), NULL if there's none
+    const uint8_t *getGamma(int color) const { return m_pGamma[color]; }
+#endif
+
+    /// the adjustment this controller's led data gets written out with for the given brightness - no adjustment at all
+    /// for prescaled led data (see setPrescaled)
+    CRGB frameAdjustment(uint8_t brightness) {
+        return m_bPrescaled ? CRGB(255, 255, 255) : getAdjustment(brightness);
     }
 
 	/// show the given color on the led strip
     void showColor(const struct CRGB & data, uint8_t brightness=255) {
+        updateDitherBits(micros());
         showColor(data, m_nLeds, getAdjustment(brightness));
+        m_bDirty = true;
+        waitFully();
     }
 
+    /// wait for output that was started by show/showColor and is still being written out in the background (e.g. by
+    /// dma or the esp32's rmt peripheral) to finish.  Controllers that write their data out before returning from
+    /// show don't need to override this.
+    virtual void waitFully() {}
+
+    /// check whether output started by show/showColor is still being written out in the background.  Controllers
+    /// that write their data out before returning from show are never still showing.
+    virtual bool isShowing() { return false; }
+
+    /// how long until the strip can take another frame, in us: what's left of the latch/reset time after the last
+    /// frame it was sent.  FastLED.show starts the controllers that are ready ahead of the ones still latching, so one
+    /// strip's latch time passes while others are being written out instead of adding up.  Controllers that don't
+    /// wait between frames, or do it in the background, are always ready.
+    virtual uint16_t latchRemaining() { return 0; }
+
     /// get the first led controller in the chain of controllers
+#if (FASTLED_PARALLEL == 1)
+    static CLEDController *head() { return __atomic_load_n(&m_pHead, __ATOMIC_ACQUIRE); }
+#else
     static CLEDController *head() { return m_pHead; }
+#endif
     /// get the next controller in the chain after this one.  will return NULL at the end of the chain
+#if (FASTLED_PARALLEL == 1)
+    CLEDController *next() { return __atomic_load_n(&m_pNext, __ATOMIC_ACQUIRE); }
+#else
     CLEDController *next() { return m_pNext; }
+#endif
 
 	/// set the default array of leds to be used by this controller
     CLEDController & setLeds(CRGB *data, int nLeds) {
         m_Data = data;
+        m_pRawData = NULL;
+#if (FASTLED_PIXEL_GENERATORS == 1)
+        m_pGenerator = NULL;
+#endif
+        m_nLeds = nLeds;
+        m_bScanned = false;
+        return *this;
+    }
+
+	/// set the default array of leds to be used by this controller, double buffered.  On every show the
+	/// contents of data are copied into pShowBuffer, which is what actually gets written out - so data
+	/// can be rendered into while the previous frame is still being sent (see FastLED.showAsync).
+	/// pShowBuffer must be as large as data, pass NULL to turn double buffering back off.
+    CLEDController & setLeds(CRGB *data, int nLeds, CRGB *pShowBuffer) {
+        m_pShowBuffer = pShowBuffer;
+        return setLeds(data, nLeds);
+    }
+
+	/// use externally owned raw channel data (e.g. a dmx/art-net packet payload) as this controller's led data, without
+	/// copying it into a CRGB array first.  The data is read straight from data on every show, so it has to stay valid
+	/// and unchanged for as long as a frame using it is being written out.  While raw data is attached leds() is NULL,
+	/// and the power management functions leave this controller's leds out of their estimate.
+	///
+	/// The controller's own RGB_ORDER is applied to the channels in the order they are stored, so when the data is
+	/// already in the order the chipset wants, declare the controller with RGB.  order only tells color correction,
+	/// color temperature and dithering which channel holds which color.
+	/// @param data the first channel of the first pixel
+	/// @param nLeds the number of leds
+	/// @param order which color each of the three channels of a pixel holds
+	/// @param stride the number of bytes from one pixel to the next, for data that carries extra channels per pixel
+	/// @param white whether the byte after the three color channels of each pixel is a white channel (stride has to be
+	/// at least 4).  Controllers that can't write out a white channel only send the rgb channels.
+    CLEDController & setLeds(const uint8_t *data, int nLeds, EOrder order = RGB, uint8_t stride = 3, bool white = false) {
+        m_Data = NULL;
+        m_pFrameQueue = NULL;
+        m_pRawData = data;
+#if (FASTLED_PIXEL_GENERATORS == 1)
+        m_pGenerator = NULL;
+#endif
+        m_RawOrder = order;
+        m_nRawStride = stride;
+        m_bRawWhite = white;
+        m_bRaw16 = false;
         m_nLeds = nLeds;
+        m_bDirty = true;
+        m_bScanned = false;
+        return *this;
+    }
+
+	/// set an array of rgbw leds to be used by this controller.  The rgb channels go out in the controller's RGB_ORDER,
+	/// followed by the white channel, which is scaled by the brightness and dithered but not color corrected.
+    CLEDController & setLeds(CRGBW *data, int nLeds) { return setLeds((const uint8_t*)data, nLeds, RGB, sizeof(CRGBW), true); }
+
+	/// set an array of 16 bit per channel leds to be used by this controller.  Controllers that can make use of more than
+	/// 8 bits per channel (APA102/SK9822) apply brightness and color correction to the full 16 bits, others write out
+	/// the high byte of each channel.
+    CLEDController & setLeds(CRGB16 *data, int nLeds) {
+        setLeds((const uint8_t*)data, nLeds, RGB, sizeof(CRGB16));
+        m_bRaw16 = true;
+        return *this;
+    }
+
+	/// take this controller's led data from a frame queue instead of a fixed array.  Every show writes out the newest
+	/// frame published to the queue, or the last one shown again if nothing new was published.  While a queue is
+	/// attached the double buffering show buffer isn't used, the queue already keeps the frame being shown apart
+	/// from the one being rendered.  Pass NULL to detach the queue again, which leaves the controller pointed at
+	/// the last frame shown.
+    CLEDController & setFrameQueue(CFrameQueue *pQueue) {
+        m_pFrameQueue = pQueue;
+        if(pQueue) { setLeds(pQueue->front(), pQueue->size()); }
+        return *this;
+    }
+
+    /// take this controller's led data from a frame queue, see setFrameQueue(CFrameQueue*)
+    CLEDController & setFrameQueue(CFrameQueue & queue) { return setFrameQueue(&queue); }
+
+#if (FASTLED_PIXEL_GENERATORS == 1)
+	/// generate this controller's led data while it's being written out, instead of reading it from an array - for
+	/// effects that are a function of the led index (and the time), without a frame buffer for them.  The generator
+	/// is called on every show to fill in the tile a few leds at a time, right before they get encoded, and the tile is
+	/// all the led memory the controller needs.  Multi lane controllers split the tile between their lanes, so it needs
+	/// at least one led per lane.
+	///
+	/// The generator runs in the middle of the output: it has to be quick (a tile's worth of leds has to be made in less
+	/// time than the one before takes to go out), and for controllers that write out from an interrupt (the ESP32's RMT
+	/// and I2S output) it runs in that interrupt, so it has to be in IRAM and can't block.  While a generator is
+	/// attached leds() is NULL, the power management functions leave this controller's leds out of their estimate, and
+	/// setSkipUnchanged sends every frame.  Controllers that read the led array directly instead of through the
+	/// PixelController (the AVR clockless/trinket output, the nrf51, d21 and kl26 controllers, and SmartMatrix) don't
+	/// support generators.
+	/// @param pGenerator the generator, NULL to detach it again (which leaves no led data attached)
+	/// @param pArg passed to the generator
+	/// @param nLeds the number of leds
+	/// @param pTile storage for the leds the generator fills in
+	/// @param nTileLeds the size of the tile, in leds
+    CLEDController & setGenerator(TPixelGenerator pGenerator, void *pArg, int nLeds, CRGB *pTile, uint16_t nTileLeds) {
+        setLeds((CRGB*)NULL, nLeds);
+        m_pFrameQueue = NULL;
+        m_pGenerator = pGenerator;
+        m_pGeneratorArg = pArg;
+        m_pTile = pTile;
+        m_nTileLeds = nTileLeds;
+        m_bDirty = true;
         return *this;
     }
 
+	/// generate this controller's led data with a functor, called as generator(pLeds, start, count) - see
+	/// setGenerator(TPixelGenerator, void*, int, CRGB*, uint16_t).  The functor has to stay around, and its operator()
+	/// has to be in IRAM like any other generator's (the call into it already is).
+    template<typename T> CLEDController & setGenerator(T & generator, int nLeds, CRGB *pTile, uint16_t nTileLeds) {
+        return setGenerator(&callGenerator<T>, (void*)&generator, nLeds, pTile, nTileLeds);
+    }
+
+	/// use palette indexed led data (see CPaletteLeds) as this controller's led data, looking each led's color up as
+	/// it's written out.  Attaches a generator, with everything that comes with it - see setGenerator.
+    CLEDController & setLeds(CPaletteLeds & leds);
+
+	/// use led data kept in external ram (see CStagedLeds) as this controller's led data, copying it into internal ram
+	/// a tile at a time as it's written out.  Attaches a generator, with everything that comes with it - see
+	/// setGenerator.
+    CLEDController & setLeds(CStagedLeds & leds);
+
+	/// use planar led data (see CPlanarLeds) as this controller's led data, gathering each led's color out of the
+	/// planes as it's written out.  Attaches a generator, with everything that comes with it - see setGenerator.
+    CLEDController & setLeds(CPlanarLeds & leds);
+
+private:
+    template<typename T> static FASTLED_IRAM void callGenerator(void *pArg, CRGB *pLeds, uint16_t start, uint16_t count) { (*(T*)pArg)(pLeds, start, count); }
+
+public:
+#endif
+
+#if (FASTLED_OUTPUT_MAPPING == 1)
+	/// write the leds out last to first, for strips that are wired up from the other end.  Controllers with a FLIP
+	/// template parameter start out reversed when it's true.
+    CLEDController & setReverse(bool reverse) { m_bReverse = reverse; m_bDirty = true; return *this; }
+
+	/// write the leds out twice, first to last and then back again, so that a strip twice as long as the led data
+	/// shows it mirrored around its middle - for symmetric fixtures, without rendering both halves.  Reversing
+	/// swaps the halves around; the offset is ignored while mirroring.
+    CLEDController & setMirror(bool mirror) { m_bMirror = mirror; m_bDirty = true; m_bScanned = false; return *this; }
+
+	/// rotate the leds along the strip: the first led written out is led offset, wrapping around to led 0 after
+	/// the last one
+    CLEDController & setOffset(uint16_t offset) { m_nOffset = offset; m_bDirty = true; return *this; }
+
+    bool getReverse() const { return m_bReverse; }
+    bool getMirror() const { return m_bMirror; }
+    uint16_t getOffset() const { return m_nOffset; }
+#endif
+
+#if (FASTLED_LANE_LENGTHS == 1)
+	/// give each lane of a multi lane (block) controller a number of leds of its own, instead of the nLeds it was added
+	/// with for every lane.  The lanes' leds go back to back in the led data, frames take as long as the longest lane
+	/// needs, and the shorter lanes get zeros after their last led.  The lengths aren't copied, and have to stay
+	/// around.  setReverse (and FLIP) reverses each lane on its own; lanes of different lengths ignore setMirror and
+	/// setOffset, and lane lengths don't combine with generated led data.
+	/// @param pLengths one length per lane, LANES of them (the ones for lanes outside the controller's mask are
+	/// ignored) - NULL to go back to nLeds for every lane
+    CLEDController & setLaneLengths(const uint16_t *pLengths) { m_pLaneLengths = pLengths; m_bDirty = true; m_bScanned = false; return *this; }
+
+    const uint16_t *getLaneLengths() const { return m_pLaneLengths; }
+#endif
+
+#if (FASTLED_SEGMENTS == 1)
+	/// split the leds into segments, each with a color adjustment of its own on top of the controller's, which the
+	/// leds get scaled by as they're written out - different bins of leds along one strip get matched up without
+	/// nscale8 passes over parts of the led data before every show.  The segments go along the strip in the order the
+	/// leds are written out (so after reversing, mirroring and rotating), the lanes of multi lane controllers all get
+	/// the same ones, and leds past the last segment just get the controller's adjustment.  Dithering follows each
+	/// segment's scale.  The segments aren't copied, and have to stay around; call setSegments again after changing
+	/// them, so a controller that skips unchanged frames sends the next one.  Segments don't combine with the APA102's
+	/// FASTLED_APA102_GLOBAL_BRIGHTNESS, which picks one global brightness per frame.
+	/// @param pSegments the segments, first to last - NULL for none
+	/// @param nSegments the number of segments
+    CLEDController & setSegments(const CLEDSegment *pSegments, uint8_t nSegments) {
+        m_pSegments = pSegments;
+        m_nSegments = pSegments ? nSegments : 0;
+        m_bDirty = true;
+        return *this;
+    }
+
+    const CLEDSegment *getSegments() const { return m_pSegments; }
+    uint8_t getSegmentCount() const { return m_nSegments; }
+#endif
+
+	/// how many leds nLanes lanes of this controller have between them, for the size() of multi lane controllers
+    int laneLeds(int nLanes) {
+#if (FASTLED_LANE_LENGTHS == 1)
+        if(m_pLaneLengths) {
+            int n = 0;
+            for(int i = 0; i < nLanes; i++) { n += m_pLaneLengths[i]; }
+            return n;
+        }
+#endif
+        return m_nLeds * nLanes;
+    }
+
+	/// have FastLED.show skip this controller when its led data and adjustment are the same as in the last frame
+	/// it sent.  Changes are found by hashing the led data on every show; use markDirty to force a resend.  Note
+	/// that dithering stops along with the output while a frame is being skipped.
+	/// @param skip whether to skip unchanged frames
+	/// @param keepaliveMs if non-zero, resend an unchanged frame anyway once this many milliseconds have passed,
+	/// for chipsets that need a periodic refresh
+    CLEDController & setSkipUnchanged(bool skip, uint16_t keepaliveMs = 0) { m_bSkipUnchanged = skip; m_nKeepaliveMs = keepaliveMs; m_bDirty = true; m_bScanned = false; return *this; }
+
+	/// put this controller on a power rail with a limit of its own, see CPowerRail.  Any number of controllers can
+	/// share a rail.  Pass NULL to take the controller off its rail again.
+    CLEDController & setPowerRail(CPowerRail *pRail) { m_pPowerRail = pRail; return *this; }
+
+	/// put this controller on a power rail with a limit of its own, see setPowerRail(CPowerRail*)
+    CLEDController & setPowerRail(CPowerRail & rail) { return setPowerRail(&rail); }
+
+	/// the power rail this controller is on, NULL if there's none
+    CPowerRail *getPowerRail() const { return m_pPowerRail; }
+
+	/// choose which show groups this controller is in, one bit per group.  FastLED.showGroups only writes out the
+	/// controllers in the groups it's given, so controllers that need different refresh rates can each be shown at
+	/// their own.  Every controller starts out in FASTLED_DEFAULT_GROUP; FastLED.show shows all of them, whatever
+	/// their groups.
+    CLEDController & setGroups(uint8_t groups) { m_nGroups = groups; return *this; }
+
+	/// the show groups this controller is in
+    uint8_t getGroups() const { return m_nGroups; }
+
+	/// whether this controller is in any of the given show groups
+    bool inGroups(uint8_t groups) const { return (m_nGroups & groups) != 0 || groups == FASTLED_ALL_GROUPS; }
+
+	/// get the timing statistics for this controller's frames
+    const LEDControllerStats & getStats() const { return m_Stats; }
+
+	/// clear out this controller's timing statistics
+    void resetStats() { m_Stats.reset(); }
+
+	/// force the next FastLED.show to write out this controller's leds, even if they look unchanged
+    CLEDController & markDirty() { m_bDirty = true; return *this; }
+
 	/// zero out the led data managed by this controller
     void clearLedData() {
         if(m_Data) {
@@ -116,9 +890,24 @@ public:
     /// How many leds does this controller manage?
     virtual int size() { return m_nLeds; }
 
+    /// How many leds does this controller write out?  Twice size() while mirroring, see setMirror.
+#if (FASTLED_OUTPUT_MAPPING == 1)
+    int outputSize() { return m_bMirror ? 2 * size() : size(); }
+#else
+    int outputSize() { return size(); }
+#endif
+
     /// Pointer to the CRGB array for this controller
     CRGB* leds() { return m_Data; }
 
+    /// the sums of the red, green and blue values of all of this controller's leds, for power limiting.  During
+    /// FastLED.show these come out of the same pass over the led data that setSkipUnchanged hashes it in, and a frame
+    /// taken from a frame queue is only summed up once.  All zero while raw channel data is attached.
+    const uint32_t *channelSums() {
+        if(!m_bScanned || !m_bSummed) { scanFrame(true); }
+        return m_ChannelSums;
+    }
+
     /// Reference to the n'th item in the controller
     CRGB &operator[](int x) { return m_Data[x]; }
 
@@ -127,6 +916,19 @@ public:
     /// get the dithering option currently set for this controller
     inline uint8_t getDither() { return m_DitherMode; }
 
+    /// get the number of 'virtual bits' of dithering this controller's frames currently get, picked by FastLED.show from
+    /// the controller's measured refresh rate.  0 means no dithering.
+    inline uint8_t getDitherBits() { return (m_DitherMode != DISABLE_DITHER && !m_bPrescaled) ? m_nDitherBits : 0; }
+
+	/// tell the controller that its led data already has the brightness and color correction/temperature applied, e.g.
+	/// because it was filled from a CRGBPaletteLUT loaded with getAdjustment(FastLED.getBrightness()).  The data is then
+	/// written out at full scale and without dithering, and FastLED.setBrightness (including the power limiting functions)
+	/// no longer affects this controller - bake the brightness into the data instead.
+    CLEDController & setPrescaled(bool prescaled) { m_bPrescaled = prescaled; m_bDirty = true; return *this; }
+
+	/// whether the controller's led data already has brightness and color correction applied, see setPrescaled
+    bool isPrescaled() const { return m_bPrescaled; }
+
 	/// the the color corrction to use for this controller, expressed as an rgb object
     CLEDController & setCorrection(CRGB correction) { m_ColorCorrection = correction; return *this; }
     /// set the color correction to use for this controller
@@ -170,6 +972,17 @@ public:
     virtual uint16_t getMaxRefreshRate() const { return 0; }
 };
 
+inline CLEDSegment::CLEDSegment(uint16_t n, const CRGB & correction, const CRGB & temperature, uint8_t brightness)
+    : nLeds(n), adjustment(CLEDController::computeAdjustment(brightness, correction, temperature)) {}
+
+/// What a PixelController has to do to the bytes of a frame on their way out, see PixelController::work
+enum EPixelWork {
+    PIXEL_RAW = 0,              ///< neither dither nor scale them, the bytes go out as they are
+    PIXEL_DITHER = 1,           ///< add the dither signal
+    PIXEL_SCALE = 2,            ///< scale them by the color adjustment
+    PIXEL_DITHER_SCALE = 3      ///< both, the way loadAndScale always does
+};
+
 // Pixel controller class.  This is the class that we use to centralize pixel access in a block of data, including
 // support for things like RGB reordering, scaling, dithering, skipping (for ARGB data), and eventually, we will
 // centralize 8/12/16 conversions here as well.
@@ -182,6 +995,57 @@ struct PixelController {
         CRGB mScale;
         int8_t mAdvance;
         int mOffsets[LANES];
+#if (FASTLED_LANE_LENGTHS == 1)
+        // lanes of their own lengths (see setLaneLengths): a lane's data runs out once mLenRemaining counts down to its
+        // mLaneStop, 0 for lanes as long as the frame
+        int mLaneStop[LANES];
+#endif
+        // white channel state, for rgbw data (see enableWhite)
+        bool mHasWhite;
+        uint8_t mScaleW;
+        uint8_t dW;
+        uint8_t eW;
+        // 16 bit channel data (see enable16)
+        bool mIs16;
+#if (FASTLED_GAMMA_OUTPUT == 1)
+        // per data byte gamma tables (see setGamma), NULL for none
+        const uint8_t *mGamma[3];
+#endif
+#if (FASTLED_PIXEL_GENERATORS == 1)
+        // generated led data (see setGenerator): the tile mData points into, how many of its leds each lane gets, and
+        // how many are left before the next refill / the index of the next leds to generate
+        TPixelGenerator mGenerator;
+        void *mGeneratorArg;
+        CRGB *mTile;
+        uint16_t mTileLeds;
+        uint16_t mTileRemaining;
+        int mGenerated;
+#endif
+#if (FASTLED_OUTPUT_MAPPING == 1)
+        // a single change of direction/jump in the data (see map): once mLenRemaining counts down to mTurnAt, the data
+        // moves by mTurnJump instead of mAdvance, and mAdvance becomes mTurnAdvance from there on.  -1 for none, which
+        // mLenRemaining never gets to.
+        int mTurnAt;
+        int mTurnJump;
+        int8_t mTurnAdvance;
+#endif
+#if (FASTLED_SPATIAL_DITHER == 1)
+        // spatial dithering (see SPATIAL_DITHER): whether it's on, the scaled dither signal of every step of the
+        // pattern, three bytes each, and the index of the current step's
+        bool mSpatial;
+        uint8_t mSpatialD[SPATIAL_DITHER_STEPS * 3];
+        uint8_t mSpatialPos;
+#endif
+#if (FASTLED_SEGMENTS == 1)
+        // segments with adjustments of their own (see setSegments): the next segment, how many are left, the
+        // mLenRemaining it starts at (-1 for none), and the scale and dither signal the segments' scales come from
+        const CLEDSegment *mSegments;
+        uint8_t mSegmentsLeft;
+        int mSegmentAt;
+        CRGB mBaseScale;
+        bool mDithered;
+        uint8_t mDitherQ;
+#endif
 
         PixelController(const PixelController & other) {
             d[0] = other.d[0];
@@ -195,6 +1059,43 @@ struct PixelController {
             mAdvance = other.mAdvance;
             mLenRemaining = mLen = other.mLen;
             for(int i = 0; i < LANES; i++) { mOffsets[i] = other.mOffsets[i]; }
+#if (FASTLED_LANE_LENGTHS == 1)
+            for(int i = 0; i < LANES; i++) { mLaneStop[i] = other.mLaneStop[i]; }
+#endif
+            mHasWhite = other.mHasWhite;
+            mScaleW = other.mScaleW;
+            dW = other.dW;
+            eW = other.eW;
+            mIs16 = other.mIs16;
+#if (FASTLED_GAMMA_OUTPUT == 1)
+            for(int i = 0; i < 3; i++) { mGamma[i] = other.mGamma[i]; }
+#endif
+#if (FASTLED_PIXEL_GENERATORS == 1)
+            mGenerator = other.mGenerator;
+            mGeneratorArg = other.mGeneratorArg;
+            mTile = other.mTile;
+            mTileLeds = other.mTileLeds;
+            mTileRemaining = other.mTileRemaining;
+            mGenerated = other.mGenerated;
+#endif
+#if (FASTLED_OUTPUT_MAPPING == 1)
+            mTurnAt = other.mTurnAt;
+            mTurnJump = other.mTurnJump;
+            mTurnAdvance = other.mTurnAdvance;
+#endif
+#if (FASTLED_SPATIAL_DITHER == 1)
+            mSpatial = other.mSpatial;
+            for(int i = 0; i < SPATIAL_DITHER_STEPS * 3; i++) { mSpatialD[i] = other.mSpatialD[i]; }
+            mSpatialPos = other.mSpatialPos;
+#endif
+#if (FASTLED_SEGMENTS == 1)
+            mSegments = other.mSegments;
+            mSegmentsLeft = other.mSegmentsLeft;
+            mSegmentAt = other.mSegmentAt;
+            mBaseScale = other.mBaseScale;
+            mDithered = other.mDithered;
+            mDitherQ = other.mDitherQ;
+#endif
 
         }
 
@@ -203,55 +1104,209 @@ struct PixelController {
           for(int i = 0; i < LANES; i++) {
             mOffsets[i] = nOffset;
             if((1<<i) & MASK) { nOffset += (len * mAdvance); }
+#if (FASTLED_LANE_LENGTHS == 1)
+            mLaneStop[i] = 0;
+#endif
           }
         }
 
-        PixelController(const uint8_t *d, int len, CRGB & s, EDitherMode dither = BINARY_DITHER, bool advance=true, uint8_t skip=0) : mData(d), mLen(len), mLenRemaining(len), mScale(s) {
-            enable_dithering(dither);
+#if (FASTLED_LANE_LENGTHS == 1)
+        // give every lane its own number of leds, laid out back to back in the data: the frame gets as long as the
+        // longest lane, and the shorter ones read as zeros once their data runs out
+        void setLaneLengths(const uint16_t *pLengths) {
+          int nMax = 0;
+          for(int i = 0; i < LANES; i++) {
+            if(((1<<i) & MASK) && pLengths[i] > nMax) { nMax = pLengths[i]; }
+          }
+          int nOffset = 0;
+          for(int i = 0; i < LANES; i++) {
+            mOffsets[i] = nOffset;
+            mLaneStop[i] = 0;
+            if((1<<i) & MASK) {
+              nOffset += (pLengths[i] * mAdvance);
+              mLaneStop[i] = nMax - pLengths[i];
+            }
+          }
+          mLen = mLenRemaining = nMax;
+        }
+
+        // is there data left for the lane's current led?
+        __attribute__((always_inline)) inline bool laneHas(int lane) { return mLenRemaining > mLaneStop[lane]; }
+#else
+        __attribute__((always_inline)) inline bool laneHas(int) { return true; }
+#endif
+
+        PixelController(const uint8_t *d, int len, CRGB & s, EDitherMode dither = BINARY_DITHER, bool advance=true, uint8_t skip=0, uint8_t ditherBits = VIRTUAL_BITS) : mData(d), mLen(len), mLenRemaining(len), mScale(s), mHasWhite(false), mIs16(false) {
+            initGamma();
+            enable_dithering(dither, ditherBits);
             mData += skip;
             mAdvance = (advance) ? 3+skip : 0;
             initOffsets(len);
         }
 
-        PixelController(const CRGB *d, int len, CRGB & s, EDitherMode dither = BINARY_DITHER) : mData((const uint8_t*)d), mLen(len), mLenRemaining(len), mScale(s) {
-            enable_dithering(dither);
+        PixelController(const CRGB *d, int len, CRGB & s, EDitherMode dither = BINARY_DITHER, uint8_t ditherBits = VIRTUAL_BITS) : mData((const uint8_t*)d), mLen(len), mLenRemaining(len), mScale(s), mHasWhite(false), mIs16(false) {
+            initGamma();
+            enable_dithering(dither, ditherBits);
             mAdvance = 3;
             initOffsets(len);
         }
 
-        PixelController(const CRGB &d, int len, CRGB & s, EDitherMode dither = BINARY_DITHER) : mData((const uint8_t*)&d), mLen(len), mLenRemaining(len), mScale(s) {
-            enable_dithering(dither);
+        PixelController(const CRGB &d, int len, CRGB & s, EDitherMode dither = BINARY_DITHER, uint8_t ditherBits = VIRTUAL_BITS) : mData((const uint8_t*)&d), mLen(len), mLenRemaining(len), mScale(s), mHasWhite(false), mIs16(false) {
+            initGamma();
+            enable_dithering(dither, ditherBits);
             mAdvance = 0;
             initOffsets(len);
         }
 
-        void init_binary_dithering() {
+        void initGamma() {
+#if (FASTLED_GAMMA_OUTPUT == 1)
+            mGamma[0] = mGamma[1] = mGamma[2] = NULL;
+#endif
+#if (FASTLED_PIXEL_GENERATORS == 1)
+            mGenerator = NULL;
+#endif
+#if (FASTLED_OUTPUT_MAPPING == 1)
+            mTurnAt = -1;
+            mTurnJump = 0;
+            mTurnAdvance = 0;
+#endif
+#if (FASTLED_SEGMENTS == 1)
+            mSegments = NULL;
+            mSegmentsLeft = 0;
+            mSegmentAt = -1;
+#endif
+        }
+
+#if (FASTLED_OUTPUT_MAPPING == 1)
+        // change the order the leds get read in: reversed, mirrored (the data read first to last and then last to
+        // first, twice as many leds as there is data) or rotated by offset leds.  Has to be called before any of the
+        // data is read, and after setLaneLengths.  The lanes of multi lane controllers all get the same mapping, except
+        // lanes of their own lengths, which only get reversed - each in place.
+        void map(bool reverse, bool mirror, uint16_t offset) {
+            int n = mLen;
+            int8_t s = mAdvance;
+            if(n == 0) { return; }
+#if (FASTLED_LANE_LENGTHS == 1)
+            bool bLaneLengths = false;
+            for(int i = 0; i < LANES; i++) { if(mLaneStop[i]) { bLaneLengths = true; } }
+            if(bLaneLengths) {
+                // every lane starts from its own last led, and laneHas stops it after its first
+                if(reverse && s != 0) {
+                    for(int i = 0; i < LANES; i++) { mOffsets[i] += (n - mLaneStop[i] - 1) * s; }
+                    mAdvance = -s;
+                }
+                return;
+            }
+#endif
+            if(mirror) {
+                mLen = mLenRemaining = 2 * n;
+                mTurnAt = n;
+                mTurnJump = 0;
+                if(reverse) { mData += (n - 1) * s; mAdvance = -s; mTurnAdvance = s; }
+                else { mTurnAdvance = -s; }
+            } else if(s != 0) {
+                offset %= n;
+                if(reverse) {
+                    // read from led offset - 1 down, wrapping around from led 0 to the last one
+                    int start = (offset + n - 1) % n;
+                    mData += start * s;
+                    mAdvance = mTurnAdvance = -s;
+                    mTurnJump = (n - 1) * s;
+                    mTurnAt = n - 1 - start;
+                } else {
+                    // read from led offset up, wrapping around from the last led to led 0
+                    mData += offset * s;
+                    mTurnAdvance = s;
+                    mTurnJump = -(n - 1) * s;
+                    mTurnAt = offset;
+                }
+            }
+        }
+#endif
+
+#if (FASTLED_PIXEL_GENERATORS == 1)
+        // read the led data from a generator instead, through a tile split evenly between the lanes, and fill in the
+        // first leds of every lane
+        void setGenerator(TPixelGenerator pGenerator, void *pArg, CRGB *pTile, uint16_t nTileLeds) {
+            int nLanes = 0;
+            for(int i = 0; i < LANES; i++) { if((1<<i) & MASK) { nLanes++; } }
+            mGenerator = pGenerator;
+            mGeneratorArg = pArg;
+            mTile = pTile;
+            mTileLeds = nTileLeds / nLanes;
+            mAdvance = 3;
+            // the lanes' offsets go into the tile instead of the led data
+            int nOffset = 0;
+            for(int i = 0; i < LANES; i++) {
+                mOffsets[i] = nOffset;
+                if((1<<i) & MASK) { nOffset += mTileLeds * 3; }
+            }
+            mGenerated = 0;
+            generate();
+        }
+
+        // fill the tile with the next leds of every lane, and point the data back at its start
+        // the refill happens in the middle of writing out a frame, so it goes wherever the output code does (see
+        // FASTLED_IRAM) - the generator itself is up to whoever attached it
+        FASTLED_IRAM void generate() {
+            uint16_t count = (mLen - mGenerated) < mTileLeds ? (mLen - mGenerated) : mTileLeds;
+            int nLane = 0;
+            for(int i = 0; i < LANES; i++) {
+                if((1<<i) & MASK) {
+                    (*mGenerator)(mGeneratorArg, mTile + (nLane * mTileLeds), (nLane * mLen) + mGenerated, count);
+                    nLane++;
+                }
+            }
+            mGenerated += count;
+            mTileRemaining = count;
+            mData = (const uint8_t*)mTile;
+        }
+#endif
+
+#if (FASTLED_SEGMENTS == 1)
+        // scale the leds by the segments' adjustments, on top of the current scale, starting with the next led to be
+        // read.  Has to be called after anything that changes the number of leds (map, setLaneLengths).
+        void setSegments(const CLEDSegment *pSegments, uint8_t nSegments) {
+            mBaseScale = mScale;
+            mSegments = pSegments;
+            mSegmentsLeft = nSegments;
+            mSegmentAt = mLenRemaining;
+            nextSegment();
+        }
+
+        // switch the scale (and the dithering that goes with it) over to the next segment's, or back to the base
+        // scale after the last one.  It happens in the middle of writing out a frame, see generate.
+        FASTLED_IRAM void nextSegment() {
+            while(mSegmentsLeft && mSegments->nLeds == 0) { mSegments++; mSegmentsLeft--; }
+            if(mSegmentsLeft == 0) {
+                mScale = mBaseScale;
+                mSegmentAt = -1;
+            } else {
+                for(int i = 0; i < 3; i++) { mScale.raw[i] = scale8(mBaseScale.raw[i], mSegments->adjustment.raw[i]); }
+                mSegmentAt -= mSegments->nLeds;
+                mSegments++;
+                mSegmentsLeft--;
+            }
+            mScaleW = mScale.raw[0];
+            if(mScale.raw[1] > mScaleW) { mScaleW = mScale.raw[1]; }
+            if(mScale.raw[2] > mScaleW) { mScaleW = mScale.raw[2]; }
+#if !defined(NO_DITHERING) || (NO_DITHERING != 1)
+            if(mDithered) { scaleDithering(mDitherQ); }
+#endif
+        }
+#endif
+
+        void init_binary_dithering(uint8_t ditherBits = VIRTUAL_BITS) {
 #if !defined(NO_DITHERING) || (NO_DITHERING != 1)
 
-            // Set 'virtual bits' of dithering to the highest level
-            // that is not likely to cause excessive flickering at
-            // low brightness levels + low update rates.
-            // These pre-set values are a little ambitious, since
+            // ditherBits is the number of 'virtual bits' of dithering,
+            // the highest level that is not likely to cause excessive
+            // flickering at low brightness levels at the controller's
+            // update rate.  VIRTUAL_BITS is a little ambitious, since
             // a 400Hz update rate for WS2811-family LEDs is only
-            // possible with 85 pixels or fewer.
-            // Once we have a 'number of milliseconds since last update'
-            // value available here, we can quickly calculate the correct
-            // number of 'virtual bits' on the fly with a couple of 'if'
-            // statements -- no division required.  At this point,
-            // the division is done at compile time, so there's no runtime
-            // cost, but the values are still hard-coded.
-#define MAX_LIKELY_UPDATE_RATE_HZ     400
-#define MIN_ACCEPTABLE_DITHER_RATE_HZ  50
-#define UPDATES_PER_FULL_DITHER_CYCLE (MAX_LIKELY_UPDATE_RATE_HZ / MIN_ACCEPTABLE_DITHER_RATE_HZ)
-#define RECOMMENDED_VIRTUAL_BITS ((UPDATES_PER_FULL_DITHER_CYCLE>1) + \
-                                  (UPDATES_PER_FULL_DITHER_CYCLE>2) + \
-                                  (UPDATES_PER_FULL_DITHER_CYCLE>4) + \
-                                  (UPDATES_PER_FULL_DITHER_CYCLE>8) + \
-                                  (UPDATES_PER_FULL_DITHER_CYCLE>16) + \
-                                  (UPDATES_PER_FULL_DITHER_CYCLE>32) + \
-                                  (UPDATES_PER_FULL_DITHER_CYCLE>64) + \
-                                  (UPDATES_PER_FULL_DITHER_CYCLE>128) )
-#define VIRTUAL_BITS RECOMMENDED_VIRTUAL_BITS
+            // possible with 85 pixels or fewer, so FastLED.show picks
+            // it per controller from the measured time between frames
+            // (see CLEDController::updateDitherBits).
 
             // R is the digther signal 'counter'.
             static byte R = 0;
@@ -259,7 +1314,6 @@ struct PixelController {
 
             // R is wrapped around at 2^ditherBits,
             // so if ditherBits is 2, R will cycle through (0,1,2,3)
-            byte ditherBits = VIRTUAL_BITS;
             R &= (0x01 << ditherBits) - 1;
 
             // Q is the "unscaled dither signal" itself.
@@ -287,10 +1341,20 @@ struct PixelController {
                 Q += 0x01 << (7 - ditherBits);
             }
 
-            // D and E form the "scaled dither signal"
-            // which is added to pixel values to affect the
-            // actual dithering.
+#if (FASTLED_SEGMENTS == 1)
+            // kept for the segments to scale to their own scales, see nextSegment
+            mDithered = true;
+            mDitherQ = Q;
+#endif
+            scaleDithering(Q);
+#endif
+        }
 
+#if !defined(NO_DITHERING) || (NO_DITHERING != 1)
+        // D and E form the "scaled dither signal"
+        // which is added to pixel values to affect the
+        // actual dithering.
+        FASTLED_IRAM void scaleDithering(byte Q) {
             // Setup the initial D and E values
             for(int i = 0; i < 3; i++) {
                     byte s = mScale.raw[i];
@@ -301,8 +1365,39 @@ struct PixelController {
 #endif
                     if(e[i]) e[i]--;
             }
+
+#if (FASTLED_SPATIAL_DITHER == 1)
+            if(mSpatial) {
+                // the pattern's steps split the dither signal's range into SPATIAL_DITHER_STEPS cells, in bit reversed
+                // order along the strip, and the frame's signal picks the point within every cell
+                for(int k = 0; k < SPATIAL_DITHER_STEPS; k++) {
+                    uint8_t r = 0;
+                    for(int b = 0; b < SPATIAL_DITHER_BITS; b++) { if(k & (1 << b)) { r |= 0x80 >> b; } }
+                    byte Qk = r + (Q >> SPATIAL_DITHER_BITS);
+                    for(int i = 0; i < 3; i++) {
+                        byte s = mScale.raw[i];
+                        byte ek = s ? (256/s) + 1 : 0;
+                        byte dk = scale8(Qk, ek);
+#if (FASTLED_SCALE8_FIXED == 1)
+                        if(dk) (dk--);
+#endif
+                        mSpatialD[(k * 3) + i] = dk;
+                    }
+                }
+                mSpatialPos = 0;
+                d[0] = mSpatialD[0]; d[1] = mSpatialD[1]; d[2] = mSpatialD[2];
+            }
+#endif
+
+            // the white channel gets dithered the same way, against its own scale
+            eW = mScaleW ? (256/mScaleW) + 1 : 0;
+            dW = scale8(Q, eW);
+#if (FASTLED_SCALE8_FIXED == 1)
+            if(dW) (dW--);
 #endif
+            if(eW) eW--;
         }
+#endif
 
         // Do we have n pixels left to process?
         __attribute__((always_inline)) inline bool has(int n) {
@@ -310,37 +1405,150 @@ struct PixelController {
         }
 
         // toggle dithering enable
-        void enable_dithering(EDitherMode dither) {
+        void enable_dithering(EDitherMode dither, uint8_t ditherBits = VIRTUAL_BITS) {
+            // color correction and temperature only ever scale the rgb channels down relative to the brightest
+            // one, so the largest scale is the brightness the white channel gets
+            mScaleW = mScale.raw[0];
+            if(mScale.raw[1] > mScaleW) { mScaleW = mScale.raw[1]; }
+            if(mScale.raw[2] > mScaleW) { mScaleW = mScale.raw[2]; }
+            dW = eW = 0;
+#if (FASTLED_SEGMENTS == 1)
+            mDithered = false;
+#endif
+#if (FASTLED_SPATIAL_DITHER == 1)
+            mSpatial = false;
+#endif
             switch(dither) {
-                case BINARY_DITHER: init_binary_dithering(); break;
+#if (FASTLED_SPATIAL_DITHER == 1) && (!defined(NO_DITHERING) || (NO_DITHERING != 1))
+                case SPATIAL_DITHER:
+                    mSpatial = true;
+                    if(ditherBits) { init_binary_dithering(ditherBits); break; }
+                    // too slow for any dithering over time: the middle of every cell of the pattern
+#if (FASTLED_SEGMENTS == 1)
+                    mDithered = true;
+                    mDitherQ = 0x80;
+#endif
+                    scaleDithering(0x80);
+                    break;
+#else
+                case SPATIAL_DITHER:
+#endif
+                case BINARY_DITHER: if(ditherBits) { init_binary_dithering(ditherBits); break; }
+                // fall through - no virtual bits means no dithering
                 default: d[0]=d[1]=d[2]=e[0]=e[1]=e[2]=0; break;
             }
         }
 
+        // What loading a byte has to do for this frame, an EPixelWork: no dithering when it's off (or has no virtual
+        // bits, as below 100fps) and no scaling with an adjustment of 255/255/255.  Controllers check it once a frame
+        // and run an encode loop built for it out of the loadAndScale<SLOT, WORK> functions, which leave out what
+        // isn't needed and give the same bytes as loadAndScale.
+        int work() {
+            int w = PIXEL_RAW;
+            if(d[0] | d[1] | d[2] | e[0] | e[1] | e[2] | dW | eW) { w |= PIXEL_DITHER; }
+#if (FASTLED_SCALE8_FIXED == 1)
+            if((mScale.raw[0] & mScale.raw[1] & mScale.raw[2]) != 255) { w |= PIXEL_SCALE; }
+#else
+            // the old scale8 takes a bit off even at 255
+            w |= PIXEL_SCALE;
+#endif
+#if (FASTLED_SEGMENTS == 1)
+            // the segments change the scale and dithering partway through the frame
+            if(mSegmentsLeft) { w = PIXEL_DITHER_SCALE; }
+#endif
+            return w;
+        }
+
+        // Are the bytes that go out the led data exactly as it is, one rgb led after another - nothing to do to them
+        // (see work), no reordering, gamma, white channel, 16 bit data, lanes, generator or mapping?  Then a whole
+        // frame is the size() * 3 bytes at mData, and controllers can copy them out with wide loads.
+        bool rawCopy() {
+            if(work() != PIXEL_RAW || RGB_ORDER != RGB || mAdvance != 3 || mHasWhite || mIs16 || LANES > 1) { return false; }
+#if (FASTLED_GAMMA_OUTPUT == 1)
+            if(mGamma[0] || mGamma[1] || mGamma[2]) { return false; }
+#endif
+#if (FASTLED_PIXEL_GENERATORS == 1)
+            if(mGenerator) { return false; }
+#endif
+#if (FASTLED_OUTPUT_MAPPING == 1)
+            if(mTurnAt >= 0) { return false; }
+#endif
+            return mLenRemaining == mLen;
+        }
+
         __attribute__((always_inline)) inline int size() { return mLen; }
 
         // get the amount to advance the pointer by
         __attribute__((always_inline)) inline int advanceBy() { return mAdvance; }
 
         // advance the data pointer forward, adjust position counter
+#if (FASTLED_PIXEL_GENERATORS == 1) || (FASTLED_OUTPUT_MAPPING == 1) || (FASTLED_SEGMENTS == 1)
+         __attribute__((always_inline)) inline void advanceData() {
+             mLenRemaining--;
+#if (FASTLED_OUTPUT_MAPPING == 1)
+             if(mLenRemaining == mTurnAt) { mData += mTurnJump; mAdvance = mTurnAdvance; } else
+#endif
+             { mData += mAdvance; }
+#if (FASTLED_PIXEL_GENERATORS == 1)
+             if(mGenerator && --mTileRemaining == 0 && mLenRemaining > 0) { generate(); }
+#endif
+#if (FASTLED_SEGMENTS == 1)
+             if(mLenRemaining == mSegmentAt) { nextSegment(); }
+#endif
+         }
+#else
          __attribute__((always_inline)) inline void advanceData() { mData += mAdvance; mLenRemaining--;}
+#endif
 
         // step the dithering forward
          __attribute__((always_inline)) inline void stepDithering() {
              // IF UPDATING HERE, BE SURE TO UPDATE THE ASM VERSION IN
              // clockless_trinket.h!
+#if (FASTLED_SPATIAL_DITHER == 1)
+                if(mSpatial) {
+                    mSpatialPos = (mSpatialPos == (SPATIAL_DITHER_STEPS - 1) * 3) ? 0 : mSpatialPos + 3;
+                    d[0] = mSpatialD[mSpatialPos];
+                    d[1] = mSpatialD[mSpatialPos + 1];
+                    d[2] = mSpatialD[mSpatialPos + 2];
+                    return;
+                }
+#endif
                 d[0] = e[0] - d[0];
                 d[1] = e[1] - d[1];
                 d[2] = e[2] - d[2];
         }
 
+        // treat the byte after the three rgb bytes of each pixel as a white channel, for controllers that can write one
+        // out.  The data's stride (advanceBy) has to leave room for it.
+        __attribute__((always_inline)) inline void enableWhite() { mHasWhite = true; }
+
+        // does the data carry a white channel?
+        __attribute__((always_inline)) inline bool hasWhite() { return mHasWhite; }
+
+        // the data is 16 bits per channel, laid out like a CRGB16 - the three high bytes followed by the three low bytes.
+        // The plain load functions read the high bytes, controllers that can use the extra bits read the loadAndScale16
+        // functions.  The data's stride (advanceBy) has to cover all six bytes.
+        __attribute__((always_inline)) inline void enable16() { mIs16 = true; }
+
+        // does the data carry 16 bits per channel?
+        __attribute__((always_inline)) inline bool is16() { return mIs16; }
+
+        // step the white channel's dithering forward, alongside stepDithering
+         __attribute__((always_inline)) inline void stepWhiteDithering() { dW = eW - dW; }
+
         // Some chipsets pre-cycle the first byte, which means we want to cycle byte 0's dithering separately
         __attribute__((always_inline)) inline void preStepFirstByteDithering() {
             d[RO(0)] = e[RO(0)] - d[RO(0)];
         }
 
-        template<int SLOT>  __attribute__((always_inline)) inline static uint8_t loadByte(PixelController & pc) { return pc.mData[RO(SLOT)]; }
-        template<int SLOT>  __attribute__((always_inline)) inline static uint8_t loadByte(PixelController & pc, int lane) { return pc.mData[pc.mOffsets[lane] + RO(SLOT)]; }
+        template<int SLOT>  __attribute__((always_inline)) inline static uint8_t loadByte(PixelController & pc) { return pc.gamma<SLOT>(pc, pc.mData[RO(SLOT)]); }
+        template<int SLOT>  __attribute__((always_inline)) inline static uint8_t loadByte(PixelController & pc, int lane) { return pc.laneHas(lane) ? pc.gamma<SLOT>(pc, pc.mData[pc.mOffsets[lane] + RO(SLOT)]) : 0; }
+
+#if (FASTLED_GAMMA_OUTPUT == 1)
+        template<int SLOT>  __attribute__((always_inline)) inline static uint8_t gamma(PixelController & pc, uint8_t b) { return pc.mGamma[RO(SLOT)] ? pc.mGamma[RO(SLOT)][b] : b; }
+#else
+        template<int SLOT>  __attribute__((always_inline)) inline static uint8_t gamma(PixelController & , uint8_t b) { return b; }
+#endif
 
         template<int SLOT>  __attribute__((always_inline)) inline static uint8_t dither(PixelController & pc, uint8_t b) { return b ? qadd8(b, pc.d[RO(SLOT)]) : 0; }
         template<int SLOT>  __attribute__((always_inline)) inline static uint8_t dither(PixelController & , uint8_t b, uint8_t d) { return b ? qadd8(b,d) : 0; }
@@ -354,12 +1562,37 @@ struct PixelController {
         template<int SLOT>  __attribute__((always_inline)) inline static uint8_t loadAndScale(PixelController & pc, int lane, uint8_t d, uint8_t scale) { return scale8(pc.dither<SLOT>(pc, pc.loadByte<SLOT>(pc, lane), d), scale); }
         template<int SLOT>  __attribute__((always_inline)) inline static uint8_t loadAndScale(PixelController & pc, int lane, uint8_t scale) { return scale8(pc.loadByte<SLOT>(pc, lane), scale); }
 
+        // loadAndScale doing only the work an EPixelWork asks for, see work
+        template<int SLOT, int WORK>  __attribute__((always_inline)) inline static uint8_t loadAndScale(PixelController & pc) {
+            uint8_t b = loadByte<SLOT>(pc);
+            if(WORK & PIXEL_DITHER) { b = dither<SLOT>(pc, b); }
+            if(WORK & PIXEL_SCALE) { b = scale<SLOT>(pc, b); }
+            return b;
+        }
+
         template<int SLOT>  __attribute__((always_inline)) inline static uint8_t advanceAndLoadAndScale(PixelController & pc) { pc.advanceData(); return pc.loadAndScale<SLOT>(pc); }
         template<int SLOT>  __attribute__((always_inline)) inline static uint8_t advanceAndLoadAndScale(PixelController & pc, int lane) { pc.advanceData(); return pc.loadAndScale<SLOT>(pc, lane); }
 
         template<int SLOT> __attribute__((always_inline)) inline static uint8_t getd(PixelController & pc) { return pc.d[RO(SLOT)]; }
         template<int SLOT> __attribute__((always_inline)) inline static uint8_t getscale(PixelController & pc) { return pc.mScale.raw[RO(SLOT)]; }
 
+        // load a channel as 16 bits (8 bit data is stretched to the full 16 bit range) and scale it, without dithering
+        template<int SLOT>  __attribute__((always_inline)) inline static uint16_t loadAndScale16(PixelController & pc) {
+            uint16_t v = pc.mIs16 ? (((uint16_t)pc.mData[RO(SLOT)] << 8) | pc.mData[3 + RO(SLOT)]) : ((uint16_t)pc.mData[RO(SLOT)] * 257);
+            return scale16by8(v, pc.mScale.raw[RO(SLOT)]);
+        }
+
+        // load, dither and scale the white channel
+        __attribute__((always_inline)) inline uint8_t loadAndScaleW() { uint8_t b = mData[3]; return scale8(b ? qadd8(b, dW) : 0, mScaleW); }
+        __attribute__((always_inline)) inline uint8_t loadAndScaleW(int lane) { uint8_t b = laneHas(lane) ? mData[mOffsets[lane] + 3] : 0; return scale8(b ? qadd8(b, dW) : 0, mScaleW); }
+
+        template<int WORK> __attribute__((always_inline)) inline uint8_t loadAndScaleW() {
+            uint8_t b = mData[3];
+            if(WORK & PIXEL_DITHER) { b = b ? qadd8(b, dW) : 0; }
+            if(WORK & PIXEL_SCALE) { b = scale8(b, mScaleW); }
+            return b;
+        }
+
         // Helper functions to get around gcc stupidities
         __attribute__((always_inline)) inline uint8_t loadAndScale0(int lane) { return loadAndScale<0>(*this, lane); }
         __attribute__((always_inline)) inline uint8_t loadAndScale1(int lane) { return loadAndScale<1>(*this, lane); }
@@ -367,6 +1600,10 @@ struct PixelController {
         __attribute__((always_inline)) inline uint8_t advanceAndLoadAndScale0(int lane) { return advanceAndLoadAndScale<0>(*this, lane); }
         __attribute__((always_inline)) inline uint8_t stepAdvanceAndLoadAndScale0(int lane) { stepDithering(); return advanceAndLoadAndScale<0>(*this, lane); }
 
+        __attribute__((always_inline)) inline uint16_t loadAndScale16_0() { return loadAndScale16<0>(*this); }
+        __attribute__((always_inline)) inline uint16_t loadAndScale16_1() { return loadAndScale16<1>(*this); }
+        __attribute__((always_inline)) inline uint16_t loadAndScale16_2() { return loadAndScale16<2>(*this); }
+
         __attribute__((always_inline)) inline uint8_t loadAndScale0() { return loadAndScale<0>(*this); }
         __attribute__((always_inline)) inline uint8_t loadAndScale1() { return loadAndScale<1>(*this); }
         __attribute__((always_inline)) inline uint8_t loadAndScale2() { return loadAndScale<2>(*this); }
@@ -378,12 +1615,46 @@ template<EOrder RGB_ORDER, int LANES=1, uint32_t MASK=0xFFFFFFFF> class CPixelLE
 protected:
   virtual void showPixels(PixelController<RGB_ORDER,LANES,MASK> & pixels) = 0;
 
+  /// hand the gamma tables over to the pixel controller, one per data byte
+  ///@param order which color each byte of a pixel holds
+  void setPixelGamma(PixelController<RGB_ORDER,LANES,MASK> & pixels, EOrder order) {
+#if (FASTLED_GAMMA_OUTPUT == 1)
+    for(int i = 0; i < 3; i++) { pixels.mGamma[i] = m_pGamma[RGB_BYTE(order, i)]; }
+#endif
+  }
+
+  /// apply the controller's reverse/mirror/offset settings to the pixel controller
+  void setPixelMap(PixelController<RGB_ORDER,LANES,MASK> & pixels) {
+#if (FASTLED_OUTPUT_MAPPING == 1)
+    if(m_bReverse || m_bMirror || m_nOffset) { pixels.map(m_bReverse, m_bMirror, m_nOffset); }
+#endif
+  }
+
+  /// apply the controller's lane lengths to the pixel controller
+  void setPixelLanes(PixelController<RGB_ORDER,LANES,MASK> & pixels) {
+#if (FASTLED_LANE_LENGTHS == 1)
+    if(LANES > 1 && m_pLaneLengths) { pixels.setLaneLengths(m_pLaneLengths); }
+#endif
+  }
+
+  /// hand the controller's segments over to the pixel controller, once the number of leds it writes out is settled
+  void setPixelSegments(PixelController<RGB_ORDER,LANES,MASK> & pixels) {
+#if (FASTLED_SEGMENTS == 1)
+    if(m_pSegments) { pixels.setSegments(m_pSegments, m_nSegments); }
+#endif
+  }
+
   /// set all the leds on the controller to a given color
   ///@param data the crgb color to set the leds to
   ///@param nLeds the numner of leds to set to this color
   ///@param scale the rgb scaling value for outputting color
   virtual void showColor(const struct CRGB & data, int nLeds, CRGB scale) {
-    PixelController<RGB_ORDER, LANES, MASK> pixels(data, nLeds, scale, getDither());
+    PixelController<RGB_ORDER, LANES, MASK> pixels(data, nLeds, scale, getDither(), getDitherBits());
+    setPixelGamma(pixels, RGB);
+    setPixelLanes(pixels);
+    // only mirroring makes a difference, to the number of leds
+    setPixelMap(pixels);
+    setPixelSegments(pixels);
     showPixels(pixels);
   }
 
@@ -392,10 +1663,47 @@ protected:
 ///@param nLeds the number of leds being written out
 ///@param scale the rgb scaling to apply to each led before writing it out
   virtual void show(const struct CRGB *data, int nLeds, CRGB scale) {
-    PixelController<RGB_ORDER, LANES, MASK> pixels(data, nLeds, scale, getDither());
+    PixelController<RGB_ORDER, LANES, MASK> pixels(data, nLeds, scale, getDither(), getDitherBits());
+    setPixelGamma(pixels, RGB);
+    setPixelLanes(pixels);
+    setPixelMap(pixels);
+    setPixelSegments(pixels);
     showPixels(pixels);
   }
 
+/// write raw channel data out to the leds managed by this controller
+///@param data the first byte of the first pixel
+///@param nLeds the number of leds being written out
+///@param stride the number of bytes from one pixel to the next
+///@param scale the rgb scaling to apply to each led, in the order the channels are stored
+  virtual void showRaw(const uint8_t *data, int nLeds, uint8_t stride, CRGB scale) {
+    PixelController<RGB_ORDER, LANES, MASK> pixels(data, nLeds, scale, getDither(), true, 0, getDitherBits());
+    pixels.mAdvance = stride;
+    pixels.initOffsets(nLeds);
+    if(m_bRawWhite) { pixels.enableWhite(); }
+    if(m_bRaw16) { pixels.enable16(); }
+    setPixelGamma(pixels, m_RawOrder);
+    setPixelLanes(pixels);
+    setPixelMap(pixels);
+    setPixelSegments(pixels);
+    showPixels(pixels);
+  }
+
+#if (FASTLED_PIXEL_GENERATORS == 1)
+/// write out led data made by a generator as it goes
+///@param pGenerator, pArg the generator and the argument it gets called with
+///@param pTile, nTileLeds the leds the generator fills in, a few at a time
+///@param nLeds the number of leds being written out
+///@param scale the rgb scaling to apply to each led before writing it out
+  virtual void showGenerated(TPixelGenerator pGenerator, void *pArg, CRGB *pTile, uint16_t nTileLeds, int nLeds, CRGB scale) {
+    PixelController<RGB_ORDER, LANES, MASK> pixels(pTile, nLeds, scale, getDither(), getDitherBits());
+    setPixelGamma(pixels, RGB);
+    pixels.setGenerator(pGenerator, pArg, pTile, nTileLeds);
+    setPixelSegments(pixels);
+    showPixels(pixels);
+  }
+#endif
+
 public:
   CPixelLEDController() : CLEDController() {}
 };
@@ -3,6 +3,61 @@
 
 #include "FastLED.h"
 
+///@ingroup chipsets
+///@{
+FASTLED_NAMESPACE_BEGIN
+
+/// The channels in a DMX universe
+#define DMX_UNIVERSE_CHANNELS 512
+
+/// Base for the controllers that write their leds out as DMX universes, over a DMX line or the network.  The
+/// leds are encoded a universe at a time into a buffer the controller provides, 512 channels at most per universe
+/// (170 rgb or 128 rgbw leds - a led never spans two universes), and each universe is then handed to the
+/// controller whole, for a single write, instead of a call per channel.  Leds past the last universe the output
+/// can carry are dropped.
+template <EOrder RGB_ORDER = RGB> class CDMXUniverseController : public CPixelLEDController<RGB_ORDER> {
+public:
+	/// the number of universes the controller's leds take up
+	uint16_t universes() {
+		// rgbw only comes from raw led data, see CLEDController::setLeds
+		uint16_t perUniverse = DMX_UNIVERSE_CHANNELS / ((this->m_pRawData && this->m_bRawWhite) ? 4 : 3);
+		return (CLEDController::size() + perUniverse - 1) / perUniverse;
+	}
+
+protected:
+	/// where the channels of the given universe (counted from 0) go, channel 1 first.  Needs room for all 512.
+	virtual uint8_t *beginUniverse(uint16_t universe) = 0;
+
+	/// the first nChannels channels of the universe are in place: send it
+	virtual void endUniverse(uint16_t universe, uint16_t nChannels) = 0;
+
+	/// how many universes the output can carry
+	virtual uint16_t maxUniverses() { return 0xFFFF; }
+
+	virtual void showPixels(PixelController<RGB_ORDER> & pixels) {
+		uint8_t step = pixels.hasWhite() ? 4 : 3;
+		uint16_t perUniverse = (DMX_UNIVERSE_CHANNELS / step) * step;
+		uint16_t maxUniverse = maxUniverses();
+		for(uint16_t universe = 0; universe < maxUniverse && pixels.has(1); universe++) {
+			uint8_t *pData = beginUniverse(universe);
+			uint16_t nChannels = 0;
+			while(pixels.has(1) && nChannels < perUniverse) {
+				*pData++ = pixels.loadAndScale0();
+				*pData++ = pixels.loadAndScale1();
+				*pData++ = pixels.loadAndScale2();
+				if(step == 4) { *pData++ = pixels.loadAndScaleW(); pixels.stepWhiteDithering(); }
+				nChannels += step;
+				pixels.advanceData();
+				pixels.stepDithering();
+			}
+			endUniverse(universe, nChannels);
+		}
+	}
+};
+
+FASTLED_NAMESPACE_END
+///@}
+
 #ifdef DmxSimple_h
 #include<DmxSimple.h>
 #define HAS_DMX_SIMPLE
@@ -39,21 +94,18 @@ FASTLED_NAMESPACE_END
 
 FASTLED_NAMESPACE_BEGIN
 
-template <EOrder RGB_ORDER = RGB> class DMXSerialController : public CPixelLEDController<RGB_ORDER> {
+// the leds are encoded straight into DMXSerial's own channel buffer, which it sends out on its own
+template <EOrder RGB_ORDER = RGB> class DMXSerialController : public CDMXUniverseController<RGB_ORDER> {
 public:
 	// initialize the LED controller
 	virtual void init() { DMXSerial.init(DMXController); }
 
-	virtual void showPixels(PixelController<RGB_ORDER> & pixels) {
-		int iChannel = 1;
-		while(pixels.has(1)) {
-			DMXSerial.write(iChannel++, pixels.loadAndScale0());
-			DMXSerial.write(iChannel++, pixels.loadAndScale1());
-			DMXSerial.write(iChannel++, pixels.loadAndScale2());
-			pixels.advanceData();
-			pixels.stepDithering();
-		}
-	}
+protected:
+	// the buffer starts with the start code
+	virtual uint8_t *beginUniverse(uint16_t universe) { return DMXSerial.getBuffer() + 1; }
+	// DMXSerial only sends as many channels as it's told to, 32 unless told otherwise
+	virtual void endUniverse(uint16_t universe, uint16_t nChannels) { DMXSerial.maxChannel(nChannels); }
+	virtual uint16_t maxUniverses() { return 1; }
 };
 
 FASTLED_NAMESPACE_END
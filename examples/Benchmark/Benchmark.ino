@@ -0,0 +1,118 @@
+#include "FastLED.h"
+
+// Times the library's hot paths and prints how many cpu cycles each one takes per pixel (or per call, for the
+// single value functions), so that releases and settings can be compared against a frame budget.  Nothing needs
+// to be wired up.
+//
+// The numbers come from micros(), scaled by the cpu clock, over enough repeats to drown out its resolution.  They
+// include a little loop overhead, so compare them with each other rather than reading them as exact.
+//
+// On a desktop machine this builds against the host platform (see platforms/host), e.g.
+//   g++ -O2 -x c++ -I<path to FastLED> Benchmark.ino <path to FastLED>/*.cpp
+// in which case the cycles are the host's micros scaled to F_CPU - useful for spotting regressions, not for
+// predicting a microcontroller's numbers.
+
+#if defined(__AVR__)
+#define WIDTH 8
+#define HEIGHT 8
+#define REPEAT 8
+#elif defined(FASTLED_HOST)
+#define WIDTH 16
+#define HEIGHT 16
+#define REPEAT 4096
+#else
+#define WIDTH 16
+#define HEIGHT 16
+#define REPEAT 64
+#endif
+#define NUM_LEDS (WIDTH * HEIGHT)
+
+CRGB leds[NUM_LEDS];
+CHSV hsvs[NUM_LEDS];
+uint8_t noise[NUM_LEDS];
+CRGBPalette16 palette16;
+CRGBPalette32 palette32;
+CRGBPalette256 palette256;
+
+// keeps the compiler from throwing away the results of the single value functions
+volatile uint32_t sink;
+
+uint16_t XY(uint8_t x, uint8_t y) { return (y * WIDTH) + x; }
+
+void report(const char *name, uint32_t us, uint32_t count) {
+  // cycles per element, to a tenth of a cycle
+  uint32_t tenths = (uint32_t)(((uint64_t)us * (F_CPU / 100000L)) / count);
+#if defined(FASTLED_HOST)
+  printf("%-28s %7lu.%lu cycles\n", name, (unsigned long)(tenths / 10), (unsigned long)(tenths % 10));
+#else
+  Serial.print(name);
+  for(int i = strlen(name); i < 28; i++) { Serial.print(' '); }
+  Serial.print(tenths / 10); Serial.print('.'); Serial.print(tenths % 10); Serial.println(F(" cycles"));
+#endif
+}
+
+// runs BODY REPEAT times and reports the time per PER elements
+#define BENCH(NAME, PER, BODY) { \
+    uint32_t start = micros(); \
+    for(int r = 0; r < REPEAT; r++) { BODY; } \
+    report(NAME, micros() - start, (uint32_t)(PER) * REPEAT); \
+  }
+
+void setup() {
+#if !defined(FASTLED_HOST)
+  Serial.begin(115200);
+  delay(1000);
+#endif
+  palette16 = RainbowColors_p;
+  palette32 = RainbowColors_p;
+  palette256 = RainbowColors_p;
+  for(int i = 0; i < NUM_LEDS; i++) { hsvs[i] = CHSV(i * 7, 255 - i, 255); }
+  fill_rainbow(leds, NUM_LEDS, 0, 3);
+}
+
+void loop() {
+  uint32_t acc = 0;
+
+  BENCH("scale8", NUM_LEDS, for(int i = 0; i < NUM_LEDS; i++) { acc += scale8(i, r); });
+  BENCH("nscale8x3", NUM_LEDS, for(int i = 0; i < NUM_LEDS; i++) { nscale8x3(leds[i].r, leds[i].g, leds[i].b, 250); });
+  fill_rainbow(leds, NUM_LEDS, 0, 3);
+  BENCH("sin16", NUM_LEDS, for(int i = 0; i < NUM_LEDS; i++) { acc += sin16(i * 257 + r); });
+
+  BENCH("inoise8 1D", NUM_LEDS, for(int i = 0; i < NUM_LEDS; i++) { acc += inoise8(i * 97 + r); });
+  BENCH("inoise8 2D", NUM_LEDS, for(int i = 0; i < NUM_LEDS; i++) { acc += inoise8(i * 97, r * 31); });
+  BENCH("inoise8 3D", NUM_LEDS, for(int i = 0; i < NUM_LEDS; i++) { acc += inoise8(i * 97, r * 31, i); });
+  BENCH("inoise16 1D", NUM_LEDS, for(int i = 0; i < NUM_LEDS; i++) { acc += inoise16((uint32_t)i * 6007 + r); });
+  BENCH("inoise16 2D", NUM_LEDS, for(int i = 0; i < NUM_LEDS; i++) { acc += inoise16((uint32_t)i * 6007, (uint32_t)r * 1999); });
+  BENCH("inoise16 3D", NUM_LEDS, for(int i = 0; i < NUM_LEDS; i++) { acc += inoise16((uint32_t)i * 6007, (uint32_t)r * 1999, i); });
+  BENCH("fill_raw_2dnoise8", NUM_LEDS, fill_raw_2dnoise8(noise, WIDTH, HEIGHT, 1, 0, 97, 0, 97, r * 31));
+
+  BENCH("ColorFromPalette 16 blend", NUM_LEDS, for(int i = 0; i < NUM_LEDS; i++) { leds[i] = ColorFromPalette(palette16, i + r, 255, LINEARBLEND); });
+  BENCH("ColorFromPalette 16", NUM_LEDS, for(int i = 0; i < NUM_LEDS; i++) { leds[i] = ColorFromPalette(palette16, i + r, 255, NOBLEND); });
+  BENCH("ColorFromPalette 32 blend", NUM_LEDS, for(int i = 0; i < NUM_LEDS; i++) { leds[i] = ColorFromPalette(palette32, i + r, 255, LINEARBLEND); });
+  BENCH("ColorFromPalette 32", NUM_LEDS, for(int i = 0; i < NUM_LEDS; i++) { leds[i] = ColorFromPalette(palette32, i + r, 255, NOBLEND); });
+  BENCH("ColorFromPalette 256 blend", NUM_LEDS, for(int i = 0; i < NUM_LEDS; i++) { leds[i] = ColorFromPalette(palette256, i + r, 255, LINEARBLEND); });
+  BENCH("ColorFromPalette 256", NUM_LEDS, for(int i = 0; i < NUM_LEDS; i++) { leds[i] = ColorFromPalette(palette256, i + r, 255, NOBLEND); });
+
+  BENCH("hsv2rgb_rainbow", NUM_LEDS, hsv2rgb_rainbow(hsvs, leds, NUM_LEDS));
+  BENCH("blur2d", NUM_LEDS, blur2d(leds, WIDTH, HEIGHT, 64));
+  fill_rainbow(leds, NUM_LEDS, 0, 3);
+  BENCH("napplyGamma_video", NUM_LEDS, napplyGamma_video(leds, NUM_LEDS, 2.2));
+  fill_rainbow(leds, NUM_LEDS, 0, 3);
+  BENCH("calculate_unscaled_power_mW", NUM_LEDS, acc += calculate_unscaled_power_mW(leds, NUM_LEDS));
+
+  sink = acc;
+
+#if defined(FASTLED_HOST)
+  exit(0);
+#else
+  Serial.println();
+  delay(5000);
+#endif
+}
+
+#if defined(FASTLED_HOST)
+int main() {
+  setup();
+  for(;;) { loop(); }
+}
+#endif
@@ -0,0 +1,58 @@
+#include "FastLED.h"
+
+// Shows how each kind of led output spends a frame's time: how long show keeps the cpu busy, how long the frame
+// takes to get out onto the wire, how long interrupts are held off (in total, and the longest single stretch),
+// and how much of the frame's time is left for other code.  Useful for picking between a bit banged output and a
+// peripheral driven one for a given number of leds, or for checking what FASTLED_ALLOW_INTERRUPTS buys.
+//
+// Edit the controllers below to the outputs you want to compare - each one can be the only one wired up, the
+// timings don't need anything connected to the pins.  The interrupt counts only come from the controllers that can
+// time them (the clockless controllers with a cycle counter: esp32, esp8266, teensy 3.x), they read 0 elsewhere.
+
+#define NUM_LEDS 300
+#define FRAMES 50
+
+CRGB clocklessLeds[NUM_LEDS];
+CRGB spiLeds[NUM_LEDS];
+
+const char *names[] = { "clockless WS2812B", "SPI APA102" };
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+  FastLED.addLeds<WS2812B, 5, GRB>(clocklessLeds, NUM_LEDS);
+  // pins without hardware spi get bit banged spi
+  FastLED.addLeds<APA102, 12, 14, BGR>(spiLeds, NUM_LEDS);
+}
+
+void printUs(const char *label, uint32_t cycles) {
+  Serial.print(label);
+  Serial.print(cycles / (F_CPU / 1000000L));
+  Serial.print(F("us "));
+}
+
+void loop() {
+  FastLED.resetStats();
+  for(int i = 0; i < FRAMES; i++) {
+    fill_rainbow(clocklessLeds, NUM_LEDS, i * 4, 2);
+    fill_rainbow(spiLeds, NUM_LEDS, i * 4, 2);
+    FastLED.show();
+  }
+  // let the last frame finish, so its wire time is in
+  FastLED.waitShow();
+
+  for(int i = 0; i < FastLED.count(); i++) {
+    const LEDControllerStats & stats = FastLED[i].getStats();
+    Serial.print(i < (int)(sizeof(names) / sizeof(names[0])) ? names[i] : "controller");
+    Serial.print(F(": "));
+    printUs("busy ", stats.avgCycles());
+    printUs("wire ", stats.avgWireCycles());
+    printUs("blocked ", stats.avgBlockedCycles());
+    printUs("longest block ", stats.maxBlockedCycles);
+    printUs("free ", stats.avgFreeCycles());
+    Serial.print(F("retries "));
+    Serial.println(stats.retries);
+  }
+  Serial.println();
+  delay(5000);
+}
@@ -52,5 +52,42 @@
 #define FASTLED_INTERRUPT_RETRY_COUNT 2
 #endif
 
+// Clockless chipsets can't pick a frame up where it broke off - once the line has been idle for the
+// latch time, the strip starts over at its first pixel.  So rather than just trying the same thing
+// again, the esp controllers that allow interrupts between pixels double the number of pixels they
+// write between interrupt windows for every frame that had to be restarted, up to this many, and
+// halve it again after FASTLED_INTERRUPT_RELAX_FRAMES frames in a row went out in one go.  The
+// current spacing and the restarts are in each controller's getStats().  Set to 1 to always let
+// interrupts in after every pixel.
+#ifndef FASTLED_INTERRUPT_MAX_SPACING
+#define FASTLED_INTERRUPT_MAX_SPACING 32
+#endif
+
+#ifndef FASTLED_INTERRUPT_RELAX_FRAMES
+#define FASTLED_INTERRUPT_RELAX_FRAMES 16
+#endif
+
+// Use this to run the beat generators and the EVERY_N timers (everything that goes by GET_MILLIS) on FastLEDClock,
+// the timebase the nodes of a distributed installation share (see sync.h), rather than on the local millis - so
+// beatsin16 and friends are in step on all of them.
+#ifndef FASTLED_SHARED_TIMEBASE
+#define FASTLED_SHARED_TIMEBASE 0
+#endif
+
+// Use this to turn on the trace points inside show (see trace.h and setTrace), which hand cycle stamped events -
+// the frame, power limit and controller begin/end, interrupt retries - to a callback.  Left at 0 they compile out to
+// nothing.
+#ifndef FASTLED_TRACE
+#define FASTLED_TRACE 0
+#endif
+
+// Use this to have the clocked chipsets (APA102, SK9822, P9813, LPD8806, SM16716) hand the cpu to other tasks every
+// so many leds while writing out a frame, rather than holding it for the whole strip - see FASTLED_SPI_YIELD in
+// fastspi_types.h.  They don't mind their clock stopping in between leds, the clockless chipsets do and never
+// yield.  Left at 0 frames go out in one go.
+#ifndef FASTLED_SPI_CHUNK_LEDS
+#define FASTLED_SPI_CHUNK_LEDS 0
+#endif
+
 
 #endif
@@ -23,6 +23,42 @@ public:
 	}
 
 	void mark() { mLastMicros = micros() & 0xFFFF; }
+
+	/// how much longer wait would wait for, in us - 0 once the wait time is over
+	uint16_t remaining() {
+		uint16_t diff = (micros() & 0xFFFF) - mLastMicros;
+		return (diff < WAIT) ? (WAIT - diff) : 0;
+	}
+};
+
+/// How many pixels a clockless controller that lets interrupts in between pixels writes between interrupt windows.
+/// Starts at every pixel, doubles (up to FASTLED_INTERRUPT_MAX_SPACING) whenever an interrupt ran long enough to
+/// make the frame start over, and halves again after FASTLED_INTERRUPT_RELAX_FRAMES frames in a row went out
+/// without that.
+class CInterruptSpacing {
+	uint16_t mSpacing;
+	uint8_t mCleanFrames;
+public:
+	CInterruptSpacing() : mSpacing(1), mCleanFrames(0) {}
+
+	/// the number of pixels to write between interrupt windows
+	uint16_t spacing() const { return mSpacing; }
+
+	/// a frame has to be started over
+	void restarted() {
+		mCleanFrames = 0;
+		mSpacing <<= 1;
+		if(mSpacing > FASTLED_INTERRUPT_MAX_SPACING) { mSpacing = FASTLED_INTERRUPT_MAX_SPACING; }
+	}
+
+	/// a frame went out, at the first try or not
+	void finished(bool firstTry) {
+		if(!firstTry || mSpacing == 1) { return; }
+		if(++mCleanFrames >= FASTLED_INTERRUPT_RELAX_FRAMES) {
+			mSpacing >>= 1;
+			mCleanFrames = 0;
+		}
+	}
 };
 
 
@@ -40,6 +40,11 @@ template<uint8_t _DATA_PIN, uint8_t _CLOCK_PIN, uint8_t _SPI_CLOCK_DIVIDER>
 class SPIOutput : public NRF51SPIOutput<_DATA_PIN, _CLOCK_PIN, _SPI_CLOCK_DIVIDER> {};
 #endif
 
+#if defined(FASTLED_ESP32) && defined(FASTLED_ALL_PINS_HARDWARE_SPI)
+template<uint8_t _DATA_PIN, uint8_t _CLOCK_PIN, uint8_t _SPI_CLOCK_DIVIDER>
+class SPIOutput : public ESP32SPIOutput<_DATA_PIN, _CLOCK_PIN, _SPI_CLOCK_DIVIDER> {};
+#endif
+
 #if defined(SPI_DATA) && defined(SPI_CLOCK)
 
 #if defined(FASTLED_TEENSY3) && defined(ARM_HARDWARE_SPI)
@@ -83,6 +88,11 @@ DECLARE_SPI1(21,20);
 template<uint8_t SPI_SPEED>
 class SPIOutput<SPI_DATA, SPI_CLOCK, SPI_SPEED> : public SAMHardwareSPIOutput<SPI_DATA, SPI_CLOCK, SPI_SPEED> {};
 
+#elif defined(STM32F10X_MD)
+
+template<uint8_t SPI_SPEED>
+class SPIOutput<SPI_DATA, SPI_CLOCK, SPI_SPEED> : public STM32HardwareSPIOutput<SPI_DATA, SPI_CLOCK, SPI_SPEED> {};
+
 #elif defined(AVR_HARDWARE_SPI)
 
 template<uint8_t SPI_SPEED>
@@ -129,6 +139,40 @@ class SPIOutput<SPI_UART1_DATA, SPI_UART1_CLOCK, SPI_SPEED> : public AVRUSART1SP
 #  endif
 #endif
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Block writes - with FASTLED_SPI_BLOCK_WRITES defined (the ESP32 hardware SPI defines it, since it can DMA straight out of
+// the encoded frame), chipsets that support it encode a whole frame, boundary frames and all, into one buffer and hand it
+// to the SPI backend with a single writeBytes call instead of writing it out a byte/word at a time.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef FASTLED_SPI_BLOCK_MALLOC
+#define FASTLED_SPI_BLOCK_MALLOC(len) malloc(len)
+#define FASTLED_SPI_BLOCK_FREE(ptr) free(ptr)
+#endif
+
+/// A buffer for encoding a frame of SPI output into, grown as needed and reused from frame to frame
+class CSPIBlockBuffer {
+	uint8_t *mBuffer;
+	int mSize;
+public:
+	CSPIBlockBuffer() : mBuffer(NULL), mSize(0) {}
+
+	/// get a buffer of at least len bytes - the contents are not kept when it has to grow
+	uint8_t *reserve(int len) {
+		if(len > mSize) {
+			if(mBuffer != NULL) { FASTLED_SPI_BLOCK_FREE(mBuffer); }
+			mBuffer = (uint8_t*)FASTLED_SPI_BLOCK_MALLOC(len);
+			mSize = (mBuffer != NULL) ? len : 0;
+		}
+		return mBuffer;
+	}
+
+	/// the buffer itself
+	uint8_t *data() { return mBuffer; }
+};
+
 FASTLED_NAMESPACE_END
 
 #endif
@@ -47,6 +47,8 @@ public:
 	// wait until the SPI subsystem is ready for more data to write.  A NOP when bitbanging
 	static void wait() __attribute__((always_inline)) { }
 	static void waitFully() __attribute__((always_inline)) { wait(); }
+	// writes are done by the time they return, nothing is ever still going out
+	static bool busy() { return false; }
 
 	static void writeByteNoWait(uint8_t b) __attribute__((always_inline)) { writeByte(b); }
 	static void writeBytePostWait(uint8_t b) __attribute__((always_inline)) { writeByte(b); wait(); }
@@ -240,12 +242,16 @@ public:
 
 	// write a block of len uint8_ts out.  Need to type this better so that explicit casts into the call aren't required.
 	// note that this template version takes a class parameter for a per-byte modifier to the data.
+	// The bytes go out in chunks of FASTLED_SPI_CHUNK_LEDS leds at 4 bytes a led - the apa102 and sk9822 block
+	// writes come through here.
 	template <class D> void writeBytes(register uint8_t *data, int len) {
 		select();
+		CSPIYield<FASTLED_SPI_CHUNK_LEDS * 4> chunk;
 #ifdef FAST_SPI_INTERRUPTS_WRITE_PINS
 		uint8_t *end = data + len;
 		while(data != end) {
 			writeByte(D::adjust(*data++));
+			chunk.step();
 		}
 #else
 		register clock_ptr_t clockpin = FastPin<CLOCK_PIN>::port();
@@ -262,6 +268,11 @@ public:
 
 			while(data != end) {
 				writeByte(D::adjust(*data++), clockpin, datapin, datahi, datalo, clockhi, clocklo);
+				if(chunk.step()) {
+					// other tasks may have changed the other pins on the ports
+					datahi = FastPin<DATA_PIN>::hival(); datalo = FastPin<DATA_PIN>::loval();
+					clockhi = FastPin<CLOCK_PIN>::hival(); clocklo = FastPin<CLOCK_PIN>::loval();
+				}
 			}
 
 		} else {
@@ -276,6 +287,12 @@ public:
 
 			while(data != end) {
 				writeByte(D::adjust(*data++), datapin, datahi_clockhi, datalo_clockhi, datahi_clocklo, datalo_clocklo);
+				if(chunk.step()) {
+					datahi_clockhi = FastPin<DATA_PIN>::hival() | FastPin<CLOCK_PIN>::mask();
+					datalo_clockhi = FastPin<DATA_PIN>::loval() | FastPin<CLOCK_PIN>::mask();
+					datahi_clocklo = FastPin<DATA_PIN>::hival() & ~FastPin<CLOCK_PIN>::mask();
+					datalo_clocklo = FastPin<DATA_PIN>::loval() & ~FastPin<CLOCK_PIN>::mask();
+				}
 			}
 			// FastPin<CLOCK_PIN>::lo();
 		}
@@ -290,10 +307,12 @@ public:
 
 	// write a block of uint8_ts out in groups of three.  len is the total number of uint8_ts to write out.  The template
 	// parameters indicate how many uint8_ts to skip at the beginning of each grouping, as well as a class specifying a per
-	// byte of data modification to be made.  (See DATA_NOP above)
+	// byte of data modification to be made.  (See DATA_NOP above)  With FLAG_YIELD the pixels go out in chunks of
+	// FASTLED_SPI_CHUNK_LEDS.
 	template <uint8_t FLAGS, class D, EOrder RGB_ORDER>  __attribute__((noinline)) void writePixels(PixelController<RGB_ORDER> pixels) {
 		select();
 		int len = pixels.mLen;
+		CSPIYield<(FLAGS & FLAG_YIELD) ? FASTLED_SPI_CHUNK_LEDS : 0> chunk;
 
 #ifdef FAST_SPI_INTERRUPTS_WRITE_PINS
 		// If interrupts or other things may be generating output while we're working on things, then we need
@@ -307,6 +326,7 @@ public:
 			writeByte(D::adjust(pixels.loadAndScale2()));
 			pixels.advanceData();
 			pixels.stepDithering();
+			chunk.step();
 		}
 #else
 		// If we can guaruntee that no one else will be writing data while we are running (namely, changing the values of the PORT/PDOR pins)
@@ -331,6 +351,11 @@ public:
 				writeByte(D::adjust(pixels.loadAndScale2()), clockpin, datapin, datahi, datalo, clockhi, clocklo);
 				pixels.advanceData();
 				pixels.stepDithering();
+				if(chunk.step()) {
+					// other tasks may have changed the other pins on the ports
+					datahi = FastPin<DATA_PIN>::hival(); datalo = FastPin<DATA_PIN>::loval();
+					clockhi = FastPin<CLOCK_PIN>::hival(); clocklo = FastPin<CLOCK_PIN>::loval();
+				}
 			}
 
 		} else {
@@ -349,6 +374,12 @@ public:
 				writeByte(D::adjust(pixels.loadAndScale2()), datapin, datahi_clockhi, datalo_clockhi, datahi_clocklo, datalo_clocklo);
 				pixels.advanceData();
 				pixels.stepDithering();
+				if(chunk.step()) {
+					datahi_clockhi = FastPin<DATA_PIN>::hival() | FastPin<CLOCK_PIN>::mask();
+					datalo_clockhi = FastPin<DATA_PIN>::loval() | FastPin<CLOCK_PIN>::mask();
+					datahi_clocklo = FastPin<DATA_PIN>::hival() & ~FastPin<CLOCK_PIN>::mask();
+					datalo_clocklo = FastPin<DATA_PIN>::loval() & ~FastPin<CLOCK_PIN>::mask();
+				}
 			}
 		}
 #endif
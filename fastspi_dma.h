@@ -0,0 +1,86 @@
+#ifndef __INC_FASTSPI_DMA_H
+#define __INC_FASTSPI_DMA_H
+
+///@file fastspi_dma.h
+/// DMA for hardware SPI outputs that push bytes through a FIFO register.  With it, the block writes chipsets hand
+/// their encoded frames over in (see FASTLED_SPI_BLOCK_WRITES in fastspi.h) go out of the frame buffer by DMA: the
+/// write returns as soon as the transfer is queued, and the controller's waitFully/isShowing see to the rest, so
+/// FastLED.showAsync and several strips on separate outputs don't wait on the SPI.
+
+FASTLED_NAMESPACE_BEGIN
+
+#ifndef FASTLED_SPI_DMA
+#define FASTLED_SPI_DMA 0
+#endif
+
+#if defined(FASTLED_TEENSY3) && defined(CORE_TEENSY) && (FASTLED_SPI_DMA == 1)
+
+FASTLED_NAMESPACE_END
+#include <DMAChannel.h>
+FASTLED_NAMESPACE_BEGIN
+
+#define FASTLED_SPI_BLOCK_WRITES
+
+/// The DMA side of a Kinetis (Teensy 3.x) SPI0 block write.  There's one transfer going out at a time, shared by every
+/// output on the port, whatever pins they're on - starting a transfer, or selecting the port for one, finishes the
+/// one before it first.  The output that started a transfer gets called back once the DMA is done, to drain the
+/// FIFO and release its pins.
+class CKinetisSPIDMA {
+	DMAChannel *mChannel;
+	void (*mDone)(void *pArg);
+	void *mDoneArg;
+
+	static CKinetisSPIDMA & state() {
+		static CKinetisSPIDMA sState;
+		return sState;
+	}
+
+public:
+	/// the most bytes one transfer can take (the DMA's major loop count is 15 bits)
+	static int maxBytes() { return 32767; }
+
+	/// start sending len bytes from data to the SPI0 FIFO, one byte per FIFO entry.  The output has to be selected
+	/// and have its tx FIFO DMA request enabled.
+	/// @param pDone called once the transfer is done, from finish
+	/// @returns false if there's no DMA channel to be had - the caller has to write the bytes itself
+	static bool start(volatile uint32_t & pushr, const uint8_t *data, int len, void (*pDone)(void*), void *pArg) {
+		CKinetisSPIDMA & s = state();
+		finish();
+		if(s.mChannel == NULL) {
+			s.mChannel = new DMAChannel();
+			if(s.mChannel->channel >= DMA_NUM_CHANNELS) { delete s.mChannel; s.mChannel = NULL; return false; }
+			s.mChannel->disableOnCompletion();
+			s.mChannel->triggerAtHardwareEvent(DMAMUX_SOURCE_SPI0_TX);
+		}
+		s.mChannel->sourceBuffer(data, len);
+		s.mChannel->destination((volatile uint8_t &)pushr);
+		s.mDone = pDone;
+		s.mDoneArg = pArg;
+		s.mChannel->enable();
+		return true;
+	}
+
+	/// whether a transfer started by the given output is still active - it's only done once finish has been called
+	static bool active(void *pArg) { return state().mDone != NULL && state().mDoneArg == pArg; }
+
+	/// whether the DMA is still moving bytes into the FIFO
+	static bool busy() { CKinetisSPIDMA & s = state(); return s.mDone != NULL && !s.mChannel->complete(); }
+
+	/// wait for the transfer going out (if there is one) to be done, and hand it back to the output that started it
+	static void finish() {
+		CKinetisSPIDMA & s = state();
+		if(s.mDone == NULL) { return; }
+		while(!s.mChannel->complete()) {}
+		s.mChannel->clearComplete();
+		s.mChannel->disable();
+		void (*pDone)(void*) = s.mDone;
+		s.mDone = NULL;
+		(*pDone)(s.mDoneArg);
+	}
+};
+
+#endif
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -25,8 +25,34 @@ public:
 };
 
 #define FLAG_START_BIT 0x80
+#define FLAG_YIELD 0x40
 #define MASK_SKIP_BITS 0x3F
 
+/// What the clocked chipsets call in between the chunks of a frame, see FASTLED_SPI_CHUNK_LEDS.  Under FreeRTOS
+/// yield only lets in tasks of the same priority or higher - define it as vTaskDelay(1) to let the idle task (and
+/// the watchdog it feeds) in as well.
+#ifndef FASTLED_SPI_YIELD
+#define FASTLED_SPI_YIELD() yield()
+#endif
+
+/// Counts off the leds (or bytes) of a frame being written out, and yields the cpu with FASTLED_SPI_YIELD every
+/// CHUNK of them.  With CHUNK at 0 it's nothing at all.  The WS2801 latches its leds after 500us without a clock, so
+/// it never goes out in chunks - writePixels only chunks with FLAG_YIELD set.
+template<int CHUNK> class CSPIYield {
+	int mCount;
+public:
+	CSPIYield() : mCount(0) {}
+
+	/// count one off
+	/// @returns true if it yielded, in which case anything cached about the pins' ports has to be read again
+	__attribute__((always_inline)) inline bool step() {
+		if(CHUNK == 0 || ++mCount < CHUNK) { return false; }
+		mCount = 0;
+		FASTLED_SPI_YIELD();
+		return true;
+	}
+};
+
 // Clock speed dividers
 #define SPEED_DIV_2 2
 #define SPEED_DIV_4 4
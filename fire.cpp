@@ -0,0 +1,109 @@
+#define FASTLED_INTERNAL
+#include "FastLED.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+// The colors render looks each cell's heat up in: a table of the sketch's own (see setColors), or HeatColor - which
+// is HeatColorsLUT where there's FASTLED_HEATCOLOR_TABLE, so it's a table load either way.
+struct FireTableColors {
+	const CRGB *pColors;
+	CRGB operator()(uint8_t heat) const { return pColors[heat]; }
+};
+
+struct FireHeatColors {
+#if (FASTLED_HEATCOLOR_TABLE == 1)
+	CRGB operator()(uint8_t heat) const {
+		const TRGBPaletteTableEntry &entry = HeatColorsLUT.entries[heat];
+		return CRGB(entry.r, entry.g, entry.b);
+	}
+#else
+	CRGB operator()(uint8_t heat) const { return HeatColor(heat); }
+#endif
+};
+
+template<typename COLORS>
+static void renderColumns(CRGB *leds, const uint8_t *pHeat, uint16_t width, uint16_t height, bool reverse, COLORS colors) {
+	for(uint16_t x = 0; x < width; x++) {
+		if(reverse) {
+			for(uint16_t y = height; y > 0; y--) { *leds++ = colors(pHeat[y - 1]); }
+		} else {
+			for(uint16_t y = 0; y < height; y++) { *leds++ = colors(pHeat[y]); }
+		}
+		pHeat += height;
+	}
+}
+
+template<typename COLORS>
+static void renderXY(CRGB *leds, const XYMap &map, const uint8_t *pHeat, uint16_t width, uint16_t height, COLORS colors) {
+	uint16_t bottom = map.height() - 1;
+	for(uint16_t x = 0; x < width; x++) {
+		for(uint16_t y = 0; y < height; y++) { leds[map(x, bottom - y)] = colors(pHeat[y]); }
+		pHeat += height;
+	}
+}
+
+void FireEngine::updateCoolLimit() {
+	// Fire2012 cools every cell by random8(0, ((COOLING * 10) / NUM_LEDS) + 2)
+	uint16_t limit = m_nHeight ? ((m_nCooling * 10) / m_nHeight) + 2 : 2;
+	m_nCoolLimit = (limit > 255) ? 255 : limit;
+}
+
+void FireEngine::loadPalette(CRGB *pColors, const CRGBPalette16 &pal) {
+	for(int t = 0; t < 256; t++) { pColors[t] = ColorFromPalette(pal, scale8(t, 240)); }
+}
+
+// cooling random numbers are drawn this many at a time
+#define FIRE_RANDOM_BATCH 32
+
+void FireEngine::step() {
+	uint8_t cool[FIRE_RANDOM_BATCH];
+	uint16_t height = m_nHeight;
+	// no cells to cool, or to put a spark in
+	if(height == 0) { return; }
+
+	for(uint16_t x = 0; x < m_nWidth; x++) {
+		uint8_t *pHeat = m_pHeat + (x * height);
+
+		// Cool every cell, then let the heat drift up: cell k becomes (cell[k-1] + 2 * cell[k-2]) / 3 of the cooled
+		// cells.  Going forward, the two cooled cells below k are carried along in c1 and c2 instead of being read
+		// back, since they've been overwritten by then.
+		uint8_t c1 = 0, c2 = 0;
+		for(uint16_t k = 0; k < height; ) {
+			uint16_t n = height - k;
+			if(n > FIRE_RANDOM_BATCH) { n = FIRE_RANDOM_BATCH; }
+			m_Random.fill8(cool, n, m_nCoolLimit);
+			for(uint16_t i = 0; i < n; i++, k++) {
+				uint8_t c = qsub8(pHeat[k], cool[i]);
+				if(k >= 2) { pHeat[k] = (c1 + c2 + c2) / 3; } else { pHeat[k] = c; }
+				c2 = c1;
+				c1 = c;
+			}
+		}
+
+		// Randomly ignite a new spark near the bottom
+		if(m_Random.random8() < m_nSparking) {
+			uint8_t y = m_Random.random8(height < 7 ? height : 7);
+			pHeat[y] = qadd8(pHeat[y], m_Random.random8(160, 255));
+		}
+	}
+}
+
+void FireEngine::render(CRGB *leds, bool reverse) const {
+	if(m_pColors) {
+		FireTableColors colors = { m_pColors };
+		renderColumns(leds, m_pHeat, m_nWidth, m_nHeight, reverse, colors);
+	} else {
+		renderColumns(leds, m_pHeat, m_nWidth, m_nHeight, reverse, FireHeatColors());
+	}
+}
+
+void FireEngine::render(CRGB *leds, const XYMap &map) const {
+	if(m_pColors) {
+		FireTableColors colors = { m_pColors };
+		renderXY(leds, map, m_pHeat, m_nWidth, m_nHeight, colors);
+	} else {
+		renderXY(leds, map, m_pHeat, m_nWidth, m_nHeight, FireHeatColors());
+	}
+}
+
+FASTLED_NAMESPACE_END
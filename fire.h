@@ -0,0 +1,98 @@
+#ifndef __INC_FIRE_H
+#define __INC_FIRE_H
+
+#include "FastLED.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+///@file fire.h
+/// the Fire2012 effect as a library class, for any number of columns of flames
+
+///@defgroup Fire Fire simulation
+///@{
+
+/// Mark Kriegsman's Fire2012 heat simulation, for one or more columns of flames side by side (width columns of
+/// height cells each, cell 0 at the bottom).  Every step cools all the cells a little, lets the heat drift up and
+/// diffuse, and randomly ignites sparks near the bottom of each column; render then maps the heat to colors.
+///
+/// Each column keeps its cells next to each other, and cooling and diffusion are done in a single forward pass over
+/// them with a rolling window.  The random numbers come from the engine's own CRandom, so engines running on
+/// different cores don't share a seed.  Colors are looked up in a 256 entry table: by default one of HeatColor
+/// shared by all engines, or one made from a palette with loadPalette.
+///
+/// The heat needs width * height bytes of storage, see CFireEngine for an engine that carries its own.
+class FireEngine {
+	uint16_t m_nWidth;
+	uint16_t m_nHeight;
+	uint8_t *m_pHeat;
+	uint8_t m_nCooling;
+	uint8_t m_nCoolLimit;
+	uint8_t m_nSparking;
+	const CRGB *m_pColors;
+	CRandom m_Random;
+
+	void updateCoolLimit();
+
+public:
+	/// create a fire over caller provided storage
+	/// @param width the number of columns
+	/// @param height the number of cells per column
+	/// @param pHeat storage for width * height cells, all cold (zero) to start with
+	/// @param cooling how much the air cools as it rises, 20-100 is a useful range (Fire2012's COOLING)
+	/// @param sparking the chance (out of 255) that a column gets a new spark each step, 50-200 is a useful range
+	/// (Fire2012's SPARKING)
+	/// @param seed the seed of the engine's random numbers
+	FireEngine(uint16_t width, uint16_t height, uint8_t *pHeat, uint8_t cooling = 55, uint8_t sparking = 120, uint32_t seed = 1337)
+		: m_nWidth(width), m_nHeight(height), m_pHeat(pHeat), m_nCooling(cooling), m_nSparking(sparking), m_pColors(NULL), m_Random(seed) {
+		updateCoolLimit();
+	}
+
+	/// the number of columns
+	uint16_t width() const { return m_nWidth; }
+	/// the number of cells per column
+	uint16_t height() const { return m_nHeight; }
+
+	/// set how much the air cools as it rises
+	void setCooling(uint8_t cooling) { m_nCooling = cooling; updateCoolLimit(); }
+	/// set the chance (out of 255) that a column gets a new spark each step
+	void setSparking(uint8_t sparking) { m_nSparking = sparking; }
+
+	/// look colors up in a 256 entry table (indexed by heat) rather than HeatColor's.  The table is read on every
+	/// render, so it has to stay around.  Pass NULL to go back to HeatColor.
+	void setColors(const CRGB *pColors) { m_pColors = pColors; }
+
+	/// fill a 256 entry color table for setColors from a palette, the way Fire2012WithPalette colors its heat: the
+	/// heat is scaled down to 0-240 first, so the hottest cells don't wrap around to the coldest color
+	static void loadPalette(CRGB *pColors, const CRGBPalette16 &pal);
+
+	/// the heat of a cell.  No range checking is done.
+	uint8_t &heat(uint16_t x, uint16_t y) { return m_pHeat[(x * m_nHeight) + y]; }
+
+	/// run one step of the simulation for every column
+	void step();
+
+	/// map the heat to colors, one column after another, each running from its bottom cell up - or from the top
+	/// down if reverse is set
+	void render(CRGB *leds, bool reverse = false) const;
+
+	/// map the heat to colors on a matrix with width columns and height rows, flames rising from the bottom row
+	void render(CRGB *leds, const XYMap &map) const;
+};
+
+/// A FireEngine that carries the storage for its heat with it
+/// @tparam WIDTH the number of columns
+/// @tparam HEIGHT the number of cells per column
+template<uint16_t WIDTH, uint16_t HEIGHT>
+class CFireEngine : public FireEngine {
+	uint8_t m_Heat[WIDTH * HEIGHT];
+public:
+	CFireEngine(uint8_t cooling = 55, uint8_t sparking = 120, uint32_t seed = 1337) : FireEngine(WIDTH, HEIGHT, m_Heat, cooling, sparking, seed) {
+		memset8(m_Heat, 0, sizeof(m_Heat));
+	}
+};
+
+///@}
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -0,0 +1,91 @@
+#define FASTLED_INTERNAL
+#include "FastLED.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+static void put16(uint8_t *p, uint16_t v) { p[0] = v & 0xFF; p[1] = v >> 8; }
+static uint16_t read16(const uint8_t *p) { return p[0] | ((uint16_t)p[1] << 8); }
+
+// a run costs 4 bytes of header, an unchanged led 3 - gaps of a single led are cheaper to send than to skip
+#define FRAMEDELTA_MERGE_GAP 1
+
+uint32_t CFrameDeltaEncoder::encode(const CRGB *pLeds, uint8_t *pOut, bool key) {
+	key = key || m_bKey;
+	m_bKey = false;
+	pOut[0] = ++m_nSequence;
+	pOut[1] = key ? FRAMEDELTA_KEY : 0;
+	put16(pOut + 2, m_nLeds);
+	uint8_t *p = pOut + FRAMEDELTA_HEADER;
+
+	uint16_t i = 0;
+	uint16_t nLast = 0;
+	while(i < m_nLeds) {
+		// find the next changed led, and how far the changes go from there
+		uint16_t start = i;
+		if(!key) {
+			while(start < m_nLeds && pLeds[start] == m_pPrevious[start]) { start++; }
+			if(start == m_nLeds) { break; }
+		}
+		uint16_t end = start + 1;
+		if(key) {
+			end = m_nLeds;
+		} else {
+			uint16_t gap = 0;
+			for(uint16_t j = end; j < m_nLeds; j++) {
+				if(pLeds[j] == m_pPrevious[j]) {
+					if(++gap > FRAMEDELTA_MERGE_GAP) { break; }
+				} else {
+					gap = 0;
+					end = j + 1;
+				}
+			}
+		}
+		put16(p, start - nLast);
+		put16(p + 2, end - start);
+		p += 4;
+		for(uint16_t j = start; j < end; j++) {
+			*p++ = pLeds[j].r; *p++ = pLeds[j].g; *p++ = pLeds[j].b;
+		}
+		i = nLast = end;
+	}
+
+	memcpy8((void*)m_pPrevious, (const void*)pLeds, sizeof(CRGB) * m_nLeds);
+	return p - pOut;
+}
+
+bool CFrameDeltaDecoder::apply(const uint8_t *pData, uint32_t nBytes, CRGB *pLeds, uint16_t nLeds) {
+	if(nBytes < FRAMEDELTA_HEADER || read16(pData + 2) != nLeds) { m_nDropped++; return false; }
+	bool key = pData[1] & FRAMEDELTA_KEY;
+	if(!key && (!m_bSynced || pData[0] != (uint8_t)(m_nSequence + 1))) {
+		m_bSynced = false;
+		m_nDropped++;
+		return false;
+	}
+
+	// check the runs before touching the leds, so a broken frame doesn't get half applied
+	const uint8_t *pEnd = pData + nBytes;
+	for(int pass = 0; pass < 2; pass++) {
+		const uint8_t *p = pData + FRAMEDELTA_HEADER;
+		uint32_t pos = 0;
+		while(p < pEnd) {
+			if(p + 4 > pEnd) { m_bSynced = false; m_nDropped++; return false; }
+			pos += read16(p);
+			uint16_t count = read16(p + 2);
+			p += 4;
+			if(pos + count > nLeds || p + (3 * (uint32_t)count) > pEnd) { m_bSynced = false; m_nDropped++; return false; }
+			if(pass) {
+				CRGB *pLed = pLeds + pos;
+				for(uint16_t j = 0; j < count; j++) { pLed->r = p[0]; pLed->g = p[1]; pLed->b = p[2]; pLed++; p += 3; }
+			} else {
+				p += 3 * count;
+			}
+			pos += count;
+		}
+	}
+
+	m_nSequence = pData[0];
+	m_bSynced = true;
+	return true;
+}
+
+FASTLED_NAMESPACE_END
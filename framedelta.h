@@ -0,0 +1,87 @@
+#ifndef __INC_FRAMEDELTA_H
+#define __INC_FRAMEDELTA_H
+
+///@file framedelta.h
+/// delta encoding between consecutive frames, for sending led data over a network when most of it doesn't change from
+/// one frame to the next
+
+#include "led_sysdefs.h"
+#include "pixeltypes.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+///@defgroup FrameDelta Frame deltas
+/// An encoded frame is a header followed by the runs of leds that changed since the previous frame.  All values are
+/// little endian:
+///
+///     sequence number        uint8, one more than the previous frame's
+///     flags                  uint8, FRAMEDELTA_KEY for a frame that doesn't depend on the previous one
+///     number of leds         uint16, in the whole frame
+///     runs                   each of them: the number of unchanged leds before it (uint16), the number of leds in
+///                            it (uint16), then three bytes (r, g, b) per led
+///
+/// A key frame is a single run over all the leds.  Unchanged leds between two runs only get merged into them when
+/// that takes fewer bytes.
+///@{
+
+#define FRAMEDELTA_HEADER 4
+#define FRAMEDELTA_KEY 0x01
+
+/// The encoding side: keeps a copy of the last frame it encoded, and encodes the next one against it.  The copy
+/// needs nLeds CRGB objects of storage.
+class CFrameDeltaEncoder {
+	CRGB *m_pPrevious;
+	uint16_t m_nLeds;
+	uint8_t m_nSequence;
+	bool m_bKey;
+
+public:
+	/// create an encoder over caller provided storage.  The first frame is always a key frame.
+	/// @param pPrevious storage for a copy of the last frame, nLeds CRGB objects
+	/// @param nLeds the number of leds in a frame
+	CFrameDeltaEncoder(CRGB *pPrevious, uint16_t nLeds) : m_pPrevious(pPrevious), m_nLeds(nLeds), m_nSequence(0), m_bKey(true) {}
+
+	/// the most bytes an encoded frame can take (a key frame)
+	uint32_t maxBytes() const { return FRAMEDELTA_HEADER + 4 + (3 * (uint32_t)m_nLeds); }
+
+	/// make the next frame a key frame, e.g. when a receiver has asked for one or just came online
+	void requestKeyFrame() { m_bKey = true; }
+
+	/// encode a frame
+	/// @param pLeds the frame
+	/// @param pOut room for the encoded frame, maxBytes
+	/// @param key force a key frame, e.g. every so often so receivers that lost a frame get back in sync
+	/// @returns the number of bytes written
+	uint32_t encode(const CRGB *pLeds, uint8_t *pOut, bool key = false);
+};
+
+/// The decoding side: applies encoded frames to an led array.  A frame that doesn't follow on from the last one
+/// applied (because one went missing) is dropped, and so is everything after it up to the next key frame.
+class CFrameDeltaDecoder {
+	uint8_t m_nSequence;
+	bool m_bSynced;
+	uint32_t m_nDropped;
+
+public:
+	CFrameDeltaDecoder() : m_nSequence(0), m_bSynced(false), m_nDropped(0) {}
+
+	/// apply an encoded frame to the leds, patching the runs in place
+	/// @param pData, nBytes the encoded frame
+	/// @param pLeds the leds the previous frames were applied to
+	/// @param nLeds the number of leds in pLeds
+	/// @returns false if the frame was dropped: it's broken, doesn't fit the leds, or the decoder is waiting for a
+	/// key frame - in which case it's time to ask the sender for one
+	bool apply(const uint8_t *pData, uint32_t nBytes, CRGB *pLeds, uint16_t nLeds);
+
+	/// whether the last frame applied leaves the leds matching the sender's
+	bool synced() const { return m_bSynced; }
+
+	/// how many frames were dropped so far
+	uint32_t dropped() const { return m_nDropped; }
+};
+
+///@}
+
+FASTLED_NAMESPACE_END
+
+#endif
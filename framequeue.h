@@ -0,0 +1,102 @@
+#ifndef __INC_FRAMEQUEUE_H
+#define __INC_FRAMEQUEUE_H
+
+///@file framequeue.h
+/// a lock free single producer/single consumer queue of led frames, for handing frames from one task (e.g. a
+/// network receiver) to the led output without a mutex
+
+#include "led_sysdefs.h"
+#include "pixeltypes.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+/// A triple buffered frame queue.  The producer renders into back() and hands the finished frame over with publish(),
+/// which never blocks.  The consumer (a controller the queue was attached to with CLEDController::setFrameQueue)
+/// picks up the newest published frame at the start of every show, so a frame that gets published before the previous
+/// one made it out replaces it - stale frames are dropped, not queued up.  Each buffer is owned by exactly one side at a
+/// time, so a frame can't change while it's being written out.
+///
+/// Exactly one task/isr may call back()/publish(), the calls made by FastLED.show on the controller's behalf are the
+/// only consumer.
+class CFrameQueue {
+	// bits 0-1 hold the index of the buffer that's waiting to be picked up, bit 2 is set when that buffer holds a frame
+	// the consumer hasn't seen yet
+	enum { FRESH = 0x04, INDEX = 0x03 };
+
+	CRGB *m_pBuffers;
+	int m_nLeds;
+	volatile uint8_t m_State;
+	uint8_t m_nBack;
+	uint8_t m_nFront;
+	volatile uint32_t m_nPublished;
+	volatile uint32_t m_nDropped;
+
+	static uint8_t swapState(volatile uint8_t *pState, uint8_t value) {
+#if defined(__AVR__)
+		uint8_t sreg = SREG; cli();
+		uint8_t old = *pState;
+		*pState = value;
+		SREG = sreg;
+		return old;
+#else
+		return __atomic_exchange_n(pState, value, __ATOMIC_ACQ_REL);
+#endif
+	}
+
+public:
+	/// create a frame queue over caller provided storage
+	/// @param pBuffers storage for three frames, i.e. 3 * nLeds CRGB objects
+	/// @param nLeds the number of leds in a frame
+	CFrameQueue(CRGB *pBuffers, int nLeds) : m_pBuffers(pBuffers), m_nLeds(nLeds), m_State(1), m_nBack(2), m_nFront(0), m_nPublished(0), m_nDropped(0) {}
+
+	/// the number of leds in a frame
+	int size() const { return m_nLeds; }
+
+	/// producer side: the buffer to render the next frame into.  It stays the same until publish is called.
+	CRGB *back() { return m_pBuffers + (m_nBack * m_nLeds); }
+
+	/// producer side: hand the frame in back() over to the consumer, replacing any earlier frame it hasn't picked up
+	/// yet.  Never blocks.
+	/// @returns the buffer to render the next frame into
+	CRGB *publish() {
+		uint8_t old = swapState(&m_State, m_nBack | FRESH);
+		m_nBack = old & INDEX;
+		if(old & FRESH) { m_nDropped++; }
+		m_nPublished++;
+		return back();
+	}
+
+	/// whether a frame was published that the consumer hasn't picked up yet
+	bool hasFrame() const { return m_State & FRESH; }
+
+	/// consumer side: the buffer holding the frame that's currently being shown
+	CRGB *front() { return m_pBuffers + (m_nFront * m_nLeds); }
+
+	/// consumer side: make the newest published frame the front buffer.  The previous front buffer goes back to the
+	/// producer, so it must not be in use by the output anymore when this is called.
+	/// @returns false if nothing new was published since the last call, in which case front() is unchanged
+	bool acquire() {
+		if(!(m_State & FRESH)) { return false; }
+		m_nFront = swapState(&m_State, m_nFront) & INDEX;
+		return true;
+	}
+
+	/// how many frames were published so far
+	uint32_t published() const { return m_nPublished; }
+
+	/// how many published frames got replaced by a newer one before they could be shown
+	uint32_t dropped() const { return m_nDropped; }
+};
+
+/// A CFrameQueue that carries the storage for its frames with it
+/// @tparam SIZE the number of leds in a frame
+template<int SIZE>
+class CRGBFrameQueue : public CFrameQueue {
+	CRGB m_Frames[3 * SIZE];
+public:
+	CRGBFrameQueue() : CFrameQueue(m_Frames, SIZE) {}
+};
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -0,0 +1,243 @@
+#define FASTLED_INTERNAL
+#include "FastLED.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+static uint16_t read16(const uint8_t *p) { return p[0] | ((uint16_t)p[1] << 8); }
+static uint32_t read32(const uint8_t *p) { return read16(p) | ((uint32_t)read16(p + 2) << 16); }
+
+// whether len bytes of runs decode to exactly nLeds leds
+static bool checkRuns(const uint8_t *p, uint32_t len, uint16_t nLeds) {
+	const uint8_t *pEnd = p + len;
+	uint32_t n = 0;
+	while(p < pEnd) {
+		uint8_t run = *p++;
+		p += (run & 0x80) ? 3 : 3 * ((run & 0x7F) + 1);
+		n += (run & 0x7F) + 1;
+	}
+	return p == pEnd && n == nLeds;
+}
+
+CFrameStream::CFrameStream(const uint8_t *pData, uint32_t nBytes) : m_pData(pData), m_nBytes(nBytes), m_pFirstFrame(NULL),
+	m_pNext(NULL), m_nFrame(0), m_nFrames(0), m_nFps(0), m_nSections(0), m_bLoop(false), m_nFrameTime(0) {
+	memset8((void*)m_Sections, 0, sizeof(m_Sections));
+	if(nBytes < 8 || memcmp(pData, "FLS1", 4) != 0) { return; }
+	uint8_t nSections = pData[7];
+	if(nSections > FRAMESTREAM_MAX_SECTIONS || nBytes < 8 + (2 * (uint32_t)nSections)) { return; }
+	for(int i = 0; i < nSections; i++) { m_Sections[i].nLeds = read16(pData + 8 + (2 * i)); }
+	m_nFrames = read16(pData + 4);
+	m_nFps = pData[6];
+	m_nSections = nSections;
+	m_pFirstFrame = m_pNext = pData + 8 + (2 * nSections);
+}
+
+const uint8_t *CFrameStream::readFrame(const uint8_t *p, bool attach) {
+	const uint8_t *pEnd = m_pData + m_nBytes;
+	if(p < pEnd && *p == FRAMESTREAM_TIME) {
+		if(p + 5 > pEnd) { return NULL; }
+		if(attach) { m_nFrameTime = read32(p + 1); }
+		p += 5;
+	} else if(attach) {
+		m_nFrameTime = 0;
+	}
+	for(int i = 0; i < m_nSections; i++) {
+		Section & section = m_Sections[i];
+		if(p >= pEnd) { return NULL; }
+		uint8_t type = *p++;
+		uint32_t len;
+		switch(type) {
+			case FRAMESTREAM_RAW: len = section.nLeds * 3; break;
+			case FRAMESTREAM_RLE: if(p + 2 > pEnd) { return NULL; } len = read16(p); p += 2; break;
+			case FRAMESTREAM_REPEAT: len = 0; break;
+			default: return NULL;
+		}
+		if(p + len > pEnd) { return NULL; }
+		if(type == FRAMESTREAM_RLE && !checkRuns(p, len, section.nLeds)) { return NULL; }
+		if(attach && section.pController) {
+			if(type == FRAMESTREAM_RAW) {
+				section.pController->setLeds(p, section.nLeds, RGB);
+			}
+#if (FASTLED_PIXEL_GENERATORS == 1)
+			else if(type == FRAMESTREAM_RLE) {
+				section.pRuns = p;
+				section.pRunsEnd = p + len;
+				section.pController->setGenerator(&decode, (void*)&section, section.nLeds, section.pTile, section.nTileLeds);
+			}
+#endif
+		}
+		p += len;
+	}
+	return p;
+}
+
+FASTLED_IRAM void CFrameStream::decode(void *pArg, CRGB *pLeds, uint16_t start, uint16_t count) {
+	Section *pSection = (Section*)pArg;
+	if(start == 0) { pSection->pRead = pSection->pRuns; pSection->nRun = 0; }
+	const uint8_t *pRead = pSection->pRead;
+	const uint8_t *pRepeat = pSection->pRepeat;
+	uint8_t nRun = pSection->nRun;
+	while(count--) {
+		if(nRun == 0) {
+			// past the end of the runs (readFrame checked they cover the section) is black
+			if(pRead >= pSection->pRunsEnd) { memset8((void*)pLeds, 0, (count + 1) * sizeof(CRGB)); break; }
+			uint8_t n = *pRead++;
+			nRun = (n & 0x7F) + 1;
+			if(n & 0x80) { pRepeat = pRead; pRead += 3; } else { pRepeat = NULL; }
+		}
+		const uint8_t *p = pRepeat;
+		if(p == NULL) { p = pRead; pRead += 3; }
+		pLeds->r = p[0]; pLeds->g = p[1]; pLeds->b = p[2];
+		pLeds++;
+		nRun--;
+	}
+	pSection->pRead = pRead;
+	pSection->pRepeat = pRepeat;
+	pSection->nRun = nRun;
+}
+
+void CFrameStream::begin(bool loop) {
+	m_bLoop = loop;
+	m_pNext = m_pFirstFrame;
+	m_nFrame = 0;
+	if(m_nFps) { FastLED.setMaxRefreshRate(m_nFps); }
+}
+
+bool CFrameStream::nextFrame() {
+	if(!valid()) { return false; }
+	if(m_nFrame >= m_nFrames) {
+		if(!m_bLoop || m_nFrames == 0) { return false; }
+		m_pNext = m_pFirstFrame;
+		m_nFrame = 0;
+	}
+	for(int i = 0; i < m_nSections; i++) {
+		if(m_Sections[i].pController) { m_Sections[i].pController->waitFully(); }
+	}
+	const uint8_t *p = readFrame(m_pNext, true);
+	// a broken frame ends the stream where it is
+	if(p == NULL) { m_nFrames = m_nFrame; return false; }
+	m_pNext = p;
+	m_nFrame++;
+	return true;
+}
+
+static void put16(uint8_t *p, uint16_t v) { p[0] = v & 0xFF; p[1] = v >> 8; }
+static void put32(uint8_t *p, uint32_t v) { put16(p, v & 0xFFFF); put16(p + 2, v >> 16); }
+
+int CFrameStream::encodeHeader(uint8_t *pOut, uint16_t nFrames, uint8_t fps, uint8_t nSections, const uint16_t *pLeds) {
+	memcpy(pOut, "FLS1", 4);
+	put16(pOut + 4, nFrames);
+	pOut[6] = fps;
+	pOut[7] = nSections;
+	for(int i = 0; i < nSections; i++) { put16(pOut + 8 + (2 * i), pLeds[i]); }
+	return 8 + (2 * nSections);
+}
+
+static uint8_t *putLeds(uint8_t *p, const CRGB *pLeds, int n) {
+	for(int i = 0; i < n; i++) { *p++ = pLeds[i].r; *p++ = pLeds[i].g; *p++ = pLeds[i].b; }
+	return p;
+}
+
+int CFrameStream::encode(const CRGB *pLeds, const CRGB *pPrevious, uint16_t nLeds, uint8_t *pOut) {
+	if(pPrevious && memcmp(pLeds, pPrevious, nLeds * sizeof(CRGB)) == 0) { pOut[0] = FRAMESTREAM_REPEAT; return 1; }
+
+	// try rle first, giving up as soon as it comes out no smaller than raw - or too long for its uint16 length
+	uint8_t *p = pOut + 3;
+	uint8_t *pEnd = pOut + 1 + (nLeds * 3);
+	if(pEnd > pOut + 3 + 0x10000) { pEnd = pOut + 3 + 0x10000; }
+	int i = 0;
+	while(i < nLeds) {
+		int n = 1;
+		while(i + n < nLeds && n < 128 && pLeds[i + n] == pLeds[i]) { n++; }
+		if(n == 1) {
+			// leds that don't repeat, up to the start of the next run
+			while(i + n < nLeds && n < 128 && !(i + n + 1 < nLeds && pLeds[i + n + 1] == pLeds[i + n])) { n++; }
+			if(p + 1 + (n * 3) >= pEnd) { break; }
+			*p++ = n - 1;
+			p = putLeds(p, pLeds + i, n);
+		} else {
+			if(p + 4 >= pEnd) { break; }
+			*p++ = 0x80 | (n - 1);
+			p = putLeds(p, pLeds + i, 1);
+		}
+		i += n;
+	}
+	if(i == nLeds) {
+		pOut[0] = FRAMESTREAM_RLE;
+		put16(pOut + 1, p - (pOut + 3));
+		return p - pOut;
+	}
+
+	pOut[0] = FRAMESTREAM_RAW;
+	return putLeds(pOut + 1, pLeds, nLeds) - pOut;
+}
+
+CFrameRecorder::CFrameRecorder(uint8_t *pBuffer, uint32_t nBytes) : m_pBuffer(pBuffer), m_nBytes(nBytes), m_nFrameBytes(0),
+	m_nSlots(0), m_nNext(0), m_nRecorded(0), m_pFrame(NULL), m_pSink(NULL), m_pSinkArg(NULL), m_nSections(0) {}
+
+bool CFrameRecorder::begin() {
+	// every frame is the time, followed by a raw section per controller
+	uint32_t offset = 5;
+	m_nSections = 0;
+	for(CLEDController *pCur = CLEDController::head(); pCur && m_nSections < FRAMESTREAM_MAX_SECTIONS; pCur = pCur->next()) {
+		m_SectionLeds[m_nSections] = pCur->size();
+		m_SectionOffsets[m_nSections] = offset + 1;
+		offset += 1 + (3 * (uint32_t)pCur->size());
+		m_nSections++;
+	}
+	m_nFrameBytes = offset;
+	m_nSlots = m_nBytes / m_nFrameBytes;
+	m_nNext = 0;
+	m_nRecorded = 0;
+	m_pFrame = NULL;
+	for(uint32_t n = 0; n < m_nSlots; n++) {
+		uint8_t *p = slot(n);
+		p[0] = FRAMESTREAM_TIME;
+		for(int i = 0; i < m_nSections; i++) { p[m_SectionOffsets[i] - 1] = FRAMESTREAM_RAW; }
+	}
+	return m_nSlots != 0;
+}
+
+bool CFrameRecorder::beginFrame(uint32_t micros) {
+	if(m_nSlots == 0) { return false; }
+	m_pFrame = slot(m_nNext);
+	put32(m_pFrame + 1, micros);
+	return true;
+}
+
+void CFrameRecorder::repeatSection(int n) {
+	if(n >= m_nSections) { return; }
+	uint32_t len = 3 * (uint32_t)m_SectionLeds[n];
+	if(m_nRecorded == 0) { memset8((void*)(m_pFrame + m_SectionOffsets[n]), 0, len); return; }
+	const uint8_t *pPrevious = slot(m_nNext ? m_nNext - 1 : m_nSlots - 1);
+	if(pPrevious != m_pFrame) { memcpy8((void*)(m_pFrame + m_SectionOffsets[n]), (const void*)(pPrevious + m_SectionOffsets[n]), len); }
+}
+
+void CFrameRecorder::clearSection(int n) {
+	if(n < m_nSections) { memset8((void*)(m_pFrame + m_SectionOffsets[n]), 0, 3 * (uint32_t)m_SectionLeds[n]); }
+}
+
+void CFrameRecorder::endFrame() {
+	if(m_pSink) { (*m_pSink)(m_pSinkArg, m_pFrame, m_nFrameBytes); }
+	m_nRecorded++;
+	if(++m_nNext == m_nSlots) { m_nNext = 0; }
+	m_pFrame = NULL;
+}
+
+uint32_t CFrameRecorder::save(TFrameSink pSink, void *pArg, uint8_t fps) {
+	uint32_t nHeld = frames();
+	uint32_t nFrames = (nHeld > 0xFFFF) ? 0xFFFF : nHeld;
+	uint8_t header[8 + (2 * FRAMESTREAM_MAX_SECTIONS)];
+	uint32_t nBytes = CFrameStream::encodeHeader(header, nFrames, fps, m_nSections, m_SectionLeds);
+	(*pSink)(pArg, header, nBytes);
+	// once the ring buffer is full, the oldest frame is the one that gets replaced next
+	uint32_t n = (m_nRecorded > m_nSlots) ? m_nNext : 0;
+	if(nFrames) { n = (n + (nHeld - nFrames)) % m_nSlots; }
+	for(uint32_t i = 0; i < nFrames; i++) {
+		(*pSink)(pArg, slot(n), m_nFrameBytes);
+		nBytes += m_nFrameBytes;
+		if(++n == m_nSlots) { n = 0; }
+	}
+	return nBytes;
+}
+
+FASTLED_NAMESPACE_END
@@ -0,0 +1,231 @@
+#ifndef __INC_FRAMESTREAM_H
+#define __INC_FRAMESTREAM_H
+
+///@file framestream.h
+/// playback of pre-rendered animations, straight from the memory they're stored in (e.g. memory mapped flash), without
+/// copying frames into led arrays
+
+#include "led_sysdefs.h"
+#include "pixeltypes.h"
+#include "controller.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+///@defgroup FrameStream Frame streams
+/// A frame stream holds a pre-rendered animation for one or more controllers, one section of leds per controller.
+/// All values are little endian.  The stream starts with a header:
+///
+///     "FLS1"                 4 bytes
+///     number of frames       uint16
+///     frames per second      uint8
+///     number of sections     uint8
+///     leds in each section   uint16 per section
+///
+/// followed by the frames, each of them holding every section in turn.  A frame can start with FRAMESTREAM_TIME and
+/// the time it was shown at (uint32, in µs - see CFrameRecorder).  A section starts with a type byte:
+///
+///     FRAMESTREAM_RAW     the leds, three bytes (r, g, b) each
+///     FRAMESTREAM_RLE     the number of bytes that follow (uint16), then runs: a byte n with the top bit clear is
+///                         followed by n + 1 leds of three bytes each, one with the top bit set by a single led that
+///                         repeats (n & 0x7F) + 1 times
+///     FRAMESTREAM_REPEAT  nothing, the section is the same as in the previous frame (in a first frame the section
+///                         isn't written out at all)
+///
+/// CFrameStream::encode makes sections in this format, e.g. from effects run on the host platform.
+///@{
+
+#define FRAMESTREAM_RAW 0
+#define FRAMESTREAM_RLE 1
+#define FRAMESTREAM_REPEAT 2
+#define FRAMESTREAM_TIME 3
+
+/// The most sections a stream can have
+#ifndef FRAMESTREAM_MAX_SECTIONS
+#define FRAMESTREAM_MAX_SECTIONS 8
+#endif
+
+/// Plays a frame stream on controllers, each section on a controller of its own.  Raw sections are attached as raw
+/// led data (see CLEDController::setLeds(const uint8_t*, int, EOrder, uint8_t, bool)), so the controller reads them
+/// right out of the stream; rle sections get decoded a tile at a time as the controller writes them out (see
+/// CLEDController::setGenerator), on platforms with FASTLED_PIXEL_GENERATORS - elsewhere they're skipped.  Neither
+/// needs any frame sized memory.  Rle sections are decoded in order, so they can only be played on single lane
+/// controllers.
+///
+/// The stream has to stay where it is, unchanged, while it's being played.  Frames are paced with
+/// FastLED.setMaxRefreshRate: call begin, then nextFrame and FastLED.show for every frame.
+class CFrameStream {
+	struct Section {
+		uint16_t nLeds;
+		CLEDController *pController;
+		CRGB *pTile;
+		uint16_t nTileLeds;
+		// the section's runs in the current frame, and where decoding them has got to
+		const uint8_t *pRuns;
+		const uint8_t *pRunsEnd;
+		const uint8_t *pRead;
+		const uint8_t *pRepeat;
+		uint8_t nRun;
+	};
+
+	const uint8_t *m_pData;
+	uint32_t m_nBytes;
+	const uint8_t *m_pFirstFrame;
+	const uint8_t *m_pNext;
+	uint16_t m_nFrame;
+	uint16_t m_nFrames;
+	uint8_t m_nFps;
+	uint8_t m_nSections;
+	bool m_bLoop;
+	uint32_t m_nFrameTime;
+	Section m_Sections[FRAMESTREAM_MAX_SECTIONS];
+
+	// step over a frame, attaching each of its sections to its controller on the way if attach is set
+	// @returns the start of the next frame, or NULL if the frame runs past the end of the stream or has a section that
+	// doesn't decode to exactly its number of leds
+	const uint8_t *readFrame(const uint8_t *p, bool attach);
+
+	// decode count leds of an rle section, a TPixelGenerator over a section.  Starting over at led 0 restarts the
+	// runs, the rest of the leds have to be asked for in order.  It runs wherever the output refills do, see FASTLED_IRAM.
+	static FASTLED_IRAM void decode(void *pArg, CRGB *pLeds, uint16_t start, uint16_t count);
+
+public:
+	/// open a frame stream
+	/// @param pData the stream, e.g. a const array or a memory mapped flash partition
+	/// @param nBytes the size of the stream
+	CFrameStream(const uint8_t *pData, uint32_t nBytes);
+
+	/// whether the stream has a valid header
+	bool valid() const { return m_pFirstFrame != NULL; }
+
+	/// the number of frames in the stream
+	uint16_t frames() const { return m_nFrames; }
+
+	/// the rate the stream was rendered at, in frames per second
+	uint8_t fps() const { return m_nFps; }
+
+	/// the number of sections in every frame
+	uint8_t sections() const { return m_nSections; }
+
+	/// the number of leds in a section
+	uint16_t sectionLeds(uint8_t section) const { return m_Sections[section].nLeds; }
+
+	/// the frame that the next call to nextFrame shows
+	uint16_t frame() const { return m_nFrame; }
+
+	/// the time the frame nextFrame moved on to was shown at when it was recorded, in µs, 0 for frames without one
+	uint32_t frameTime() const { return m_nFrameTime; }
+
+	/// play a section on a controller
+	/// @param section the section to play
+	/// @param controller the controller to play it on
+	/// @param pTile, nTileLeds storage for decoding rle frames, a few leds at a time - can be NULL for streams that
+	/// only have raw frames
+	void attach(uint8_t section, CLEDController & controller, CRGB *pTile = NULL, uint16_t nTileLeds = 0) {
+		Section & s = m_Sections[section];
+		s.pController = &controller;
+		s.pTile = pTile;
+		s.nTileLeds = nTileLeds;
+		// nothing to show until the first frame
+		controller.setLeds((CRGB*)NULL, 0);
+	}
+
+	/// start playing from the first frame, pacing the shows to the stream's frame rate
+	/// @param loop whether to start over after the last frame
+	void begin(bool loop = true);
+
+	/// move every attached controller on to the next frame of the stream, for the following FastLED.show.  A frame
+	/// that's still being written out mustn't get changed, so this waits for the controllers to finish first.
+	/// @returns false when the stream is over (or broken), leaving the controllers on the last frame
+	bool nextFrame();
+
+	/// write a stream header into pOut
+	/// @param pLeds the number of leds in each section
+	/// @returns the number of bytes written, 8 + 2 per section
+	static int encodeHeader(uint8_t *pOut, uint16_t nFrames, uint8_t fps, uint8_t nSections, const uint16_t *pLeds);
+
+	/// encode a section of a frame into pOut, as whichever of repeat, rle and raw comes out the smallest
+	/// @param pLeds the section's leds
+	/// @param pPrevious the section's leds in the previous frame, NULL for none
+	/// @param pOut room for at least 3 + nLeds * 3 bytes
+	/// @returns the number of bytes written
+	static int encode(const CRGB *pLeds, const CRGB *pPrevious, uint16_t nLeds, uint8_t *pOut);
+};
+
+/// Something recorded frames get handed to as they're made, e.g. a function writing them to a file
+typedef void (*TFrameSink)(void *pArg, const uint8_t *pData, uint32_t nBytes);
+
+/// Records the frames FastLED.show writes out, once it's been handed to FastLED.setRecorder: one section per
+/// controller, holding the colors the leds went out with (after gamma, brightness, color correction and power
+/// limiting, but before dithering), and the time each frame was shown at.  Frames are kept in a ring buffer, the
+/// newest ones replacing the oldest once it's full, so recording can be left on to keep the last few seconds around
+/// - save writes them out as a frame stream (see CFrameStream) that can be played back or analyzed offline.  A sink
+/// gets every frame handed to it as it's recorded, in stream format without the header (see
+/// CFrameStream::encodeHeader).
+///
+/// Every frame takes 5 + 1 + 3 * leds bytes per controller, see frameBytes.  The controllers are laid out when the
+/// recorder is handed to FastLED.setRecorder; controllers added later, or whose number of leds changed, come out black.
+class CFrameRecorder {
+	uint8_t *m_pBuffer;
+	uint32_t m_nBytes;
+	uint32_t m_nFrameBytes;
+	uint32_t m_nSlots;
+	uint32_t m_nNext;
+	uint32_t m_nRecorded;
+	uint8_t *m_pFrame;
+	TFrameSink m_pSink;
+	void *m_pSinkArg;
+	uint8_t m_nSections;
+	uint16_t m_SectionLeds[FRAMESTREAM_MAX_SECTIONS];
+	uint32_t m_SectionOffsets[FRAMESTREAM_MAX_SECTIONS];
+
+	uint8_t *slot(uint32_t n) { return m_pBuffer + (n * m_nFrameBytes); }
+
+public:
+	/// create a recorder over caller provided storage
+	/// @param pBuffer storage for the frames, at least one (frameBytes)
+	/// @param nBytes the size of the storage
+	CFrameRecorder(uint8_t *pBuffer, uint32_t nBytes);
+
+	/// lay out the frames for the controllers there are now, and drop whatever was recorded so far.  Called by
+	/// FastLED.setRecorder.
+	/// @returns false if there's no room for a single frame
+	bool begin();
+
+	/// hand every recorded frame to a sink as well, NULL for none.  The frame data is only valid during the call.
+	void setSink(TFrameSink pSink, void *pArg = NULL) { m_pSink = pSink; m_pSinkArg = pArg; }
+
+	/// the size of a recorded frame, in bytes
+	uint32_t frameBytes() const { return m_nFrameBytes; }
+
+	/// the number of frames held in the ring buffer
+	uint32_t frames() const { return m_nRecorded < m_nSlots ? m_nRecorded : m_nSlots; }
+
+	/// the number of frames recorded since begin, including the ones that have been replaced since
+	uint32_t recorded() const { return m_nRecorded; }
+
+	/// write the frames held in the ring buffer out as a frame stream, oldest first
+	/// @param fps the rate the stream gets played back at, 0 for as fast as it can go
+	/// @returns the number of bytes written
+	uint32_t save(TFrameSink pSink, void *pArg, uint8_t fps = 0);
+
+	/// @name used by FastLED.show
+	///@{
+	/// start recording a frame shown at the given time
+	/// @returns false if the recorder hasn't got anywhere to put it
+	bool beginFrame(uint32_t micros);
+	/// where to put a controller's leds in the frame being recorded, NULL if they don't fit
+	uint8_t *section(int n, int nLeds) { return (n < m_nSections && nLeds == m_SectionLeds[n]) ? m_pFrame + m_SectionOffsets[n] : NULL; }
+	/// a controller wasn't shown: carry its leds over from the previous frame
+	void repeatSection(int n);
+	/// a controller's leds didn't fit: make them black
+	void clearSection(int n);
+	/// finish the frame being recorded
+	void endFrame();
+	///@}
+};
+
+///@}
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef __INC_GOVERNOR_H
+#define __INC_GOVERNOR_H
+
+///@file governor.h
+/// a quality level for effects that keeps the frame rate at the max refresh rate
+
+#include "led_sysdefs.h"
+#include "controller.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+/// Watches how much of every frame period (see FastLED.setMaxRefreshRate) goes into rendering and showing the frame,
+/// and turns a quality level down when frames start running late, and back up again once there's time to spare.
+/// Effects read the level and pick their work to match - noise octaves, blur passes, interpolating or not - so content
+/// written for the fastest hardware keeps a steady frame rate on slower hardware.  The dithering depth goes down with
+/// the quality, too.
+///
+/// The time a frame took is measured from one show until the next one is called, so it covers rendering as well as
+/// waiting for the previous frame to be written out.  The level drops fast (a step at a time, every few frames, while
+/// frames take longer than the high mark) and comes back slowly (a smaller step after a run of frames below the low
+/// mark), so it doesn't see-saw around the point where frames just fit.  Only shows of all the show groups are
+/// measured, and without a max refresh rate there's nothing to measure against, so the level stays where it is.
+///
+///     CFrameGovernor governor;
+///     FastLED.setMaxRefreshRate(60);
+///     FastLED.setGovernor(&governor);
+///     ...
+///     fill_2dnoise16(leds, W, H, true, governor.quality(1, 6), ...);
+///     if(governor.quality() > 128) { blur2d(leds, W, H, 64); }
+///     FastLED.show();
+class CFrameGovernor {
+	uint8_t m_nQuality;
+	uint8_t m_nMinQuality;
+	// smoothed frame time over the frame period, 256 for a frame that takes exactly the period
+	uint16_t m_nLoad;
+	uint8_t m_nHigh;
+	uint8_t m_nLow;
+	uint8_t m_nDropStep;
+	uint8_t m_nRaiseStep;
+	uint8_t m_nRaiseFrames;
+	// frames in a row with the load under the low mark, and frames left before the level can drop again
+	uint8_t m_nCalmFrames;
+	uint8_t m_nHoldFrames;
+
+public:
+	/// @param minQuality the lowest the quality level goes
+	CFrameGovernor(uint8_t minQuality = 0) : m_nQuality(255), m_nMinQuality(minQuality), m_nLoad(0), m_nHigh(243), m_nLow(192),
+		m_nDropStep(32), m_nRaiseStep(16), m_nRaiseFrames(30), m_nCalmFrames(0), m_nHoldFrames(0) {}
+
+	/// the quality level, from minQuality (frames are running late) to 255 (there's time to spare)
+	uint8_t quality() const { return m_nQuality; }
+
+	/// the quality level scaled to a range of settings, e.g. quality(1, 6) for a number of noise octaves
+	uint8_t quality(uint8_t lo, uint8_t hi) const { return lo + (((uint16_t)(hi - lo) * m_nQuality + 127) / 255); }
+
+	/// the most dithering bits the controllers get at the current quality level - all of them at full quality
+	uint8_t maxDitherBits() const { return ((uint16_t)m_nQuality * (VIRTUAL_BITS + 1)) >> 8; }
+
+	/// how much of the frame period frames take, smoothed - 256 for a frame that takes exactly the period
+	uint16_t load() const { return m_nLoad; }
+
+	/// set the marks the smoothed load is held between, in 256ths of the frame period: above high the quality level
+	/// drops, and it rises after a run of frames below low.  243 (95%) and 192 (75%) by default.
+	CFrameGovernor & setMarks(uint8_t high, uint8_t low) { m_nHigh = high; m_nLow = low; return *this; }
+
+	/// set how far the quality level moves at a time: drop when frames run late, raise after raiseFrames frames in
+	/// a row with time to spare.  32, 16 and 30 by default.
+	CFrameGovernor & setSteps(uint8_t drop, uint8_t raise, uint8_t raiseFrames) {
+		m_nDropStep = drop;
+		m_nRaiseStep = raise;
+		m_nRaiseFrames = raiseFrames;
+		return *this;
+	}
+
+	/// go back to full quality and forget the measurements, e.g. after switching to different content
+	void reset() { m_nQuality = 255; m_nLoad = 0; m_nCalmFrames = 0; m_nHoldFrames = 0; }
+
+	/// count a frame, called by FastLED.show
+	/// @param frameMicros how long the frame took, from the show before it until this one was called
+	/// @param periodMicros the frame period the max refresh rate asks for
+	void frame(uint32_t frameMicros, uint32_t periodMicros) {
+		if(periodMicros == 0) { return; }
+		// anything past four periods counts as four, which also keeps the shift from overflowing
+		uint32_t sample = (frameMicros >= (periodMicros << 2)) ? 1024 : (frameMicros << 8) / periodMicros;
+		m_nLoad = ((m_nLoad * 3) + sample + 2) >> 2;
+
+		if(m_nHoldFrames) { m_nHoldFrames--; }
+		if(m_nLoad > m_nHigh) {
+			m_nCalmFrames = 0;
+			if(m_nHoldFrames == 0 && m_nQuality > m_nMinQuality) {
+				// the lower level takes a few frames to show up in the smoothed load
+				m_nQuality = (m_nQuality - m_nMinQuality > m_nDropStep) ? m_nQuality - m_nDropStep : m_nMinQuality;
+				m_nHoldFrames = 4;
+			}
+		} else if(m_nLoad < m_nLow) {
+			if(++m_nCalmFrames >= m_nRaiseFrames) {
+				m_nCalmFrames = 0;
+				m_nQuality = (255 - m_nQuality > m_nRaiseStep) ? m_nQuality + m_nRaiseStep : 255;
+			}
+		} else {
+			m_nCalmFrames = 0;
+		}
+	}
+};
+
+FASTLED_NAMESPACE_END
+
+#endif
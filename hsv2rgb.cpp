@@ -501,10 +501,83 @@ void hsv2rgb_raw(const struct CHSV * phsv, struct CRGB * prgb, int numLeds) {
     }
 }
 
+// A table of the fully saturated, full brightness rainbow, so the
+// array conversion can look a hue's color up instead of going down
+// the section branches of hsv2rgb_rainbow for every pixel.  Costs
+// 768 bytes of ram, which isn't worth it on AVR.
+#ifndef FASTLED_RAINBOW_LUT
+#if defined(__AVR__)
+#define FASTLED_RAINBOW_LUT 0
+#else
+#define FASTLED_RAINBOW_LUT 1
+#endif
+#endif
+
+#if (FASTLED_RAINBOW_LUT == 1)
+static CLazyTable<CRGB[256]> sRainbow;
+
+static void buildRainbow( CRGB (&table)[256])
+{
+    for( int hue = 0; hue < 256; hue++) {
+        hsv2rgb_rainbow( CHSV( hue, 255, 255), table[hue]);
+    }
+}
+
+// built on first use, see CLazyTable
+static const CRGB* rainbowTable()
+{
+    return sRainbow.get( buildRainbow);
+}
+#endif
+
+#if (FASTLED_RAINBOW_LUT == 1)
+// Saturation and value are applied the same way hsv2rgb_rainbow does,
+// but without its special cases: with the fixed scale8, scaling by 255
+// leaves a channel alone, scaling by 0 clears it and a zero channel
+// stays zero, so they all come out of the plain math.  The older
+// scale8 needs the video scaling for that, and still has to special
+// case a saturation of 0.
+static inline CRGB rainbow_from_table( const CRGB* rainbow, uint8_t hue, uint8_t sat, uint8_t val)
+{
+    CRGB rgb = rainbow[hue];
+
+#if (FASTLED_SCALE8_FIXED==1)
+    nscale8x3( rgb.r, rgb.g, rgb.b, sat);
+#else
+    if( sat == 0) {
+        rgb = CRGB( 255, 255, 255);
+        sat = 255;
+    }
+    nscale8x3_video( rgb.r, rgb.g, rgb.b, sat);
+#endif
+    uint8_t desat = 255 - sat;
+    uint8_t brightness_floor = scale8( desat, desat);
+    rgb.r += brightness_floor;
+    rgb.g += brightness_floor;
+    rgb.b += brightness_floor;
+
+    val = scale8_video( val, val);
+#if (FASTLED_SCALE8_FIXED==1)
+    nscale8x3( rgb.r, rgb.g, rgb.b, val);
+#else
+    nscale8x3_video( rgb.r, rgb.g, rgb.b, val);
+#endif
+    return rgb;
+}
+#endif
+
 void hsv2rgb_rainbow( const struct CHSV* phsv, struct CRGB * prgb, int numLeds) {
+#if (FASTLED_RAINBOW_LUT == 1)
+    const CRGB* rainbow = rainbowTable();
+    for( int i = 0; i < numLeds; i++) {
+        const CHSV & hsv = phsv[i];
+        prgb[i] = rainbow_from_table( rainbow, hsv.hue, hsv.sat, hsv.val);
+    }
+#else
     for(int i = 0; i < numLeds; i++) {
         hsv2rgb_rainbow(phsv[i], prgb[i]);
     }
+#endif
 }
 
 void hsv2rgb_spectrum( const struct CHSV* phsv, struct CRGB * prgb, int numLeds) {
@@ -517,6 +590,88 @@ void hsv2rgb_spectrum( const struct CHSV* phsv, struct CRGB * prgb, int numLeds)
 
 #define FIXFRAC8(N,D) (((N)*256)/(D))
 
+// The hue part of rgb2hsv_approximate, for channels that have had
+// their desaturation removed and been scaled up
+static inline uint8_t approximate_hue( uint8_t r, uint8_t g, uint8_t b)
+{
+    uint8_t h;
+
+    // since this wasn't a pure shade of gray,
+    // the interesting question is what hue is it
+    
+    
+    
+    // start with which channel is highest
+    // (ties don't matter)
+    uint8_t highest = r;
+    if( g > highest) highest = g;
+    if( b > highest) highest = b;
+    
+    if( highest == r ) {
+        // Red is highest.
+        // Hue could be Purple/Pink-Red,Red-Orange,Orange-Yellow
+        if( g == 0 ) {
+            // if green is zero, we're in Purple/Pink-Red
+            h = (HUE_PURPLE + HUE_PINK) / 2;
+            h += scale8( qsub8(r, 128), FIXFRAC8(48,128));
+        } else if ( (r - g) > g) {
+            // if R-G > G then we're in Red-Orange
+            h = HUE_RED;
+            h += scale8( g, FIXFRAC8(32,85));
+        } else {
+            // R-G < G, we're in Orange-Yellow
+            h = HUE_ORANGE;
+            h += scale8( qsub8((g - 85) + (171 - r), 4), FIXFRAC8(32,85)); //221
+        }
+        
+    } else if ( highest == g) {
+        // Green is highest
+        // Hue could be Yellow-Green, Green-Aqua
+        if( b == 0) {
+            // if Blue is zero, we're in Yellow-Green
+            //   G = 171..255
+            //   R = 171..  0
+            h = HUE_YELLOW;
+            uint8_t radj = scale8( qsub8(171,r),   47); //171..0 -> 0..171 -> 0..31
+            uint8_t gadj = scale8( qsub8(g,171),   96); //171..255 -> 0..84 -> 0..31;
+            uint8_t rgadj = radj + gadj;
+            uint8_t hueadv = rgadj / 2;
+            h += hueadv;
+            //h += scale8( qadd8( 4, qadd8((g - 128), (128 - r))),
+            //             FIXFRAC8(32,255)); //
+        } else {
+            // if Blue is nonzero we're in Green-Aqua
+            if( (g-b) > b) {
+                h = HUE_GREEN;
+                h += scale8( b, FIXFRAC8(32,85));
+            } else {
+                h = HUE_AQUA;
+                h += scale8( qsub8(b, 85), FIXFRAC8(8,42));
+            }
+        }
+        
+    } else /* highest == b */ {
+        // Blue is highest
+        // Hue could be Aqua/Blue-Blue, Blue-Purple, Purple-Pink
+        if( r == 0) {
+            // if red is zero, we're in Aqua/Blue-Blue
+            h = HUE_AQUA + ((HUE_BLUE - HUE_AQUA) / 4);
+            h += scale8( qsub8(b, 128), FIXFRAC8(24,128));
+        } else if ( (b-r) > r) {
+            // B-R > R, we're in Blue-Purple
+            h = HUE_BLUE;
+            h += scale8( r, FIXFRAC8(32,85));
+        } else {
+            // B-R < R, we're in Purple-Pink
+            h = HUE_PURPLE;
+            h += scale8( qsub8(r, 85), FIXFRAC8(32,85));
+        }
+    }
+    
+    h += 1;
+    return h;
+}
+
 // This function is only an approximation, and it is not
 // nearly as fast as the normal HSV-to-RGB conversion.
 // See extended notes in the .h file.
@@ -627,82 +782,125 @@ CHSV rgb2hsv_approximate( const CRGB& rgb)
     //Serial.print("s.3="); Serial.print(s); Serial.println("");
     
     
-    // since this wasn't a pure shade of gray,
-    // the interesting question is what hue is it
-    
-    
-    
-    // start with which channel is highest
-    // (ties don't matter)
-    uint8_t highest = r;
-    if( g > highest) highest = g;
-    if( b > highest) highest = b;
-    
-    if( highest == r ) {
-        // Red is highest.
-        // Hue could be Purple/Pink-Red,Red-Orange,Orange-Yellow
-        if( g == 0 ) {
-            // if green is zero, we're in Purple/Pink-Red
-            h = (HUE_PURPLE + HUE_PINK) / 2;
-            h += scale8( qsub8(r, 128), FIXFRAC8(48,128));
-        } else if ( (r - g) > g) {
-            // if R-G > G then we're in Red-Orange
-            h = HUE_RED;
-            h += scale8( g, FIXFRAC8(32,85));
-        } else {
-            // R-G < G, we're in Orange-Yellow
-            h = HUE_ORANGE;
-            h += scale8( qsub8((g - 85) + (171 - r), 4), FIXFRAC8(32,85)); //221
-        }
-        
-    } else if ( highest == g) {
-        // Green is highest
-        // Hue could be Yellow-Green, Green-Aqua
-        if( b == 0) {
-            // if Blue is zero, we're in Yellow-Green
-            //   G = 171..255
-            //   R = 171..  0
-            h = HUE_YELLOW;
-            uint8_t radj = scale8( qsub8(171,r),   47); //171..0 -> 0..171 -> 0..31
-            uint8_t gadj = scale8( qsub8(g,171),   96); //171..255 -> 0..84 -> 0..31;
-            uint8_t rgadj = radj + gadj;
-            uint8_t hueadv = rgadj / 2;
-            h += hueadv;
-            //h += scale8( qadd8( 4, qadd8((g - 128), (128 - r))),
-            //             FIXFRAC8(32,255)); //
-        } else {
-            // if Blue is nonzero we're in Green-Aqua
-            if( (g-b) > b) {
-                h = HUE_GREEN;
-                h += scale8( b, FIXFRAC8(32,85));
-            } else {
-                h = HUE_AQUA;
-                h += scale8( qsub8(b, 85), FIXFRAC8(8,42));
-            }
-        }
-        
-    } else /* highest == b */ {
-        // Blue is highest
-        // Hue could be Aqua/Blue-Blue, Blue-Purple, Purple-Pink
-        if( r == 0) {
-            // if red is zero, we're in Aqua/Blue-Blue
-            h = HUE_AQUA + ((HUE_BLUE - HUE_AQUA) / 4);
-            h += scale8( qsub8(b, 128), FIXFRAC8(24,128));
-        } else if ( (b-r) > r) {
-            // B-R > R, we're in Blue-Purple
-            h = HUE_BLUE;
-            h += scale8( r, FIXFRAC8(32,85));
-        } else {
-            // B-R < R, we're in Purple-Pink
-            h = HUE_PURPLE;
-            h += scale8( qsub8(r, 85), FIXFRAC8(32,85));
-        }
-    }
-    
-    h += 1;
+    h = approximate_hue( r, g, b);
     return CHSV( h, s, v);
 }
 
+// Tables for the divisions and square roots of rgb2hsv_approximate,
+// for converting arrays.  Costs 1K of ram, which isn't worth it on AVR.
+#ifndef FASTLED_RGB2HSV_LUT
+#if defined(__AVR__)
+#define FASTLED_RGB2HSV_LUT 0
+#else
+#define FASTLED_RGB2HSV_LUT 1
+#endif
+#endif
+
+#if (FASTLED_RGB2HSV_LUT == 1)
+struct CRGB2HSVTables {
+    uint16_t scaleup[256];    // 65535 / n
+    uint8_t saturation[256];  // the undimmed saturation for a desaturation
+    uint8_t value[256];       // the undimmed value
+};
+static CLazyTable<CRGB2HSVTables> sRGB2HSV;
+
+static void buildRGB2HSV( CRGB2HSVTables& tables)
+{
+    for( int n = 0; n < 256; n++) {
+        tables.scaleup[n] = n ? (65535 / n) : 0;
+        tables.saturation[n] = n ? (255 - sqrt16( n * 256)) : 255;
+        tables.value[n] = (n != 255) ? sqrt16( n * 256) : 255;
+    }
+}
+
+// built on first use, see CLazyTable
+static const CRGB2HSVTables& rgb2hsvTables()
+{
+    return sRGB2HSV.get( buildRGB2HSV);
+}
+
+// rgb2hsv_approximate, reading its divisions and square roots from the tables
+static inline CHSV rgb2hsv_from_tables( const CRGB2HSVTables& tables, const CRGB& rgb)
+{
+    uint8_t r = rgb.r;
+    uint8_t g = rgb.g;
+    uint8_t b = rgb.b;
+
+    uint8_t desat = 255;
+    if( r < desat) desat = r;
+    if( g < desat) desat = g;
+    if( b < desat) desat = b;
+
+    r -= desat;
+    g -= desat;
+    b -= desat;
+
+    uint8_t s = tables.saturation[desat];
+
+    if( (r + g + b) == 0) {
+        return CHSV( 0, 0, 255 - s);
+    }
+
+    if( s < 255) {
+        if( s == 0) s = 1;
+        uint32_t scaleup = tables.scaleup[s];
+        r = ((uint32_t)(r) * scaleup) / 256;
+        g = ((uint32_t)(g) * scaleup) / 256;
+        b = ((uint32_t)(b) * scaleup) / 256;
+    }
+
+    uint16_t total = r + g + b;
+    uint8_t v;
+    if( total < 255) {
+        if( total == 0) total = 1;
+        uint32_t scaleup = tables.scaleup[total];
+        r = ((uint32_t)(r) * scaleup) / 256;
+        g = ((uint32_t)(g) * scaleup) / 256;
+        b = ((uint32_t)(b) * scaleup) / 256;
+    }
+
+    if( total > 255 ) {
+        v = 255;
+    } else {
+        v = tables.value[ qadd8( desat, total)];
+    }
+
+    return CHSV( approximate_hue( r, g, b), s, v);
+}
+#endif
+
+void rgb2hsv_approximate( const struct CRGB* prgb, struct CHSV* phsv, int numLeds)
+{
+#if (FASTLED_RGB2HSV_LUT == 1)
+    const CRGB2HSVTables& tables = rgb2hsvTables();
+    for( int i = 0; i < numLeds; i++) {
+        phsv[i] = rgb2hsv_from_tables( tables, prgb[i]);
+    }
+#else
+    for( int i = 0; i < numLeds; i++) {
+        phsv[i] = rgb2hsv_approximate( prgb[i]);
+    }
+#endif
+}
+
+void hue_shift( struct CRGB* leds, int numLeds, uint8_t delta)
+{
+#if (FASTLED_RGB2HSV_LUT == 1) && (FASTLED_RAINBOW_LUT == 1)
+    const CRGB2HSVTables& tables = rgb2hsvTables();
+    const CRGB* rainbow = rainbowTable();
+    for( int i = 0; i < numLeds; i++) {
+        CHSV hsv = rgb2hsv_from_tables( tables, leds[i]);
+        leds[i] = rainbow_from_table( rainbow, hsv.hue + delta, hsv.sat, hsv.val);
+    }
+#else
+    for( int i = 0; i < numLeds; i++) {
+        CHSV hsv = rgb2hsv_approximate( leds[i]);
+        hsv.hue += delta;
+        hsv2rgb_rainbow( hsv, leds[i]);
+    }
+#endif
+}
+
 // Examples that need work:
 //   0,192,192
 //   192,64,64
@@ -14,6 +14,10 @@ FASTLED_NAMESPACE_BEGIN
 //                   than a straight 'spectrum'.
 //
 //                   NOTE: here hue is 0-255, not just 0-191
+//
+//                   The array version looks hues up in a table
+//                   built on first use (except on AVR), with the
+//                   same results.
 
 void hsv2rgb_rainbow( const struct CHSV& hsv, struct CRGB& rgb);
 void hsv2rgb_rainbow( const struct CHSV* phsv, struct CRGB * prgb, int numLeds);
@@ -86,6 +90,17 @@ void hsv2rgb_raw(const struct CHSV* phsv, struct CRGB * prgb, int numLeds);
 //
 CHSV rgb2hsv_approximate( const CRGB& rgb);
 
+// rgb2hsv_approximate for an array.  Except on AVR, its divisions and
+// square roots are read from tables built on first use, with the same
+// results as the single color version, which makes it a good deal
+// faster.
+void rgb2hsv_approximate( const struct CRGB* prgb, struct CHSV* phsv, int numLeds);
+
+// hue_shift - rotate the hues of an array of colors by delta, the same
+//             as a trip through rgb2hsv_approximate and hsv2rgb_rainbow
+//             but without an array of CHSVs in between.
+void hue_shift( struct CRGB* leds, int numLeds, uint8_t delta);
+
 FASTLED_NAMESPACE_END
 
 #endif
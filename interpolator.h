@@ -0,0 +1,131 @@
+#ifndef __INC_INTERPOLATOR_H
+#define __INC_INTERPOLATOR_H
+
+///@file interpolator.h
+/// temporal interpolation between rendered frames, so leds can be written out at a higher frame rate than an effect
+/// renders at
+
+#include "led_sysdefs.h"
+#include "pixeltypes.h"
+#include "controller.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+/// Blends between the last two frames an effect rendered, for writing the leds out more often than the effect can
+/// render them: every show writes out a frame part of the way from the previous rendered frame to the newest one,
+/// going by the time since the newest one was added, measured against the (smoothed) time between rendered frames.
+/// Motion comes out smooth, and the extra frames make for faster dithering, at the cost of one rendered frame of
+/// latency.
+///
+/// Rendered frames are handed over with addFrame.  The blended frames either get written straight into the output as
+/// the controller writes it out (see attach), or into a CRGB array with blend for controllers that can't do that.
+/// The frames need 2 * nLeds CRGB objects of storage, CRGBFrameInterpolator carries its own.
+class CFrameInterpolator {
+	CRGB *m_pFrames;
+	int m_nLeds;
+	CRGB *m_pTile;
+	uint16_t m_nTileLeds;
+	CLEDController *m_pController;
+	// which of the two frames is the newest, when it was added and the smoothed time between frames, in µs
+	uint8_t m_nCurrent;
+	uint32_t m_nFrameStart;
+	uint32_t m_nFrameMicros;
+	uint32_t m_nFrames;
+	// the blend for the frame being written out, and whether it's all the way at the newest frame
+	fract8 m_nBlend;
+	bool m_bDone;
+
+	CRGB *previous() { return m_pFrames + ((m_nCurrent ^ 1) * m_nLeds); }
+	CRGB *current() { return m_pFrames + (m_nCurrent * m_nLeds); }
+
+	// work out how far along from the previous frame to the current one output is
+	FASTLED_IRAM void updateBlend() {
+		uint32_t elapsed = micros() - m_nFrameStart;
+		m_bDone = (m_nFrames < 2) || (elapsed >= m_nFrameMicros);
+		m_nBlend = m_bDone ? 255 : (elapsed << 8) / m_nFrameMicros;
+	}
+
+public:
+	/// create an interpolator over caller provided storage
+	/// @param pFrames storage for two frames, i.e. 2 * nLeds CRGB objects
+	/// @param nLeds the number of leds in a frame
+	/// @param pTile, nTileLeds storage for the blended leds, a few at a time, when attached to a controller (see
+	/// CLEDController::setGenerator).  Can be NULL when only blend gets used.
+	CFrameInterpolator(CRGB *pFrames, int nLeds, CRGB *pTile = NULL, uint16_t nTileLeds = 0)
+		: m_pFrames(pFrames), m_nLeds(nLeds), m_pTile(pTile), m_nTileLeds(nTileLeds), m_pController(NULL),
+		  m_nCurrent(0), m_nFrameStart(0), m_nFrameMicros(0), m_nFrames(0), m_nBlend(255), m_bDone(true) {
+		memset8((void*)m_pFrames, 0, 2 * sizeof(CRGB) * nLeds);
+	}
+
+	/// the number of leds in a frame
+	int size() const { return m_nLeds; }
+
+	/// hand a newly rendered frame over.  It's copied, so the leds can be rendered into again right away.  If the
+	/// interpolator is attached to a controller, this waits for the frame being written out to finish first.
+	void addFrame(const CRGB *pLeds) {
+		uint32_t now = micros();
+		if(m_nFrames) {
+			uint32_t interval = now - m_nFrameStart;
+			if(interval > 1000000UL) { interval = 1000000UL; }
+			m_nFrameMicros = m_nFrameMicros ? ((m_nFrameMicros * 3) + interval) / 4 : interval;
+		}
+		if(m_pController) { m_pController->waitFully(); }
+		// the oldest frame makes room for the new one
+		m_nCurrent ^= 1;
+		memcpy8((void*)current(), (const void*)pLeds, sizeof(CRGB) * m_nLeds);
+		m_nFrameStart = now;
+		m_nFrames++;
+	}
+
+	/// how many frames were added so far
+	uint32_t frames() const { return m_nFrames; }
+
+	/// the smoothed time between added frames, in µs
+	uint32_t frameMicros() const { return m_nFrameMicros; }
+
+	/// write the frame for right now into pLeds
+	void blend(CRGB *pLeds) {
+		updateBlend();
+		interpolate(this, pLeds, 0, m_nLeds);
+	}
+
+	/// blend count leds from start on into pLeds, a TPixelGenerator over a CFrameInterpolator.  The blend is worked
+	/// out when the first led is asked for, so the whole frame uses the same one.  It runs wherever the output refills
+	/// do, see FASTLED_IRAM.
+	static FASTLED_IRAM void interpolate(void *pArg, CRGB *pLeds, uint16_t start, uint16_t count) {
+		CFrameInterpolator *pThis = (CFrameInterpolator*)pArg;
+		if(start == 0 && pLeds == pThis->m_pTile) { pThis->updateBlend(); }
+		const CRGB *pCurrent = pThis->current() + start;
+		if(pThis->m_bDone) {
+			memcpy8((void*)pLeds, (const void*)pCurrent, sizeof(CRGB) * count);
+			return;
+		}
+		const CRGB *pPrevious = pThis->previous() + start;
+		fract8 frac = pThis->m_nBlend;
+		while(count--) { *pLeds++ = (*pPrevious++).lerp8(*pCurrent++, frac); }
+	}
+
+#if (FASTLED_PIXEL_GENERATORS == 1)
+	/// have a controller write out the blended frames, blending each led as it goes - no output frame buffer needed.
+	/// Every show writes out a new blended frame, so show as often as the output can keep up with.
+	void attach(CLEDController & controller) {
+		m_pController = &controller;
+		controller.setGenerator(&interpolate, (void*)this, m_nLeds, m_pTile, m_nTileLeds);
+	}
+#endif
+};
+
+/// A CFrameInterpolator that carries the storage for its frames and tile with it
+/// @tparam SIZE the number of leds in a frame
+/// @tparam TILE the size of the tile, in leds
+template<int SIZE, int TILE = 16>
+class CRGBFrameInterpolator : public CFrameInterpolator {
+	CRGB m_Frames[2 * SIZE];
+	CRGB m_Tile[TILE];
+public:
+	CRGBFrameInterpolator() : CFrameInterpolator(m_Frames, SIZE, m_Tile, TILE) {}
+};
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -27,6 +27,9 @@
 #include "platforms/esp/8266/led_sysdefs_esp8266.h"
 #elif defined(ESP32)
 #include "platforms/esp/32/led_sysdefs_esp32.h"
+#elif defined(FASTLED_HOST) || (!defined(ARDUINO) && (defined(__x86_64__) || defined(__i386__)))
+// Host (desktop) builds, for profiling and debugging
+#include "platforms/host/led_sysdefs_host.h"
 #else
 // AVR platforms
 #include "platforms/avr/led_sysdefs_avr.h"
@@ -45,4 +48,9 @@
 
 #define CLKS_PER_US (F_CPU/1000000)
 
+// Where the timing critical output code goes, on platforms that can keep it out of flash (see led_sysdefs_esp32.h)
+#ifndef FASTLED_IRAM
+#define FASTLED_IRAM
+#endif
+
 #endif
@@ -125,6 +125,80 @@ void * memmove8 ( void * dst, const void* src, uint16_t num )
 #endif /* AVR */
 
 
+// fill_sin8 and friends: on 32 bit targets sin8 comes out of a 256 entry
+// table, built on first use (see CLazyTable).
+#ifndef FASTLED_SIN8_TABLE
+#if defined(__AVR__)
+#define FASTLED_SIN8_TABLE 0
+#else
+#define FASTLED_SIN8_TABLE 1
+#endif
+#endif
+
+#if (FASTLED_SIN8_TABLE == 1)
+static CLazyTable<uint8_t[256]> sSin8;
+
+static void buildSin8( uint8_t (&table)[256])
+{
+    for( int theta = 0; theta < 256; theta++) {
+        table[theta] = sin8( theta);
+    }
+}
+
+static const uint8_t* sin8Table()
+{
+    return sSin8.get( buildSin8);
+}
+#define SIN8_FILL(theta) (table[(uint8_t)(theta)])
+#else
+#define SIN8_FILL(theta) (sin8( theta))
+#endif
+
+void fill_sin8( uint8_t* out, uint16_t count, uint8_t phase, uint8_t dphase)
+{
+#if (FASTLED_SIN8_TABLE == 1)
+    const uint8_t* table = sin8Table();
+#endif
+    while( count--) {
+        *out++ = SIN8_FILL( phase);
+        phase += dphase;
+    }
+}
+
+void fill_sin16( int16_t* out, uint16_t count, uint16_t phase, uint16_t dphase)
+{
+    while( count--) {
+        *out++ = sin16( phase);
+        phase += dphase;
+    }
+}
+
+void fill_beatsin8( uint8_t* out, uint16_t count, accum88 beats_per_minute, uint8_t lowest, uint8_t highest,
+                    uint32_t timebase, uint8_t phase_offset, uint8_t dphase)
+{
+#if (FASTLED_SIN8_TABLE == 1)
+    const uint8_t* table = sin8Table();
+#endif
+    uint8_t phase = beat8( beats_per_minute, timebase) + phase_offset;
+    uint8_t rangewidth = highest - lowest;
+    while( count--) {
+        *out++ = lowest + scale8( SIN8_FILL( phase), rangewidth);
+        phase += dphase;
+    }
+}
+
+void fill_beatsin16( uint16_t* out, uint16_t count, accum88 beats_per_minute, uint16_t lowest, uint16_t highest,
+                     uint32_t timebase, uint16_t phase_offset, uint16_t dphase)
+{
+    uint16_t phase = beat16( beats_per_minute, timebase) + phase_offset;
+    uint16_t rangewidth = highest - lowest;
+    while( count--) {
+        *out++ = lowest + scale16( sin16( phase) + 32768, rangewidth);
+        phase += dphase;
+    }
+}
+
+
 
 
 #if 0
@@ -437,13 +437,39 @@ void * memcpy8 ( void * dst, const void * src, uint16_t num )  __attribute__ ((n
 void * memset8 ( void * ptr, uint8_t value, uint16_t num ) __attribute__ ((noinline)) ;
 }
 #else
-// on non-AVR platforms, these names just call standard libc.
+// on non-AVR platforms, these names just call standard libc, which already
+// copies and fills a word at a time (from ROM on the esp32) and takes a
+// size_t length, so there's no 64K limit there.  fill_solid for CRGB arrays
+// writes whole words too, see colorutils.cpp.
 #define memmove8 memmove
 #define memcpy8 memcpy
 #define memset8 memset
 #endif
 
 
+///////////////////////////////////////////////////////////////////////
+//
+// CLazyTable: a table of values worked out on first use (and only read
+//   after that), for lookup tables too big to keep as constants.  Two
+//   cores building it at the same time write the same values, so no
+//   lock is needed, the flag just mustn't be seen before them.  A static
+//   CLazyTable starts out zeroed, i.e. not built.
+
+template<typename T> struct CLazyTable {
+    T table;
+    bool built;
+
+    const T& get( void (*build)( T& table))
+    {
+        if( !__atomic_load_n( &built, __ATOMIC_ACQUIRE)) {
+            build( table);
+            __atomic_store_n( &built, true, __ATOMIC_RELEASE);
+        }
+        return table;
+    }
+};
+
+
 ///////////////////////////////////////////////////////////////////////
 //
 // linear interpolation, such as could be used for Perlin noise, etc.
@@ -853,6 +879,13 @@ uint32_t get_millisecond_timer();
 #define GET_MILLIS get_millisecond_timer
 #endif
 
+#if (FASTLED_SHARED_TIMEBASE == 1)
+// the shared timebase's millis, see FASTLED_SHARED_TIMEBASE and sync.h
+uint32_t shared_millis();
+#undef GET_MILLIS
+#define GET_MILLIS shared_millis
+#endif
+
 // beat16 generates a 16-bit 'sawtooth' wave at a given BPM,
 ///        with BPM specified in Q8.8 fixed-point format; e.g.
 ///        for this function, 120 BPM MUST BE specified as
@@ -929,6 +962,30 @@ LIB8STATIC uint8_t beatsin8( accum88 beats_per_minute, uint8_t lowest = 0, uint8
 }
 
 
+/// fill_sin8 fills a buffer with sin8 of a phase that starts at phase and
+///           goes up by dphase from one entry to the next - e.g. the
+///           brightness of every pixel along a wave.  The values are the
+///           same as calling sin8 for each entry, but on 32 bit targets
+///           they're read out of a 256 entry table.
+void fill_sin8( uint8_t* out, uint16_t count, uint8_t phase, uint8_t dphase);
+
+/// fill_sin16 fills a buffer with sin16 of a phase that starts at phase and
+///           goes up by dphase from one entry to the next.
+void fill_sin16( int16_t* out, uint16_t count, uint16_t phase, uint16_t dphase);
+
+/// fill_beatsin8 fills a buffer with beatsin8 values, entry i using a
+///           phase offset of phase_offset + (i * dphase).  The beat is
+///           worked out once, so every entry is from the same moment.
+void fill_beatsin8( uint8_t* out, uint16_t count, accum88 beats_per_minute, uint8_t lowest = 0, uint8_t highest = 255,
+                    uint32_t timebase = 0, uint8_t phase_offset = 0, uint8_t dphase = 0);
+
+/// fill_beatsin16 fills a buffer with beatsin16 values, entry i using a
+///           phase offset of phase_offset + (i * dphase).  The beat is
+///           worked out once, so every entry is from the same moment.
+void fill_beatsin16( uint16_t* out, uint16_t count, accum88 beats_per_minute, uint16_t lowest = 0, uint16_t highest = 65535,
+                     uint32_t timebase = 0, uint16_t phase_offset = 0, uint16_t dphase = 0);
+
+
 /// Return the current seconds since boot in a 16-bit value.  Used as part of the
 /// "every N time-periods" mechanism
 LIB8STATIC uint16_t seconds16()
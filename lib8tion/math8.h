@@ -113,6 +113,41 @@ LIB8STATIC_ALWAYS_INLINE uint8_t qsub8( uint8_t i, uint8_t j)
 #endif
 }
 
+/// add each of the four bytes packed into one 32 bit word to the same byte
+/// of another, saturating at 0xFF - qadd8 on all four at once
+/// @returns the four sums, each capped at 0xFF
+LIB8STATIC_ALWAYS_INLINE uint32_t qadd8x4( uint32_t i, uint32_t j)
+{
+#if QADD8_ARM_DSP_ASM == 1
+    asm volatile( "uqadd8 %0, %0, %1" : "+r" (i) : "r" (j));
+    return i;
+#else
+    // add the low seven bits of every byte, then fix up the top bits and
+    // find the bytes that carried out
+    uint32_t sum = ((i & 0x7F7F7F7FUL) + (j & 0x7F7F7F7FUL)) ^ ((i ^ j) & 0x80808080UL);
+    uint32_t carry = ((i & j) | ((i | j) & ~sum)) & 0x80808080UL;
+    return sum | ((carry << 1) - (carry >> 7));
+#endif
+}
+
+/// subtract each of the four bytes packed into one 32 bit word from the same
+/// byte of another, saturating at 0x00 - qsub8 on all four at once
+/// @returns the four differences, each with a floor of 0
+LIB8STATIC_ALWAYS_INLINE uint32_t qsub8x4( uint32_t i, uint32_t j)
+{
+#if QADD8_ARM_DSP_ASM == 1
+    asm volatile( "uqsub8 %0, %0, %1" : "+r" (i) : "r" (j));
+    return i;
+#else
+    // subtract the low seven bits of every byte with the top bits set, so no
+    // byte borrows from the next, then fix up the top bits and find the bytes
+    // that borrowed
+    uint32_t diff = ((i | 0x80808080UL) - (j & 0x7F7F7F7FUL)) ^ ((i ^ ~j) & 0x80808080UL);
+    uint32_t borrow = ((~i & j) | ((~i | j) & diff)) & 0x80808080UL;
+    return diff & ~((borrow << 1) - (borrow >> 7));
+#endif
+}
+
 /// add one byte to another, with one byte result
 LIB8STATIC_ALWAYS_INLINE uint8_t add8( uint8_t i, uint8_t j)
 {
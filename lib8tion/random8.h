@@ -89,6 +89,118 @@ LIB8STATIC void random16_add_entropy( uint16_t entropy)
     rand16seed += entropy;
 }
 
+/// Fill a buffer with 8-bit random numbers, the same ones that many
+/// calls to random8() would return, but with the seed kept in a register
+/// for the whole buffer
+LIB8STATIC void fill_random8( uint8_t* out, uint16_t count)
+{
+    uint16_t seed = rand16seed;
+    while( count--) {
+        seed = (seed * FASTLED_RAND16_2053) + FASTLED_RAND16_13849;
+        *out++ = (uint8_t)(((uint8_t)(seed & 0xFF)) + ((uint8_t)(seed >> 8)));
+    }
+    rand16seed = seed;
+}
+
+/// Fill a buffer with 16-bit random numbers, the same ones that many
+/// calls to random16() would return
+LIB8STATIC void fill_random16( uint16_t* out, uint16_t count)
+{
+    uint16_t seed = rand16seed;
+    while( count--) {
+        seed = (seed * FASTLED_RAND16_2053) + FASTLED_RAND16_13849;
+        *out++ = seed;
+    }
+    rand16seed = seed;
+}
+
+/// A random number generator with its own state, for effects that want a
+/// repeatable sequence of their own, or that run on another core or task
+/// than the rest of the sketch and shouldn't share rand16seed with it.
+/// It's a 32-bit xorshift, which is better mixed than the 16-bit
+/// generator behind random8() and gives four random bytes per step.
+class CRandom {
+    uint32_t m_State;
+
+    /// advance the state, a xorshift32 step
+    uint32_t next() {
+        uint32_t x = m_State;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        m_State = x;
+        return x;
+    }
+
+public:
+    /// create a generator with the given seed (a seed of 0 is replaced by a
+    /// fixed non-zero one, which xorshift needs)
+    CRandom( uint32_t seed = 0x2545F491UL) { setSeed( seed); }
+
+    /// Set the seed, see the constructor
+    void setSeed( uint32_t seed) { m_State = seed ? seed : 0x2545F491UL; }
+
+    /// Get the current state, which can be passed to setSeed to pick up the sequence from here
+    uint32_t getSeed() const { return m_State; }
+
+    /// Add entropy into the generator
+    void addEntropy( uint32_t entropy) { setSeed( m_State + entropy); }
+
+    /// Generate a 32-bit random number
+    uint32_t random32() { return next(); }
+
+    /// Generate a 16-bit random number
+    uint16_t random16() { return next() >> 16; }
+
+    /// Generate an 16-bit random number between 0 and lim
+    uint16_t random16( uint16_t lim) { return ((uint32_t)lim * random16()) >> 16; }
+
+    /// Generate an 16-bit random number in the given range
+    uint16_t random16( uint16_t min, uint16_t lim) { return random16( lim - min) + min; }
+
+    /// Generate an 8-bit random number
+    uint8_t random8() { return next() >> 24; }
+
+    /// Generate an 8-bit random number between 0 and lim
+    uint8_t random8( uint8_t lim) { return (random8() * lim) >> 8; }
+
+    /// Generate an 8-bit random number in the given range
+    uint8_t random8( uint8_t min, uint8_t lim) { return random8( lim - min) + min; }
+
+    /// Fill a buffer with 8-bit random numbers, four per step
+    void fill8( uint8_t* out, uint16_t count) {
+        while( count >= 4) {
+            uint32_t r = next();
+            out[0] = r;
+            out[1] = r >> 8;
+            out[2] = r >> 16;
+            out[3] = r >> 24;
+            out += 4; count -= 4;
+        }
+        if( count) {
+            uint32_t r = next();
+            while( count--) { *out++ = r >> 24; r <<= 8; }
+        }
+    }
+
+    /// Fill a buffer with 8-bit random numbers between 0 and lim
+    void fill8( uint8_t* out, uint16_t count, uint8_t lim) {
+        fill8( out, count);
+        while( count--) { *out = (*out * lim) >> 8; out++; }
+    }
+
+    /// Fill a buffer with 16-bit random numbers, two per step
+    void fill16( uint16_t* out, uint16_t count) {
+        while( count >= 2) {
+            uint32_t r = next();
+            out[0] = r;
+            out[1] = r >> 16;
+            out += 2; count -= 2;
+        }
+        if( count) { *out = random16(); }
+    }
+};
+
 ///@}
 
 #endif
@@ -409,6 +409,53 @@ LIB8STATIC void nscale8x2_video( uint8_t& i, uint8_t& j, fract8 scale)
 }
 
 
+/// scale the four bytes packed into one 32 bit word by a fifth one, which
+///         is treated as the numerator of a fraction whose denominator is
+///         256 - scale8 on all four at once, with the same results
+///         (FASTLED_SCALE8_FIXED or not).  Two multiplies on 32 bit targets.
+LIB8STATIC_ALWAYS_INLINE uint32_t scale8x4( uint32_t w, fract8 scale)
+{
+#if (FASTLED_SCALE8_FIXED == 1)
+    uint32_t s = (uint32_t)scale + 1;
+#else
+    uint32_t s = scale;
+#endif
+    // the even and odd bytes in 16 bit lanes, where 255 * 256 still fits
+    uint32_t even = ((w & 0x00FF00FFUL) * s) >> 8;
+    uint32_t odd  = ((w >> 8) & 0x00FF00FFUL) * s;
+    return (even & 0x00FF00FFUL) | (odd & 0xFF00FF00UL);
+}
+
+/// scale the four bytes packed into one 32 bit word by a fifth one, the way
+///         scale8_video does, so that non-zero bytes stay non-zero unless
+///         scale is zero
+LIB8STATIC_ALWAYS_INLINE uint32_t scale8x4_video( uint32_t w, fract8 scale)
+{
+    uint32_t even = ((w & 0x00FF00FFUL) * scale) >> 8;
+    uint32_t odd  = ((w >> 8) & 0x00FF00FFUL) * scale;
+    uint32_t scaled = (even & 0x00FF00FFUL) | (odd & 0xFF00FF00UL);
+    if( !scale) return scaled;
+    // 0x01 in every non-zero byte (the scaled bytes are at most 254, so adding it can't carry)
+    uint32_t nonzero = ((w | ((w & 0x7F7F7F7FUL) + 0x7F7F7F7FUL)) >> 7) & 0x01010101UL;
+    return scaled + nonzero;
+}
+
+/// scale the four bytes packed into one 32 bit word in place, see scale8x4
+///
+///         THIS FUNCTION ALWAYS MODIFIES ITS ARGUMENT IN PLACE
+LIB8STATIC_ALWAYS_INLINE void nscale8x4( uint32_t& w, fract8 scale)
+{
+    w = scale8x4( w, scale);
+}
+
+/// scale the four bytes packed into one 32 bit word in place, see scale8x4_video
+///
+///         THIS FUNCTION ALWAYS MODIFIES ITS ARGUMENT IN PLACE
+LIB8STATIC_ALWAYS_INLINE void nscale8x4_video( uint32_t& w, fract8 scale)
+{
+    w = scale8x4_video( w, scale);
+}
+
 /// scale a 16-bit unsigned value by an 8-bit value,
 ///         considered as numerator of a fraction whose denominator
 ///         is 256. In other words, it computes i * (scale / 256)
@@ -3,22 +3,38 @@
 
 FASTLED_NAMESPACE_BEGIN
 
+// the permutation table of the noise hashing, Ken Perlin's original one
+#define NOISE_PERMUTATION 151,160,137,91,90,15, \
+   131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,8,99,37,240,21,10,23, \
+   190, 6,148,247,120,234,75,0,26,197,62,94,252,219,203,117,35,11,32,57,177,33, \
+   88,237,149,56,87,174,20,125,136,171,168, 68,175,74,165,71,134,139,48,27,166, \
+   77,146,158,231,83,111,229,122,60,211,133,230,220,105,92,41,55,46,245,40,244, \
+   102,143,54, 65,25,63,161, 1,216,80,73,209,76,132,187,208, 89,18,169,200,196, \
+   135,130,116,188,159,86,164,100,109,198,173,186, 3,64,52,217,226,250,124,123, \
+   5,202,38,147,118,126,255,82,85,212,207,206,59,227,47,16,58,17,182,189,28,42, \
+   223,183,170,213,119,248,152, 2,44,154,163, 70,221,153,101,155,167, 43,172,9, \
+   129,22,39,253, 19,98,108,110,79,113,224,232,178,185, 112,104,218,246,97,228, \
+   251,34,242,193,238,210,144,12,191,179,162,241, 81,51,145,235,249,14,239,107, \
+   49,192,214, 31,181,199,106,157,184, 84,204,176,115,121,50,45,127, 4,150,254, \
+   138,236,205,93,222,114,67,29,24,72,243,141,128,195,78,66,215,61,156,180
+
+#if FASTLED_NOISE_RAM_TABLE == 1
+// The table repeated twice and kept in ram: with 512 entries the sums of hashes and coordinates never run past the
+// end, so the hashing can use full width index math instead of wrapping every sum to 8 bits.  Comes out the same.
+#ifndef FASTLED_NOISE_TABLE_ATTR
+#define FASTLED_NOISE_TABLE_ATTR
+#endif
+#define P(x) (p[(x)])
+typedef unsigned int noise_hash_t;
+
+FASTLED_NOISE_TABLE_ATTR static uint8_t const p[512] = { NOISE_PERMUTATION, NOISE_PERMUTATION };
+#else
 #define P(x) FL_PGM_READ_BYTE_NEAR(p + x)
+typedef uint8_t noise_hash_t;
 
-FL_PROGMEM static uint8_t const p[] = { 151,160,137,91,90,15,
-   131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,8,99,37,240,21,10,23,
-   190, 6,148,247,120,234,75,0,26,197,62,94,252,219,203,117,35,11,32,57,177,33,
-   88,237,149,56,87,174,20,125,136,171,168, 68,175,74,165,71,134,139,48,27,166,
-   77,146,158,231,83,111,229,122,60,211,133,230,220,105,92,41,55,46,245,40,244,
-   102,143,54, 65,25,63,161, 1,216,80,73,209,76,132,187,208, 89,18,169,200,196,
-   135,130,116,188,159,86,164,100,109,198,173,186, 3,64,52,217,226,250,124,123,
-   5,202,38,147,118,126,255,82,85,212,207,206,59,227,47,16,58,17,182,189,28,42,
-   223,183,170,213,119,248,152, 2,44,154,163, 70,221,153,101,155,167, 43,172,9,
-   129,22,39,253, 19,98,108,110,79,113,224,232,178,185, 112,104,218,246,97,228,
-   251,34,242,193,238,210,144,12,191,179,162,241, 81,51,145,235,249,14,239,107,
-   49,192,214, 31,181,199,106,157,184, 84,204,176,115,121,50,45,127, 4,150,254,
-   138,236,205,93,222,114,67,29,24,72,243,141,128,195,78,66,215,61,156,180,151
-   };
+// with one extra entry for P(X+1)
+FL_PROGMEM static uint8_t const p[] = { NOISE_PERMUTATION, 151 };
+#endif
 
 
 #if FASTLED_NOISE_ALLOW_AVERAGE_TO_OVERFLOW == 1
@@ -62,6 +78,34 @@ static int16_t inline __attribute__((always_inline))  avg15_inline_avr_mul( int1
 #define FADE(x) scale16(x,x)
 #define LERP(a,b,u) lerp15by16(a,b,u)
 #endif
+
+#if (FASTLED_NOISE_32BIT == 1) && !defined(FADE_12)
+// Full width versions of lerp15by16 and avg15, for cores where 32-bit math is as cheap as 8-bit math: no 16-bit
+// intermediates to sign extend, and the interpolation picks its direction with a mask rather than a branch.  The
+// results are the same as the 16-bit versions'.
+static int32_t inline __attribute__((always_inline)) lerp15by16_32(int32_t a, int32_t b, uint32_t frac) {
+  int32_t delta = b - a;
+  int32_t sign = delta >> 31;
+  uint32_t magnitude = (delta ^ sign) - sign;
+#if FASTLED_SCALE8_FIXED == 1
+  int32_t scaled = (magnitude * (frac + 1)) >> 16;
+#else
+  int32_t scaled = (magnitude * frac) >> 16;
+#endif
+  return a + ((scaled ^ sign) - sign);
+}
+
+static int32_t inline __attribute__((always_inline)) avg15_32(int32_t i, int32_t j) {
+  return ((i + j) >> 1) + (i & 0x1);
+}
+
+#undef LERP
+#define LERP(a,b,u) lerp15by16_32(a,b,u)
+#if FASTLED_NOISE_ALLOW_AVERAGE_TO_OVERFLOW != 1
+#undef AVG15
+#define AVG15(U,V) (avg15_32((U),(V)))
+#endif
+#endif
 static int16_t inline __attribute__((always_inline))  grad16(uint8_t hash, int16_t x, int16_t y, int16_t z) {
 #if 0
   switch(hash & 0xF) {
@@ -281,12 +325,12 @@ int16_t inoise16_raw(uint32_t x, uint32_t y, uint32_t z)
   uint8_t Z = (z>>16)&0xFF;
 
   // Hash cube corner coordinates
-  uint8_t A = P(X)+Y;
-  uint8_t AA = P(A)+Z;
-  uint8_t AB = P(A+1)+Z;
-  uint8_t B = P(X+1)+Y;
-  uint8_t BA = P(B) + Z;
-  uint8_t BB = P(B+1)+Z;
+  noise_hash_t A = P(X)+Y;
+  noise_hash_t AA = P(A)+Z;
+  noise_hash_t AB = P(A+1)+Z;
+  noise_hash_t B = P(X+1)+Y;
+  noise_hash_t BA = P(B) + Z;
+  noise_hash_t BB = P(B+1)+Z;
 
   // Get the relative position of the point in the cube
   uint16_t u = x & 0xFFFF;
@@ -317,8 +361,9 @@ int16_t inoise16_raw(uint32_t x, uint32_t y, uint32_t z)
   return ans;
 }
 
-uint16_t inoise16(uint32_t x, uint32_t y, uint32_t z) {
-  int32_t ans = inoise16_raw(x,y,z);
+// the scaling from inoise16_raw(x,y,z) to inoise16(x,y,z), shared with CNoise16Row
+static uint16_t inline __attribute__((always_inline)) scale_noise16_3d(int16_t raw) {
+  int32_t ans = raw;
   ans = ans + 19052L;
   uint32_t pan = ans;
   // pan = (ans * 220L) >> 7.  That's the same as:
@@ -327,12 +372,67 @@ uint16_t inoise16(uint32_t x, uint32_t y, uint32_t z) {
   // since we're returning the 'middle' 16 out of a 32-bit value anyway.
   pan *= 440L;
   return (pan>>8);
+}
+
+uint16_t inoise16(uint32_t x, uint32_t y, uint32_t z) {
+  return scale_noise16_3d(inoise16_raw(x,y,z));
 
   // // return scale16by8(pan,220)<<1;
   // return ((inoise16_raw(x,y,z)+19052)*220)>>7;
   // return scale16by8(inoise16_raw(x,y,z)+19052,220)<<1;
 }
 
+// Four points at the same y and z.  The y/z part of the math is shared, and the four cubes get hashed before any of
+// the interpolation, so the four independent chains of lerps can be interleaved by the compiler (or the core).
+void inoise16_raw_x4(const uint32_t *x, uint32_t y, uint32_t z, int16_t *pResult)
+{
+  uint8_t Y = (y>>16)&0xFF;
+  uint8_t Z = (z>>16)&0xFF;
+  uint16_t v = y & 0xFFFF;
+  uint16_t w = z & 0xFFFF;
+  int16_t yy = (v >> 1) & 0x7FFF;
+  int16_t zz = (w >> 1) & 0x7FFF;
+  uint16_t N = 0x8000L;
+  v = FADE(v); w = FADE(w);
+
+  noise_hash_t AA[4], AB[4], BA[4], BB[4];
+  uint16_t u[4];
+  int16_t xx[4];
+  for(uint8_t i = 0; i < 4; i++) {
+    uint8_t X = (x[i]>>16)&0xFF;
+    noise_hash_t A = P(X)+Y;
+    AA[i] = P(A)+Z;
+    AB[i] = P(A+1)+Z;
+    noise_hash_t B = P(X+1)+Y;
+    BA[i] = P(B) + Z;
+    BB[i] = P(B+1)+Z;
+
+    u[i] = x[i] & 0xFFFF;
+    xx[i] = (u[i] >> 1) & 0x7FFF;
+    u[i] = FADE(u[i]);
+  }
+
+  for(uint8_t i = 0; i < 4; i++) {
+    int16_t X1 = LERP(grad16(P(AA[i]), xx[i], yy, zz), grad16(P(BA[i]), xx[i] - N, yy, zz), u[i]);
+    int16_t X2 = LERP(grad16(P(AB[i]), xx[i], yy-N, zz), grad16(P(BB[i]), xx[i] - N, yy - N, zz), u[i]);
+    int16_t X3 = LERP(grad16(P(AA[i]+1), xx[i], yy, zz-N), grad16(P(BA[i]+1), xx[i] - N, yy, zz-N), u[i]);
+    int16_t X4 = LERP(grad16(P(AB[i]+1), xx[i], yy-N, zz-N), grad16(P(BB[i]+1), xx[i] - N, yy - N, zz - N), u[i]);
+
+    int16_t Y1 = LERP(X1,X2,v);
+    int16_t Y2 = LERP(X3,X4,v);
+
+    pResult[i] = LERP(Y1,Y2,w);
+  }
+}
+
+void inoise16_x4(const uint32_t *x, uint32_t y, uint32_t z, uint16_t *pResult) {
+  int16_t raw[4];
+  inoise16_raw_x4(x,y,z,raw);
+  for(uint8_t i = 0; i < 4; i++) {
+    pResult[i] = scale_noise16_3d(raw[i]);
+  }
+}
+
 int16_t inoise16_raw(uint32_t x, uint32_t y)
 {
   // Find the unit cube containing the point
@@ -340,12 +440,12 @@ int16_t inoise16_raw(uint32_t x, uint32_t y)
   uint8_t Y = y>>16;
 
   // Hash cube corner coordinates
-  uint8_t A = P(X)+Y;
-  uint8_t AA = P(A);
-  uint8_t AB = P(A+1);
-  uint8_t B = P(X+1)+Y;
-  uint8_t BA = P(B);
-  uint8_t BB = P(B+1);
+  noise_hash_t A = P(X)+Y;
+  noise_hash_t AA = P(A);
+  noise_hash_t AB = P(A+1);
+  noise_hash_t B = P(X+1)+Y;
+  noise_hash_t BA = P(B);
+  noise_hash_t BB = P(B+1);
 
   // Get the relative position of the point in the cube
   uint16_t u = x & 0xFFFF;
@@ -366,8 +466,9 @@ int16_t inoise16_raw(uint32_t x, uint32_t y)
   return ans;
 }
 
-uint16_t inoise16(uint32_t x, uint32_t y) {
-  int32_t ans = inoise16_raw(x,y);
+// the scaling from inoise16_raw(x,y) to inoise16(x,y), shared with CNoise16Row2d
+static uint16_t inline __attribute__((always_inline)) scale_noise16_2d(int16_t raw) {
+  int32_t ans = raw;
   ans = ans + 17308L;
   uint32_t pan = ans;
   // pan = (ans * 242L) >> 7.  That's the same as:
@@ -376,7 +477,11 @@ uint16_t inoise16(uint32_t x, uint32_t y) {
   // since we're returning the 'middle' 16 out of a 32-bit value anyway.
   pan *= 484L;
   return (pan>>8);
-    
+}
+
+uint16_t inoise16(uint32_t x, uint32_t y) {
+  return scale_noise16_2d(inoise16_raw(x,y));
+
   // return (uint32_t)(((int32_t)inoise16_raw(x,y)+(uint32_t)17308)*242)>>7;
   // return scale16by8(inoise16_raw(x,y)+17308,242)<<1;
 }
@@ -387,10 +492,10 @@ int16_t inoise16_raw(uint32_t x)
   uint8_t X = x>>16;
 
   // Hash cube corner coordinates
-  uint8_t A = P(X);
-  uint8_t AA = P(A);
-  uint8_t B = P(X+1);
-  uint8_t BA = P(B);
+  noise_hash_t A = P(X);
+  noise_hash_t AA = P(A);
+  noise_hash_t B = P(X+1);
+  noise_hash_t BA = P(B);
 
   // Get the relative position of the point in the cube
   uint16_t u = x & 0xFFFF;
@@ -418,12 +523,12 @@ int8_t inoise8_raw(uint16_t x, uint16_t y, uint16_t z)
   uint8_t Z = z>>8;
 
   // Hash cube corner coordinates
-  uint8_t A = P(X)+Y;
-  uint8_t AA = P(A)+Z;
-  uint8_t AB = P(A+1)+Z;
-  uint8_t B = P(X+1)+Y;
-  uint8_t BA = P(B) + Z;
-  uint8_t BB = P(B+1)+Z;
+  noise_hash_t A = P(X)+Y;
+  noise_hash_t AA = P(A)+Z;
+  noise_hash_t AB = P(A+1)+Z;
+  noise_hash_t B = P(X+1)+Y;
+  noise_hash_t BA = P(B) + Z;
+  noise_hash_t BB = P(B+1)+Z;
 
   // Get the relative position of the point in the cube
   uint8_t u = x;
@@ -463,12 +568,12 @@ int8_t inoise8_raw(uint16_t x, uint16_t y)
   uint8_t Y = y>>8;
 
   // Hash cube corner coordinates
-  uint8_t A = P(X)+Y;
-  uint8_t AA = P(A);
-  uint8_t AB = P(A+1);
-  uint8_t B = P(X+1)+Y;
-  uint8_t BA = P(B);
-  uint8_t BB = P(B+1);
+  noise_hash_t A = P(X)+Y;
+  noise_hash_t AA = P(A);
+  noise_hash_t AB = P(A+1);
+  noise_hash_t B = P(X+1)+Y;
+  noise_hash_t BA = P(B);
+  noise_hash_t BB = P(B+1);
 
   // Get the relative position of the point in the cube
   uint8_t u = x;
@@ -501,10 +606,10 @@ int8_t inoise8_raw(uint16_t x)
   uint8_t X = x>>8;
 
   // Hash cube corner coordinates
-  uint8_t A = P(X);
-  uint8_t AA = P(A);
-  uint8_t B = P(X+1);
-  uint8_t BA = P(B);
+  noise_hash_t A = P(X);
+  noise_hash_t AA = P(A);
+  noise_hash_t B = P(X+1);
+  noise_hash_t BA = P(B);
 
   // Get the relative position of the point in the cube
   uint8_t u = x;
@@ -525,6 +630,391 @@ uint8_t inoise8(uint16_t x) {
   return scale8(69+inoise8_raw(x), 255)<<1;
 }
 
+// Simplex noise.  The point gets skewed onto a lattice of triangles (2d) or tetrahedra (3d), and only the 3 or 4
+// corners of the one it's in contribute, each one's gradient falling off with the distance from it - no fade curves
+// and no lerps.  The 3d lattice is the usual one, skewed by 1/3 and unskewed by 1/6.  The 2d one is skewed by 1/3
+// and unskewed by 1/5 rather than by the irrational factors of equilateral triangles, so its triangles come out a
+// little stretched along the diagonal - but the skewing is exact, and both lattices repeat every 768 units, so the
+// coordinates get wrapped at a multiple of that to keep all of the math in 32 bits.  The offsets from the corners
+// are in Q15 and the contributions in Q31, scaled to the range of the matching inoise16_raw at the end.
+// small enough for the sums of the 3d cell coordinates to fit 16 bits
+#define SIMPLEX_WRAP (768 * 14)
+
+static uint32_t inline __attribute__((always_inline)) simplex_wrap(uint32_t v) {
+  uint16_t V = v >> 16;
+  if(V >= SIMPLEX_WRAP) { V %= SIMPLEX_WRAP; }
+  return ((uint32_t)V << 16) | (v & 0xFFFF);
+}
+
+static uint8_t inline __attribute__((always_inline)) simplex_hash(uint8_t I, uint8_t J) {
+  noise_hash_t A = P(I)+J;
+  return P(A);
+}
+
+static uint8_t inline __attribute__((always_inline)) simplex_hash(uint8_t I, uint8_t J, uint8_t K) {
+  noise_hash_t A = P(I)+J;
+  noise_hash_t AA = P(A)+K;
+  return P(AA);
+}
+
+// (0.5 - d^2)^4 times the gradient of a corner d away from the point, 0 outside of its radius.  The offsets stay
+// under 1.3 or so, so their squares fit, and inside the radius they fit the gradients' 16 bits.
+static int32_t inline __attribute__((always_inline)) simplex_corner(uint8_t hash, int32_t dx, int32_t dy) {
+  int32_t t = 16384 - ((dx*dx) >> 15) - ((dy*dy) >> 15);
+  if(t <= 0) { return 0; }
+  t = (t*t) >> 15;
+  return ((t*t) >> 12) * grad16(hash, dx, dy);
+}
+
+static int32_t inline __attribute__((always_inline)) simplex_corner(uint8_t hash, int32_t dx, int32_t dy, int32_t dz) {
+  int32_t t = 16384 - ((dx*dx) >> 15) - ((dy*dy) >> 15) - ((dz*dz) >> 15);
+  if(t <= 0) { return 0; }
+  t = (t*t) >> 15;
+  return ((t*t) >> 12) * grad16(hash, dx, dy, dz);
+}
+
+// the sums of the contributions peak at around +/-5.6e7 (3d) and +/-5.7e7 (2d), scaled so those come out at the
+// edges of the inoise16_raw ranges
+#define SIMPLEX_SCALE_3D 5700
+#define SIMPLEX_SCALE_2D 5060
+
+static int16_t inline __attribute__((always_inline)) simplex_scale(int32_t n, int32_t scale, int16_t range) {
+  n = ((n >> 12) * scale) >> 12;
+  return (n > range) ? range : ((n < -range) ? -range : n);
+}
+
+// The 3d simplex noise, for coordinates that are wrapped already.  It keeps the corner hashes of the last simplex
+// around, the scanline evaluators below hand it a row of points that mostly stay in the same one.
+class CSimplex3d {
+  // the cell and the tetrahedron in it the hashes are for
+  uint32_t key;
+  uint8_t h0, h1, h2, h3;
+
+public:
+  CSimplex3d() : key(0xFFFFFFFF) {}
+
+  int16_t raw(uint32_t x, uint32_t y, uint32_t z) {
+    // Skew onto the lattice to find the cell, and unskew its origin back for the offsets from it
+    uint32_t s = (x + y + z) / 3;
+    uint32_t i = (x + s) >> 16;
+    uint32_t j = (y + s) >> 16;
+    uint32_t k = (z + s) >> 16;
+    uint32_t t = ((i + j + k) << 16) / 6;
+    int32_t x0 = (int32_t)(x + t - (i << 16)) >> 1;
+    int32_t y0 = (int32_t)(y + t - (j << 16)) >> 1;
+    int32_t z0 = (int32_t)(z + t - (k << 16)) >> 1;
+
+    // The tetrahedron the point is in, from the order of the offsets: the second and third corners are one and two
+    // steps along the axes with the largest offsets (bits 0-2 for x, y and z)
+    // steps, looked up by x >= y, y >= z and x >= z rather than branched to.  Two of the combinations can't happen.
+    static const uint8_t steps[8] = { 0x64, 0x54, 0x62, 0x00, 0x00, 0x51, 0x32, 0x31 };
+    uint8_t c = steps[(x0 >= y0) | ((y0 >= z0) << 1) | ((x0 >= z0) << 2)];
+    uint8_t c1 = c & 0x0F, c2 = c >> 4;
+
+    uint8_t I = i, J = j, K = k;
+    uint32_t cell = I | ((uint32_t)J << 8) | ((uint32_t)K << 16) | ((uint32_t)c1 << 24) | ((uint32_t)c2 << 28);
+    if(cell != key) {
+      h0 = simplex_hash(I, J, K);
+      h1 = simplex_hash(I + (c1 & 1), J + ((c1 >> 1) & 1), K + (c1 >> 2));
+      h2 = simplex_hash(I + (c2 & 1), J + ((c2 >> 1) & 1), K + (c2 >> 2));
+      h3 = simplex_hash(I+1, J+1, K+1);
+      key = cell;
+    }
+
+    // Every step along the lattice moves the unskewed corner back 1/6 on all the axes
+    const int32_t N = 0x8000L;
+    const int32_t G1 = 5461, G2 = 10923, G3 = 16384;
+    int32_t n = simplex_corner(h0, x0, y0, z0);
+    n += simplex_corner(h1, x0 - ((c1 & 1) ? N : 0) + G1, y0 - ((c1 & 2) ? N : 0) + G1, z0 - ((c1 & 4) ? N : 0) + G1);
+    n += simplex_corner(h2, x0 - ((c2 & 1) ? N : 0) + G2, y0 - ((c2 & 2) ? N : 0) + G2, z0 - ((c2 & 4) ? N : 0) + G2);
+    n += simplex_corner(h3, x0 - N + G3, y0 - N + G3, z0 - N + G3);
+
+    return simplex_scale(n, SIMPLEX_SCALE_3D, 19052);
+  }
+};
+
+int16_t isnoise16_raw(uint32_t x, uint32_t y, uint32_t z) {
+  CSimplex3d simplex;
+  return simplex.raw(simplex_wrap(x), simplex_wrap(y), simplex_wrap(z));
+}
+
+uint16_t isnoise16(uint32_t x, uint32_t y, uint32_t z) {
+  return scale_noise16_3d(isnoise16_raw(x,y,z));
+}
+
+int16_t isnoise16_raw(uint32_t x, uint32_t y)
+{
+  x = simplex_wrap(x); y = simplex_wrap(y);
+
+  uint32_t s = (x + y) / 3;
+  uint32_t i = (x + s) >> 16;
+  uint32_t j = (y + s) >> 16;
+  uint32_t t = ((i + j) << 16) / 5;
+  int32_t x0 = (int32_t)(x + t - (i << 16)) >> 1;
+  int32_t y0 = (int32_t)(y + t - (j << 16)) >> 1;
+
+  // Every step along the lattice moves the unskewed corner back 1/5 on both axes
+  const int32_t N = 0x8000L;
+  const int32_t G1 = 6554, G2 = 13107;
+  uint8_t I = i, J = j;
+  int32_t n = simplex_corner(simplex_hash(I, J), x0, y0);
+  if(x0 > y0) {
+    n += simplex_corner(simplex_hash(I+1, J), x0 - N + G1, y0 + G1);
+  } else {
+    n += simplex_corner(simplex_hash(I, J+1), x0 + G1, y0 - N + G1);
+  }
+  n += simplex_corner(simplex_hash(I+1, J+1), x0 - N + G2, y0 - N + G2);
+
+  return simplex_scale(n, SIMPLEX_SCALE_2D, 17308);
+}
+
+uint16_t isnoise16(uint32_t x, uint32_t y) {
+  return scale_noise16_2d(isnoise16_raw(x,y));
+}
+
+// the 8 bit versions evaluate the same noise at 8.8 coordinates - which never need wrapping - scaled to the range
+// of inoise8_raw
+static int8_t inline __attribute__((always_inline)) simplex_raw8_3d(int16_t raw) { return ((int32_t)raw * 255) >> 16; }
+
+int8_t isnoise8_raw(uint16_t x, uint16_t y, uint16_t z) {
+  CSimplex3d simplex;
+  return simplex_raw8_3d(simplex.raw((uint32_t)x << 8, (uint32_t)y << 8, (uint32_t)z << 8));
+}
+
+uint8_t isnoise8(uint16_t x, uint16_t y, uint16_t z) {
+  return scale8(76+isnoise8_raw(x,y,z),215)<<1;
+}
+
+int8_t isnoise8_raw(uint16_t x, uint16_t y) {
+  return ((int32_t)isnoise16_raw((uint32_t)x << 8, (uint32_t)y << 8) * 261) >> 16;
+}
+
+uint8_t isnoise8(uint16_t x, uint16_t y) {
+  return scale8(69+isnoise8_raw(x,y),237)<<1;
+}
+
+static ENoiseBasis noise_basis = NOISE_PERLIN;
+
+void set_noise_basis(ENoiseBasis basis) { noise_basis = basis; }
+ENoiseBasis get_noise_basis() { return noise_basis; }
+
+// Scanline evaluators for the 3d noise functions.  The raw 2d fills evaluate inoise8/inoise16(x, y, time) for a
+// row of x values at a fixed y and time, so everything that only depends on y and z (the cell's y/z coordinates,
+// their fractions and fades) is worked out once per row, and the eight corner hashes of the current lattice cell
+// are kept while x stays within it - with low scales many pixels in a row fall into the same cell.  The per pixel
+// math is the same as in inoise16_raw/inoise8_raw, in the same order, so the results are identical.  With the
+// simplex basis the rows hand every pixel to isnoise16_raw/isnoise8_raw instead - the skewing mixes x into the
+// other coordinates, so there's nothing to keep from one pixel to the next.
+class CNoise16Row {
+  uint8_t Y, Z;
+  int16_t yy, zz;
+  uint16_t v, w;
+  uint16_t cell;
+  uint8_t hAA, hBA, hAB, hBB, hAA1, hBA1, hAB1, hBB1;
+  // the simplex basis's wrapped 16.16 y and z
+  uint32_t sy, sz;
+  bool simplex;
+  CSimplex3d snoise;
+
+  void enterCell(uint8_t X) {
+    noise_hash_t A = P(X)+Y;
+    noise_hash_t AA = P(A)+Z;
+    noise_hash_t AB = P(A+1)+Z;
+    noise_hash_t B = P(X+1)+Y;
+    noise_hash_t BA = P(B) + Z;
+    noise_hash_t BB = P(B+1)+Z;
+    hAA = P(AA); hBA = P(BA); hAB = P(AB); hBB = P(BB);
+    hAA1 = P(AA+1); hBA1 = P(BA+1); hAB1 = P(AB+1); hBB1 = P(BB+1);
+    cell = X;
+  }
+
+public:
+  // an evaluator without a row, to be assigned one before use
+  CNoise16Row() : cell(0x100), simplex(false) {}
+
+  CNoise16Row(uint32_t y, uint32_t z) : cell(0x100), sy(simplex_wrap(y)), sz(simplex_wrap(z)), simplex(noise_basis == NOISE_SIMPLEX) {
+    Y = (y>>16)&0xFF;
+    Z = (z>>16)&0xFF;
+    v = y & 0xFFFF;
+    w = z & 0xFFFF;
+    yy = (v >> 1) & 0x7FFF;
+    zz = (w >> 1) & 0x7FFF;
+    v = FADE(v); w = FADE(w);
+  }
+
+  int16_t raw(uint32_t x) {
+    if(simplex) { return snoise.raw(simplex_wrap(x), sy, sz); }
+    uint8_t X = (x>>16)&0xFF;
+    if(X != cell) { enterCell(X); }
+
+    uint16_t u = x & 0xFFFF;
+    int16_t xx = (u >> 1) & 0x7FFF;
+    uint16_t N = 0x8000L;
+
+    u = FADE(u);
+
+    int16_t X1 = LERP(grad16(hAA, xx, yy, zz), grad16(hBA, xx - N, yy, zz), u);
+    int16_t X2 = LERP(grad16(hAB, xx, yy-N, zz), grad16(hBB, xx - N, yy - N, zz), u);
+    int16_t X3 = LERP(grad16(hAA1, xx, yy, zz-N), grad16(hBA1, xx - N, yy, zz-N), u);
+    int16_t X4 = LERP(grad16(hAB1, xx, yy-N, zz-N), grad16(hBB1, xx - N, yy - N, zz - N), u);
+
+    int16_t Y1 = LERP(X1,X2,v);
+    int16_t Y2 = LERP(X3,X4,v);
+
+    return LERP(Y1,Y2,w);
+  }
+
+  uint16_t noise(uint32_t x) { return scale_noise16_3d(raw(x)); }
+};
+
+class CNoise8Row {
+  uint8_t Y, Z;
+  int8_t yy, zz;
+  uint8_t v, w;
+  uint16_t cell;
+  uint8_t hAA, hBA, hAB, hBB, hAA1, hBA1, hAB1, hBB1;
+  // the simplex basis's wrapped 16.16 y and z
+  uint32_t sy, sz;
+  bool simplex;
+  CSimplex3d snoise;
+
+  void enterCell(uint8_t X) {
+    noise_hash_t A = P(X)+Y;
+    noise_hash_t AA = P(A)+Z;
+    noise_hash_t AB = P(A+1)+Z;
+    noise_hash_t B = P(X+1)+Y;
+    noise_hash_t BA = P(B) + Z;
+    noise_hash_t BB = P(B+1)+Z;
+    hAA = P(AA); hBA = P(BA); hAB = P(AB); hBB = P(BB);
+    hAA1 = P(AA+1); hBA1 = P(BA+1); hAB1 = P(AB+1); hBB1 = P(BB+1);
+    cell = X;
+  }
+
+public:
+  CNoise8Row(uint16_t y, uint16_t z) : cell(0x100), sy((uint32_t)y << 8), sz((uint32_t)z << 8), simplex(noise_basis == NOISE_SIMPLEX) {
+    Y = y>>8;
+    Z = z>>8;
+    yy = ((uint8_t)(y)>>1) & 0x7F;
+    zz = ((uint8_t)(z)>>1) & 0x7F;
+    v = scale8((uint8_t)y,(uint8_t)y);
+    w = scale8((uint8_t)z,(uint8_t)z);
+  }
+
+  int8_t raw(uint16_t x) {
+    if(simplex) { return simplex_raw8_3d(snoise.raw((uint32_t)x << 8, sy, sz)); }
+    uint8_t X = x>>8;
+    if(X != cell) { enterCell(X); }
+
+    uint8_t u = x;
+    int8_t xx = ((uint8_t)(x)>>1) & 0x7F;
+    uint8_t N = 0x80;
+
+    u = scale8(u,u);
+
+    int8_t X1 = lerp7by8(grad8(hAA, xx, yy, zz), grad8(hBA, xx - N, yy, zz), u);
+    int8_t X2 = lerp7by8(grad8(hAB, xx, yy-N, zz), grad8(hBB, xx - N, yy - N, zz), u);
+    int8_t X3 = lerp7by8(grad8(hAA1, xx, yy, zz-N), grad8(hBA1, xx - N, yy, zz-N), u);
+    int8_t X4 = lerp7by8(grad8(hAB1, xx, yy-N, zz-N), grad8(hBB1, xx - N, yy - N, zz - N), u);
+
+    int8_t Y1 = lerp7by8(X1,X2,v);
+    int8_t Y2 = lerp7by8(X3,X4,v);
+
+    return lerp7by8(Y1,Y2,w);
+  }
+
+  uint8_t noise(uint16_t x) { return scale8(76+(raw(x)),215)<<1; }
+};
+
+// The same for the 2d noise functions, evaluated along x at a fixed y
+class CNoise16Row2d {
+  uint8_t Y;
+  int16_t yy;
+  uint16_t v;
+  uint16_t cell;
+  uint8_t hAA, hBA, hAB, hBB;
+
+  void enterCell(uint8_t X) {
+    noise_hash_t A = P(X)+Y;
+    noise_hash_t AA = P(A);
+    noise_hash_t AB = P(A+1);
+    noise_hash_t B = P(X+1)+Y;
+    noise_hash_t BA = P(B);
+    noise_hash_t BB = P(B+1);
+    hAA = P(AA); hBA = P(BA); hAB = P(AB); hBB = P(BB);
+    cell = X;
+  }
+
+public:
+  CNoise16Row2d(uint32_t y) : cell(0x100) {
+    Y = y>>16;
+    v = y & 0xFFFF;
+    yy = (v >> 1) & 0x7FFF;
+    v = FADE(v);
+  }
+
+  int16_t raw(uint32_t x) {
+    uint8_t X = x>>16;
+    if(X != cell) { enterCell(X); }
+
+    uint16_t u = x & 0xFFFF;
+    int16_t xx = (u >> 1) & 0x7FFF;
+    uint16_t N = 0x8000L;
+
+    u = FADE(u);
+
+    int16_t X1 = LERP(grad16(hAA, xx, yy), grad16(hBA, xx - N, yy), u);
+    int16_t X2 = LERP(grad16(hAB, xx, yy-N), grad16(hBB, xx - N, yy - N), u);
+
+    return LERP(X1,X2,v);
+  }
+
+  uint16_t noise(uint32_t x) { return scale_noise16_2d(raw(x)); }
+};
+
+class CNoise8Row2d {
+  uint8_t Y;
+  int8_t yy;
+  uint8_t v;
+  uint16_t cell;
+  uint8_t hAA, hBA, hAB, hBB;
+
+  void enterCell(uint8_t X) {
+    noise_hash_t A = P(X)+Y;
+    noise_hash_t AA = P(A);
+    noise_hash_t AB = P(A+1);
+    noise_hash_t B = P(X+1)+Y;
+    noise_hash_t BA = P(B);
+    noise_hash_t BB = P(B+1);
+    hAA = P(AA); hBA = P(BA); hAB = P(AB); hBB = P(BB);
+    cell = X;
+  }
+
+public:
+  CNoise8Row2d(uint16_t y) : cell(0x100) {
+    Y = y>>8;
+    yy = ((uint8_t)(y)>>1) & 0x7F;
+    v = scale8((uint8_t)y,(uint8_t)y);
+  }
+
+  int8_t raw(uint16_t x) {
+    uint8_t X = x>>8;
+    if(X != cell) { enterCell(X); }
+
+    uint8_t u = x;
+    int8_t xx = ((uint8_t)(x)>>1) & 0x7F;
+    uint8_t N = 0x80;
+
+    u = scale8(u,u);
+
+    int8_t X1 = lerp7by8(grad8(hAA, xx, yy), grad8(hBA, xx - N, yy), u);
+    int8_t X2 = lerp7by8(grad8(hAB, xx, yy-N), grad8(hBB, xx - N, yy - N), u);
+
+    return lerp7by8(X1,X2,v);
+  }
+
+  uint8_t noise(uint16_t x) { return scale8(69+raw(x),237)<<1; }
+};
+
 // struct q44 {
 //   uint8_t i:4;
 //   uint8_t f:4;
@@ -539,12 +1029,17 @@ uint8_t inoise8(uint16_t x) {
 //     return (v *mulby44.i)  + ((v * mulby44.f) >> 4);
 // }
 
-void fill_raw_noise8(uint8_t *pData, uint8_t num_points, uint8_t octaves, uint16_t x, int scale, uint16_t time) {
+// the 1d raw fills are templated on the type of the point counter, so fills of up to 255 points keep using an
+// 8-bit loop
+template<typename COUNT>
+static void raw_noise8(uint8_t *pData, COUNT num_points, uint8_t octaves, uint16_t x, int scale, uint16_t time) {
   uint32_t _xx = x;
   uint32_t scx = scale;
   for(int o = 0; o < octaves; o++) {
-    for(int i = 0,xx=_xx; i < num_points; i++, xx+=scx) {
-          pData[i] = qadd8(pData[i],inoise8(xx,time)>>o);
+    COUNT i = 0;
+    CNoise8Row2d row(time);
+    for(int xx=_xx; i < num_points; i++, xx+=scx) {
+          pData[i] = qadd8(pData[i],row.noise(xx)>>o);
     }
 
     _xx <<= 1;
@@ -552,12 +1047,23 @@ void fill_raw_noise8(uint8_t *pData, uint8_t num_points, uint8_t octaves, uint16
   }
 }
 
-void fill_raw_noise16into8(uint8_t *pData, uint8_t num_points, uint8_t octaves, uint32_t x, int scale, uint32_t time) {
+void fill_raw_noise8(uint8_t *pData, uint16_t num_points, uint8_t octaves, uint16_t x, int scale, uint16_t time) {
+  if(num_points <= 255) {
+    raw_noise8<uint8_t>(pData, num_points, octaves, x, scale, time);
+  } else {
+    raw_noise8<uint16_t>(pData, num_points, octaves, x, scale, time);
+  }
+}
+
+template<typename COUNT>
+static void raw_noise16into8(uint8_t *pData, COUNT num_points, uint8_t octaves, uint32_t x, int scale, uint32_t time) {
   uint32_t _xx = x;
   uint32_t scx = scale;
   for(int o = 0; o < octaves; o++) {
-    for(int i = 0,xx=_xx; i < num_points; i++, xx+=scx) {
-      uint32_t accum = (inoise16(xx,time))>>o;
+    COUNT i = 0;
+    CNoise16Row2d row(time);
+    for(int xx=_xx; i < num_points; i++, xx+=scx) {
+      uint32_t accum = (row.noise(xx))>>o;
       accum += (pData[i]<<8);
       if(accum > 65535) { accum = 65535; }
       pData[i] = accum>>8;
@@ -568,9 +1074,254 @@ void fill_raw_noise16into8(uint8_t *pData, uint8_t num_points, uint8_t octaves,
   }
 }
 
-void fill_raw_2dnoise8(uint8_t *pData, int width, int height, uint8_t octaves, q44 freq44, fract8 amplitude, int skip, uint16_t x, int scalex, uint16_t y, int scaley, uint16_t time) {
+void fill_raw_noise16into8(uint8_t *pData, uint16_t num_points, uint8_t octaves, uint32_t x, int scale, uint32_t time) {
+  if(num_points <= 255) {
+    raw_noise16into8<uint8_t>(pData, num_points, octaves, x, scale, time);
+  } else {
+    raw_noise16into8<uint16_t>(pData, num_points, octaves, x, scale, time);
+  }
+}
+
+// The recursive 2d raw fills below run once per octave, every level sweeping the whole buffer and blending over the
+// one below it.  The octave stacks evaluate all of the octaves for a row before moving on to the next one instead,
+// applying the levels to each pixel in the same order the recursion does - deepest first, each level blending over
+// the one below - so the results are identical while the buffer only gets written once.  The lowest level always has
+// the full amplitude, so whatever was in the buffer beforehand doesn't matter.  The stacks keep a few rows of noise
+// per octave on the stack, fills that would need more than NOISE_MAX_SCRATCH bytes for that fall back to the
+// recursive versions.
+#define NOISE_MAX_OCTAVES 8
+#if defined(__AVR__)
+#define NOISE_MAX_SCRATCH 128
+#else
+#define NOISE_MAX_SCRATCH 2048
+#endif
+
+// The octaves of fill_raw_2dnoise8.  Level k evaluates the noise at every pixel, but writes it to a skip+k square
+// of pixels starting there, so a pixel gets blended with the noise of every level k pixel up to skip+k-1 rows and
+// columns before it.  The last skip+k rows of noise are kept around for each level.
+class CNoiseOctaves8 {
+  struct Level {
+    uint16_t x, y;
+    int scalex, scaley;
+    int skip;
+    fract8 amplitude;
+    uint8_t *pRows;
+    int first, last;
+  };
+  Level L[NOISE_MAX_OCTAVES];
+  uint8_t n;
+  int width;
+  uint16_t time;
+
+  void fillRow(Level & l, int i) {
+    uint16_t y = l.y + ((uint32_t)i * (uint32_t)l.scaley);
+    CNoise8Row row(y,time);
+    uint8_t *pRow = l.pRows + ((i % l.skip) * width);
+    uint16_t xx = l.x;
+    for(int j = 0; j < width; j++, xx+=l.scalex) {
+      uint8_t noise_base = row.noise(xx);
+      noise_base = (0x80 & noise_base) ? (noise_base - 127) : (127 - noise_base);
+      pRow[j] = scale8(noise_base<<1,l.amplitude);
+    }
+  }
+
+public:
+  // the scratch space needed, or -1 if the stack is too deep
+  static int scratch(int width, uint8_t octaves, int skip) {
+    if(octaves > NOISE_MAX_OCTAVES || skip < 1) { return -1; }
+    int rows = 0;
+    for(uint8_t k = 0; k < octaves || k == 0; k++) { rows += skip + k; }
+    return rows * width;
+  }
+
+  CNoiseOctaves8(uint8_t *pScratch, int width, uint8_t octaves, q44 freq44, fract8 amplitude, int skip, uint16_t x, int scalex, uint16_t y, int scaley, uint16_t time)
+    : n((octaves > 1) ? octaves : 1), width(width), time(time) {
+    for(uint8_t k = 0; k < n; k++) {
+      Level & l = L[k];
+      l.x = x; l.y = y;
+      l.scalex = scalex * skip;
+      l.scaley = scaley * skip;
+      l.skip = skip;
+      // amplitude is always 255 on the lowest level
+      l.amplitude = (k == n-1) ? 255 : amplitude;
+      l.pRows = pScratch;
+      l.first = 1; l.last = 0;
+      pScratch += skip * width;
+
+      // the parameters the recursion passes down
+      x = x*freq44; scalex = freq44 * scalex;
+      y = y*freq44; scaley = freq44 * scaley;
+      skip++;
+    }
+  }
+
+  // the finished values of row r.  Rows should be asked for in order, up or down.
+  void row(int r, uint8_t *pOut) {
+    for(uint8_t k = 0; k < n; k++) {
+      Level & l = L[k];
+      int first = (r >= l.skip) ? (r - l.skip + 1) : 0;
+      for(int i = first; i <= r; i++) {
+        if(i < l.first || i > l.last) { fillRow(l,i); }
+      }
+      l.first = first; l.last = r;
+    }
+
+    // the levels are blended over each other a row at a time, which is still only one trip through the row
+    memset(pOut, 0, width);
+    for(int k = n-1; k >= 0; k--) {
+      const Level & l = L[k];
+      fract8 invamp = 255-l.amplitude;
+      for(int j = 0; j < width; j++) {
+        uint8_t value = pOut[j];
+        int firstx = (j >= l.skip) ? (j - l.skip + 1) : 0;
+        for(int i = l.first; i <= r; i++) {
+          const uint8_t *pRow = l.pRows + ((i % l.skip) * width);
+          for(int jj = firstx; jj <= j; jj++) {
+            value = scale8(value,invamp) + pRow[jj];
+          }
+        }
+        pOut[j] = value;
+      }
+    }
+  }
+};
+
+// The octaves of fill_raw_2dnoise16into8.  Level k evaluates the noise once per skip+k square of pixels, so one row
+// of blocks is kept around for each level.
+class CNoiseOctaves16into8 {
+  struct Level {
+    uint32_t x, y;
+    int scalex, scaley;
+    int skip;
+    fract8 amplitude;
+    uint8_t *pRow;
+    int block;
+  };
+  Level L[NOISE_MAX_OCTAVES];
+  uint8_t n;
+  int width;
+  uint32_t time;
+
+  void fillRow(Level & l, int block) {
+    uint32_t y = l.y + ((uint32_t)block * (uint32_t)l.scaley);
+    CNoise16Row row(y,time);
+    uint32_t xx = l.x;
+    for(int j = 0; j < width; j+=l.skip, xx+=l.scalex) {
+      uint16_t noise_base = row.noise(xx);
+      noise_base = (0x8000 & noise_base) ? noise_base - (32767) : 32767 - noise_base;
+      noise_base = scale8(noise_base>>7,l.amplitude);
+      for(int jj=j; jj<(j+l.skip) && jj<width; jj++) {
+        l.pRow[jj] = noise_base;
+      }
+    }
+    l.block = block;
+  }
+
+public:
+  // the scratch space needed, or -1 if the stack is too deep
+  static int scratch(int width, uint8_t octaves, int skip) {
+    if(octaves > NOISE_MAX_OCTAVES || skip < 1) { return -1; }
+    return ((octaves > 1) ? octaves : 1) * width;
+  }
+
+  CNoiseOctaves16into8(uint8_t *pScratch, int width, uint8_t octaves, q44 freq44, fract8 amplitude, int skip, uint32_t x, int scalex, uint32_t y, int scaley, uint32_t time)
+    : n((octaves > 1) ? octaves : 1), width(width), time(time) {
+    for(uint8_t k = 0; k < n; k++) {
+      Level & l = L[k];
+      l.x = x; l.y = y;
+      l.scalex = scalex * skip;
+      l.scaley = scaley * skip;
+      l.skip = skip;
+      // amplitude is always 255 on the lowest level
+      l.amplitude = (k == n-1) ? 255 : amplitude;
+      l.pRow = pScratch;
+      l.block = -1;
+      pScratch += width;
+
+      // the parameters the recursion passes down
+      x = x*freq44; scalex = scalex *freq44;
+      y = y*freq44; scaley = scaley * freq44;
+      skip++;
+    }
+  }
+
+  // the finished values of row r, in any order
+  void row(int r, uint8_t *pOut) {
+    for(uint8_t k = 0; k < n; k++) {
+      Level & l = L[k];
+      int block = r / l.skip;
+      if(block != l.block) { fillRow(l,block); }
+    }
+
+    // the levels are blended over each other a row at a time, which is still only one trip through the row
+    memset(pOut, 0, width);
+    for(int k = n-1; k >= 0; k--) {
+      const Level & l = L[k];
+      fract8 invamp = 255-l.amplitude;
+      if(l.skip == 1) {
+        for(int j = 0; j < width; j++) { pOut[j] = qadd8(scale8(pOut[j],invamp),l.pRow[j]); }
+      } else {
+        for(int j = 0; j < width; j++) { pOut[j] = scale8(pOut[j],invamp) + l.pRow[j]; }
+      }
+    }
+  }
+};
+
+// the octaves of fill_raw_2dnoise16 all use the same skip, so every level's noise for a block gets combined before
+// the block is written.  Needs no scratch space.
+static void raw_2dnoise16_octaves(uint16_t *pData, int width, int height, uint8_t octaves, q88 freq88, fract16 amplitude, int skip, uint32_t x, int scalex, uint32_t y, int scaley, uint32_t time) {
+  struct {
+    uint32_t y;
+    int x, xx;
+    int scalex, scaley;
+    fract16 amplitude;
+    CNoise16Row row;
+  } L[NOISE_MAX_OCTAVES];
+  uint8_t n = (octaves > 1) ? octaves : 1;
+  for(uint8_t k = 0; k < n; k++) {
+    L[k].x = x; L[k].y = y;
+    L[k].scalex = scalex * skip;
+    L[k].scaley = scaley * skip;
+    // amplitude is always 65535 on the lowest level
+    L[k].amplitude = (k == n-1) ? 65535 : amplitude;
+
+    x = x *freq88; scalex = scalex *freq88;
+    y = y * freq88; scaley = scaley * freq88;
+  }
+
+  for(int i = 0; i < height; i+=skip) {
+    for(uint8_t k = 0; k < n; k++) {
+      L[k].row = CNoise16Row(L[k].y,time);
+      L[k].xx = L[k].x;
+      L[k].y += L[k].scaley;
+    }
+    uint16_t *pRow = pData + (i*width);
+    for(int j = 0; j < width; j+=skip) {
+      uint16_t value = 0;
+      for(int k = n-1; k >= 0; k--) {
+        uint16_t noise_base = L[k].row.noise(L[k].xx);
+        noise_base = (0x8000 & noise_base) ? noise_base - (32767) : 32767 - noise_base;
+        noise_base = scale16(noise_base<<1, L[k].amplitude);
+        value = scale16(value,65535-L[k].amplitude) + noise_base;
+        L[k].xx += L[k].scalex;
+      }
+      if(skip==1) {
+        pRow[j] = value;
+      } else {
+        for(int ii = i; ii<(i+skip) && ii<height; ii++) {
+          uint16_t *pRow = pData + (ii*width);
+          for(int jj=j; jj<(j+skip) && jj<width; jj++) {
+            pRow[jj] = value;
+          }
+        }
+      }
+    }
+  }
+}
+
+static void raw_2dnoise8_recursive(uint8_t *pData, int width, int height, uint8_t octaves, q44 freq44, fract8 amplitude, int skip, uint16_t x, int scalex, uint16_t y, int scaley, uint16_t time) {
   if(octaves > 1) {
-    fill_raw_2dnoise8(pData, width, height, octaves-1, freq44, amplitude, skip+1, x*freq44, freq44 * scalex, y*freq44, freq44 * scaley, time);
+    raw_2dnoise8_recursive(pData, width, height, octaves-1, freq44, amplitude, skip+1, x*freq44, freq44 * scalex, y*freq44, freq44 * scaley, time);
   } else {
     // amplitude is always 255 on the lowest level
     amplitude=255;
@@ -583,9 +1334,10 @@ void fill_raw_2dnoise8(uint8_t *pData, int width, int height, uint8_t octaves, q
   uint16_t xx = x;
   for(int i = 0; i < height; i++, y+=scaley) {
     uint8_t *pRow = pData + (i*width);
+    CNoise8Row row(y,time);
     xx = x;
     for(int j = 0; j < width; j++, xx+=scalex) {
-      uint8_t noise_base = inoise8(xx,y,time);
+      uint8_t noise_base = row.noise(xx);
       noise_base = (0x80 & noise_base) ? (noise_base - 127) : (127 - noise_base);
       noise_base = scale8(noise_base<<1,amplitude);
       if(skip == 1) {
@@ -602,13 +1354,27 @@ void fill_raw_2dnoise8(uint8_t *pData, int width, int height, uint8_t octaves, q
   }
 }
 
+void fill_raw_2dnoise8(uint8_t *pData, int width, int height, uint8_t octaves, q44 freq44, fract8 amplitude, int skip, uint16_t x, int scalex, uint16_t y, int scaley, uint16_t time) {
+  int scratch = CNoiseOctaves8::scratch(width, octaves, skip);
+  if(scratch < 0 || scratch > NOISE_MAX_SCRATCH) {
+    raw_2dnoise8_recursive(pData, width, height, octaves, freq44, amplitude, skip, x, scalex, y, scaley, time);
+    return;
+  }
+
+  uint8_t buffer[scratch];
+  CNoiseOctaves8 stack(buffer, width, octaves, freq44, amplitude, skip, x, scalex, y, scaley, time);
+  for(int i = 0; i < height; i++) {
+    stack.row(i, pData + (i*width));
+  }
+}
+
 void fill_raw_2dnoise8(uint8_t *pData, int width, int height, uint8_t octaves, uint16_t x, int scalex, uint16_t y, int scaley, uint16_t time) {
   fill_raw_2dnoise8(pData, width, height, octaves, q44(2,0), 128, 1, x, scalex, y, scaley, time);
 }
 
-void fill_raw_2dnoise16(uint16_t *pData, int width, int height, uint8_t octaves, q88 freq88, fract16 amplitude, int skip, uint32_t x, int scalex, uint32_t y, int scaley, uint32_t time) {
+static void raw_2dnoise16_recursive(uint16_t *pData, int width, int height, uint8_t octaves, q88 freq88, fract16 amplitude, int skip, uint32_t x, int scalex, uint32_t y, int scaley, uint32_t time) {
   if(octaves > 1) {
-    fill_raw_2dnoise16(pData, width, height, octaves-1, freq88, amplitude, skip, x *freq88 , scalex *freq88, y * freq88, scaley * freq88, time);
+    raw_2dnoise16_recursive(pData, width, height, octaves-1, freq88, amplitude, skip, x *freq88 , scalex *freq88, y * freq88, scaley * freq88, time);
   } else {
     // amplitude is always 255 on the lowest level
     amplitude=65535;
@@ -619,8 +1385,9 @@ void fill_raw_2dnoise16(uint16_t *pData, int width, int height, uint8_t octaves,
   fract16 invamp = 65535-amplitude;
   for(int i = 0; i < height; i+=skip, y+=scaley) {
     uint16_t *pRow = pData + (i*width);
+    CNoise16Row row(y,time);
     for(int j = 0,xx=x; j < width; j+=skip, xx+=scalex) {
-      uint16_t noise_base = inoise16(xx,y,time);
+      uint16_t noise_base = row.noise(xx);
       noise_base = (0x8000 & noise_base) ? noise_base - (32767) : 32767 - noise_base;
       noise_base = scale16(noise_base<<1, amplitude);
       if(skip==1) {
@@ -637,12 +1404,20 @@ void fill_raw_2dnoise16(uint16_t *pData, int width, int height, uint8_t octaves,
   }
 }
 
+void fill_raw_2dnoise16(uint16_t *pData, int width, int height, uint8_t octaves, q88 freq88, fract16 amplitude, int skip, uint32_t x, int scalex, uint32_t y, int scaley, uint32_t time) {
+  if(octaves > NOISE_MAX_OCTAVES || skip < 1) {
+    raw_2dnoise16_recursive(pData, width, height, octaves, freq88, amplitude, skip, x, scalex, y, scaley, time);
+  } else {
+    raw_2dnoise16_octaves(pData, width, height, octaves, freq88, amplitude, skip, x, scalex, y, scaley, time);
+  }
+}
+
 int32_t nmin=11111110;
 int32_t nmax=0;
 
-void fill_raw_2dnoise16into8(uint8_t *pData, int width, int height, uint8_t octaves, q44 freq44, fract8 amplitude, int skip, uint32_t x, int scalex, uint32_t y, int scaley, uint32_t time) {
+static void raw_2dnoise16into8_recursive(uint8_t *pData, int width, int height, uint8_t octaves, q44 freq44, fract8 amplitude, int skip, uint32_t x, int scalex, uint32_t y, int scaley, uint32_t time) {
   if(octaves > 1) {
-    fill_raw_2dnoise16into8(pData, width, height, octaves-1, freq44, amplitude, skip+1, x*freq44, scalex *freq44, y*freq44, scaley * freq44, time);
+    raw_2dnoise16into8_recursive(pData, width, height, octaves-1, freq44, amplitude, skip+1, x*freq44, scalex *freq44, y*freq44, scaley * freq44, time);
   } else {
     // amplitude is always 255 on the lowest level
     amplitude=255;
@@ -654,9 +1429,10 @@ void fill_raw_2dnoise16into8(uint8_t *pData, int width, int height, uint8_t octa
   fract8 invamp = 255-amplitude;
   for(int i = 0; i < height; i+=skip, y+=scaley) {
     uint8_t *pRow = pData + (i*width);
+    CNoise16Row row(y,time);
     xx = x;
     for(int j = 0; j < width; j+=skip, xx+=scalex) {
-      uint16_t noise_base = inoise16(xx,y,time);
+      uint16_t noise_base = row.noise(xx);
       noise_base = (0x8000 & noise_base) ? noise_base - (32767) : 32767 - noise_base;
       noise_base = scale8(noise_base>>7,amplitude);
       if(skip==1) {
@@ -673,6 +1449,20 @@ void fill_raw_2dnoise16into8(uint8_t *pData, int width, int height, uint8_t octa
   }
 }
 
+void fill_raw_2dnoise16into8(uint8_t *pData, int width, int height, uint8_t octaves, q44 freq44, fract8 amplitude, int skip, uint32_t x, int scalex, uint32_t y, int scaley, uint32_t time) {
+  int scratch = CNoiseOctaves16into8::scratch(width, octaves, skip);
+  if(scratch < 0 || scratch > NOISE_MAX_SCRATCH) {
+    raw_2dnoise16into8_recursive(pData, width, height, octaves, freq44, amplitude, skip, x, scalex, y, scaley, time);
+    return;
+  }
+
+  uint8_t buffer[scratch];
+  CNoiseOctaves16into8 stack(buffer, width, octaves, freq44, amplitude, skip, x, scalex, y, scaley, time);
+  for(int i = 0; i < height; i++) {
+    stack.row(i, pData + (i*width));
+  }
+}
+
 void fill_raw_2dnoise16into8(uint8_t *pData, int width, int height, uint8_t octaves, uint32_t x, int scalex, uint32_t y, int scaley, uint32_t time) {
   fill_raw_2dnoise16into8(pData, width, height, octaves, q44(2,0), 171, 1, x, scalex, y, scaley, time);
 }
@@ -713,9 +1503,78 @@ void fill_noise16(CRGB *leds, int num_leds,
   }
 }
 
+// The 2d fills run the value and the hue octave stacks side by side, a row at a time, and write the colors straight
+// to the leds - the hue noise is mirrored in both directions, so its rows get computed bottom up.  A matrix that
+// would need more scratch space for the stacks than for whole V/H planes gets the planes instead.
+struct CSerpentineIndex {
+  int width;
+  bool serpentine;
+  int operator()(int x, int y) const { return (y*width) + ((serpentine && (y & 0x1)) ? (width-1-x) : x); }
+};
+
+template<class VALUE, class INDEX>
+static void fused_2dnoise(CRGB *leds, const INDEX& index, int width, int height, VALUE & V, CNoiseOctaves8 & H,
+                          uint8_t sat, uint8_t hue_shift, bool blend) {
+  uint8_t pV[width];
+  uint8_t pH[width];
+  int w1 = width-1;
+  int h1 = height-1;
+  for(int i = 0; i < height; i++) {
+    V.row(i, pV);
+    H.row(h1-i, pH);
+    for(int j = 0; j < width; j++) {
+      CRGB led(CHSV(hue_shift + pH[w1-j],sat,pV[j]));
+      CRGB & dst = leds[index(j,i)];
+
+      if(blend) {
+        dst >>= 1; dst += (led>>=1);
+      } else {
+        dst = led;
+      }
+    }
+  }
+}
+
+template<class INDEX>
+static bool fused_2dnoise8(CRGB *leds, const INDEX& index, int width, int height,
+            uint8_t octaves, uint16_t x, int xscale, uint16_t y, int yscale, uint16_t time,
+            uint8_t hue_octaves, uint16_t hue_x, int hue_xscale, uint16_t hue_y, uint16_t hue_yscale,uint16_t hue_time,bool blend) {
+  int vScratch = CNoiseOctaves8::scratch(width, octaves, 1);
+  int hScratch = CNoiseOctaves8::scratch(width, hue_octaves, 1);
+  if(vScratch < 0 || hScratch < 0 || (vScratch + hScratch) > (2*width*height)) { return false; }
+
+  uint8_t vBuffer[vScratch];
+  uint8_t hBuffer[hScratch];
+  CNoiseOctaves8 V(vBuffer, width, octaves, q44(2,0), 128, 1, x, xscale, y, yscale, time);
+  CNoiseOctaves8 H(hBuffer, width, hue_octaves, q44(2,0), 128, 1, hue_x, hue_xscale, hue_y, hue_yscale, hue_time);
+  fused_2dnoise(leds, index, width, height, V, H, 255, 0, blend);
+  return true;
+}
+
+template<class INDEX>
+static bool fused_2dnoise16(CRGB *leds, const INDEX& index, int width, int height,
+            uint8_t octaves, uint32_t x, int xscale, uint32_t y, int yscale, uint32_t time,
+            uint8_t hue_octaves, uint16_t hue_x, int hue_xscale, uint16_t hue_y, uint16_t hue_yscale,uint16_t hue_time, bool blend, uint16_t hue_shift) {
+  int vScratch = CNoiseOctaves16into8::scratch(width, octaves, 1);
+  int hScratch = CNoiseOctaves8::scratch(width, hue_octaves, 1);
+  if(vScratch < 0 || hScratch < 0 || (vScratch + hScratch) > (2*width*height)) { return false; }
+
+  uint8_t vBuffer[vScratch];
+  uint8_t hBuffer[hScratch];
+  CNoiseOctaves16into8 V(vBuffer, width, octaves, q44(2,0), 171, 1, x, xscale, y, yscale, time);
+  CNoiseOctaves8 H(hBuffer, width, hue_octaves, q44(2,0), 128, 1, hue_x, hue_xscale, hue_y, hue_yscale, hue_time);
+  fused_2dnoise(leds, index, width, height, V, H, 196, hue_shift >> 8, blend);
+  return true;
+}
+
 void fill_2dnoise8(CRGB *leds, int width, int height, bool serpentine,
             uint8_t octaves, uint16_t x, int xscale, uint16_t y, int yscale, uint16_t time,
             uint8_t hue_octaves, uint16_t hue_x, int hue_xscale, uint16_t hue_y, uint16_t hue_yscale,uint16_t hue_time,bool blend) {
+  CSerpentineIndex index = { width, serpentine };
+  if(fused_2dnoise8(leds,index,width,height,octaves,x,xscale,y,yscale,time,hue_octaves,hue_x,hue_xscale,hue_y,hue_yscale,hue_time,blend)) {
+    return;
+  }
+
   uint8_t V[height][width];
   uint8_t H[height][width];
 
@@ -749,6 +1608,11 @@ void fill_2dnoise8(CRGB *leds, int width, int height, bool serpentine,
 void fill_2dnoise16(CRGB *leds, int width, int height, bool serpentine,
             uint8_t octaves, uint32_t x, int xscale, uint32_t y, int yscale, uint32_t time,
             uint8_t hue_octaves, uint16_t hue_x, int hue_xscale, uint16_t hue_y, uint16_t hue_yscale,uint16_t hue_time, bool blend, uint16_t hue_shift) {
+  CSerpentineIndex index = { width, serpentine };
+  if(fused_2dnoise16(leds,index,width,height,octaves,x,xscale,y,yscale,time,hue_octaves,hue_x,hue_xscale,hue_y,hue_yscale,hue_time,blend,hue_shift)) {
+    return;
+  }
+
   uint8_t V[height][width];
   uint8_t H[height][width];
 
@@ -784,4 +1648,204 @@ void fill_2dnoise16(CRGB *leds, int width, int height, bool serpentine,
   }
 }
 
+// write the noise in V/H out to the leds through an XYMap
+static void map_2dnoise(CRGB *leds, const XYMap& map, const uint8_t *V, const uint8_t *H, uint8_t sat, uint8_t hue_shift, bool blend,
+                        int startRow, int endRow) {
+  int width = map.width();
+  int height = map.height();
+  int w1 = width-1;
+  int h1 = height-1;
+  for(int i = startRow; i < endRow; i++) {
+    const uint16_t *pRow = map.row(i);
+    const uint8_t *pV = V + (i*width);
+    const uint8_t *pH = H + ((h1-i)*width) + w1;
+    for(int j = 0; j < width; j++) {
+      CRGB led(CHSV(hue_shift + *pH--,sat,*pV++));
+      CRGB & dst = leds[pRow[j]];
+
+      if(blend) {
+        dst >>= 1; dst += (led>>=1);
+      } else {
+        dst = led;
+      }
+    }
+  }
+}
+
+void fill_2dnoise8(CRGB *leds, const XYMap& map,
+            uint8_t octaves, uint16_t x, int xscale, uint16_t y, int yscale, uint16_t time,
+            uint8_t hue_octaves, uint16_t hue_x, int hue_xscale, uint16_t hue_y, uint16_t hue_yscale,uint16_t hue_time,bool blend) {
+  int width = map.width();
+  int height = map.height();
+  if(fused_2dnoise8(leds,map,width,height,octaves,x,xscale,y,yscale,time,hue_octaves,hue_x,hue_xscale,hue_y,hue_yscale,hue_time,blend)) {
+    return;
+  }
+
+  uint8_t V[height][width];
+  uint8_t H[height][width];
+
+  memset(V,0,height*width);
+  memset(H,0,height*width);
+
+  fill_raw_2dnoise8((uint8_t*)V,width,height,octaves,x,xscale,y,yscale,time);
+  fill_raw_2dnoise8((uint8_t*)H,width,height,hue_octaves,hue_x,hue_xscale,hue_y,hue_yscale,hue_time);
+
+  map_2dnoise(leds,map,(uint8_t*)V,(uint8_t*)H,255,0,blend,0,height);
+}
+
+void fill_2dnoise16(CRGB *leds, const XYMap& map,
+            uint8_t octaves, uint32_t x, int xscale, uint32_t y, int yscale, uint32_t time,
+            uint8_t hue_octaves, uint16_t hue_x, int hue_xscale, uint16_t hue_y, uint16_t hue_yscale,uint16_t hue_time, bool blend, uint16_t hue_shift) {
+  int width = map.width();
+  int height = map.height();
+  if(fused_2dnoise16(leds,map,width,height,octaves,x,xscale,y,yscale,time,hue_octaves,hue_x,hue_xscale,hue_y,hue_yscale,hue_time,blend,hue_shift)) {
+    return;
+  }
+
+  uint8_t V[height][width];
+  uint8_t H[height][width];
+
+  memset(V,0,height*width);
+  memset(H,0,height*width);
+
+  fill_raw_2dnoise16into8((uint8_t*)V,width,height,octaves,q44(2,0),171,1,x,xscale,y,yscale,time);
+  fill_raw_2dnoise8((uint8_t*)H,width,height,hue_octaves,hue_x,hue_xscale,hue_y,hue_yscale,hue_time);
+
+  map_2dnoise(leds,map,(uint8_t*)V,(uint8_t*)H,196,hue_shift >> 8,blend,0,height);
+}
+
+// The parallel 2d fills compute the value and the hue noise on different cores, then split the rows between
+// them to turn the noise into colors.  The octave stacks carry their state from one row to the next, so they're
+// split by plane rather than by rows to keep the output identical.
+struct C2dNoiseJob {
+  CRGB *leds;
+  const XYMap *map;
+  uint8_t *V;
+  uint8_t *H;
+  bool wide;
+  uint8_t octaves; uint32_t x; int xscale; uint32_t y; int yscale; uint32_t time;
+  uint8_t hue_octaves; uint16_t hue_x; int hue_xscale; uint16_t hue_y; uint16_t hue_yscale; uint16_t hue_time;
+  uint8_t sat; uint8_t hue_shift; bool blend;
+};
+
+static void noisePlanes(void *pArg, uint16_t start, uint16_t end) {
+  const C2dNoiseJob & job = *(const C2dNoiseJob*)pArg;
+  int width = job.map->width();
+  int height = job.map->height();
+  for(uint16_t plane = start; plane < end; plane++) {
+    if(plane == 0) {
+      if(job.wide) {
+        fill_raw_2dnoise16into8(job.V,width,height,job.octaves,q44(2,0),171,1,job.x,job.xscale,job.y,job.yscale,job.time);
+      } else {
+        fill_raw_2dnoise8(job.V,width,height,job.octaves,job.x,job.xscale,job.y,job.yscale,job.time);
+      }
+    } else {
+      fill_raw_2dnoise8(job.H,width,height,job.hue_octaves,job.hue_x,job.hue_xscale,job.hue_y,job.hue_yscale,job.hue_time);
+    }
+  }
+}
+
+static void noiseRows(void *pArg, uint16_t start, uint16_t end) {
+  const C2dNoiseJob & job = *(const C2dNoiseJob*)pArg;
+  map_2dnoise(job.leds,*job.map,job.V,job.H,job.sat,job.hue_shift,job.blend,start,end);
+}
+
+void fill_2dnoise8_parallel(CRGB *leds, const XYMap& map,
+            uint8_t octaves, uint16_t x, int xscale, uint16_t y, int yscale, uint16_t time,
+            uint8_t hue_octaves, uint16_t hue_x, int hue_xscale, uint16_t hue_y, uint16_t hue_yscale,uint16_t hue_time,bool blend) {
+  int width = map.width();
+  int height = map.height();
+  uint8_t V[height][width];
+  uint8_t H[height][width];
+
+  memset(V,0,height*width);
+  memset(H,0,height*width);
+
+  C2dNoiseJob job = { leds, &map, (uint8_t*)V, (uint8_t*)H, false,
+                      octaves, x, xscale, y, yscale, time,
+                      hue_octaves, hue_x, hue_xscale, hue_y, hue_yscale, hue_time,
+                      255, 0, blend };
+  parallel_for(2, noisePlanes, &job);
+  parallel_for(height, noiseRows, &job);
+}
+
+void fill_2dnoise16_parallel(CRGB *leds, const XYMap& map,
+            uint8_t octaves, uint32_t x, int xscale, uint32_t y, int yscale, uint32_t time,
+            uint8_t hue_octaves, uint16_t hue_x, int hue_xscale, uint16_t hue_y, uint16_t hue_yscale,uint16_t hue_time, bool blend, uint16_t hue_shift) {
+  int width = map.width();
+  int height = map.height();
+  uint8_t V[height][width];
+  uint8_t H[height][width];
+
+  memset(V,0,height*width);
+  memset(H,0,height*width);
+
+  C2dNoiseJob job = { leds, &map, (uint8_t*)V, (uint8_t*)H, true,
+                      octaves, x, xscale, y, yscale, time,
+                      hue_octaves, hue_x, hue_xscale, hue_y, hue_yscale, hue_time,
+                      196, (uint8_t)(hue_shift >> 8), blend };
+  parallel_for(2, noisePlanes, &job);
+  parallel_for(height, noiseRows, &job);
+}
+
+void NoiseField::computePlane(uint8_t n, uint32_t index) {
+  fill_raw_2dnoise16into8(plane(n), m_nWidth, m_nHeight, m_nOctaves, m_x, m_scalex, m_y, m_scaley, index * m_nInterval);
+}
+
+// make sure the planes around time are cached, returning how far time is between them
+uint8_t NoiseField::prepare(uint32_t time) {
+  uint32_t index = time / m_nInterval;
+  if(!m_bValid || index != m_nPlane) {
+    if(m_bValid && index == (m_nPlane + 1)) {
+      // moving forward a plane, the second one is still good
+      m_nFirst ^= 1;
+      computePlane(m_nFirst ^ 1, index + 1);
+    } else if(m_bValid && (index + 1) == m_nPlane) {
+      // and backwards
+      m_nFirst ^= 1;
+      computePlane(m_nFirst, index);
+    } else {
+      computePlane(m_nFirst, index);
+      computePlane(m_nFirst ^ 1, index + 1);
+    }
+    m_nPlane = index;
+    m_bValid = true;
+  }
+
+  uint32_t offset = time - (index * m_nInterval);
+  if(m_nInterval <= 0xFFFFFF) {
+    return (offset << 8) / m_nInterval;
+  } else {
+    return offset / (m_nInterval >> 8);
+  }
+}
+
+void NoiseField::fill(uint8_t *pData, uint32_t time) {
+  uint8_t frac = prepare(time);
+  const uint8_t *pA = plane(m_nFirst);
+  uint16_t count = m_nWidth * m_nHeight;
+  if(frac == 0) {
+    memcpy(pData, pA, count);
+    return;
+  }
+
+  const uint8_t *pB = plane(m_nFirst ^ 1);
+  for(uint16_t i = 0; i < count; i++) {
+    pData[i] = lerp8by8(pA[i], pB[i], frac);
+  }
+}
+
+void fill_2dnoise16(CRGB *leds, const XYMap& map, NoiseField& value, uint32_t time, NoiseField& hue, uint32_t hue_time,
+            bool blend, uint16_t hue_shift) {
+  int width = map.width();
+  int height = map.height();
+  uint8_t V[height][width];
+  uint8_t H[height][width];
+
+  value.fill((uint8_t*)V, time);
+  hue.fill((uint8_t*)H, hue_time);
+
+  map_2dnoise(leds,map,(uint8_t*)V,(uint8_t*)H,196,hue_shift >> 8,blend,0,height);
+}
+
 FASTLED_NAMESPACE_END
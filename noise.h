@@ -21,6 +21,10 @@ FASTLED_NAMESPACE_BEGIN
 extern uint16_t inoise16(uint32_t x, uint32_t y, uint32_t z);
 extern uint16_t inoise16(uint32_t x, uint32_t y);
 extern uint16_t inoise16(uint32_t x);
+
+/// inoise16(x,y,z) for four x coordinates at once, sharing the work for y and z and letting the four evaluations
+/// be interleaved
+extern void inoise16_x4(const uint32_t *x, uint32_t y, uint32_t z, uint16_t *pResult);
 ///@}
 
 /// @name raw 16 bit noise functions
@@ -30,6 +34,7 @@ extern uint16_t inoise16(uint32_t x);
 extern int16_t inoise16_raw(uint32_t x, uint32_t y, uint32_t z);
 extern int16_t inoise16_raw(uint32_t x, uint32_t y);
 extern int16_t inoise16_raw(uint32_t x);
+extern void inoise16_raw_x4(const uint32_t *x, uint32_t y, uint32_t z, int16_t *pResult);
 ///@}
 
 /// @name 8 bit scaled noise functions
@@ -52,10 +57,42 @@ extern int8_t inoise8_raw(uint16_t x, uint16_t y);
 extern int8_t inoise8_raw(uint16_t x);
 ///@}
 
+/// @name simplex noise functions
+///@{
+/// Fixed point simplex noise, with the coordinates and output ranges of the functions above.  Only the 3 (2d) or 4
+/// (3d) corners of the simplex a point is in get evaluated, with no fade curves or interpolation - fewer table
+/// lookups and no chains of dependent lerps, but more multiplies, so how it compares with inoise16 depends on the
+/// core.  It has less of the axis aligned look of the cube lattice, and a little triangular structure showing
+/// through instead.  The lattice repeats every 768 units rather than every 256, so there's a seam where the
+/// coordinates wrap around - every 256 units for the 8 bit versions.  See set_noise_basis for using it in the fill
+/// functions.
+extern uint16_t isnoise16(uint32_t x, uint32_t y, uint32_t z);
+extern uint16_t isnoise16(uint32_t x, uint32_t y);
+extern int16_t isnoise16_raw(uint32_t x, uint32_t y, uint32_t z);
+extern int16_t isnoise16_raw(uint32_t x, uint32_t y);
+extern uint8_t isnoise8(uint16_t x, uint16_t y, uint16_t z);
+extern uint8_t isnoise8(uint16_t x, uint16_t y);
+extern int8_t isnoise8_raw(uint16_t x, uint16_t y, uint16_t z);
+extern int8_t isnoise8_raw(uint16_t x, uint16_t y);
+///@}
+
+/// the noise the 2d fill functions are built from
+typedef enum {
+	NOISE_PERLIN,	///< inoise8/inoise16, the default
+	NOISE_SIMPLEX	///< isnoise8/isnoise16
+} ENoiseBasis;
+
+/// pick the noise the 2d fills (fill_raw_2dnoise*, fill_2dnoise* and the noise fields) use, for all of them.  Noise
+/// fields keep the planes they already have until they move on to new ones.
+void set_noise_basis(ENoiseBasis basis);
+/// the noise the 2d fills use
+ENoiseBasis get_noise_basis();
+
 ///@name raw fill functions
 ///@{
 /// Raw noise fill functions - fill into a 1d or 2d array of 8-bit values using either 8-bit noise or 16-bit noise
-/// functions.
+/// functions.  The 2d fills evaluate every octave for a row before moving on to the next row, so the array only
+/// gets written once no matter how many octaves there are.
 ///@param pData the array of data to write into
 ///@param num_points the number of points of noise to compute
 ///@param octaves the number of octaves to use for noise
@@ -64,8 +101,8 @@ extern int8_t inoise8_raw(uint16_t x);
 ///@param scalex the scale (distance) between x points when filling in noise
 ///@param scaley the scale (distance) between y points when filling in noise
 ///@param time the time position for the noise field
-void fill_raw_noise8(uint8_t *pData, uint8_t num_points, uint8_t octaves, uint16_t x, int scalex, uint16_t time);
-void fill_raw_noise16into8(uint8_t *pData, uint8_t num_points, uint8_t octaves, uint32_t x, int scalex, uint32_t time);
+void fill_raw_noise8(uint8_t *pData, uint16_t num_points, uint8_t octaves, uint16_t x, int scalex, uint16_t time);
+void fill_raw_noise16into8(uint8_t *pData, uint16_t num_points, uint8_t octaves, uint32_t x, int scalex, uint32_t time);
 void fill_raw_2dnoise8(uint8_t *pData, int width, int height, uint8_t octaves, uint16_t x, int scalex, uint16_t y, int scaley, uint16_t time);
 void fill_raw_2dnoise16into8(uint8_t *pData, int width, int height, uint8_t octaves, uint32_t x, int scalex, uint32_t y, int scaley, uint32_t time);
 
@@ -76,6 +113,8 @@ void fill_raw_2dnoise16into8(uint8_t *pData, int width, int height, uint8_t octa
 ///@name fill functions
 ///@{
 /// fill functions to fill leds with values based on noise functions.  These functions use the fill_raw_* functions as appropriate.
+/// The 2d fills compute the value and hue noise a row at a time and write the colors straight to the leds, rather than
+/// filling whole value and hue planes on the stack first.
 void fill_noise8(CRGB *leds, int num_leds,
             uint8_t octaves, uint16_t x, int scale,
             uint8_t hue_octaves, uint16_t hue_x, int hue_scale,
@@ -91,6 +130,96 @@ void fill_2dnoise16(CRGB *leds, int width, int height, bool serpentine,
             uint8_t octaves, uint32_t x, int xscale, uint32_t y, int yscale, uint32_t time,
             uint8_t hue_octaves, uint16_t hue_x, int hue_xscale, uint16_t hue_y, uint16_t hue_yscale,uint16_t hue_time, bool blend, uint16_t hue_shift=0);
 
+/// fill_2dnoise8/fill_2dnoise16 for a matrix described by an XYMap, for rotated or arbitrary layouts
+void fill_2dnoise8(CRGB *leds, const XYMap& map,
+            uint8_t octaves, uint16_t x, int xscale, uint16_t y, int yscale, uint16_t time,
+            uint8_t hue_octaves, uint16_t hue_x, int hue_xscale, uint16_t hue_y, uint16_t hue_yscale,uint16_t hue_time,bool blend);
+void fill_2dnoise16(CRGB *leds, const XYMap& map,
+            uint8_t octaves, uint32_t x, int xscale, uint32_t y, int yscale, uint32_t time,
+            uint8_t hue_octaves, uint16_t hue_x, int hue_xscale, uint16_t hue_y, uint16_t hue_yscale,uint16_t hue_time, bool blend, uint16_t hue_shift=0);
+
+/// the XYMap fill_2dnoise8/fill_2dnoise16, with the work split between cores where the platform has more than one
+/// (see parallel.h)
+void fill_2dnoise8_parallel(CRGB *leds, const XYMap& map,
+            uint8_t octaves, uint16_t x, int xscale, uint16_t y, int yscale, uint16_t time,
+            uint8_t hue_octaves, uint16_t hue_x, int hue_xscale, uint16_t hue_y, uint16_t hue_yscale,uint16_t hue_time,bool blend);
+void fill_2dnoise16_parallel(CRGB *leds, const XYMap& map,
+            uint8_t octaves, uint32_t x, int xscale, uint32_t y, int yscale, uint32_t time,
+            uint8_t hue_octaves, uint16_t hue_x, int hue_xscale, uint16_t hue_y, uint16_t hue_yscale,uint16_t hue_time, bool blend, uint16_t hue_shift=0);
+
+/// A cache for slowly evolving 2d noise.  The noise of fill_raw_2dnoise16into8 is only evaluated at multiples of the
+/// interval along the time axis, the times in between blend the two neighbouring time planes - so a field whose time
+/// only moves a few steps a frame costs one 8-bit blend per pixel on most frames, rather than a full evaluation of
+/// every octave.  The values match fill_raw_2dnoise16into8 exactly at multiples of the interval.
+///
+/// The planes need 2 * width * height bytes of storage, see CNoiseField for a field that carries its own.
+class NoiseField {
+	uint16_t m_nWidth;
+	uint16_t m_nHeight;
+	uint8_t *m_pPlanes;
+	uint8_t m_nOctaves;
+	uint32_t m_nInterval;
+	uint32_t m_x, m_y;
+	int m_scalex, m_scaley;
+	// the time plane (time / interval) held by the first buffer, the one after it is in the other buffer
+	uint32_t m_nPlane;
+	uint8_t m_nFirst;
+	bool m_bValid;
+
+	uint8_t *plane(uint8_t n) { return m_pPlanes + (n * m_nWidth * m_nHeight); }
+	void computePlane(uint8_t n, uint32_t index);
+	uint8_t prepare(uint32_t time);
+
+public:
+	/// create a noise field over caller provided storage
+	/// @param width, height the size of the field
+	/// @param pPlanes storage for two time planes, 2 * width * height bytes
+	/// @param octaves the number of octaves of noise
+	/// @param interval the distance in time between the planes that get evaluated
+	NoiseField(uint16_t width, uint16_t height, uint8_t *pPlanes, uint8_t octaves, uint32_t interval)
+		: m_nWidth(width), m_nHeight(height), m_pPlanes(pPlanes), m_nOctaves(octaves), m_nInterval(interval ? interval : 1),
+		  m_x(0), m_y(0), m_scalex(0), m_scaley(0), m_nPlane(0), m_nFirst(0), m_bValid(false) {}
+
+	/// the width of the field
+	uint16_t width() const { return m_nWidth; }
+	/// the height of the field
+	uint16_t height() const { return m_nHeight; }
+
+	/// set where in the noise the field is and how far apart its points are, as for fill_raw_2dnoise16into8.  The
+	/// cached planes are thrown away.
+	void setPosition(uint32_t x, int scalex, uint32_t y, int scaley) {
+		m_x = x; m_scalex = scalex; m_y = y; m_scaley = scaley; m_bValid = false;
+	}
+	/// set the number of octaves.  The cached planes are thrown away.
+	void setOctaves(uint8_t octaves) { m_nOctaves = octaves; m_bValid = false; }
+	/// set the distance in time between the evaluated planes.  The cached planes are thrown away.
+	void setInterval(uint32_t interval) { m_nInterval = interval ? interval : 1; m_bValid = false; }
+
+	/// fill pData (width * height values, row after row) with the field at the given time
+	void fill(uint8_t *pData, uint32_t time);
+
+	/// the value of the field at (x,y) at the given time.  No range checking is done.
+	uint8_t at(uint16_t x, uint16_t y, uint32_t time) {
+		uint8_t frac = prepare(time);
+		uint16_t i = (y * m_nWidth) + x;
+		return lerp8by8(plane(m_nFirst)[i], plane(m_nFirst ^ 1)[i], frac);
+	}
+};
+
+/// A NoiseField that carries the storage for its planes with it
+/// @tparam WIDTH, HEIGHT the size of the field
+template<uint16_t WIDTH, uint16_t HEIGHT>
+class CNoiseField : public NoiseField {
+	uint8_t m_Planes[2 * WIDTH * HEIGHT];
+public:
+	CNoiseField(uint8_t octaves, uint32_t interval) : NoiseField(WIDTH, HEIGHT, m_Planes, octaves, interval) {}
+};
+
+/// fill_2dnoise16 from a pair of noise fields, one for the value and one for the hue, which must both be the size of
+/// the map.  Unlike fill_2dnoise16 the hue comes from 16 bit noise as well.
+void fill_2dnoise16(CRGB *leds, const XYMap& map, NoiseField& value, uint32_t time, NoiseField& hue, uint32_t hue_time,
+            bool blend, uint16_t hue_shift=0);
+
 FASTLED_NAMESPACE_END
 ///@}
 
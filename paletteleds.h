@@ -0,0 +1,92 @@
+#ifndef __INC_PALETTELEDS_H
+#define __INC_PALETTELEDS_H
+
+///@file paletteleds.h
+/// palette indexed led data: one byte per led, looked up in a palette as the leds are written out
+
+#include "led_sysdefs.h"
+#include "pixeltypes.h"
+#include "colorutils.h"
+#include "controller.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+/// Led data kept as one palette index per led, a third of the memory of a CRGB array, for effects that compute a
+/// palette index per led anyway.  The indices are looked up in the palette while the controller writes them out (see
+/// CLEDController::setLeds(CPaletteLeds&)), so there's no pass expanding them to colors first; brightness, color
+/// correction and dithering get applied to the looked up colors as usual.  A 16 entry palette is expanded to 256
+/// blended entries when it's set, so lookups come out the same as ColorFromPalette with LINEARBLEND, and changes to
+/// the palette only show after setting it again.
+///
+/// The indices are read while the frame goes out, the same as a CRGB array without double buffering.  The tile holds
+/// the few looked up leds the controller encodes from, see CLEDController::setGenerator.  CPaletteLedArray carries
+/// its own storage.
+class CPaletteLeds {
+	uint8_t *m_pIndices;
+	int m_nLeds;
+	CRGB *m_pTile;
+	uint16_t m_nTileLeds;
+	CRGBPalette256 m_Palette;
+
+public:
+	/// create palette indexed led data over caller provided storage, with an all black palette
+	/// @param pIndices storage for nLeds indices
+	/// @param nLeds the number of leds
+	/// @param pTile storage for the looked up leds, a few at a time
+	/// @param nTileLeds the size of the tile, in leds
+	CPaletteLeds(uint8_t *pIndices, int nLeds, CRGB *pTile, uint16_t nTileLeds) : m_pIndices(pIndices), m_nLeds(nLeds), m_pTile(pTile), m_nTileLeds(nTileLeds) {
+		memset8((void*)m_Palette.entries, 0, sizeof(m_Palette.entries));
+	}
+
+	/// the number of leds
+	int size() const { return m_nLeds; }
+
+	/// the palette indices, one per led - what effects draw into
+	uint8_t *indices() { return m_pIndices; }
+
+	/// the palette index of a led
+	uint8_t & operator[](int n) { return m_pIndices[n]; }
+
+	/// the palette the indices get looked up in
+	CRGBPalette256 & palette() { return m_Palette; }
+
+	/// set the palette the indices get looked up in, from anything a CRGBPalette256 can be assigned from
+	template<typename PALETTE> void setPalette(const PALETTE & palette) { m_Palette = palette; }
+
+	/// the tile the looked up leds go into, and its size
+	CRGB *tile() { return m_pTile; }
+	uint16_t tileSize() const { return m_nTileLeds; }
+
+	/// look up count leds from start on into pLeds, a TPixelGenerator over a CPaletteLeds.  It runs wherever the output
+	/// refills do, see FASTLED_IRAM.
+	static FASTLED_IRAM void resolve(void *pArg, CRGB *pLeds, uint16_t start, uint16_t count) {
+		CPaletteLeds *pThis = (CPaletteLeds*)pArg;
+		const uint8_t *pIndex = pThis->m_pIndices + start;
+		const CRGB *pEntries = pThis->m_Palette.entries;
+		while(count--) { *pLeds++ = pEntries[*pIndex++]; }
+	}
+
+	/// look all the leds up into a CRGB array, for controllers that can't do it as they go
+	void expand(CRGB *pLeds) { resolve(this, pLeds, 0, m_nLeds); }
+};
+
+/// CPaletteLeds that carry the storage for their indices and tile with them
+/// @tparam SIZE the number of leds
+/// @tparam TILE the size of the tile, in leds
+template<int SIZE, int TILE = 16>
+class CPaletteLedArray : public CPaletteLeds {
+	uint8_t m_Indices[SIZE];
+	CRGB m_Tile[TILE];
+public:
+	CPaletteLedArray() : CPaletteLeds(m_Indices, SIZE, m_Tile, TILE) { memset8(m_Indices, 0, sizeof(m_Indices)); }
+};
+
+#if (FASTLED_PIXEL_GENERATORS == 1)
+inline CLEDController & CLEDController::setLeds(CPaletteLeds & leds) {
+	return setGenerator(&CPaletteLeds::resolve, (void*)&leds, leds.size(), leds.tile(), leds.tileSize());
+}
+#endif
+
+FASTLED_NAMESPACE_END
+
+#endif
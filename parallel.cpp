@@ -0,0 +1,73 @@
+#define FASTLED_INTERNAL
+#include "FastLED.h"
+
+#if (FASTLED_PARALLEL == 1)
+
+extern "C" {
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+}
+
+FASTLED_NAMESPACE_BEGIN
+
+// One worker per core, created the first time work is split from the other core.  A worker only runs the job
+// that's been set up for it, and gives its done semaphore when it's through.  sBusy makes sure only one split
+// runs at a time.
+struct CParallelJob {
+	ParallelRangeFunction fn;
+	void *pArg;
+	uint16_t start;
+	uint16_t end;
+};
+
+static TaskHandle_t sWorker[2] = { NULL, NULL };
+static SemaphoreHandle_t sWorkerDone[2] = { NULL, NULL };
+static CParallelJob sWorkerJob[2];
+static volatile uint8_t sBusy = 0;
+
+static void parallelWorker(void *pArg) {
+	CParallelJob & job = sWorkerJob[(int)(intptr_t)pArg];
+	for(;;) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		job.fn(job.pArg, job.start, job.end);
+		xSemaphoreGive(sWorkerDone[(int)(intptr_t)pArg]);
+	}
+}
+
+void parallel_for(uint16_t count, ParallelRangeFunction fn, void *pArg) {
+	if(count < 2 || __atomic_exchange_n(&sBusy, 1, __ATOMIC_ACQUIRE)) {
+		fn(pArg, 0, count);
+		return;
+	}
+
+	int other = xPortGetCoreID() ^ 1;
+	if(sWorker[other] == NULL) {
+		if(sWorkerDone[other] == NULL) { sWorkerDone[other] = xSemaphoreCreateBinary(); }
+		if(sWorkerDone[other] == NULL ||
+		   xTaskCreatePinnedToCore(parallelWorker, "FastLEDpar", FASTLED_ESP32_PARALLEL_STACK, (void*)(intptr_t)other,
+		                           FASTLED_ESP32_PARALLEL_PRIORITY, &sWorker[other], other) != pdPASS) {
+			sWorker[other] = NULL;
+			__atomic_store_n(&sBusy, 0, __ATOMIC_RELEASE);
+			fn(pArg, 0, count);
+			return;
+		}
+	}
+
+	uint16_t half = count / 2;
+	CParallelJob & job = sWorkerJob[other];
+	job.fn = fn;
+	job.pArg = pArg;
+	job.start = half;
+	job.end = count;
+	xTaskNotifyGive(sWorker[other]);
+
+	fn(pArg, 0, half);
+
+	xSemaphoreTake(sWorkerDone[other], portMAX_DELAY);
+	__atomic_store_n(&sBusy, 0, __ATOMIC_RELEASE);
+}
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef __INC_PARALLEL_H
+#define __INC_PARALLEL_H
+
+///@file parallel.h
+/// splitting per frame effect work between cores, on the platforms that have more than one
+
+#include "led_sysdefs.h"
+
+// Platforms that can run work on another core define FASTLED_PARALLEL to 1 in their led_sysdefs
+#ifndef FASTLED_PARALLEL
+#define FASTLED_PARALLEL 0
+#endif
+
+FASTLED_NAMESPACE_BEGIN
+
+///@defgroup Parallel Parallel helpers
+///@{
+
+/// A piece of work over the range [start, end) of some larger range of count items (leds, rows, columns...)
+typedef void (*ParallelRangeFunction)(void *pArg, uint16_t start, uint16_t end);
+
+#if (FASTLED_PARALLEL == 1)
+/// Run fn over [0, count), split in two: the caller runs the first half while a worker task on the other core runs
+/// the second, and the call returns once both halves are done.  fn must only touch the items in the range it's given
+/// (plus anything read only).  Calls made while a split is already running (a nested call, or one from another task)
+/// run fn over the whole range inline, so this is always safe to call.
+void parallel_for(uint16_t count, ParallelRangeFunction fn, void *pArg);
+#else
+inline void parallel_for(uint16_t count, ParallelRangeFunction fn, void *pArg) { fn(pArg, 0, count); }
+#endif
+
+///@}
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -0,0 +1,106 @@
+#define FASTLED_INTERNAL
+#include "FastLED.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+Particle *ParticleSystem::emit(int32_t x, int32_t y, int16_t vx, int16_t vy, const CRGB &color, uint8_t life, uint8_t fade) {
+	if(m_nCount >= m_nCapacity) { return NULL; }
+	Particle *p = m_pParticles + m_nCount++;
+	p->x = x; p->y = y;
+	p->vx = vx; p->vy = vy;
+	p->color = color;
+	p->brightness = 255;
+	p->fade = fade;
+	p->life = life;
+	return p;
+}
+
+uint16_t ParticleSystem::burst(int32_t x, int32_t y, uint16_t count, uint16_t speed, const CRGB &color, uint8_t life, uint8_t fade) {
+	uint16_t room = m_nCapacity - m_nCount;
+	if(count > room) { count = room; }
+	// the fastest a velocity holds
+	if(speed > 32767) { speed = 32767; }
+	for(uint16_t i = 0; i < count; i++) {
+		uint16_t angle = m_Random.random16();
+		int32_t s = m_Random.random16(speed);
+		emit(x, y, (cos16(angle) * s) >> 15, (sin16(angle) * s) >> 15, color, life, fade);
+	}
+	return count;
+}
+
+// a velocity plus an acceleration, held to what fits in the velocity
+static int16_t accelerate(int16_t v, int16_t a) {
+	int32_t n = (int32_t)v + a;
+	if(n > 32767) { return 32767; }
+	if(n < -32767) { return -32767; }
+	return n;
+}
+
+void ParticleSystem::step() {
+	int16_t gx = m_nGravityX, gy = m_nGravityY;
+	uint16_t keep = 256 - m_nDrag;
+	int32_t right = (int32_t)m_nWidth << 8, bottom = (int32_t)m_nHeight << 8;
+
+	for(uint16_t i = 0; i < m_nCount; ) {
+		Particle &p = m_pParticles[i];
+		p.vx = accelerate(p.vx, gx);
+		p.vy = accelerate(p.vy, gy);
+		if(keep != 256) {
+			// dividing rather than shifting takes negative velocities all the way to 0, too
+			p.vx = ((int32_t)p.vx * keep) / 256;
+			p.vy = ((int32_t)p.vy * keep) / 256;
+		}
+		p.x += p.vx;
+		p.y += p.vy;
+		p.brightness = qsub8(p.brightness, p.fade);
+
+		// a particle lights the pixels it's between, so it's off the area once it's a whole pixel past an edge
+		bool done = (p.life <= 1) || (p.brightness == 0)
+			|| (m_nWidth && (p.x <= -256 || p.x >= right))
+			|| (m_nHeight && (p.y <= -256 || p.y >= bottom));
+		if(done) {
+			// the last particle takes this one's place, and gets stepped next
+			p = m_pParticles[--m_nCount];
+		} else {
+			p.life--;
+			i++;
+		}
+	}
+}
+
+void ParticleSystem::render(CRGB *leds, uint16_t count) const {
+	for(const Particle *p = m_pParticles, *pEnd = m_pParticles + m_nCount; p != pEnd; p++) {
+		int32_t ix = p->x >> 8;
+		uint16_t fx = p->x & 0xFF;
+		// the two pixels get the brightness by how close the particle is to each of them
+		uint8_t s0 = ((256 - fx) * p->brightness) >> 8;
+		uint8_t s1 = (fx * p->brightness) >> 8;
+		if(ix >= 0 && ix < count && s0) { leds[ix] += CRGB(p->color).nscale8(s0); }
+		ix++;
+		if(ix >= 0 && ix < count && s1) { leds[ix] += CRGB(p->color).nscale8(s1); }
+	}
+}
+
+void ParticleSystem::render(CRGB *leds, const XYMap &map) const {
+	int32_t width = map.width(), height = map.height();
+	for(const Particle *p = m_pParticles, *pEnd = m_pParticles + m_nCount; p != pEnd; p++) {
+		int32_t ix = p->x >> 8, iy = p->y >> 8;
+		if(ix < -1 || ix >= width || iy < -1 || iy >= height) { continue; }
+		uint32_t fx = p->x & 0xFF, fy = p->y & 0xFF;
+		// the four pixels get the brightness by the area of the pixel sized square around the particle over them
+		uint32_t wx[2] = { 256 - fx, fx }, wy[2] = { 256 - fy, fy };
+		for(uint8_t j = 0; j < 2; j++) {
+			int32_t y = iy + j;
+			if(y < 0 || y >= height) { continue; }
+			const uint16_t *pRow = map.row(y);
+			for(uint8_t i = 0; i < 2; i++) {
+				int32_t x = ix + i;
+				if(x < 0 || x >= width) { continue; }
+				uint8_t s = (wx[i] * wy[j] * p->brightness) >> 16;
+				if(s) { leds[pRow[x]] += CRGB(p->color).nscale8(s); }
+			}
+		}
+	}
+}
+
+FASTLED_NAMESPACE_END
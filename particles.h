@@ -0,0 +1,129 @@
+#ifndef __INC_PARTICLES_H
+#define __INC_PARTICLES_H
+
+#include "FastLED.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+///@file particles.h
+/// a particle system over a fixed pool of particles, for sparkles, fireworks, rain and the like
+
+///@defgroup Particles Particle systems
+///@{
+
+/// A particle: a position and a velocity in pixels, in 8.8 fixed point (256 is one pixel), a color with a brightness
+/// that fades by fade every step, and the number of steps it has left to live.  The position has 24 bits of whole
+/// pixels, so it covers strips of any length; the velocity goes up to 127 pixels a step.
+struct Particle {
+	int32_t x, y;
+	int16_t vx, vy;
+	CRGB color;
+	uint8_t brightness;
+	uint8_t fade;
+	uint8_t life;
+};
+
+/// Moves, fades and draws the particles of a fixed size pool, so nothing gets allocated while an effect runs and the
+/// memory it takes is known up front.  The live particles are kept packed at the start of the pool - a particle that
+/// dies gets replaced by the last one - so stepping and rendering is a walk over contiguous storage, whatever order
+/// they came and went in.
+///
+/// Every step adds the gravity to the velocities, takes the drag off them, moves the particles, fades them, and
+/// retires the ones that are out of life, faded to black, or off the bounds.  Rendering adds each particle's color
+/// onto the leds (saturating, with CRGB::operator+=), spread over the pixels around its position by how close it is
+/// to each of them, so particles move smoothly between pixels rather than jumping from one to the next.  Random
+/// numbers come from the system's own CRandom, see burst.
+///
+/// The pool needs capacity Particles of storage, see CParticleSystem for a system that carries its own.
+///
+///     CParticleSystem<128> sparks;
+///     sparks.setGravity(0, 6);
+///     sparks.setBounds(WIDTH, HEIGHT);
+///     ...
+///     if(random8() < 8) { sparks.burst(random8(WIDTH) << 8, random8(HEIGHT) << 8, 40, 512, CRGB::Gold, 60, 4); }
+///     fadeToBlackBy(leds, NUM_LEDS, 64);
+///     sparks.step();
+///     sparks.render(leds, map);
+class ParticleSystem {
+	Particle *m_pParticles;
+	uint16_t m_nCapacity;
+	uint16_t m_nCount;
+	int16_t m_nGravityX;
+	int16_t m_nGravityY;
+	uint8_t m_nDrag;
+	uint16_t m_nWidth;
+	uint16_t m_nHeight;
+	CRandom m_Random;
+
+public:
+	/// create a particle system over caller provided storage, with no particles yet
+	/// @param pParticles storage for the pool
+	/// @param capacity the number of particles the storage has room for
+	/// @param seed the seed of the system's random numbers
+	ParticleSystem(Particle *pParticles, uint16_t capacity, uint32_t seed = 1337)
+		: m_pParticles(pParticles), m_nCapacity(capacity), m_nCount(0), m_nGravityX(0), m_nGravityY(0), m_nDrag(0),
+		  m_nWidth(0), m_nHeight(0), m_Random(seed) {}
+
+	/// the number of live particles
+	uint16_t size() const { return m_nCount; }
+	/// the most particles there can be at once
+	uint16_t capacity() const { return m_nCapacity; }
+
+	/// the live particles, size() of them one after another, e.g. to steer them in ways step doesn't
+	Particle *particles() { return m_pParticles; }
+	const Particle *particles() const { return m_pParticles; }
+
+	/// the system's random numbers, for effects that want theirs to come from the same place
+	CRandom &random() { return m_Random; }
+
+	/// set what's added to every particle's velocity every step, in 8.8 pixels per step
+	void setGravity(int16_t ax, int16_t ay) { m_nGravityX = ax; m_nGravityY = ay; }
+
+	/// set how much of their velocity particles lose every step, in 256ths - 0 (the default) for none
+	void setDrag(uint8_t drag) { m_nDrag = drag; }
+
+	/// retire particles that move more than a pixel off a width x height area.  A size of 0 (the default) leaves
+	/// that axis unbounded - e.g. setBounds(NUM_LEDS, 0) for a strip.
+	void setBounds(uint16_t width, uint16_t height) { m_nWidth = width; m_nHeight = height; }
+
+	/// add a particle, at full brightness
+	/// @param x,y the position, in 8.8 pixels
+	/// @param vx,vy the velocity, in 8.8 pixels per step
+	/// @param color the color
+	/// @param life the number of steps it lives for
+	/// @param fade how much its brightness drops every step, 0 to stay at full brightness all its life
+	/// @returns the new particle, or NULL if the pool is full
+	Particle *emit(int32_t x, int32_t y, int16_t vx, int16_t vy, const CRGB &color, uint8_t life, uint8_t fade = 0);
+
+	/// add count particles at a position, flying off in random directions at random speeds up to speed (in 8.8
+	/// pixels per step, at most 32767), e.g. for a firework going off.  As many as fit in the pool get added.
+	/// @returns the number of particles added
+	uint16_t burst(int32_t x, int32_t y, uint16_t count, uint16_t speed, const CRGB &color, uint8_t life, uint8_t fade = 0);
+
+	/// retire all the particles
+	void clear() { m_nCount = 0; }
+
+	/// move and fade all the particles by a step, and retire the ones that are done
+	void step();
+
+	/// add the particles onto a strip, by their x positions
+	void render(CRGB *leds, uint16_t count) const;
+
+	/// add the particles onto a matrix
+	void render(CRGB *leds, const XYMap &map) const;
+};
+
+/// A ParticleSystem that carries the storage for its pool with it
+/// @tparam CAPACITY the most particles there can be at once
+template<uint16_t CAPACITY>
+class CParticleSystem : public ParticleSystem {
+	Particle m_Particles[CAPACITY];
+public:
+	CParticleSystem(uint32_t seed = 1337) : ParticleSystem(m_Particles, CAPACITY, seed) {}
+};
+
+///@}
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -3,6 +3,28 @@
 
 #include "FastLED.h"
 
+/// @name bulk pixel set operations
+/// The CPixelView operators that don't care which way a set runs treat it as the plain range of memory it covers.
+/// For CRGB that range is handed to the array functions in colorutils (which work on whole words where they can),
+/// any other pixel type is done pixel by pixel.
+//@{
+template<class PIXEL_TYPE> inline void pixelset_fill(PIXEL_TYPE *pixels, int n, const PIXEL_TYPE & color) { for(int i = 0; i < n; i++) { pixels[i] = color; } }
+template<class PIXEL_TYPE> inline void pixelset_nscale8(PIXEL_TYPE *pixels, int n, uint8_t scale) { for(int i = 0; i < n; i++) { pixels[i].nscale8(scale); } }
+template<class PIXEL_TYPE> inline void pixelset_nscale8_video(PIXEL_TYPE *pixels, int n, uint8_t scale) { for(int i = 0; i < n; i++) { pixels[i].nscale8_video(scale); } }
+template<class PIXEL_TYPE> inline void pixelset_addToRGB(PIXEL_TYPE *pixels, int n, uint8_t d) { for(int i = 0; i < n; i++) { pixels[i].addToRGB(d); } }
+template<class PIXEL_TYPE> inline void pixelset_copy(PIXEL_TYPE *dst, const PIXEL_TYPE *src, int n) { for(int i = 0; i < n; i++) { dst[i] = src[i]; } }
+template<class PIXEL_TYPE> inline void pixelset_add(PIXEL_TYPE *dst, const PIXEL_TYPE *src, int n) { for(int i = 0; i < n; i++) { dst[i] += src[i]; } }
+
+inline void pixelset_fill(CRGB *pixels, int n, const CRGB & color) { ::fill_solid(pixels, n, color); }
+inline void pixelset_nscale8(CRGB *pixels, int n, uint8_t scale) { ::nscale8(pixels, n, scale); }
+inline void pixelset_nscale8_video(CRGB *pixels, int n, uint8_t scale) { ::nscale8_video(pixels, n, scale); }
+// every channel gets the same saturating add, so a CRGB range is just a run of bytes
+inline void pixelset_addToRGB(CRGB *pixels, int n, uint8_t d) { uint8_t *p = (uint8_t*)pixels; for(int i = n * 3; i > 0; i--, p++) { *p = qadd8(*p, d); } }
+// only called when copying forward can't overwrite source pixels before they're read, which memmove8 agrees with
+inline void pixelset_copy(CRGB *dst, const CRGB *src, int n) { memmove8((void*)dst, (const void*)src, n * sizeof(CRGB)); }
+inline void pixelset_add(CRGB *dst, const CRGB *src, int n) { uint8_t *p = (uint8_t*)dst; const uint8_t *q = (const uint8_t*)src; for(int i = n * 3; i > 0; i--, p++, q++) { *p = qadd8(*p, *q); } }
+//@}
+
 /// Represents a set of CRGB led objects.  Provides the [] array operator, and works like a normal array in that case.
 /// This should be kept in sync with the set of functions provided by CRGB as well as functions in colorutils.  Note
 /// that a pixel set is a window into another set of led data, it is not its own set of led data.
@@ -34,11 +56,11 @@ public:
 
   /// Get the size of this set
   /// @return the size of the set
-  int size() { return abs(len); }
+  int size() const { return abs(len); }
 
   /// Whether or not this set goes backwards
   /// @return whether or not the set is backwards
-  bool reversed() { return len < 0; }
+  bool reversed() const { return len < 0; }
 
   /// do these sets point to the same thing (note, this is different from the contents of the set being the same)
   bool operator==(const CPixelView & rhs) const { return leds == rhs.leds && len == rhs.len && dir == rhs.dir; }
@@ -68,7 +90,7 @@ public:
   /// Assign the passed in color to all elements in this set
   /// @param color the new color for the elements in the set
   inline CPixelView & operator=(const PIXEL_TYPE & color) {
-    for(iterator pixel = begin(), _end = end(); pixel != _end; ++pixel) { (*pixel) = color; }
+    pixelset_fill(first(), size(), color);
     return *this;
   }
 
@@ -85,6 +107,7 @@ public:
   /// Copy the contents of the passed in set to our set.  Note if one set is smaller than the other, only the
   /// smallest number of items will be copied over.
   inline CPixelView & operator=(const CPixelView & rhs) {
+    if(forwardFrom(rhs)) { pixelset_copy(leds, rhs.leds, overlap(rhs)); return *this; }
     for(iterator pixel = begin(), rhspixel = rhs.begin(), _end = end(), rhs_end = rhs.end(); (pixel != _end) && (rhspixel != rhs_end); ++pixel, ++rhspixel) {
       (*pixel) = (*rhspixel);
     }
@@ -94,9 +117,9 @@ public:
   /// @name modification/scaling operators
   //@{
   /// Add the passed in value to r,g, b for all the pixels in this set
-  inline CPixelView & addToRGB(uint8_t inc) { for(iterator pixel = begin(), _end = end(); pixel != _end; ++pixel) { (*pixel) += inc; } return *this; }
+  inline CPixelView & addToRGB(uint8_t inc) { pixelset_addToRGB(first(), size(), inc); return *this; }
   /// Add every pixel in the other set to this set
-  inline CPixelView & operator+=(CPixelView & rhs) { for(iterator pixel = begin(), rhspixel = rhs.begin(), _end = end(), rhs_end = rhs.end(); (pixel != _end) && (rhspixel != rhs_end); ++pixel, ++rhspixel) { (*pixel) += (*rhspixel); } return *this; }
+  inline CPixelView & operator+=(CPixelView & rhs) { if(dir > 0 && rhs.dir > 0) { pixelset_add(leds, rhs.leds, overlap(rhs)); return *this; } for(iterator pixel = begin(), rhspixel = rhs.begin(), _end = end(), rhs_end = rhs.end(); (pixel != _end) && (rhspixel != rhs_end); ++pixel, ++rhspixel) { (*pixel) += (*rhspixel); } return *this; }
 
   /// Subtract the passed in value from r,g,b for all pixels in this set
   inline CPixelView & subFromRGB(uint8_t inc) { for(iterator pixel = begin(), _end = end(); pixel != _end; ++pixel) { (*pixel) -= inc; } return *this; }
@@ -121,14 +144,14 @@ public:
   inline CPixelView & operator*=(uint8_t d) { for(iterator pixel = begin(), _end = end(); pixel != _end; ++pixel) { (*pixel) *= d; } return *this; }
 
   /// Scale every led by the given scale
-  inline CPixelView & nscale8_video(uint8_t scaledown) { for(iterator pixel = begin(), _end = end(); pixel != _end; ++pixel) { (*pixel).nscale8_video(scaledown); } return *this;}
+  inline CPixelView & nscale8_video(uint8_t scaledown) { pixelset_nscale8_video(first(), size(), scaledown); return *this;}
   /// Scale down every led by the given scale
-  inline CPixelView & operator%=(uint8_t scaledown) { for(iterator pixel = begin(), _end = end(); pixel != _end; ++pixel) { (*pixel).nscale8_video(scaledown); } return *this; }
+  inline CPixelView & operator%=(uint8_t scaledown) { return nscale8_video(scaledown); }
   /// Fade every led down by the given scale
   inline CPixelView & fadeLightBy(uint8_t fadefactor) { return nscale8_video(255 - fadefactor); }
 
   /// Scale every led by the given scale
-  inline CPixelView & nscale8(uint8_t scaledown) { for(iterator pixel = begin(), _end = end(); pixel != _end; ++pixel) { (*pixel).nscale8(scaledown); } return *this; }
+  inline CPixelView & nscale8(uint8_t scaledown) { pixelset_nscale8(first(), size(), scaledown); return *this; }
   /// Scale every led by the given scale
   inline CPixelView & nscale8(PIXEL_TYPE & scaledown) { for(iterator pixel = begin(), _end = end(); pixel != _end; ++pixel) { (*pixel).nscale8(scaledown); } return *this; }
   /// Scale every led in this set by every led in the other set
@@ -253,6 +276,20 @@ public:
     return *this;
   }
 
+private:
+  /// the lowest address in this set, whichever way it runs
+  inline PIXEL_TYPE *first() const { return (dir > 0) ? leds : end_pos + 1; }
+
+  /// whether copying rhs over this set pixel by pixel works out the same as moving the memory - both sets run
+  /// forward, and rhs either starts at or after this set or doesn't overlap it
+  inline bool forwardFrom(const CPixelView & rhs) const {
+    return dir > 0 && rhs.dir > 0 && (rhs.leds >= leds || rhs.leds + overlap(rhs) <= leds);
+  }
+
+  /// how many pixels an operation between this set and rhs covers, the size of the smaller one
+  inline int overlap(const CPixelView & rhs) const { return (size() < rhs.size()) ? size() : rhs.size(); }
+
+public:
   // TODO: Make this a fully specified/proper iterator
   template <class T>
   class pixelset_iterator_base {
@@ -290,12 +327,62 @@ __attribute__((always_inline))
 inline CRGB *operator+(const CRGBSet & pixels, int offset) { return (CRGB*)pixels + offset; }
 
 
+/// What led arrays that output drivers may DMA from (or copy out with word loads) get aligned to, in bytes.  Their
+/// sizes get padded out to it too, so a word read of the last led stays inside the array.
+#ifndef FASTLED_LED_ALIGN
+#define FASTLED_LED_ALIGN 4
+#endif
+
+/// Where allocateLeds gets its memory - on the ESP32, DMA capable internal ram
+#ifndef FASTLED_DMA_LEDS_MALLOC
+#define FASTLED_DMA_LEDS_MALLOC(len) malloc(len)
+#define FASTLED_DMA_LEDS_FREE(ptr) free(ptr)
+#endif
+
+/// Whether output drivers can DMA straight from a block of memory
+#ifndef FASTLED_DMA_CAPABLE
+#define FASTLED_DMA_CAPABLE(ptr) ((((uintptr_t)(ptr)) & (FASTLED_LED_ALIGN - 1)) == 0)
+#endif
+
+/// A CRGBSet with its own leds, aligned to FASTLED_LED_ALIGN (the array's size is padded out to it too), so drivers
+/// can send it by DMA without copying it into a buffer of their own first - as long as it's somewhere DMA can read,
+/// which for a global or a local on the ESP32 it is.
 template<int SIZE>
 class CRGBArray : public CPixelView<CRGB> {
-  CRGB rawleds[SIZE];
+  CRGB rawleds[SIZE] __attribute__((aligned(FASTLED_LED_ALIGN)));
 public:
   CRGBArray() : CPixelView<CRGB>(rawleds, SIZE) {}
   using CPixelView::operator=;
 };
 
+/// the smallest number of leds, at least nLeds, that's a whole number of FASTLED_LED_ALIGN units - sizing each lane of
+/// a block controller's leds with it leaves every lane starting aligned
+inline int alignedLeds(int nLeds) {
+  int align = (FASTLED_LED_ALIGN % 3) ? FASTLED_LED_ALIGN : (FASTLED_LED_ALIGN / 3);
+  return ((nLeds + align - 1) / align) * align;
+}
+
+/// Allocate nLeds leds, cleared to black, for output drivers to DMA from: aligned (see FASTLED_LED_ALIGN), padded
+/// out to a whole number of words, and with FASTLED_DMA_LEDS_MALLOC, so on the ESP32 in DMA capable internal ram.
+/// For leds that don't stay around for the whole sketch, free them again with freeLeds.
+/// @returns the leds, or NULL if there isn't the memory
+inline CRGB *allocateLeds(int nLeds) {
+  int len = ((nLeds * (int)sizeof(CRGB)) + FASTLED_LED_ALIGN - 1) & ~(FASTLED_LED_ALIGN - 1);
+  uint8_t *p = (uint8_t*)FASTLED_DMA_LEDS_MALLOC(len + FASTLED_LED_ALIGN);
+  if(p == NULL) { return NULL; }
+  // the allocator may only align to less than FASTLED_LED_ALIGN: step up to it, and keep the step below the leds
+  uint8_t step = FASTLED_LED_ALIGN - (((uintptr_t)p) & (FASTLED_LED_ALIGN - 1));
+  p += step;
+  p[-1] = step;
+  memset(p, 0, len);
+  return (CRGB*)p;
+}
+
+/// free leds from allocateLeds
+inline void freeLeds(CRGB *pLeds) {
+  if(pLeds == NULL) { return; }
+  uint8_t *p = (uint8_t*)pLeds;
+  FASTLED_DMA_LEDS_FREE(p - p[-1]);
+}
+
 #endif
@@ -848,6 +848,124 @@ inline CRGB operator%( const CRGB& p1, uint8_t d)
 }
 
 
+/// Representation of an RGBW pixel (Red, Green, Blue, White), for chipsets like the SK6812 RGBW that drive a
+/// separate white led.  The rgb channels are laid out the same way as in a CRGB, with the white channel after
+/// them.  Attach an array of these to a controller with CLEDController::setLeds(CRGBW*, int).
+struct CRGBW {
+	union {
+		struct {
+            union {
+                uint8_t r;
+                uint8_t red;
+            };
+            union {
+                uint8_t g;
+                uint8_t green;
+            };
+            union {
+                uint8_t b;
+                uint8_t blue;
+            };
+            union {
+                uint8_t w;
+                uint8_t white;
+            };
+        };
+		uint8_t raw[4];
+	};
+
+    /// Array access operator to index into the crgbw object
+	inline uint8_t& operator[] (uint8_t x) __attribute__((always_inline)) { return raw[x]; }
+
+    /// Array access operator to index into the crgbw object
+    inline const uint8_t& operator[] (uint8_t x) const __attribute__((always_inline)) { return raw[x]; }
+
+    // default values are UNINITIALIZED
+	inline CRGBW() __attribute__((always_inline)) {}
+
+    /// allow construction from R, G, B, W
+    inline CRGBW( uint8_t ir, uint8_t ig, uint8_t ib, uint8_t iw = 0) __attribute__((always_inline))
+        : r(ir), g(ig), b(ib), w(iw)
+    {
+    }
+
+    /// allow construction from an rgb color, with the white channel off
+    inline CRGBW( const CRGB& rhs) __attribute__((always_inline))
+        : r(rhs.r), g(rhs.g), b(rhs.b), w(0)
+    {
+    }
+
+    /// allow assignment from an rgb color, which turns the white channel off
+    inline CRGBW& operator= (const CRGB& rhs) __attribute__((always_inline))
+    {
+        r = rhs.r;
+        g = rhs.g;
+        b = rhs.b;
+        w = 0;
+        return *this;
+    }
+
+    /// the rgb part of this color
+    inline CRGB rgb() const __attribute__((always_inline)) { return CRGB(r, g, b); }
+};
+
+/// Representation of an RGB pixel with 16 bits per channel, for chipsets that can make use of more than 8 bits (e.g.
+/// APA102/SK9822/HD107 through their 5 bit global brightness).  The high bytes of the three channels are stored first,
+/// followed by the low bytes, so controllers that only handle 8 bits per channel read the high bytes and still show
+/// the right colors.  Attach an array of these to a controller with CLEDController::setLeds(CRGB16*, int).
+struct CRGB16 {
+    uint8_t hi[3];
+    uint8_t lo[3];
+
+    // default values are UNINITIALIZED
+    inline CRGB16() __attribute__((always_inline)) {}
+
+    /// allow construction from 16 bit R, G, B
+    inline CRGB16( uint16_t ir, uint16_t ig, uint16_t ib) __attribute__((always_inline)) { setRGB(ir, ig, ib); }
+
+    /// allow construction from an 8 bit rgb color, scaled up to the full 16 bit range
+    inline CRGB16( const CRGB& rhs) __attribute__((always_inline))
+    {
+        for(uint8_t i = 0; i < 3; i++) { hi[i] = lo[i] = rhs.raw[i]; }
+    }
+
+    /// allow assignment from an 8 bit rgb color, scaled up to the full 16 bit range
+    inline CRGB16& operator= (const CRGB& rhs) __attribute__((always_inline))
+    {
+        for(uint8_t i = 0; i < 3; i++) { hi[i] = lo[i] = rhs.raw[i]; }
+        return *this;
+    }
+
+    /// get channel x (0 = red, 1 = green, 2 = blue)
+    inline uint16_t get( uint8_t x) const __attribute__((always_inline)) { return ((uint16_t)hi[x] << 8) | lo[x]; }
+
+    /// set channel x (0 = red, 1 = green, 2 = blue)
+    inline void set( uint8_t x, uint16_t v) __attribute__((always_inline)) { hi[x] = v >> 8; lo[x] = v & 0xFF; }
+
+    inline uint16_t r() const __attribute__((always_inline)) { return get(0); }
+    inline uint16_t g() const __attribute__((always_inline)) { return get(1); }
+    inline uint16_t b() const __attribute__((always_inline)) { return get(2); }
+
+    /// set all three channels at once
+    inline CRGB16& setRGB( uint16_t ir, uint16_t ig, uint16_t ib) __attribute__((always_inline))
+    {
+        set(0, ir); set(1, ig); set(2, ib);
+        return *this;
+    }
+
+    /// the 8 bit color, i.e. the high bytes of each channel
+    inline CRGB rgb() const __attribute__((always_inline)) { return CRGB(hi[0], hi[1], hi[2]); }
+};
+
+inline __attribute__((always_inline)) bool operator== (const CRGBW& lhs, const CRGBW& rhs)
+{
+    return (lhs.r == rhs.r) && (lhs.g == rhs.g) && (lhs.b == rhs.b) && (lhs.w == rhs.w);
+}
+
+inline __attribute__((always_inline)) bool operator!= (const CRGBW& lhs, const CRGBW& rhs)
+{
+    return !(lhs == rhs);
+}
 
 /// RGB orderings, used when instantiating controllers to determine what
 /// order the controller should send RGB data out in, RGB being the default
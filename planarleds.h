@@ -0,0 +1,141 @@
+#ifndef __INC_PLANARLEDS_H
+#define __INC_PLANARLEDS_H
+
+///@file planarleds.h
+/// planar led data: the reds, greens and blues of all the leds kept in three separate arrays
+
+#include "led_sysdefs.h"
+#include "pixeltypes.h"
+#include "colorutils.h"
+#include "controller.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+/// the bytes of storage CPlanarLeds need for nLeds leds: three word aligned planes, each padded to a whole word
+#define PLANAR_LEDS_BYTES(nLeds) (3 * ((((uint32_t)(nLeds)) + 3) & ~3UL))
+
+/// Led data kept as three planes - all the reds, then all the greens, then all the blues - instead of an array of
+/// CRGBs.  Every plane starts on a word boundary and is padded to a whole number of words, so the bulk functions below
+/// work on four leds at a time with plain word loads and stores, where a CRGB array's three byte stride gets in their
+/// way (the blur in particular can't do a CRGB array a word at a time, as each word there holds parts of different
+/// colors).  The planes get gathered into CRGBs while the controller writes them out (see
+/// CLEDController::setLeds(CPlanarLeds&)), so there's no pass interleaving them first.
+///
+/// The padding at the end of each plane has to stay 0 - the bulk functions never write to it, and blur1d reads it as
+/// the (black) led past the last one.  The planes are read while the frame goes out, the same as a CRGB array without
+/// double buffering.  The tile holds the few gathered leds the controller encodes from, see
+/// CLEDController::setGenerator.  CPlanarLedArray carries its own storage.
+class CPlanarLeds {
+	uint8_t *m_pPlanes;
+	int m_nLeds;
+	int m_nStride;
+	CRGB *m_pTile;
+	uint16_t m_nTileLeds;
+
+public:
+	/// create planar led data over caller provided storage.  The leds start out black.
+	/// @param pStorage word aligned storage for the planes, PLANAR_LEDS_BYTES(nLeds) of it
+	/// @param nLeds the number of leds
+	/// @param pTile storage for the gathered leds, a few at a time
+	/// @param nTileLeds the size of the tile, in leds
+	CPlanarLeds(uint8_t *pStorage, int nLeds, CRGB *pTile, uint16_t nTileLeds) : m_pPlanes(pStorage), m_nLeds(nLeds), m_nStride((nLeds + 3) & ~3), m_pTile(pTile), m_nTileLeds(nTileLeds) {
+		memset8(m_pPlanes, 0, PLANAR_LEDS_BYTES(nLeds));
+	}
+
+	/// the number of leds
+	int size() const { return m_nLeds; }
+
+	/// the distance from one plane to the next, in bytes - the number of leds, rounded up to a whole word
+	int stride() const { return m_nStride; }
+
+	/// a color's plane: 0 for red, 1 for green, 2 for blue
+	uint8_t *plane(int n) { return m_pPlanes + (n * m_nStride); }
+	const uint8_t *plane(int n) const { return m_pPlanes + (n * m_nStride); }
+
+	uint8_t *r() { return plane(0); }
+	uint8_t *g() { return plane(1); }
+	uint8_t *b() { return plane(2); }
+
+	/// the color of a led
+	CRGB get(int n) const { return CRGB(m_pPlanes[n], m_pPlanes[m_nStride + n], m_pPlanes[(2 * m_nStride) + n]); }
+
+	/// set the color of a led
+	void set(int n, const CRGB & color) {
+		m_pPlanes[n] = color.r;
+		m_pPlanes[m_nStride + n] = color.g;
+		m_pPlanes[(2 * m_nStride) + n] = color.b;
+	}
+
+	/// the tile the gathered leds go into, and its size
+	CRGB *tile() { return m_pTile; }
+	uint16_t tileSize() const { return m_nTileLeds; }
+
+	/// gather count leds from start on into pLeds, a TPixelGenerator over a CPlanarLeds.  It runs wherever the output
+	/// refills do, see FASTLED_IRAM.
+	static FASTLED_IRAM void resolve(void *pArg, CRGB *pLeds, uint16_t start, uint16_t count) {
+		CPlanarLeds *pThis = (CPlanarLeds*)pArg;
+		const uint8_t *pR = pThis->m_pPlanes + start;
+		const uint8_t *pG = pR + pThis->m_nStride;
+		const uint8_t *pB = pG + pThis->m_nStride;
+		while(count--) { pLeds->r = *pR++; pLeds->g = *pG++; pLeds->b = *pB++; pLeds++; }
+	}
+
+	/// gather all the leds into a CRGB array, for controllers that can't do it as they go
+	void expand(CRGB *pLeds) const { resolve((void*)this, pLeds, 0, m_nLeds); }
+
+	/// set all the leds from a CRGB array
+	void load(const CRGB *pLeds) {
+		uint8_t *pR = r(), *pG = g(), *pB = b();
+		for(int i = 0; i < m_nLeds; i++) { pR[i] = pLeds[i].r; pG[i] = pLeds[i].g; pB[i] = pLeds[i].b; }
+	}
+};
+
+/// CPlanarLeds that carry the storage for their planes and tile with them
+/// @tparam SIZE the number of leds
+/// @tparam TILE the size of the tile, in leds
+template<int SIZE, int TILE = 16>
+class CPlanarLedArray : public CPlanarLeds {
+	uint32_t m_Planes[PLANAR_LEDS_BYTES(SIZE) / 4];
+	CRGB m_Tile[TILE];
+public:
+	CPlanarLedArray() : CPlanarLeds((uint8_t*)m_Planes, SIZE, m_Tile, TILE) {}
+};
+
+///@ingroup ColorUtils
+/// The bulk color functions for planar led data, with the same results as the CRGB array versions (see colorutils.h)
+///@{
+
+/// fill all the leds with a solid color
+void fill_solid(CPlanarLeds & leds, const CRGB & color);
+
+/// scale all the leds down by scale/256ths, see nscale8(CRGB*, uint16_t, uint8_t)
+void nscale8(CPlanarLeds & leds, uint8_t scale);
+
+/// fade all the leds toward black by fadeBy/256ths, see fadeToBlackBy(CRGB*, uint16_t, uint8_t)
+void fadeToBlackBy(CPlanarLeds & leds, uint8_t fadeBy);
+
+/// blend the leds toward the overlay's by amountOfOverlay/256ths, see nblend(CRGB*, CRGB*, uint16_t, fract8).  As many
+/// leds as the smaller of the two has are blended.
+void nblend(CPlanarLeds & existing, const CPlanarLeds & overlay, fract8 amountOfOverlay);
+
+/// spread the light of every led to its two neighbors, see blur1d(CRGB*, uint16_t, fract8)
+void blur1d(CPlanarLeds & leds, fract8 blur_amount);
+
+/// look up a palette index for every led, see fill_from_palette(CRGB*, const uint8_t*, uint16_t, ...)
+/// @param indices one palette index per led, leds.size() of them
+void fill_from_palette(CPlanarLeds & leds, const uint8_t *indices, const CRGBPalette16 & pal, uint8_t brightness = 255, TBlendType blendType = LINEARBLEND);
+void fill_from_palette(CPlanarLeds & leds, const uint8_t *indices, const CRGBPalette32 & pal, uint8_t brightness = 255, TBlendType blendType = LINEARBLEND);
+void fill_from_palette(CPlanarLeds & leds, const uint8_t *indices, const CRGBPalette256 & pal, uint8_t brightness = 255, TBlendType blendType = NOBLEND);
+void fill_from_palette(CPlanarLeds & leds, const uint8_t *indices, const CRGBPaletteLUT & lut);
+
+///@}
+
+#if (FASTLED_PIXEL_GENERATORS == 1)
+inline CLEDController & CLEDController::setLeds(CPlanarLeds & leds) {
+	return setGenerator(&CPlanarLeds::resolve, (void*)&leds, leds.size(), leds.tile(), leds.tileSize());
+}
+#endif
+
+FASTLED_NAMESPACE_END
+
+#endif
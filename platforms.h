@@ -29,6 +29,9 @@
 // Include ESP32
 #elif defined(ESP32)
 #include "platforms/esp/32/fastled_esp32.h"
+#elif defined(FASTLED_HOST) || (!defined(ARDUINO) && (defined(__x86_64__) || defined(__i386__)))
+// Host (desktop) builds, for profiling and debugging
+#include "platforms/host/fastled_host.h"
 #else
 // AVR platforms
 #include "platforms/avr/fastled_avr.h"
@@ -43,4 +43,17 @@ extern volatile uint32_t systick_millis_count;
 #endif
 
 
+// Send the frames of SPI chipsets that encode them whole (APA102, SK9822) out of hardware SPI by DMA, returning as
+// soon as the transfer is queued (see fastspi_dma.h).  Takes a DMA channel.  Set to 0 (here or as a compiler flag)
+// to write them out with the cpu.
+#ifndef FASTLED_SPI_DMA
+#define FASTLED_SPI_DMA 1
+#endif
+
+// Let the lanes of block controllers have lengths of their own (see CLEDController::setLaneLengths).  Costs a check per
+// byte on the way out.  Set to 0 (here or as a compiler flag, all of the library has to agree) to turn it off.
+#ifndef FASTLED_LANE_LENGTHS
+#define FASTLED_LANE_LENGTHS 1
+#endif
+
 #endif
@@ -25,14 +25,15 @@ public:
 	}
 
 	virtual uint16_t getMaxRefreshRate() const { return 400; }
+	virtual uint16_t latchRemaining() { return mWait.remaining(); }
 
 protected:
 
 	virtual void showPixels(PixelController<RGB_ORDER> & pixels) {
     mWait.wait();
-		if(!showRGBInternal(pixels)) {
+		if(!showRGBInternal(pixels, this->m_Stats)) {
       sei(); delayMicroseconds(WAIT_TIME); cli();
-      showRGBInternal(pixels);
+      showRGBInternal(pixels, this->m_Stats);
     }
     mWait.mark();
   }
@@ -66,8 +67,8 @@ protected:
 	}
 
 	// This method is made static to force making register Y available to use for data on AVR - if the method is non-static, then
-	// gcc will use register Y for the this pointer.
-	static uint32_t showRGBInternal(PixelController<RGB_ORDER> pixels) {
+	// gcc will use register Y for the this pointer.  The stretches interrupts are kept off for go into stats.
+	static uint32_t showRGBInternal(PixelController<RGB_ORDER> pixels, LEDControllerStats & stats) {
 	    // Get access to the clock
 		ARM_DEMCR    |= ARM_DEMCR_TRCENA;
 		ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
@@ -83,12 +84,14 @@ protected:
 		register uint8_t b = pixels.loadAndScale0();
 
 		cli();
-		uint32_t next_mark = ARM_DWT_CYCCNT + (T1+T2+T3);
+		uint32_t locked = ARM_DWT_CYCCNT;
+		uint32_t next_mark = locked + (T1+T2+T3);
 
 		while(pixels.has(1)) {
 			pixels.stepDithering();
 			#if (FASTLED_ALLOW_INTERRUPTS == 1)
 			cli();
+			locked = ARM_DWT_CYCCNT;
 			// if interrupts took longer than 45µs, punt on the current frame
 			if(ARM_DWT_CYCCNT > next_mark) {
 				if((ARM_DWT_CYCCNT-next_mark) > ((WAIT_TIME-INTERRUPT_THRESHOLD)*CLKS_PER_US)) { sei(); return 0; }
@@ -109,10 +112,14 @@ protected:
 			writeBits<8+XTRA0>(next_mark, port, hi, lo, b);
 			b = pixels.advanceAndLoadAndScale0();
 			#if (FASTLED_ALLOW_INTERRUPTS == 1)
+			stats.blocked(ARM_DWT_CYCCNT - locked);
 			sei();
 			#endif
 		};
 
+		#if (FASTLED_ALLOW_INTERRUPTS == 0)
+		stats.blocked(ARM_DWT_CYCCNT - locked);
+		#endif
 		sei();
 		return ARM_DWT_CYCCNT;
 	}
@@ -31,7 +31,7 @@ class InlineBlockClocklessController : public CPixelLEDController<RGB_ORDER, LAN
 	data_ptr_t mPort;
 	CMinWait<WAIT_TIME> mWait;
 public:
-	virtual int size() { return CLEDController::size() * LANES; }
+	virtual int size() { return CLEDController::laneLeds(LANES); }
 
 	virtual void showPixels(PixelController<RGB_ORDER, LANES, LANE_MASK> & pixels) { 
 		mWait.wait();
@@ -89,6 +89,7 @@ public:
 	}
 
 	virtual uint16_t getMaxRefreshRate() const { return 400; }
+	virtual uint16_t latchRemaining() { return mWait.remaining(); }
 
 	typedef union {
 		uint8_t bytes[12];
@@ -212,6 +213,8 @@ class SixteenWayInlineBlockClocklessController : public CPixelLEDController<RGB_
 	data_ptr_t mPort;
 	CMinWait<WAIT_TIME> mWait;
 public:
+	virtual uint16_t latchRemaining() { return mWait.remaining(); }
+
 	virtual void init() {
 		static_assert(LANES <= 16, "Maximum of 16 lanes for Teensy parallel controllers!");
 		// FastPin<30>::setOutput();
@@ -13,6 +13,10 @@ FASTLED_NAMESPACE_BEGIN
 
 #if defined(FASTLED_TEENSY3) && defined(CORE_TEENSY)
 
+FASTLED_NAMESPACE_END
+#include "fastspi_dma.h"
+FASTLED_NAMESPACE_BEGIN
+
 // Version 1.20 renamed SPI_t to KINETISK_SPI_t
 #if TEENSYDUINO >= 120
 #define SPI_t KINETISK_SPI_t
@@ -283,7 +287,7 @@ public:
 		// pin/spi configuration happens on select
 	}
 
-	static void waitFully() __attribute__((always_inline)) {
+	static void waitFIFO() __attribute__((always_inline)) {
 		// Wait for the last byte to get shifted into the register
 		cli();
 		while( (SPIX.SR & 0xF000) > 0) {
@@ -297,6 +301,23 @@ public:
 		SPIX.SR |= (SPI_SR_TCF | SPI_SR_EOQF);
 	}
 
+	// wait for everything written so far to be out, a block write going out by DMA included
+	void waitFully() {
+#if (FASTLED_SPI_DMA == 1)
+		if(CKinetisSPIDMA::active(this)) { CKinetisSPIDMA::finish(); return; }
+#endif
+		waitFIFO();
+	}
+
+	// whether a block write is still going out
+	bool busy() {
+#if (FASTLED_SPI_DMA == 1)
+		return CKinetisSPIDMA::active(this) && (CKinetisSPIDMA::busy() || (SPIX.SR & 0xF000));
+#else
+		return false;
+#endif
+	}
+
 	static bool needwait() __attribute__((always_inline)) { return (SPIX.SR & 0x4000); }
 	static void wait() __attribute__((always_inline)) { while( (SPIX.SR & 0x4000) );  }
 	static void wait1() __attribute__((always_inline)) { while( (SPIX.SR & 0xF000) >= 0x2000);  }
@@ -361,6 +382,10 @@ public:
 	}
 
 	void inline select() __attribute__((always_inline)) {
+#if (FASTLED_SPI_DMA == 1)
+		// whoever has the port now has to be done with it first
+		CKinetisSPIDMA::finish();
+#endif
 		save_spi_state();
 		if(m_pSelect != NULL) { m_pSelect->select(); }
 		setSPIRate();
@@ -399,7 +424,33 @@ public:
 		release();
 	}
 
+#if (FASTLED_SPI_DMA == 1)
+	// the end of a block write: the DMA is done, once the FIFO has drained the port can be let go of
+	static void dmaDone(void *pArg) {
+		ARMHardwareSPIOutput *pThis = (ARMHardwareSPIOutput*)pArg;
+		SPIX.RSER = 0;
+		pThis->waitFIFO();
+		SPIX.MCR |= SPI_MCR_CLR_RXF;
+		SPIX.SR = SPI_SR_RFOF | SPI_SR_RFDF;
+		pThis->release();
+	}
+
+	// Write a block of n uint8_ts out by DMA, straight out of data - the write is only queued, so the data has to be
+	// left alone until waitFully returns.  Blocks too big for one transfer, or with no DMA channel free for them,
+	// are written out a byte at a time.
+	void writeBytes(register uint8_t *data, int len) {
+		if(pSPIX != 0x4002C000 || len > CKinetisSPIDMA::maxBytes()) { writeBytes<DATA_NOP>(data, len); return; }
+		select();
+		SPIX.RSER = SPI_RSER_TFFF_RE | SPI_RSER_TFFF_DIRS;
+		if(!CKinetisSPIDMA::start(SPIX.PUSHR, data, len, &dmaDone, this)) {
+			SPIX.RSER = 0;
+			release();
+			writeBytes<DATA_NOP>(data, len);
+		}
+	}
+#else
 	void writeBytes(register uint8_t *data, int len) { writeBytes<DATA_NOP>(data, len); }
+#endif
 
 	// write a block of uint8_ts out in groups of three.  len is the total number of uint8_ts to write out.  The template
 	// parameters indicate how many uint8_ts to skip at the beginning and/or end of each grouping
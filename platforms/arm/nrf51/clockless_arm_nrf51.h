@@ -34,6 +34,7 @@ public:
   }
 
 	virtual uint16_t getMaxRefreshRate() const { return 400; }
+	virtual uint16_t latchRemaining() { return mWait.remaining(); }
 
   virtual void showPixels(PixelController<RGB_ORDER> & pixels) {
     mWait.wait();
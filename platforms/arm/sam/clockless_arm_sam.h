@@ -30,6 +30,7 @@ public:
 	}
 
 	virtual uint16_t getMaxRefreshRate() const { return 400; }
+	virtual uint16_t latchRemaining() { return mWait.remaining(); }
 
 protected:
 
@@ -38,7 +38,7 @@ class InlineBlockClocklessController : public CPixelLEDController<RGB_ORDER, LAN
 	data_ptr_t mPort;
 	CMinWait<WAIT_TIME> mWait;
 public:
-	virtual int size() { return CLEDController::size() * LANES; }
+	virtual int size() { return CLEDController::laneLeds(LANES); }
 	virtual void init() {
     static_assert(LANES <= 8, "Maximum of 8 lanes for Due parallel controllers!");
     if(FIRST_PIN == PORTA_FIRST_PIN) {
@@ -80,6 +80,7 @@ public:
 	}
 
 	virtual uint16_t getMaxRefreshRate() const { return 400; }
+	virtual uint16_t latchRemaining() { return mWait.remaining(); }
 
   virtual void showPixels(PixelController<RGB_ORDER, LANES, PORT_MASK> & pixels) {
     mWait.wait();
@@ -0,0 +1,216 @@
+#ifndef __INC_CLOCKLESS_PWM_BLOCK_ARM_SAM_H
+#define __INC_CLOCKLESS_PWM_BLOCK_ARM_SAM_H
+
+///@file clockless_pwm_block_arm_sam.h
+/// Parallel clockless output for the Due out of the PWM peripheral, by DMA, instead of bit-banging a port with
+/// interrupts off.  The SAM3X's PIO has no DMA requests, and its SPI has one data line, but the PWM's synchronous
+/// channels can have the PDC load all of their duty cycles at every period: each lane is a PWM channel, the shared
+/// period is one led bit (T1+T2+T3), and each period the PDC writes the next bit's duty cycle - T1 for a 0, T1+T2 for
+/// a 1 - for every lane.  Each color byte of every lane is transposed (transpose8x1_MSB) into 8 bit planes, one lane
+/// per bit, which get spread out into the duty cycles.
+///
+/// The duty cycles for a few pixels' worth of data on all lanes go into a buffer (see
+/// FASTLED_SAM_PWM_PIXELS_PER_BUFFER), and there are two of them: while one goes out, the PDC's end of buffer
+/// interrupt refills the other one with the next pixels, so output runs in the background with interrupts on, and
+/// only the refills take the cpu.  The pwm interrupt's priority is raised so a refill always lands in time.
+///
+/// The lanes are PWML0-7, on pins 34, 36, 38, 40, 9, 8, 7 and 6, in lane order - use the WS2811_PORTPWM (etc.)
+/// block chipsets.  The PWM can't be used for analogWrite on those pins at the same time, and there's only one of it,
+/// so there can only be one of these controllers.  Needs FASTLED_SAM_PWM_DMA set to 1 (see led_sysdefs_arm_sam.h).
+
+FASTLED_NAMESPACE_BEGIN
+
+#if defined(__SAM3X8E__) && (FASTLED_SAM_PWM_DMA == 1)
+
+#define PORTPWM_FIRST_PIN 34
+
+/// How many pixels go into each of the two dma buffers, i.e. how many pixels are written out per interrupt.  More
+/// pixels means fewer interrupts for more ram: a buffer takes 48 bytes per pixel per lane.
+#ifndef FASTLED_SAM_PWM_PIXELS_PER_BUFFER
+#define FASTLED_SAM_PWM_PIXELS_PER_BUFFER 4
+#endif
+
+/// The PWM interrupt goes to whichever controller has the PWM, see clockless_pwm_sam.cpp
+struct SAMPWMInterrupt {
+	static void (*sHandler)(void *pArg);
+	static void *sArg;
+};
+
+template <uint8_t LANES, int T1, int T2, int T3, EOrder RGB_ORDER = GRB, int XTRA0 = 0, bool FLIP = false, int WAIT_TIME = 50>
+class PWMBlockClocklessController : public CPixelLEDController<RGB_ORDER, LANES> {
+	static_assert(LANES <= 8, "Maximum of 8 lanes for Due pwm controllers!");
+	static_assert((T1 + T2 + T3) <= 0xFFFF, "The pwm period is 16 bits");
+
+	enum {
+		BITS_PER_SLOT = 8 + XTRA0,
+		DUTIES_PER_PIXEL = 3 * BITS_PER_SLOT * LANES,
+		DUTIES_PER_BUFFER = FASTLED_SAM_PWM_PIXELS_PER_BUFFER * DUTIES_PER_PIXEL
+	};
+
+	uint16_t *mBuffers[2];
+	uint8_t mFree;
+	volatile bool mSending;
+	bool mBusy;
+	bool mEnding;
+
+	// our own copy of the pixel controller, it has to outlive the call to showPixels
+	PixelController<RGB_ORDER, LANES> *mPixels;
+	CMinWait<WAIT_TIME> mWait;
+
+public:
+	PWMBlockClocklessController() : mFree(0), mSending(false), mBusy(false), mEnding(false), mPixels(NULL) {
+		mBuffers[0] = mBuffers[1] = NULL;
+		this->initFlip(FLIP);
+	}
+
+	virtual int size() { return CLEDController::laneLeds(LANES); }
+
+	virtual void init() {
+		// PWML0-7 are peripheral B of PC2, PC4, PC6, PC8, PC21, PC22, PC23 and PC24
+		static const uint8_t sLaneBits[8] = { 2, 4, 6, 8, 21, 22, 23, 24 };
+		uint32_t pins = 0;
+		for(int i = 0; i < LANES; i++) { pins |= (1UL << sLaneBits[i]); }
+
+		for(int i = 0; i < 2; i++) { mBuffers[i] = (uint16_t*)malloc(DUTIES_PER_BUFFER * 2); }
+
+		pmc_enable_periph_clk(ID_PWM);
+		PWM->PWM_DIS = 0xFF;
+		PWM->PWM_PTCR = PERIPH_PTCR_TXTDIS;
+		for(int i = 0; i < LANES; i++) {
+			// left aligned, starting low: PWMLx is high for the duty cycle
+			PWM->PWM_CH_NUM[i].PWM_CMR = PWM_CMR_CPRE_MCK;
+			PWM->PWM_CH_NUM[i].PWM_CPRD = T1 + T2 + T3;
+			PWM->PWM_CH_NUM[i].PWM_CDTY = 0;
+		}
+		// synchronous channels on channel 0's counter, with the PDC writing the duty cycles every period
+		PWM->PWM_SCM = ((1UL << LANES) - 1) | PWM_SCM_UPDM_MODE2;
+		PWM->PWM_SCUP = PWM_SCUP_UPR(0);
+		PWM->PWM_IDR2 = 0xFFFFFFFF;
+		PWM->PWM_ENA = PWM_ENA_CHID0;
+
+		PIOC->PIO_PUDR = pins;
+		PIOC->PIO_ABSR |= pins;
+		PIOC->PIO_PDR = pins;
+
+		SAMPWMInterrupt::sHandler = interruptHandler;
+		SAMPWMInterrupt::sArg = this;
+		NVIC_SetPriority(PWM_IRQn, 0);
+		NVIC_EnableIRQ(PWM_IRQn);
+	}
+
+	virtual uint16_t getMaxRefreshRate() const { return 400; }
+	virtual uint16_t latchRemaining() { return mSending ? WAIT_TIME : mWait.remaining(); }
+
+	virtual bool isShowing() { return mSending; }
+
+	virtual void waitFully() {
+		if(mBusy) {
+			while(mSending) {}
+			mBusy = false;
+			mWait.mark();
+		}
+	}
+
+protected:
+
+	virtual void showPixels(PixelController<RGB_ORDER, LANES> & pixels) {
+		waitFully();
+		if(!pixels.has(1) || mBuffers[0] == NULL || mBuffers[1] == NULL) { return; }
+
+		if(mPixels == NULL) {
+			mPixels = new PixelController<RGB_ORDER, LANES>(pixels);
+		} else {
+			*mPixels = pixels;
+		}
+
+		mEnding = false;
+		mFree = 0;
+		mPixels->preStepFirstByteDithering();
+		uint16_t n0 = fillBuffer(mBuffers[0]);
+		uint16_t n1 = fillBuffer(mBuffers[1]);
+
+		mWait.wait();
+		mBusy = true;
+		mSending = true;
+		PWM->PWM_TPR = (uint32_t)mBuffers[0];
+		PWM->PWM_TCR = n0;
+		PWM->PWM_TNPR = (uint32_t)mBuffers[1];
+		PWM->PWM_TNCR = n1;
+		PWM->PWM_IER2 = mEnding ? PWM_IER2_TXBUFE : PWM_IER2_ENDTX;
+		PWM->PWM_PTCR = PERIPH_PTCR_TXTEN;
+	}
+
+	/// Transpose one color slot of the current pixel on every lane into 8 bit planes, MSB first, and write the duty
+	/// cycles of its bits
+	template<int SLOT> __attribute__((always_inline)) inline uint16_t *encodeSlot(uint16_t *pBuf) {
+		// lane N's byte ends up in bit N of the plane
+		uint8_t in[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+		uint8_t planes[8];
+		for(int i = 0; i < LANES; i++) {
+			in[i] = PixelController<RGB_ORDER, LANES>::template loadAndScale<SLOT>(*mPixels, i);
+		}
+		transpose8x1_MSB(in, planes);
+
+		for(int b = 0; b < 8; b++) {
+			uint8_t plane = planes[b];
+			for(int i = 0; i < LANES; i++) {
+				*pBuf++ = (plane & 0x01) ? (T1 + T2) : T1;
+				plane >>= 1;
+			}
+		}
+		for(int b = 0; b < XTRA0 * LANES; b++) { *pBuf++ = T1; }
+		return pBuf;
+	}
+
+	/// Fill a dma buffer with the next pixels.  Once out of pixels, the buffer gets one period of 0 duty cycles, which
+	/// stays in the channels and holds the lines low.  Returns how many duty cycles went in.
+	uint16_t fillBuffer(uint16_t *pBuf) {
+		if(!mPixels->has(1)) {
+			for(int i = 0; i < LANES; i++) { pBuf[i] = 0; }
+			mEnding = true;
+			return LANES;
+		}
+
+		uint16_t *p = pBuf;
+		uint16_t *pEnd = pBuf + DUTIES_PER_BUFFER;
+		while(p < pEnd && mPixels->has(1)) {
+			p = encodeSlot<0>(p);
+			p = encodeSlot<1>(p);
+			p = encodeSlot<2>(p);
+			mPixels->advanceData();
+			mPixels->stepDithering();
+		}
+		return p - pBuf;
+	}
+
+	static void interruptHandler(void *pArg) {
+		PWMBlockClocklessController *pController = (PWMBlockClocklessController*)pArg;
+
+		if(pController->mEnding) {
+			// the 0 duty cycles have been handed to the channels, and nothing's queued behind them
+			if(PWM->PWM_TCR == 0 && PWM->PWM_TNCR == 0) {
+				PWM->PWM_IDR2 = PWM_IDR2_ENDTX | PWM_IDR2_TXBUFE;
+				PWM->PWM_PTCR = PERIPH_PTCR_TXTDIS;
+				pController->mSending = false;
+			}
+			return;
+		}
+
+		// the buffer that was going out is done and the other one's going out now, so queue the next pixels behind it
+		uint16_t *pBuf = pController->mBuffers[pController->mFree];
+		pController->mFree ^= 1;
+		uint16_t n = pController->fillBuffer(pBuf);
+		PWM->PWM_TNPR = (uint32_t)pBuf;
+		PWM->PWM_TNCR = n;
+		if(pController->mEnding) {
+			PWM->PWM_IDR2 = PWM_IDR2_ENDTX;
+			PWM->PWM_IER2 = PWM_IER2_TXBUFE;
+		}
+	}
+};
+
+#endif
+
+FASTLED_NAMESPACE_END
+
+#endif
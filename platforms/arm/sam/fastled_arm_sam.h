@@ -7,5 +7,6 @@
 #include "fastspi_arm_sam.h"
 #include "clockless_arm_sam.h"
 #include "clockless_block_arm_sam.h"
+#include "clockless_pwm_block_arm_sam.h"
 
 #endif
@@ -35,5 +35,18 @@
 #define cli()  __disable_irq(); __disable_fault_irq();
 #define sei() __enable_irq(); __enable_fault_irq();
 
+// Let the lanes of block controllers have lengths of their own (see CLEDController::setLaneLengths).  Costs a check per
+// byte on the way out.  Set to 0 (here or as a compiler flag, all of the library has to agree) to turn it off.
+#ifndef FASTLED_LANE_LENGTHS
+#define FASTLED_LANE_LENGTHS 1
+#endif
+
+// Have the PWM's synchronous channels write the WS2811_PORTPWM (etc.) block outputs by DMA, in the background, see
+// clockless_pwm_block_arm_sam.h.  Off by default, since it defines PWM_Handler for the whole sketch, which then can't
+// have one of its own.  Set to 1 (here or as a compiler flag, all of the library has to agree) to turn it on.
+#ifndef FASTLED_SAM_PWM_DMA
+#define FASTLED_SAM_PWM_DMA 0
+#endif
+
 
 #endif
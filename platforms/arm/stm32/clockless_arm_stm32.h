@@ -15,18 +15,48 @@ class ClocklessController : public CPixelLEDController<RGB_ORDER> {
   data_t mPinMask;
   data_ptr_t mPort;
   CMinWait<WAIT_TIME> mWait;
+#if (FASTLED_STM32_TIMER_DMA == 1)
+  typedef STM32TimerClockless<DATA_PIN, T1, T2, T3, RGB_ORDER, XTRA0, WAIT_TIME> Timer;
+  Timer mTimer;
+  // whether the pin is a plain gpio output, for bit-banging, rather than its timer channel
+  bool mBitBang;
+#endif
 public:
   virtual void init() {
-    FastPin<DATA_PIN>::setOutput();
     mPinMask = FastPin<DATA_PIN>::mask();
     mPort = FastPin<DATA_PIN>::port();
+#if (FASTLED_STM32_TIMER_DMA == 1)
+    mBitBang = !Timer::usable();
+    if(!mBitBang) { Timer::init(); return; }
+#endif
+    FastPin<DATA_PIN>::setOutput();
   }
 
 	virtual uint16_t getMaxRefreshRate() const { return 400; }
+	virtual uint16_t latchRemaining() {
+#if (FASTLED_STM32_TIMER_DMA == 1)
+		if(mTimer.isShowing()) { return WAIT_TIME; }
+#endif
+		return mWait.remaining();
+	}
+
+#if (FASTLED_STM32_TIMER_DMA == 1)
+	virtual void waitFully() { mTimer.waitFully(); }
+	virtual bool isShowing() { return mTimer.isShowing(); }
+#endif
 
 protected:
 
   virtual void showPixels(PixelController<RGB_ORDER> & pixels) {
+#if (FASTLED_STM32_TIMER_DMA == 1)
+    if(Timer::usable()) {
+      // frames the timer can't take are bit-banged, with the pin taken back from the timer channel until it can again
+      if(mBitBang) { Timer::init(); mBitBang = false; }
+      if(mTimer.show(pixels, mWait)) { return; }
+      FastPin<DATA_PIN>::setOutput();
+      mBitBang = true;
+    }
+#endif
     mWait.wait();
     if(!showRGBInternal(pixels)) {
       sei(); delayMicroseconds(WAIT_TIME); cli();
@@ -0,0 +1,242 @@
+#ifndef __INC_CLOCKLESS_TIMER_ARM_STM32_H
+#define __INC_CLOCKLESS_TIMER_ARM_STM32_H
+
+///@file clockless_timer_arm_stm32.h
+/// Clockless output on the STM32F1's general purpose timers, for strips on pins that are timer channels.  The timer
+/// runs in pwm mode with a period of one led bit (T1+T2+T3), and each update event has the DMA load the next bit's duty
+/// cycle into the channel's (preloaded) compare register: T1 for a 0 bit, T1+T2 for a 1 bit.  The frame is encoded up
+/// front, through the usual PixelController scaling and dithering, into a byte per led bit (24 bytes of ram per rgb
+/// led), and goes out in the background - interrupts stay on, and FastLED.show can get on with the other strips.
+///
+/// Each timer has one DMA channel for its update event, so the strips on different channels of the same timer take
+/// turns.  Spark core pins on timers:
+///
+///     TIM1    8 (PA8, ch1), 9 (PA9, ch2)
+///     TIM2    10 (PA0, ch1), 11 (PA1, ch2), 19 (PA2, ch3), 18 (PA3, ch4)
+///     TIM3    14 (PA6, ch1), 15 (PA7, ch2), 16 (PB0, ch3), 17 (PB1, ch4) - only without FASTLED_SPI_DMA, since the
+///             hardware SPI's DMA channel is also TIM3's update channel
+///     TIM4    1 (PB6, ch1), 0 (PB7, ch2)
+///
+/// A timer used for leds can't also be used for analogWrite, tone or servos.  All timers run at F_CPU (APB1's are
+/// doubled up from the divided bus clock).
+
+FASTLED_NAMESPACE_BEGIN
+
+#if defined(STM32F10X_MD)
+
+template<int TIMER> struct STM32Timer;
+
+#define _DEFTIMER_STM32(N, BUS, DMACH, ADV) template<> struct STM32Timer<N> { \
+	enum { DMA_CHANNEL = DMACH, ADVANCED = ADV }; \
+	static inline TIM_TypeDef *r() __attribute__((always_inline)) { return TIM ## N; } \
+	static inline DMA_Channel_TypeDef *dma() __attribute__((always_inline)) { return DMA1_Channel ## DMACH; } \
+	static inline void enable() { RCC->BUS ## ENR |= RCC_ ## BUS ## ENR_TIM ## N ## EN; } };
+
+// TIMx_UP's DMA1 channel, and whether it's an advanced timer (with outputs that need enabling in BDTR)
+_DEFTIMER_STM32(1, APB2, 5, 1);
+_DEFTIMER_STM32(2, APB1, 2, 0);
+_DEFTIMER_STM32(3, APB1, 3, 0);
+_DEFTIMER_STM32(4, APB1, 7, 0);
+
+/// The timer and channel a pin's an output of, TIMER 0 for pins that aren't on a timer
+template<int PIN> struct STM32TimerPin { enum { TIMER = 0, CHANNEL = 0 }; };
+
+#define _DEFTIMERPIN_STM32(PIN, TIM, CH) template<> struct STM32TimerPin<PIN> { enum { TIMER = TIM, CHANNEL = CH }; };
+
+#if defined(SPARK)
+_DEFTIMERPIN_STM32(8, 1, 1); _DEFTIMERPIN_STM32(9, 1, 2);
+_DEFTIMERPIN_STM32(10, 2, 1); _DEFTIMERPIN_STM32(11, 2, 2); _DEFTIMERPIN_STM32(19, 2, 3); _DEFTIMERPIN_STM32(18, 2, 4);
+#if (FASTLED_SPI_DMA != 1)
+_DEFTIMERPIN_STM32(14, 3, 1); _DEFTIMERPIN_STM32(15, 3, 2); _DEFTIMERPIN_STM32(16, 3, 3); _DEFTIMERPIN_STM32(17, 3, 4);
+#endif
+_DEFTIMERPIN_STM32(1, 4, 1); _DEFTIMERPIN_STM32(0, 4, 2);
+#endif
+
+/// The DMA side of a timer's output.  There's one frame going out of a timer at a time, whichever channel it's on -
+/// starting the next one finishes the one before it first.  The output that started a frame gets called back once
+/// it's done.
+template<int TIMER> class STM32TimerDMA {
+	typedef STM32Timer<TIMER> Timer;
+	void (*mDone)(void *pArg);
+	void *mDoneArg;
+
+	static STM32TimerDMA & state() {
+		static STM32TimerDMA sState;
+		return sState;
+	}
+
+	static inline uint32_t tcMask() { return 1UL << ((4 * (Timer::DMA_CHANNEL - 1)) + 1); }
+	static inline uint32_t clearMask() { return 1UL << (4 * (Timer::DMA_CHANNEL - 1)); }
+
+public:
+	/// start sending len duty cycles from data to a channel's compare register, one per period of period clocks.  The
+	/// data has to end in two 0 duty cycles: the transfer's done as the first of them goes out, and the last one is
+	/// left in the compare register, holding the line low.
+	static void start(volatile uint16_t *pCCR, uint16_t period, const uint8_t *data, uint16_t len, void (*pDone)(void*), void *pArg) {
+		STM32TimerDMA & s = state();
+		finish();
+		TIM_TypeDef *pTimer = Timer::r();
+		DMA_Channel_TypeDef *pDMA = Timer::dma();
+
+		pTimer->CR1 &= ~TIM_CR1_CEN;
+		pTimer->DIER &= ~TIM_DIER_UDE;
+		pTimer->ARR = period - 1;
+		pTimer->CNT = 0;
+		*pCCR = 0;
+		// load the period and the 0 duty cycle before the first update event asks for data
+		pTimer->EGR = TIM_EGR_UG;
+		pTimer->SR = 0;
+
+		DMA1->IFCR = clearMask();
+		pDMA->CCR = 0;
+		pDMA->CPAR = (uint32_t)pCCR;
+		pDMA->CMAR = (uint32_t)data;
+		pDMA->CNDTR = len;
+		// bytes from memory, zero extended into the 16 bit register
+		pDMA->CCR = DMA_CCR1_DIR | DMA_CCR1_MINC | DMA_CCR1_PSIZE_0 | DMA_CCR1_PL_1;
+		s.mDone = pDone;
+		s.mDoneArg = pArg;
+		pDMA->CCR |= DMA_CCR1_EN;
+
+		pTimer->DIER |= TIM_DIER_UDE;
+		pTimer->CR1 |= TIM_CR1_CEN;
+	}
+
+	/// whether a frame started by the given output is still active - it's only done once finish has been called
+	static bool active(void *pArg) { return state().mDone != NULL && state().mDoneArg == pArg; }
+
+	/// whether the frame is still going out
+	static bool busy() { return state().mDone != NULL && (DMA1->ISR & tcMask()) == 0; }
+
+	/// wait for the frame going out (if there is one) to be done, stop the timer, and hand it back to the output that
+	/// started it
+	static void finish() {
+		STM32TimerDMA & s = state();
+		if(s.mDone == NULL) { return; }
+		while((DMA1->ISR & tcMask()) == 0) {}
+		Timer::r()->CR1 &= ~TIM_CR1_CEN;
+		Timer::r()->DIER &= ~TIM_DIER_UDE;
+		Timer::dma()->CCR = 0;
+		DMA1->IFCR = clearMask();
+		void (*pDone)(void*) = s.mDone;
+		s.mDone = NULL;
+		(*pDone)(s.mDoneArg);
+	}
+};
+
+/// Writes clockless led data out of a timer channel by DMA, see clockless_timer_arm_stm32.h.  ClocklessController uses
+/// it for strips on timer pins when FASTLED_STM32_TIMER_DMA is set.  The frame buffer is allocated on the first frame,
+/// and grown as needed.
+/// @tparam TIMED whether the pin's on a timer and the high times fit the buffer's bytes - strips that don't get bit-banged
+template <int DATA_PIN, int T1, int T2, int T3, EOrder RGB_ORDER = RGB, int XTRA0 = 0, int WAIT_TIME = 50,
+	bool TIMED = (STM32TimerPin<DATA_PIN>::TIMER != 0) && ((T1 + T2) <= 0xFF) && ((T1 + T2 + T3) <= 0xFFFF)>
+class STM32TimerClockless {
+	typedef STM32TimerPin<DATA_PIN> Pin;
+	typedef STM32Timer<Pin::TIMER> Timer;
+	typedef STM32TimerDMA<Pin::TIMER> DMA;
+
+	uint8_t *mBuffer;
+	int mSize;
+	CMinWait<WAIT_TIME> *mWait;
+
+	static inline volatile uint16_t *ccr() { return (volatile uint16_t*)((volatile uint8_t*)&Timer::r()->CCR1 + (4 * (Pin::CHANNEL - 1))); }
+
+	// the latch time starts once the frame's out
+	static void done(void *pArg) { ((STM32TimerClockless*)pArg)->mWait->mark(); }
+
+	static inline uint8_t *encodeByte(uint8_t *p, uint8_t b) __attribute__((always_inline)) {
+		for(int i = 0; i < 8; i++) {
+			*p++ = (b & 0x80) ? (T1 + T2) : T1;
+			b <<= 1;
+		}
+		for(int i = 0; i < XTRA0; i++) { *p++ = T1; }
+		return p;
+	}
+
+public:
+	STM32TimerClockless() : mBuffer(NULL), mSize(0), mWait(NULL) {}
+
+	static bool usable() { return true; }
+
+	/// hand the pin over to its timer channel, in pwm mode with the compare register preloaded
+	static void init() {
+		TIM_TypeDef *pTimer = Timer::r();
+		Timer::enable();
+		RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+		pinMode(DATA_PIN, AF_OUTPUT_PUSHPULL);
+
+		pTimer->PSC = 0;
+		pTimer->CR1 = TIM_CR1_ARPE;
+		const int shift = ((Pin::CHANNEL - 1) & 1) * 8;
+		const uint16_t mode = (TIM_CCMR1_OC1M_2 | TIM_CCMR1_OC1M_1 | TIM_CCMR1_OC1PE) << shift;
+		if(Pin::CHANNEL <= 2) {
+			pTimer->CCMR1 = (pTimer->CCMR1 & ~(0xFF << shift)) | mode;
+		} else {
+			pTimer->CCMR2 = (pTimer->CCMR2 & ~(0xFF << shift)) | mode;
+		}
+		*ccr() = 0;
+		pTimer->CCER |= TIM_CCER_CC1E << (4 * (Pin::CHANNEL - 1));
+		if(Timer::ADVANCED) { pTimer->BDTR |= TIM_BDTR_MOE; }
+	}
+
+	/// encode a frame and start it going out, after the latch time since the last one
+	/// @returns false if there's no room for the frame - the caller has to bit-bang it
+	bool show(PixelController<RGB_ORDER> & pixels, CMinWait<WAIT_TIME> & wait) {
+		waitFully();
+		const int bytes = (pixels.hasWhite() ? 4 : 3) * (8 + XTRA0);
+		const long len = ((long)pixels.size() * bytes) + 2;
+		if(len > 0xFFFF) { return false; }
+		if(len > mSize) {
+			if(mBuffer != NULL) { free(mBuffer); }
+			mBuffer = (uint8_t*)malloc(len);
+			mSize = (mBuffer != NULL) ? len : 0;
+			if(mBuffer == NULL) { return false; }
+		}
+
+		uint8_t *p = mBuffer;
+		pixels.preStepFirstByteDithering();
+		while(pixels.has(1)) {
+			p = encodeByte(p, pixels.loadAndScale0());
+			p = encodeByte(p, pixels.loadAndScale1());
+			p = encodeByte(p, pixels.loadAndScale2());
+			if(pixels.hasWhite()) { p = encodeByte(p, pixels.loadAndScaleW()); pixels.stepWhiteDithering(); }
+			pixels.advanceData();
+			pixels.stepDithering();
+		}
+		*p++ = 0;
+		*p++ = 0;
+
+		mWait = &wait;
+		wait.wait();
+		DMA::start(ccr(), T1 + T2 + T3, mBuffer, len, done, this);
+		return true;
+	}
+
+	/// wait for the frame going out to be done
+	void waitFully() { if(DMA::active(this)) { DMA::finish(); } }
+
+	/// whether the frame is still going out - one that's done gets finished up on the way
+	bool isShowing() {
+		if(!DMA::active(this)) { return false; }
+		if(DMA::busy()) { return true; }
+		DMA::finish();
+		return false;
+	}
+};
+
+/// Strips on pins that aren't timer channels are always bit-banged
+template <int DATA_PIN, int T1, int T2, int T3, EOrder RGB_ORDER, int XTRA0, int WAIT_TIME>
+class STM32TimerClockless<DATA_PIN, T1, T2, T3, RGB_ORDER, XTRA0, WAIT_TIME, false> {
+public:
+	static bool usable() { return false; }
+	static void init() {}
+	bool show(PixelController<RGB_ORDER> & pixels, CMinWait<WAIT_TIME> & wait) { return false; }
+	void waitFully() {}
+	bool isShowing() { return false; }
+};
+
+#endif
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -4,7 +4,8 @@
 // Include the sam headers
 #include "fastled_delay.h"
 #include "fastpin_arm_stm32.h"
-// #include "fastspi_arm_stm32.h"
+#include "fastspi_arm_stm32.h"
+#include "clockless_timer_arm_stm32.h"
 #include "clockless_arm_stm32.h"
 
 #endif
@@ -0,0 +1,200 @@
+#ifndef __INC_FASTSPI_ARM_STM32_H
+#define __INC_FASTSPI_ARM_STM32_H
+
+FASTLED_NAMESPACE_BEGIN
+
+#if defined(STM32F10X_MD)
+
+FASTLED_NAMESPACE_END
+#include "fastspi_dma.h"
+FASTLED_NAMESPACE_BEGIN
+
+#if (FASTLED_SPI_DMA == 1)
+// Chipsets encode whole frames into one buffer, which goes out of it by DMA (see writeBytes)
+#define FASTLED_SPI_BLOCK_WRITES
+#endif
+
+/// Hardware SPI output on the STM32F1's SPI1 (SCK on PA5, MOSI on PA7), master, mode 0, 8 bit frames.  SPI1 is clocked
+/// off APB2 (F_CPU), divided down by the nearest power of two at or above _SPI_CLOCK_DIVIDER.  Block writes go out by
+/// DMA (DMA1 channel 3, SPI1's tx request) straight out of the caller's buffer, and return as soon as the transfer is
+/// started - waitFully finishes it.
+template <uint8_t _DATA_PIN, uint8_t _CLOCK_PIN, uint8_t _SPI_CLOCK_DIVIDER>
+class STM32HardwareSPIOutput {
+	Selectable *m_pSelect;
+
+	// the first baud rate setting (F_CPU / 2^(br+1)) that's no faster than the requested clock
+	static uint16_t baudRate() {
+		uint16_t br = 0;
+		while(br < 7 && (2 << br) < _SPI_CLOCK_DIVIDER) { br++; }
+		return br << 3;
+	}
+
+	static inline void waitForEmpty() __attribute__((always_inline)) { while((SPI1->SR & SPI_SR_TXE) == 0); }
+
+#if (FASTLED_SPI_DMA == 1)
+	static bool & dmaActive() { static bool sActive = false; return sActive; }
+
+	// wait for a block write to be done moving bytes into the SPI, and turn the DMA back off
+	static void finishDMA() {
+		if(!dmaActive()) { return; }
+		while((DMA1->ISR & DMA_ISR_TCIF3) == 0);
+		DMA1_Channel3->CCR = 0;
+		DMA1->IFCR = DMA_IFCR_CGIF3;
+		SPI1->CR2 &= ~SPI_CR2_TXDMAEN;
+		dmaActive() = false;
+	}
+#endif
+
+public:
+	STM32HardwareSPIOutput() { m_pSelect = NULL; }
+	STM32HardwareSPIOutput(Selectable *pSelect) { m_pSelect = pSelect; }
+	void setSelect(Selectable *pSelect) { m_pSelect = pSelect; }
+
+	// initialize the SPI subsystem
+	void init() {
+		RCC->APB2ENR |= RCC_APB2ENR_SPI1EN;
+#if (FASTLED_SPI_DMA == 1)
+		RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+#endif
+		pinMode(_DATA_PIN, AF_OUTPUT_PUSHPULL);
+		pinMode(_CLOCK_PIN, AF_OUTPUT_PUSHPULL);
+
+		SPI1->CR1 = 0;
+		SPI1->CR2 = 0;
+		SPI1->CR1 = SPI_CR1_MSTR | SPI_CR1_SSM | SPI_CR1_SSI | baudRate();
+		SPI1->CR1 |= SPI_CR1_SPE;
+	}
+
+	// latch the CS select
+	void inline select() __attribute__((always_inline)) {
+#if (FASTLED_SPI_DMA == 1)
+		// a block write still going out has to finish first
+		waitFully();
+#endif
+		if(m_pSelect != NULL) { m_pSelect->select(); }
+	}
+
+	// release the CS select
+	void inline release() __attribute__((always_inline)) { if(m_pSelect != NULL) { m_pSelect->release(); } }
+
+	// wait until all queued up data has been written, a block write going out by DMA included
+	static void waitFully() {
+#if (FASTLED_SPI_DMA == 1)
+		finishDMA();
+#endif
+		waitForEmpty();
+		while(SPI1->SR & SPI_SR_BSY);
+	}
+
+	// whether a block write is still going out
+	static bool busy() {
+#if (FASTLED_SPI_DMA == 1)
+		return dmaActive() && (((DMA1->ISR & DMA_ISR_TCIF3) == 0) || (SPI1->SR & SPI_SR_BSY));
+#else
+		return false;
+#endif
+	}
+
+	// wait until the SPI subsystem is ready for more data to write
+	static void wait() __attribute__((always_inline)) { waitForEmpty(); }
+
+	// write a byte out via SPI (returns immediately on writing register)
+	static void writeByte(uint8_t b) __attribute__((always_inline)) { waitForEmpty(); SPI1->DR = b; }
+	static void writeByteNoWait(uint8_t b) __attribute__((always_inline)) { SPI1->DR = b; }
+	static void writeBytePostWait(uint8_t b) __attribute__((always_inline)) { SPI1->DR = b; waitForEmpty(); }
+
+	// write a word out via SPI (returns immediately on writing register)
+	static void writeWord(uint16_t w) __attribute__((always_inline)) { writeByte(w >> 8); writeByte(w & 0xFF); }
+
+	// A raw set of writing byte values, assumes setup/init/waiting done elsewhere
+	static void writeBytesValueRaw(uint8_t value, int len) {
+		while(len--) { writeByte(value); }
+	}
+
+	// A full cycle of writing a value for len bytes, including select, release, and waiting
+	void writeBytesValue(uint8_t value, int len) {
+		select(); writeBytesValueRaw(value, len); waitFully(); release();
+	}
+
+	template <class D> void writeBytes(register uint8_t *data, int len) {
+		uint8_t *end = data + len;
+		select();
+		while(data != end) {
+			writeByte(D::adjust(*data++));
+		}
+		D::postBlock(len);
+		waitFully();
+		release();
+	}
+
+#if (FASTLED_SPI_DMA == 1)
+	// write a block of len bytes out by DMA, straight out of data - the write is only started, so the data has to be
+	// left alone until waitFully returns.  With a select, the write waits to be out before releasing it.
+	void writeBytes(register uint8_t *data, int len) {
+		if(len > 0xFFFF) { writeBytes<DATA_NOP>(data, len); return; }
+		select();
+		DMA1->IFCR = DMA_IFCR_CGIF3;
+		DMA1_Channel3->CPAR = (uint32_t)&SPI1->DR;
+		DMA1_Channel3->CMAR = (uint32_t)data;
+		DMA1_Channel3->CNDTR = len;
+		DMA1_Channel3->CCR = DMA_CCR1_DIR | DMA_CCR1_MINC | DMA_CCR1_PL_1;
+		dmaActive() = true;
+		DMA1_Channel3->CCR |= DMA_CCR1_EN;
+		SPI1->CR2 |= SPI_CR2_TXDMAEN;
+		if(m_pSelect != NULL) {
+			waitFully();
+			release();
+		}
+	}
+#else
+	void writeBytes(register uint8_t *data, int len) { writeBytes<DATA_NOP>(data, len); }
+#endif
+
+	// write a single bit out, which bit from the passed in byte is determined by template parameter
+	// not the most efficient mechanism in the world - but should be enough for sm16716 and friends
+	template <uint8_t BIT> inline void writeBit(uint8_t b) {
+		// need to wait for all existing data to go out the door, first, then bit bang the bit with the SPI off
+		waitFully();
+		SPI1->CR1 &= ~SPI_CR1_SPE;
+		FastPin<_DATA_PIN>::setOutput();
+		FastPin<_CLOCK_PIN>::setOutput();
+		if(b & (1 << BIT)) {
+			FastPin<_DATA_PIN>::hi();
+		} else {
+			FastPin<_DATA_PIN>::lo();
+		}
+
+		FastPin<_CLOCK_PIN>::hi();
+		FastPin<_CLOCK_PIN>::lo();
+		pinMode(_DATA_PIN, AF_OUTPUT_PUSHPULL);
+		pinMode(_CLOCK_PIN, AF_OUTPUT_PUSHPULL);
+		SPI1->CR1 |= SPI_CR1_SPE;
+	}
+
+	// write a block of uint8_ts out in groups of three.  len is the total number of uint8_ts to write out.  The template
+	// parameters indicate how many uint8_ts to skip at the beginning and/or end of each grouping
+	template <uint8_t FLAGS, class D, EOrder RGB_ORDER> void writePixels(PixelController<RGB_ORDER> pixels) {
+		select();
+		int len = pixels.mLen;
+
+		while(pixels.has(1)) {
+			if(FLAGS & FLAG_START_BIT) {
+				writeBit<0>(1);
+			}
+			writeByte(D::adjust(pixels.loadAndScale0()));
+			writeByte(D::adjust(pixels.loadAndScale1()));
+			writeByte(D::adjust(pixels.loadAndScale2()));
+			pixels.advanceData();
+			pixels.stepDithering();
+		}
+		D::postBlock(len);
+		waitFully();
+		release();
+	}
+};
+
+#endif
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -42,6 +42,20 @@ typedef volatile       uint8_t RwReg; /**< Read-Write 8-bit register (volatile u
 
 #define FASTLED_NO_PINMAP
 
+// Write clockless strips on pins that are timer channels out of the timer by DMA, in the background, instead of
+// bit-banging them with interrupts off (see clockless_timer_arm_stm32.h).  Takes the timer, and a byte of ram per led
+// bit.  Set to 0 (here or as a compiler flag) to bit-bang all pins.
+#ifndef FASTLED_STM32_TIMER_DMA
+#define FASTLED_STM32_TIMER_DMA 1
+#endif
+
+// Send the frames of SPI chipsets that encode them whole (APA102, SK9822) out of hardware SPI by DMA, returning as
+// soon as the transfer is started (see fastspi_arm_stm32.h).  Takes DMA1 channel 3, which leaves TIM3's pins to be
+// bit-banged.  Set to 0 (here or as a compiler flag) to write them out with the cpu.
+#ifndef FASTLED_SPI_DMA
+#define FASTLED_SPI_DMA 1
+#endif
+
 #define F_CPU 72000000
 
 #endif
@@ -0,0 +1,63 @@
+#pragma once
+
+///@file clock_esp32.h
+/// What the cpu and apb clocks are actually running at, and keeping them there while a frame goes out.  With
+/// esp-idf's power management on (CONFIG_PM_ENABLE), dynamic frequency scaling can lower either clock whenever
+/// nothing holds a lock on it, and the clockless timings - cpu cycles for the bit-banged output, apb ticks for the
+/// rmt - have to follow.
+
+extern "C" {
+#include "sdkconfig.h"
+#include "rom/ets_sys.h"
+#include "soc/rtc.h"
+#ifdef CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
+}
+
+FASTLED_NAMESPACE_BEGIN
+
+/// the clock the cpu is running at right now, in Mhz
+inline uint32_t esp32CpuMHz() { return ets_get_cpu_frequency(); }
+
+/// the apb clock (which the rmt and i2s peripherals are clocked off) right now, in Mhz
+inline uint32_t esp32ApbMHz() { return rtc_clk_apb_freq_get() / 1000000L; }
+
+/// A power management lock that keeps frequency scaling from lowering the cpu (or apb) clock while it's held.  The
+/// lock is created on first use.  Without CONFIG_PM_ENABLE the clocks never change, and this does nothing.
+class ESP32ClockLock {
+#ifdef CONFIG_PM_ENABLE
+	esp_pm_lock_handle_t mHandle;
+	bool mApb;
+	bool mHeld;
+public:
+	/// @param apb lock the apb clock rather than the cpu clock
+	ESP32ClockLock(bool apb) : mHandle(NULL), mApb(apb), mHeld(false) {}
+
+	/// raise the clock to its maximum, if it isn't there already, and keep it there until release
+	void acquire() {
+		if(mHeld) { return; }
+		if(mHandle == NULL && esp_pm_lock_create(mApb ? ESP_PM_APB_FREQ_MAX : ESP_PM_CPU_FREQ_MAX, 0, "FastLED", &mHandle) != ESP_OK) {
+			mHandle = NULL;
+			return;
+		}
+		esp_pm_lock_acquire(mHandle);
+		mHeld = true;
+	}
+
+	/// let frequency scaling have the clock again
+	void release() {
+		if(mHeld) {
+			esp_pm_lock_release(mHandle);
+			mHeld = false;
+		}
+	}
+#else
+public:
+	ESP32ClockLock(bool) {}
+	void acquire() {}
+	void release() {}
+#endif
+};
+
+FASTLED_NAMESPACE_END
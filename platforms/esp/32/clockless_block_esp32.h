@@ -1,167 +1,459 @@
-#ifndef __INC_CLOCKLESS_BLOCK_ESP8266_H
-#define __INC_CLOCKLESS_BLOCK_ESP8266_H
+#ifndef __INC_CLOCKLESS_BLOCK_ESP32_H
+#define __INC_CLOCKLESS_BLOCK_ESP32_H
+
+///@file clockless_block_esp32.h
+/// Parallel clockless output for the ESP32, using one of the I2S peripherals in LCD (parallel) mode.  Every
+/// I2S sample is a 32 bit word with one bit per lane, and each bit of led data is FASTLED_I2S_PULSES_PER_BIT
+/// samples long: high for T1, the data bit for T2, low for T3.  The samples for a few pixels' worth of data on
+/// all lanes go into a dma buffer (see FASTLED_ESP32_I2S_PIXELS_PER_BUFFER), and a few of those buffers (see
+/// FASTLED_ESP32_I2S_BUFFERS) are chained in a ring - the dma's end of frame interrupt refills the buffers sent since
+/// it last ran with the next pixels, transposing them out of the PixelController as it goes, while the others go out.
+/// So the memory taken is the same however long the strips are, and a refill has until the rest of the ring is out
+/// to get done.  The high and low parts of each bit never change, so a refill only has to write the T2 samples.
+///
+/// The lanes can be on any output capable GPIOs - see FASTLED_ESP32_I2S_LANE_PINS below.  The FIRST_PIN
+/// template parameter is only kept for compatibility with the other block controllers: every port name the
+/// teensy's block outputs take (WS2811_PORTD, WS2811_PORTDC, ...) and the OctoWS2811 controller map onto the
+/// I2S lanes here, so sketches written for those run unchanged.  Each controller takes one of the two I2S
+/// peripherals (see fastled_esp32_claim_i2s), so there can be at most two of them - fewer with a HUB75 panel.
+
+#include <assert.h>
+
+extern "C" {
+#include "esp_heap_caps.h"
+#include "esp_intr_alloc.h"
+#include "driver/gpio.h"
+#include "driver/periph_ctrl.h"
+#include "rom/gpio.h"
+#include "rom/lldesc.h"
+#include "soc/gpio_sig_map.h"
+#include "soc/i2s_struct.h"
+#include "freertos/semphr.h"
+}
 
 #define FASTLED_HAS_BLOCKLESS 1
 
-#define PORT_MASK (((1<<LANES)-1) & 0x0000FFFFL)
-#define MIN(X,Y) (((X)<(Y)) ? (X):(Y))
-#define USED_LANES (MIN(LANES,4))
-#define REAL_FIRST_PIN 12
-#define LAST_PIN (12 + USED_LANES - 1)
+/// The GPIOs used for each lane, in lane order.  Define this (as a brace enclosed list) before including
+/// FastLED.h to pick your own pins.  Up to 24 lanes are supported, lanes past the end of the list aren't
+/// routed to any pin.
+#ifndef FASTLED_ESP32_I2S_LANE_PINS
+#define FASTLED_ESP32_I2S_LANE_PINS { 12, 13, 14, 15, 16, 17, 18, 19, 21, 22, 23, 25, 26, 27, 32, 33, 2, 4, 5, 0 }
+#endif
+
+#define FASTLED_I2S_MAX_LANES 24
+
+/// How many pixels go into each of the two dma buffers, i.e. how many pixels are written out per interrupt.  More
+/// pixels means fewer interrupts (and less cpu time taken by them) for more dma memory.  Capped at what fits in a
+/// single dma descriptor, which is 4 pixels at 800khz.
+#ifndef FASTLED_ESP32_I2S_PIXELS_PER_BUFFER
+#define FASTLED_ESP32_I2S_PIXELS_PER_BUFFER 4
+#endif
+
+/// How many dma buffers are chained in the ring.  A refill has to be done before the dma gets back around to the buffer,
+/// so more buffers let the interrupt run that much later (behind wifi, say) without the leds seeing a gap, for more dma
+/// memory.  At least 2.
+#ifndef FASTLED_ESP32_I2S_BUFFERS
+#define FASTLED_ESP32_I2S_BUFFERS 3
+#endif
+
+// The I2S sample clock is 80Mhz / 10 = 8Mhz, so each sample (pulse) is 125ns
+#define FASTLED_I2S_CLKM_DIV 10
+#define FASTLED_I2S_PULSE_HZ (80000000L / FASTLED_I2S_CLKM_DIV)
+#define FASTLED_I2S_CLKS_PER_PULSE (F_CPU / FASTLED_I2S_PULSE_HZ)
+#define FASTLED_I2S_PULSES(_CLKS) ((((_CLKS) + (FASTLED_I2S_CLKS_PER_PULSE/2)) / FASTLED_I2S_CLKS_PER_PULSE) ? \
+	(((_CLKS) + (FASTLED_I2S_CLKS_PER_PULSE/2)) / FASTLED_I2S_CLKS_PER_PULSE) : 1)
 
 FASTLED_NAMESPACE_BEGIN
 
+/// Hand out I2S peripheral 0 or 1, to whichever controller asks for it first.  Returns false if it's taken already.
+inline bool fastled_esp32_claim_i2s(int device) {
+	static uint8_t sClaimed = 0;
+	if(sClaimed & (1 << device)) { return false; }
+	sClaimed |= (1 << device);
+	return true;
+}
+
+/// Hand out whichever I2S peripheral is still free, I2S0 first.  Returns -1 once both are taken.
+inline int fastled_esp32_claim_any_i2s() {
+	for(int device = 0; device < 2; device++) {
+		if(fastled_esp32_claim_i2s(device)) { return device; }
+	}
+	return -1;
+}
+
 #ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
 extern uint32_t _frame_cnt;
 extern uint32_t _retry_cnt;
 #endif
 
 template <uint8_t LANES, int FIRST_PIN, int T1, int T2, int T3, EOrder RGB_ORDER = GRB, int XTRA0 = 0, bool FLIP = false, int WAIT_TIME = 5>
-class InlineBlockClocklessController : public CPixelLEDController<RGB_ORDER, LANES, PORT_MASK> {
-	typedef typename FastPin<FIRST_PIN>::port_ptr_t data_ptr_t;
-	typedef typename FastPin<FIRST_PIN>::port_t data_t;
-
-	data_t mPinMask;
-	data_ptr_t mPort;
+class InlineBlockClocklessController : public CPixelLEDController<RGB_ORDER, LANES> {
+	static_assert(LANES <= FASTLED_I2S_MAX_LANES, "The ESP32 I2S output supports at most 24 lanes");
+	static_assert(FASTLED_ESP32_I2S_BUFFERS >= 2, "The ESP32 I2S output needs at least 2 dma buffers");
+
+	enum {
+		P1 = FASTLED_I2S_PULSES(T1),
+		P2 = FASTLED_I2S_PULSES(T2),
+		P3 = FASTLED_I2S_PULSES(T3),
+		PULSES_PER_BIT = P1 + P2 + P3,
+		BITS_PER_SLOT = 8 + XTRA0,
+		WORDS_PER_PIXEL = 3 * BITS_PER_SLOT * PULSES_PER_BIT,
+		PIXELS_FIT = 4092 / (WORDS_PER_PIXEL * 4),
+		PIXELS_PER_BUFFER = (FASTLED_ESP32_I2S_PIXELS_PER_BUFFER < PIXELS_FIT) ? FASTLED_ESP32_I2S_PIXELS_PER_BUFFER : (PIXELS_FIT ? PIXELS_FIT : 1),
+		WORDS_PER_BUFFER = PIXELS_PER_BUFFER * WORDS_PER_PIXEL,
+		LANE_MASK = (LANES == 32) ? 0xFFFFFFFF : ((1UL << LANES) - 1)
+	};
+
+	i2s_dev_t *mI2S;
+	intr_handle_t mIntrHandle;
+	SemaphoreHandle_t mTXDone;
+	// the I2S clock comes from the apb, frequency scaling mustn't slow it under a frame
+	ESP32ClockLock mClockLock;
+	bool mBusy;
+	volatile bool mSending;
+	bool mEnding;
+	// the first buffer of 0's past the last pixel
+	int mEndBuffer;
+	// the oldest buffer that's been sent and not yet refilled
+	int mNextFill;
+
+	lldesc_t *mDescriptors[FASTLED_ESP32_I2S_BUFFERS];
+	uint32_t *mBuffers[FASTLED_ESP32_I2S_BUFFERS];
+
+	// our own copy of the pixel controller, it has to outlive the call to showPixels
+	PixelController<RGB_ORDER, LANES> *mPixels;
 	CMinWait<WAIT_TIME> mWait;
+
 public:
-	virtual int size() { return CLEDController::size() * LANES; }
-
-	virtual void showPixels(PixelController<RGB_ORDER, LANES, PORT_MASK> & pixels) {
-		// mWait.wait();
-		/*uint32_t clocks = */
-		int cnt=FASTLED_INTERRUPT_RETRY_COUNT;
-		while(!showRGBInternal(pixels) && cnt--) {
-      ets_intr_unlock();
-			#ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
-			_retry_cnt++;
-			#endif
-      delayMicroseconds(WAIT_TIME * 10);
-      ets_intr_lock();
-    }
-		// #if FASTLED_ALLOW_INTTERUPTS == 0
-		// Adjust the timer
-		// long microsTaken = CLKS_TO_MICROS(clocks);
-		// MS_COUNTER += (1 + (microsTaken / 1000));
-		// #endif
-
-		// mWait.mark();
+	InlineBlockClocklessController() : mI2S(NULL), mIntrHandle(NULL), mTXDone(NULL), mClockLock(true), mBusy(false), mSending(false), mEnding(false), mEndBuffer(0), mNextFill(0), mPixels(NULL) {
+		for(int i = 0; i < FASTLED_ESP32_I2S_BUFFERS; i++) { mDescriptors[i] = NULL; mBuffers[i] = NULL; }
+		this->initFlip(FLIP);
 	}
 
-  template<int PIN> static void initPin() {
-    if(PIN >= REAL_FIRST_PIN && PIN <= LAST_PIN) {
-			_ESPPIN<PIN, 1<<(PIN & 0xFF)>::setOutput();
-      // FastPin<PIN>::setOutput();
-    }
-  }
-
-  virtual void init() {
-		// Only supportd on pins 12-15
-    initPin<12>();
-    initPin<13>();
-    initPin<14>();
-    initPin<15>();
-    mPinMask = FastPin<FIRST_PIN>::mask();
-    mPort = FastPin<FIRST_PIN>::port();
-
-		// Serial.print("Mask is "); Serial.println(PORT_MASK);
-  }
-
-  virtual uint16_t getMaxRefreshRate() const { return 400; }
-
-	typedef union {
-		uint8_t bytes[8];
-		uint16_t shorts[4];
-		uint32_t raw[2];
-	} Lines;
-
-#define ESP_ADJUST 0 // (2*(F_CPU/24000000))
-#define ESP_ADJUST2 0
-  template<int BITS,int PX> __attribute__ ((always_inline)) inline static void writeBits(register uint32_t & last_mark, register Lines & b, PixelController<RGB_ORDER, LANES, PORT_MASK> &pixels) { // , register uint32_t & b2)  {
-	  Lines b2 = b;
-		transpose8x1_noinline(b.bytes,b2.bytes);
-
-		register uint8_t d = pixels.template getd<PX>(pixels);
-		register uint8_t scale = pixels.template getscale<PX>(pixels);
-
-		for(register uint32_t i = 0; i < USED_LANES; i++) {
-			while((__clock_cycles() - last_mark) < (T1+T2+T3));
-			last_mark = __clock_cycles();
-			*FastPin<FIRST_PIN>::sport() = PORT_MASK << REAL_FIRST_PIN;
-
-			uint32_t nword = ((uint32_t)(~b2.bytes[7-i]) & PORT_MASK) << REAL_FIRST_PIN;
-			while((__clock_cycles() - last_mark) < (T1-6));
-			*FastPin<FIRST_PIN>::cport() = nword;
-
-			while((__clock_cycles() - last_mark) < (T1+T2));
-			*FastPin<FIRST_PIN>::cport() = PORT_MASK << REAL_FIRST_PIN;
-
-			b.bytes[i] = pixels.template loadAndScale<PX>(pixels,i,d,scale);
+	virtual int size() { return CLEDController::laneLeds(LANES); }
+
+	virtual void init() {
+		int device = fastled_esp32_claim_any_i2s();
+		// both I2S peripherals are in use already: the controller stays dark
+		assert(device != -1 && "no free I2S peripheral for this block controller");
+		if(device == -1) { return; }
+		int sigBase;
+		int intrSource;
+
+		if(device == 0) {
+			mI2S = &I2S0;
+			periph_module_enable(PERIPH_I2S0_MODULE);
+			sigBase = I2S0O_DATA_OUT0_IDX;
+			intrSource = ETS_I2S0_INTR_SOURCE;
+		} else {
+			mI2S = &I2S1;
+			periph_module_enable(PERIPH_I2S1_MODULE);
+			sigBase = I2S1O_DATA_OUT0_IDX;
+			intrSource = ETS_I2S1_INTR_SOURCE;
+		}
+
+		// route each lane's I2S data output to its pin
+		static const int sLanePins[] = FASTLED_ESP32_I2S_LANE_PINS;
+		for(int i = 0; i < LANES && i < (int)(sizeof(sLanePins)/sizeof(sLanePins[0])); i++) {
+			pinMode(sLanePins[i], OUTPUT);
+			gpio_matrix_out(sLanePins[i], sigBase + i, false, false);
+		}
+
+		resetI2S();
+
+		// Parallel (lcd) mode, 32 bit samples, everything on the right channel
+		mI2S->conf.tx_msb_right = 1;
+		mI2S->conf.tx_mono = 0;
+		mI2S->conf.tx_short_sync = 0;
+		mI2S->conf.tx_msb_shift = 0;
+		mI2S->conf.tx_right_first = 1;
+		mI2S->conf.tx_slave_mod = 0;
+
+		mI2S->conf2.val = 0;
+		mI2S->conf2.lcd_en = 1;
+		mI2S->conf2.lcd_tx_wrx2_en = 0;
+		mI2S->conf2.lcd_tx_sdx2_en = 0;
+
+		mI2S->sample_rate_conf.val = 0;
+		mI2S->sample_rate_conf.tx_bits_mod = 32;
+		mI2S->sample_rate_conf.tx_bck_div_num = 1;
+
+		mI2S->clkm_conf.val = 0;
+		mI2S->clkm_conf.clka_en = 0;
+		mI2S->clkm_conf.clkm_div_a = 1;
+		mI2S->clkm_conf.clkm_div_b = 0;
+		mI2S->clkm_conf.clkm_div_num = FASTLED_I2S_CLKM_DIV;
+
+		mI2S->fifo_conf.val = 0;
+		mI2S->fifo_conf.tx_fifo_mod_force_en = 1;
+		mI2S->fifo_conf.tx_fifo_mod = 3;
+		mI2S->fifo_conf.tx_data_num = 32;
+		mI2S->fifo_conf.dscr_en = 1;
+
+		mI2S->conf1.val = 0;
+		mI2S->conf1.tx_stop_en = 0;
+		mI2S->conf1.tx_pcm_bypass = 1;
+
+		mI2S->conf_chan.val = 0;
+		mI2S->conf_chan.tx_chan_mod = 1;
+
+		mI2S->timing.val = 0;
+
+		// FASTLED_ESP32_I2S_BUFFERS dma buffers of PIXELS_PER_BUFFER pixels each, linked in a ring
+		for(int i = 0; i < FASTLED_ESP32_I2S_BUFFERS; i++) {
+			mBuffers[i] = (uint32_t*)heap_caps_malloc(WORDS_PER_BUFFER * 4, MALLOC_CAP_DMA);
+			mDescriptors[i] = (lldesc_t*)heap_caps_malloc(sizeof(lldesc_t), MALLOC_CAP_DMA);
+			if(mBuffers[i] == NULL || mDescriptors[i] == NULL) {
+				// not enough dma memory: the controller stays dark
+				for(int j = 0; j <= i; j++) {
+					heap_caps_free(mBuffers[j]); mBuffers[j] = NULL;
+					heap_caps_free(mDescriptors[j]); mDescriptors[j] = NULL;
+				}
+				return;
+			}
+			mDescriptors[i]->length = WORDS_PER_BUFFER * 4;
+			mDescriptors[i]->size = WORDS_PER_BUFFER * 4;
+			mDescriptors[i]->owner = 1;
+			mDescriptors[i]->sosf = 1;
+			mDescriptors[i]->eof = 1;
+			mDescriptors[i]->offset = 0;
+			mDescriptors[i]->buf = (uint8_t*)mBuffers[i];
 		}
+		for(int i = 0; i < FASTLED_ESP32_I2S_BUFFERS; i++) {
+			mDescriptors[i]->qe.stqe_next = mDescriptors[(i + 1) % FASTLED_ESP32_I2S_BUFFERS];
+		}
+
+		mTXDone = xSemaphoreCreateBinary();
+		esp_intr_alloc(intrSource, FASTLED_ESP32_INTR_FLAGS, interruptHandler, this, &mIntrHandle);
+	}
 
-		for(register uint32_t i = USED_LANES; i < 8; i++) {
-			while((__clock_cycles() - last_mark) < (T1+T2+T3));
-			last_mark = __clock_cycles();
-			*FastPin<FIRST_PIN>::sport() = PORT_MASK << REAL_FIRST_PIN;
+	virtual uint16_t getMaxRefreshRate() const { return 400; }
+	virtual uint16_t latchRemaining() { return mWait.remaining(); }
 
-			uint32_t nword = ((uint32_t)(~b2.bytes[7-i]) & PORT_MASK) << REAL_FIRST_PIN;
-			while((__clock_cycles() - last_mark) < (T1-6));
-			*FastPin<FIRST_PIN>::cport() = nword;
+	virtual bool isShowing() { return mSending; }
 
-			while((__clock_cycles() - last_mark) < (T1+T2));
-			*FastPin<FIRST_PIN>::cport() = PORT_MASK << REAL_FIRST_PIN;
+	virtual void waitFully() {
+		if(mBusy) {
+			xSemaphoreTake(mTXDone, portMAX_DELAY);
+			mClockLock.release();
+			mBusy = false;
+			mWait.mark();
 		}
 	}
 
-  // This method is made static to force making register Y available to use for data on AVR - if the method is non-static, then
-	// gcc will use register Y for the this pointer.
-		static uint32_t showRGBInternal(PixelController<RGB_ORDER, LANES, PORT_MASK> &allpixels) {
+protected:
+
+	virtual void showPixels(PixelController<RGB_ORDER, LANES> & pixels) {
+		waitFully();
+		if(!pixels.has(1) || mDescriptors[0] == NULL) { return; }
 
-		// Setup the pixel controller and load/scale the first byte
-		Lines b0;
+		if(mPixels == NULL) {
+			mPixels = new PixelController<RGB_ORDER, LANES>(pixels);
+		} else {
+			*mPixels = pixels;
+		}
 
-		for(int i = 0; i < USED_LANES; i++) {
-			b0.bytes[i] = allpixels.loadAndScale0(i);
+		mEnding = false;
+		mNextFill = 0;
+		for(int i = 0; i < FASTLED_ESP32_I2S_BUFFERS; i++) {
+			if(mEnding) {
+				memset(mBuffers[i], 0, WORDS_PER_BUFFER * 4);
+			} else {
+				prepBuffer(mBuffers[i]);
+				fillBuffer(i);
+			}
 		}
-		allpixels.preStepFirstByteDithering();
 
-		ets_intr_lock();
-		uint32_t _start = __clock_cycles();
-		uint32_t last_mark = _start;
+		mWait.wait();
+		mClockLock.acquire();
+		mBusy = true;
+		mSending = true;
+		startI2S();
+		#ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
+		_frame_cnt++;
+		#endif
+	}
 
-		while(allpixels.has(1)) {
-			// Write first byte, read next byte
-			writeBits<8+XTRA0,1>(last_mark, b0, allpixels);
+	void resetI2S() {
+		mI2S->lc_conf.in_rst = 1; mI2S->lc_conf.out_rst = 1; mI2S->lc_conf.ahbm_rst = 1; mI2S->lc_conf.ahbm_fifo_rst = 1;
+		mI2S->lc_conf.in_rst = 0; mI2S->lc_conf.out_rst = 0; mI2S->lc_conf.ahbm_rst = 0; mI2S->lc_conf.ahbm_fifo_rst = 0;
+		mI2S->conf.tx_reset = 1; mI2S->conf.tx_fifo_reset = 1; mI2S->conf.rx_reset = 1; mI2S->conf.rx_fifo_reset = 1;
+		mI2S->conf.tx_reset = 0; mI2S->conf.tx_fifo_reset = 0; mI2S->conf.rx_reset = 0; mI2S->conf.rx_fifo_reset = 0;
+	}
 
-			// Write second byte, read 3rd byte
-			writeBits<8+XTRA0,2>(last_mark, b0, allpixels);
-			allpixels.advanceData();
+	void startI2S() {
+		resetI2S();
+		mI2S->lc_conf.val = 0;
+		mI2S->lc_conf.out_data_burst_en = 1;
+		mI2S->lc_conf.outdscr_burst_en = 1;
+		mI2S->out_link.addr = (uint32_t)mDescriptors[0];
+		mI2S->out_link.start = 1;
+		mI2S->int_clr.val = mI2S->int_raw.val;
+		mI2S->int_ena.val = 0;
+		mI2S->int_ena.out_eof = 1;
+		mI2S->conf.tx_start = 1;
+	}
 
-			// Write third byte
-			writeBits<8+XTRA0,0>(last_mark, b0, allpixels);
+	FASTLED_IRAM void stopI2S() {
+		mI2S->int_ena.val = 0;
+		mI2S->out_link.stop = 1;
+		mI2S->conf.tx_start = 0;
+	}
 
-      #if (FASTLED_ALLOW_INTERRUPTS == 1)
-			ets_intr_unlock();
-			#endif
+	/// Write the parts of every bit that don't depend on the led data - high for T1, low for T3, and the
+	/// XTRA0 trailing bits of each byte, which are sent as 1's
+	void prepBuffer(uint32_t *pBuf) {
+		for(int bit = 0; bit < 3 * BITS_PER_SLOT * PIXELS_PER_BUFFER; bit++) {
+			uint32_t data = ((bit % BITS_PER_SLOT) >= 8) ? LANE_MASK : 0;
+			int p = 0;
+			for(; p < P1; p++) { *pBuf++ = LANE_MASK; }
+			for(; p < P1+P2; p++) { *pBuf++ = data; }
+			for(; p < PULSES_PER_BIT; p++) { *pBuf++ = 0; }
+		}
+	}
 
-			allpixels.stepDithering();
+	/// Transpose one color slot of the current pixel on every lane into 8 bit planes, MSB first, and write
+	/// them into the T2 samples of those bits
+	template<int SLOT> __attribute__((always_inline)) inline void encodeSlot(uint32_t *pBuf) {
+		uint32_t planes[8];
 
-			#if (FASTLED_ALLOW_INTERRUPTS == 1)
-      ets_intr_lock();
-			// if interrupts took longer than 45µs, punt on the current frame
-			if((int32_t)(__clock_cycles()-last_mark) > 0) {
-				if((int32_t)(__clock_cycles()-last_mark) > (T1+T2+T3+((WAIT_TIME-INTERRUPT_THRESHOLD)*CLKS_PER_US))) { ets_intr_unlock(); return 0; }
+		if(LANES > 8) {
+			// lanes past LANES stay 0
+			uint8_t in[(LANES > 16) ? 32 : 16] = { 0 };
+			for(int i = 0; i < LANES; i++) {
+				in[i] = PixelController<RGB_ORDER, LANES>::template loadAndScale<SLOT>(*mPixels, i);
+			}
+			if(LANES > 16) {
+				transpose32x8(in, planes);
+			} else {
+				uint16_t out[8];
+				transpose16x8(in, out);
+				for(int b = 0; b < 8; b++) { planes[b] = out[b]; }
 			}
-			#endif
-		};
+		} else {
+			// lane N's byte ends up in bit N of the plane
+			uint8_t in[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+			uint8_t out[8];
+			for(int i = 0; i < LANES; i++) {
+				in[i] = PixelController<RGB_ORDER, LANES>::template loadAndScale<SLOT>(*mPixels, i);
+			}
+			transpose8x1_MSB(in, out);
+			for(int b = 0; b < 8; b++) { planes[b] = out[b]; }
+		}
 
-    ets_intr_unlock();
-		#ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
-		_frame_cnt++;
-		#endif
-    return __clock_cycles() - _start;
+		pBuf += SLOT * BITS_PER_SLOT * PULSES_PER_BIT + P1;
+		for(int b = 0; b < 8; b++) {
+			for(int p = 0; p < P2; p++) { pBuf[p] = planes[b]; }
+			pBuf += PULSES_PER_BIT;
+		}
+	}
+
+	/// Fill a dma buffer with the next pixels.  Once out of pixels, the rest of the buffer is zeroed so the
+	/// lines stay low until the last pixel is out.  Returns false if there was no pixel left to write.
+	FASTLED_IRAM bool fillBuffer(int buffer) {
+		uint32_t *pBuf = mBuffers[buffer];
+		if(!mPixels->has(1)) {
+			memset(pBuf, 0, WORDS_PER_BUFFER * 4);
+			mEnding = true;
+			mEndBuffer = buffer;
+			return false;
+		}
+
+		uint32_t *pEnd = pBuf + WORDS_PER_BUFFER;
+		for(; pBuf < pEnd && mPixels->has(1); pBuf += WORDS_PER_PIXEL) {
+			encodeSlot<0>(pBuf);
+			encodeSlot<1>(pBuf);
+			encodeSlot<2>(pBuf);
+			mPixels->advanceData();
+			mPixels->stepDithering();
+		}
+		if(pBuf < pEnd) { memset(pBuf, 0, (pEnd - pBuf) * 4); }
+		return true;
+	}
+
+	/// A buffer has been sent: refill it with the next pixels, or once they're all out, zero it - or, if it's the
+	/// buffer of 0's behind the last pixel, stop.
+	/// @returns false once the output has stopped
+	FASTLED_IRAM bool bufferSent(int buffer) {
+		if(!mEnding) {
+			fillBuffer(buffer);
+		} else if(buffer == mEndBuffer) {
+			// the 0's behind the last pixel have been through the fifo, so it's all out
+			stopI2S();
+			mSending = false;
+			return false;
+		} else {
+			// the last pixels are on their way out, anything the dma reads past the end has to be 0's
+			memset(mBuffers[buffer], 0, WORDS_PER_BUFFER * 4);
+		}
+		return true;
+	}
+
+	static FASTLED_IRAM void interruptHandler(void *arg) {
+		InlineBlockClocklessController *pController = (InlineBlockClocklessController*)arg;
+		i2s_dev_t *i2s = pController->mI2S;
+
+		if(i2s->int_st.out_eof) {
+			i2s->int_clr.val = i2s->int_raw.val;
+
+			// out_eof_des_addr is the last buffer sent - if the interrupt ran late, the ones before it since the last
+			// refill have been sent too, and all of them get refilled, oldest first
+			lldesc_t *pDone = (lldesc_t*)i2s->out_eof_des_addr;
+			int done = 0;
+			while(done < (FASTLED_ESP32_I2S_BUFFERS - 1) && pDone != pController->mDescriptors[done]) { done++; }
+
+			bool bSending = true;
+			for(;;) {
+				int buffer = pController->mNextFill;
+				pController->mNextFill = (buffer + 1) % FASTLED_ESP32_I2S_BUFFERS;
+				if(!pController->bufferSent(buffer)) { bSending = false; break; }
+				if(buffer == done) { break; }
+			}
+
+			if(!bSending) {
+				BaseType_t HPTaskAwoken = pdFALSE;
+				xSemaphoreGiveFromISR(pController->mTXDone, &HPTaskAwoken);
+				if(HPTaskAwoken == pdTRUE) { portYIELD_FROM_ISR(); }
+			}
+		}
 	}
 };
 
+/// The teensy's sixteen lane block output, on the I2S lanes
+template <uint8_t LANES, int T1, int T2, int T3, EOrder RGB_ORDER = GRB, int XTRA0 = 0, bool FLIP = false, int WAIT_TIME = 5>
+class SixteenWayInlineBlockClocklessController : public InlineBlockClocklessController<LANES, 0, T1, T2, T3, RGB_ORDER, XTRA0, FLIP, WAIT_TIME> {};
+
+#ifdef USE_OCTOWS2811
+// the OctoWS2811 library's chip settings, for sketches that pass them in themselves
+#ifndef WS2811_800kHz
+#define WS2811_800kHz 0x00
+#define WS2811_400kHz 0x10
+#define WS2813_800kHz 0x20
+#endif
+
+/// The OctoWS2811 controller, eight lanes on the I2S output
+template<EOrder RGB_ORDER = GRB, uint8_t CHIP = WS2811_800kHz>
+class COctoWS2811Controller : public InlineBlockClocklessController<8, 0,
+	(CHIP == WS2811_400kHz) ? NS(800) : NS(320),
+	(CHIP == WS2811_400kHz) ? NS(800) : NS(320),
+	(CHIP == WS2811_400kHz) ? NS(900) : NS(640),
+	RGB_ORDER, 0, false, (CHIP == WS2813_800kHz) ? 300 : 5> {};
+#endif
+
 FASTLED_NAMESPACE_END
+
+// Every port the block outputs of other platforms take maps onto the I2S lanes
+#ifndef PORTB_FIRST_PIN
+#define PORTB_FIRST_PIN 0
+#endif
+#ifndef PORTC_FIRST_PIN
+#define PORTC_FIRST_PIN 15
+#endif
+#ifndef PORTD_FIRST_PIN
+#define PORTD_FIRST_PIN 2
+#endif
+#ifndef HAS_PORTDC
+#define HAS_PORTDC 1
+#endif
+
 #endif
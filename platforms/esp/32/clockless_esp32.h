@@ -4,15 +4,8 @@ FASTLED_NAMESPACE_BEGIN
 
 #ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
 extern uint32_t _frame_cnt;
-extern uint32_t _retry_cnt;
 #endif
-
-// Info on reading cycle counter from https://github.com/kbeckmann/nodemcu-firmware/blob/ws2812-dual/app/modules/ws2812.c
-__attribute__ ((always_inline)) inline static uint32_t __clock_cycles() {
-  uint32_t cyc;
-  __asm__ __volatile__ ("rsr %0,ccount":"=a" (cyc));
-  return cyc;
-}
+extern uint32_t _retry_cnt;
 
 #define FASTLED_HAS_CLOCKLESS 1
 
@@ -24,7 +17,32 @@ class ClocklessController : public CPixelLEDController<RGB_ORDER> {
 	data_t mPinMask;
 	data_ptr_t mPort;
 	CMinWait<WAIT_TIME> mWait;
+	CInterruptSpacing mSpacing;
+	ESP32ClockLock mClockLock;
+
+	// T1, T1+T2 and T1+T2+T3 are in cycles at F_CPU - these are the same timings in cycles of the clock the cpu is
+	// actually running at, worked out again whenever that changes
+	uint32_t mCpuMHz;
+	uint32_t mT1;
+	uint32_t mT12;
+	uint32_t mT123;
+	int32_t mMaxGap;
+
+	static uint32_t cpuClocks(uint32_t clks, uint32_t mhz) { return ((clks * mhz) + (F_CPU / 2000000L)) / (F_CPU / 1000000L); }
+
+	void updateTimings() {
+		uint32_t mhz = esp32CpuMHz();
+		if(mhz == mCpuMHz) { return; }
+		mCpuMHz = mhz;
+		mT1 = cpuClocks(T1, mhz);
+		mT12 = cpuClocks(T1+T2, mhz);
+		mT123 = cpuClocks(T1+T2+T3, mhz);
+		mMaxGap = (int32_t)(mT123 + ((WAIT_TIME-INTERRUPT_THRESHOLD) * mhz));
+	}
+
 public:
+	ClocklessController() : mClockLock(false), mCpuMHz(0) { this->initFlip(FLIP); }
+
 	virtual void init() {
 		FastPin<DATA_PIN>::setOutput();
 		mPinMask = FastPin<DATA_PIN>::mask();
@@ -32,47 +50,64 @@ public:
 	}
 
 	virtual uint16_t getMaxRefreshRate() const { return 400; }
+	virtual uint16_t latchRemaining() { return mWait.remaining(); }
 
 protected:
 
 	virtual void showPixels(PixelController<RGB_ORDER> & pixels) {
     mWait.wait();
+		// keep frequency scaling from changing the clock in the middle of the frame, then time the bits against
+		// the clock it's at
+		mClockLock.acquire();
+		updateTimings();
 		int cnt = FASTLED_INTERRUPT_RETRY_COUNT;
-    while((showRGBInternal(pixels)==0) && cnt--) {
-      #ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
+		bool firstTry = true;
+    while((showRGBInternal(pixels, mT1, mT12, mT123, mMaxGap, mSpacing.spacing(), this->m_Stats)==0) && cnt--) {
       _retry_cnt++;
-      #endif
+      FASTLED_TRACE_EVENT(TRACE_RETRY, cnt);
+      this->m_Stats.retries++;
+      // the strip starts over at its first pixel after the latch time, so try again with fewer interrupt windows
+      mSpacing.restarted();
+      firstTry = false;
       // ets_intr_unlock();
       interrupts();
       delayMicroseconds(WAIT_TIME);
       // ets_intr_lock();
       noInterrupts();
     }
+		mSpacing.finished(firstTry);
+		this->m_Stats.interruptSpacing = mSpacing.spacing();
+		mClockLock.release();
     mWait.mark();
   }
 
 #define _ESP_ADJ (0)
 #define _ESP_ADJ2 (0)
 
-	template<int BITS> __attribute__ ((always_inline)) inline static void writeBits(register uint32_t & last_mark, register uint32_t b)  {
+	template<int BITS> __attribute__ ((always_inline)) inline static void writeBits(register uint32_t & last_mark, register uint32_t b,
+			register uint32_t t1, register uint32_t t12, register uint32_t t123)  {
     b = ~b; b <<= 24;
     for(register uint32_t i = BITS; i > 0; i--) {
-      while((__clock_cycles() - last_mark) < (T1+T2+T3));
+      while((__clock_cycles() - last_mark) < t123);
 			last_mark = __clock_cycles();
       FastPin<DATA_PIN>::hi();
 
-      while((__clock_cycles() - last_mark) < T1);
+      while((__clock_cycles() - last_mark) < t1);
       if(b & 0x80000000L) { FastPin<DATA_PIN>::lo(); }
       b <<= 1;
 
-      while((__clock_cycles() - last_mark) < (T1+T2));
+      while((__clock_cycles() - last_mark) < t12);
       FastPin<DATA_PIN>::lo();
 		}
 	}
 
 	// This method is made static to force making register Y available to use for data on AVR - if the method is non-static, then
 	// gcc will use register Y for the this pointer.
-	static uint32_t showRGBInternal(PixelController<RGB_ORDER> pixels) {
+	// t1, t12 and t123 are T1, T1+T2 and T1+T2+T3 at the current clock, maxGap how long an interrupt may hold up a
+	// frame before it's given up on, spacing the number of pixels to write between interrupt windows.  The stretches
+	// interrupts are kept off for go into stats.  It runs from iram (FASTLED_IRAM), along with everything it inlines:
+	// writeBits and the PixelController functions.
+	static FASTLED_IRAM uint32_t showRGBInternal(PixelController<RGB_ORDER> pixels, uint32_t t1, uint32_t t12, uint32_t t123, int32_t maxGap, uint16_t spacing, LEDControllerStats & stats) {
 		// Setup the pixel controller and load/scale the first byte
 		pixels.preStepFirstByteDithering();
 		register uint32_t b = pixels.loadAndScale0();
@@ -81,36 +116,48 @@ protected:
     noInterrupts();
     uint32_t start = __clock_cycles();
 		uint32_t last_mark = start;
+		uint32_t locked = start;
+		uint16_t untilWindow = spacing;
 		while(pixels.has(1)) {
 			// Write first byte, read next byte
-			writeBits<8+XTRA0>(last_mark, b);
+			writeBits<8+XTRA0>(last_mark, b, t1, t12, t123);
 			b = pixels.loadAndScale1();
 
 			// Write second byte, read 3rd byte
-			writeBits<8+XTRA0>(last_mark, b);
+			writeBits<8+XTRA0>(last_mark, b, t1, t12, t123);
 			b = pixels.loadAndScale2();
 
-			// Write third byte, read 1st byte of next pixel
-			writeBits<8+XTRA0>(last_mark, b);
+			// Write third byte, then the white byte for rgbw data, read 1st byte of next pixel
+			writeBits<8+XTRA0>(last_mark, b, t1, t12, t123);
+			if(pixels.hasWhite()) {
+				writeBits<8+XTRA0>(last_mark, pixels.loadAndScaleW(), t1, t12, t123);
+				pixels.stepWhiteDithering();
+			}
       b = pixels.advanceAndLoadAndScale0();
 
 			#if (FASTLED_ALLOW_INTERRUPTS == 1)
-			// ets_intr_unlock();
-      interrupts();
-			#endif
-
-      pixels.stepDithering();
-
-			#if (FASTLED_ALLOW_INTERRUPTS == 1)
-			// ets_intr_lock();
-      noInterrupts();
-			// if interrupts took longer than 45µs, punt on the current frame
-			if((int32_t)(__clock_cycles()-last_mark) > 0) {
-				if((int32_t)(__clock_cycles()-last_mark) > (T1+T2+T3+((WAIT_TIME-INTERRUPT_THRESHOLD)*CLKS_PER_US))) { sei(); return 0; }
+			if(--untilWindow == 0) {
+				untilWindow = spacing;
+				stats.blocked(__clock_cycles() - locked);
+				// ets_intr_unlock();
+        interrupts();
+        pixels.stepDithering();
+				// ets_intr_lock();
+        noInterrupts();
+				locked = __clock_cycles();
+				// if interrupts took longer than 45µs, punt on the current frame
+				if((int32_t)(__clock_cycles()-last_mark) > 0) {
+					if((int32_t)(__clock_cycles()-last_mark) > maxGap) { sei(); return 0; }
+				}
+			} else {
+        pixels.stepDithering();
 			}
+			#else
+      pixels.stepDithering();
 			#endif
 		};
 
+		stats.blocked(__clock_cycles() - locked);
 		// ets_intr_unlock();
     interrupts();
     #ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
@@ -120,4 +167,165 @@ protected:
 	}
 };
 
+/// The bit-banged clockless output with its pin, timings and color order taken at runtime instead of as template
+/// parameters - for pins and chipsets that come from a configuration, and for builds with many strips, which then
+/// share a single copy of the (iram resident) output loop instead of one per ClocklessController instantiation.  A
+/// pixel's bytes are all loaded before it goes out, instead of each one while the one before it does, which makes the
+/// low time between pixels a little longer.  Add it with FastLED.addLeds(&controller, leds, nLeds); it has to stay
+/// around.
+class RuntimeClocklessController : public CPixelLEDController<RGB> {
+	int mDataPin;
+	int mRT1, mRT2, mRT3;
+	EOrder mOrder;
+	int mXtra0;
+	int mWaitTime;
+	uint16_t mLastMicros;
+	CInterruptSpacing mSpacing;
+	ESP32ClockLock mClockLock;
+
+	// the pin's set and clear registers, and its bit in them
+	volatile uint32_t *mSet;
+	volatile uint32_t *mClear;
+	uint32_t mPinMask;
+
+	// the timings in cycles of the clock the cpu is actually running at, see ClocklessController
+	uint32_t mCpuMHz;
+	uint32_t mT1;
+	uint32_t mT12;
+	uint32_t mT123;
+	int32_t mMaxGap;
+
+	static uint32_t cpuClocks(uint32_t clks, uint32_t mhz) { return ((clks * mhz) + (F_CPU / 2000000L)) / (F_CPU / 1000000L); }
+
+	void updateTimings() {
+		uint32_t mhz = esp32CpuMHz();
+		if(mhz == mCpuMHz) { return; }
+		mCpuMHz = mhz;
+		mT1 = cpuClocks(mRT1, mhz);
+		mT12 = cpuClocks(mRT1+mRT2, mhz);
+		mT123 = cpuClocks(mRT1+mRT2+mRT3, mhz);
+		mMaxGap = (int32_t)(mT123 + ((mWaitTime-INTERRUPT_THRESHOLD) * mhz));
+	}
+
+	uint16_t sinceLastFrame() { return (micros() & 0xFFFF) - mLastMicros; }
+
+public:
+	/// @param pin the gpio the leds are on
+	/// @param t1, t2, t3 the chipset's timings, in cpu clocks at F_CPU - the numbers the chipset controllers in
+	/// chipsets.h pass ClocklessController (e.g. NS(250), NS(625), NS(375) for a WS2812)
+	/// @param order the order the chipset takes the color bytes in
+	/// @param xtra0 the number of extra 1 bits after every byte
+	/// @param flip start out with the led order reversed, the chipset controllers' FLIP (see CLEDController::initFlip)
+	/// @param waitTime the latch/reset time after a frame, in microseconds
+	RuntimeClocklessController(int pin, int t1, int t2, int t3, EOrder order = RGB, int xtra0 = 0, bool flip = false, int waitTime = 5)
+		: mDataPin(pin), mRT1(t1), mRT2(t2), mRT3(t3), mOrder(order), mXtra0(xtra0), mWaitTime(waitTime), mLastMicros(0),
+		  mClockLock(false), mSet(NULL), mClear(NULL), mPinMask(0), mCpuMHz(0) {
+		this->initFlip(flip);
+	}
+
+	virtual void init() {
+		pinMode(mDataPin, OUTPUT);
+		mPinMask = (uint32_t)1 << (mDataPin & 31);
+		mSet = (mDataPin < 32) ? &_GPB0._GPOS : &_GPB1._GPOS;
+		mClear = (mDataPin < 32) ? &_GPB0._GPOC : &_GPB1._GPOC;
+	}
+
+	virtual uint16_t getMaxRefreshRate() const { return 400; }
+	virtual uint16_t latchRemaining() { uint16_t diff = sinceLastFrame(); return (diff < mWaitTime) ? (mWaitTime - diff) : 0; }
+
+protected:
+
+	virtual void showPixels(PixelController<RGB> & pixels) {
+		while(sinceLastFrame() < mWaitTime);
+		mClockLock.acquire();
+		updateTimings();
+		int cnt = FASTLED_INTERRUPT_RETRY_COUNT;
+		bool firstTry = true;
+		while((showRGBInternal(pixels) == 0) && cnt--) {
+			_retry_cnt++;
+			FASTLED_TRACE_EVENT(TRACE_RETRY, cnt);
+			this->m_Stats.retries++;
+			// the strip starts over at its first pixel after the latch time, so try again with fewer interrupt windows
+			mSpacing.restarted();
+			firstTry = false;
+			interrupts();
+			delayMicroseconds(mWaitTime);
+			noInterrupts();
+		}
+		mSpacing.finished(firstTry);
+		this->m_Stats.interruptSpacing = mSpacing.spacing();
+		mClockLock.release();
+		mLastMicros = micros() & 0xFFFF;
+	}
+
+	__attribute__ ((always_inline)) inline void writeBits(register uint32_t & last_mark, register uint32_t b, register int bits) {
+		b = ~b; b <<= 24;
+		for(register int i = bits; i > 0; i--) {
+			while((__clock_cycles() - last_mark) < mT123);
+			last_mark = __clock_cycles();
+			*mSet = mPinMask;
+
+			while((__clock_cycles() - last_mark) < mT1);
+			if(b & 0x80000000L) { *mClear = mPinMask; }
+			b <<= 1;
+
+			while((__clock_cycles() - last_mark) < mT12);
+			*mClear = mPinMask;
+		}
+	}
+
+	// the same loop as ClocklessController::showRGBInternal, with the byte order looked up per pixel and the extra
+	// bits counted at runtime
+	FASTLED_IRAM uint32_t showRGBInternal(PixelController<RGB> pixels) {
+		const int bits = 8 + mXtra0;
+		const int o0 = RGB_BYTE(mOrder, 0), o1 = RGB_BYTE(mOrder, 1), o2 = RGB_BYTE(mOrder, 2);
+		uint16_t spacing = mSpacing.spacing();
+		uint8_t b[3];
+		noInterrupts();
+		uint32_t start = __clock_cycles();
+		uint32_t last_mark = start;
+		uint32_t locked = start;
+		uint16_t untilWindow = spacing;
+		while(pixels.has(1)) {
+			b[0] = pixels.loadAndScale0();
+			b[1] = pixels.loadAndScale1();
+			b[2] = pixels.loadAndScale2();
+			writeBits(last_mark, b[o0], bits);
+			writeBits(last_mark, b[o1], bits);
+			writeBits(last_mark, b[o2], bits);
+			if(pixels.hasWhite()) {
+				writeBits(last_mark, pixels.loadAndScaleW(), bits);
+				pixels.stepWhiteDithering();
+			}
+			pixels.advanceData();
+
+			#if (FASTLED_ALLOW_INTERRUPTS == 1)
+			if(--untilWindow == 0) {
+				untilWindow = spacing;
+				this->m_Stats.blocked(__clock_cycles() - locked);
+				interrupts();
+				pixels.stepDithering();
+				noInterrupts();
+				locked = __clock_cycles();
+				// if interrupts took longer than 45µs, punt on the current frame
+				if((int32_t)(__clock_cycles()-last_mark) > 0) {
+					if((int32_t)(__clock_cycles()-last_mark) > mMaxGap) { sei(); return 0; }
+				}
+			} else {
+				pixels.stepDithering();
+			}
+			#else
+			pixels.stepDithering();
+			#endif
+		};
+
+		this->m_Stats.blocked(__clock_cycles() - locked);
+		interrupts();
+		#ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
+		_frame_cnt++;
+		#endif
+		return __clock_cycles() - start;
+	}
+};
+
 FASTLED_NAMESPACE_END
@@ -0,0 +1,517 @@
+#pragma once
+
+///@file clockless_rmt_esp32.h
+/// Clockless output for the ESP32 using the RMT (remote control) peripheral.  Rather than spinning on the
+/// cycle counter with interrupts off, the bits for each byte are turned into RMT pulse items and fed to
+/// the peripheral's channel memory, which is used as a ping-pong buffer: while the RMT is sending one half
+/// of it, the threshold interrupt refills the other half from the PixelController.  The cpu is free for
+/// everything but those short refills.
+///
+/// showPixels only starts the transmission; the controller's waitFully() blocks until the frame (and
+/// the latch/reset time after it) is out.  CFastLED::show starts every controller first and then waits
+/// on all of them, so strips on separate RMT channels are written out concurrently.
+
+extern "C" {
+#include "esp_intr_alloc.h"
+#include "driver/gpio.h"
+#include "driver/rmt.h"
+#include "rom/gpio.h"
+#include "soc/gpio_sig_map.h"
+#include "freertos/semphr.h"
+}
+
+FASTLED_NAMESPACE_BEGIN
+
+#ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
+extern uint32_t _frame_cnt;
+extern uint32_t _retry_cnt;
+#endif
+
+#define FASTLED_HAS_CLOCKLESS 1
+
+// How many 64 item RMT memory blocks each channel gets.  More blocks means fewer refill interrupts
+// per frame, but fewer usable channels (8 / FASTLED_RMT_MEM_BLOCKS)
+#ifndef FASTLED_RMT_MEM_BLOCKS
+#define FASTLED_RMT_MEM_BLOCKS 1
+#endif
+
+// Define this to have each controller keep the scaled/dithered/re-ordered bytes of the last frame and
+// re-send them untouched when the next frame's led data, brightness and dithering hash the same - a frame
+// of static content then costs one pass over the led data instead of the full scale/dither work.  Dithering
+// changes the bytes on every frame, so this only pays off with setDither(DISABLE_DITHER) (or when show runs
+// below 100fps, where FastLED.show turns dithering off anyway).  Costs 3 bytes of ram per led (4 for rgbw).
+// #define FASTLED_RMT_CACHE_FRAMES
+
+#define FASTLED_RMT_MAX_CHANNELS (8 / FASTLED_RMT_MEM_BLOCKS)
+#define FASTLED_RMT_MEM_PULSES (64 * FASTLED_RMT_MEM_BLOCKS)
+#define FASTLED_RMT_HALF_PULSES (FASTLED_RMT_MEM_PULSES / 2)
+
+// The RMT is clocked off the APB clock, divided by 2 - 40Mhz (25ns per RMT tick) at the usual 80Mhz APB clock.  The
+// T1/T2/T3 timings from chipsets.h are in cpu clocks at F_CPU; they're scaled to RMT ticks at the APB clock the
+// frame actually goes out at (frequency scaling may have lowered it), see ESP32RMTController::updateTimings.
+#define FASTLED_RMT_CLK_DIV 2
+#define ESP_TO_RMT_CYCLES(n, apb_mhz) (((n) * (apb_mhz)) / (FASTLED_RMT_CLK_DIV * (F_CPU / 1000000L)))
+
+/// Shared RMT plumbing for the clockless controller below - channel assignment, the single RMT interrupt
+/// handler, and encoding bits into the channel memory.  Subclasses only have to hand out the next byte
+/// to be written.  If more controllers are added than there are RMT channels, channels get shared, and
+/// the channel's output is re-routed to the right pin before each frame, after the channel's previous
+/// frame is done.
+class ESP32RMTController {
+protected:
+	int mPin;
+	rmt_channel_t mChannel;
+	volatile rmt_item32_t *mRMTMem;
+	SemaphoreHandle_t mTXDone;
+	bool mBusy;
+	// cleared by the interrupt handler once the end of the frame is out
+	volatile bool mSending;
+
+	// Pre-built pulse items for a 0 and a 1 bit, and the low pulse that holds the line for the
+	// latch/reset time and ends the transmission
+	rmt_item32_t mZero;
+	rmt_item32_t mOne;
+	rmt_item32_t mLatch;
+
+	// The timings the pulse items are made from, in cpu clocks at F_CPU (and us for the latch), and the APB clock
+	// (in Mhz) the items were last made for.  The APB clock is held there while a frame goes out.
+	int mT1;
+	int mT2;
+	int mT3;
+	int mLatchUs;
+	uint32_t mApbMHz;
+	ESP32ClockLock mClockLock;
+
+	// Encoding state for the frame being written out
+	int mCurPulse;
+	uint32_t mBits;
+	int mBitsLeft;
+	bool mDone;
+
+	/// Hands out the next byte to write, left aligned in bits, returning the number of bits to write (0 when there is
+	/// no more data in this frame).  A function pointer rather than a virtual: it's called from the interrupt, which
+	/// can run with the flash cache off, and vtables live in flash.
+	typedef int (*load_func)(ESP32RMTController *pController, uint32_t & bits);
+	load_func mLoadNextByte;
+
+	static FASTLED_IRAM ESP32RMTController *& channelOwner(int channel) {
+		static ESP32RMTController *sOwners[8];
+		return sOwners[channel];
+	}
+
+	void initRMT(int pin, int t1, int t2, int t3, int latch_us, load_func loadNextByte) {
+		static int sControllers = 0;
+		static intr_handle_t sIntrHandle = NULL;
+
+		mPin = pin;
+		mLoadNextByte = loadNextByte;
+		mChannel = (rmt_channel_t)((sControllers++ % FASTLED_RMT_MAX_CHANNELS) * FASTLED_RMT_MEM_BLOCKS);
+		mRMTMem = &(RMTMEM.chan[mChannel].data32[0]);
+		mTXDone = xSemaphoreCreateBinary();
+
+		mT1 = t1; mT2 = t2; mT3 = t3; mLatchUs = latch_us;
+		mApbMHz = 0;
+		updateTimings();
+
+		if(channelOwner(mChannel) == NULL) {
+			rmt_config_t conf;
+			conf.rmt_mode = RMT_MODE_TX;
+			conf.channel = mChannel;
+			conf.gpio_num = (gpio_num_t)pin;
+			conf.mem_block_num = FASTLED_RMT_MEM_BLOCKS;
+			conf.clk_div = FASTLED_RMT_CLK_DIV;
+			conf.tx_config.loop_en = false;
+			conf.tx_config.carrier_freq_hz = 0;
+			conf.tx_config.carrier_duty_percent = 0;
+			conf.tx_config.carrier_level = RMT_CARRIER_LEVEL_LOW;
+			conf.tx_config.carrier_en = false;
+			conf.tx_config.idle_level = RMT_IDLE_LEVEL_LOW;
+			conf.tx_config.idle_output_en = true;
+			rmt_config(&conf);
+
+			// Let the transmitter wrap around the end of the channel memory, and interrupt us every
+			// time another half of it has been sent
+			RMT.apb_conf.mem_tx_wrap_en = 1;
+			rmt_set_tx_thr_intr_en(mChannel, true, FASTLED_RMT_HALF_PULSES);
+			rmt_set_tx_intr_en(mChannel, true);
+
+			channelOwner(mChannel) = this;
+		}
+
+		if(sIntrHandle == NULL) {
+			esp_intr_alloc(ETS_RMT_INTR_SOURCE, FASTLED_ESP32_INTR_FLAGS, interruptHandler, 0, &sIntrHandle);
+		}
+	}
+
+	/// Make the pulse items for a 0 bit, a 1 bit and the latch in ticks of the current APB clock, unless they were
+	/// already made for it
+	void updateTimings() {
+		uint32_t apb = esp32ApbMHz();
+		if(apb == mApbMHz) { return; }
+		mApbMHz = apb;
+		int t1 = ESP_TO_RMT_CYCLES(mT1, apb), t2 = ESP_TO_RMT_CYCLES(mT2, apb), t3 = ESP_TO_RMT_CYCLES(mT3, apb);
+
+		mZero.level0 = 1; mZero.duration0 = t1;      mZero.level1 = 0; mZero.duration1 = t2 + t3;
+		mOne.level0 = 1;  mOne.duration0 = t1 + t2;  mOne.level1 = 0;  mOne.duration1 = t3;
+		// a zero length second half marks the end of transmission
+		mLatch.level0 = 0; mLatch.duration0 = mLatchUs * (apb / FASTLED_RMT_CLK_DIV); mLatch.level1 = 0; mLatch.duration1 = 0;
+	}
+
+	/// Take over the channel (if shared, unhooking the previous pin from it), and prime both halves of the
+	/// channel memory before starting the transmitter
+	void startRMT() {
+		waitRMT();
+
+		// keep frequency scaling from changing the APB clock until the frame is out, and make the pulses for the
+		// clock it's at
+		mClockLock.acquire();
+		updateTimings();
+
+		ESP32RMTController *pOwner = channelOwner(mChannel);
+		if(pOwner != this) {
+			pOwner->waitRMT();
+			gpio_matrix_out(pOwner->mPin, SIG_GPIO_OUT_IDX, 0, 0);
+			rmt_set_pin(mChannel, RMT_MODE_TX, (gpio_num_t)mPin);
+			channelOwner(mChannel) = this;
+		}
+
+		mCurPulse = 0;
+		mBitsLeft = 0;
+		mDone = false;
+		fillHalf();
+		fillHalf();
+
+		mBusy = true;
+		mSending = true;
+		rmt_tx_start(mChannel, true);
+	}
+
+	/// Block until the transmitter has sent the end of the frame, if one is going out
+	void waitRMT() {
+		if(mBusy) {
+			xSemaphoreTake(mTXDone, portMAX_DELAY);
+			mBusy = false;
+			mClockLock.release();
+		}
+	}
+
+	/// Encode the next half block worth of pulses, terminating the pulse train once out of data
+	FASTLED_IRAM void fillHalf() {
+		if(mDone) { return; }
+
+		volatile rmt_item32_t *pItem = mRMTMem + mCurPulse;
+		for(int i = 0; i < FASTLED_RMT_HALF_PULSES; i++) {
+			if(mBitsLeft == 0) {
+				mBitsLeft = (*mLoadNextByte)(this, mBits);
+				if(mBitsLeft == 0) {
+					pItem->val = mLatch.val;
+					mDone = true;
+					return;
+				}
+			}
+			pItem->val = (mBits & 0x80000000L) ? mOne.val : mZero.val;
+			pItem++;
+			mBits <<= 1;
+			mBitsLeft--;
+		}
+
+		mCurPulse = (mCurPulse == 0) ? FASTLED_RMT_HALF_PULSES : 0;
+	}
+
+	static FASTLED_IRAM void interruptHandler(void *) {
+		uint32_t intr_st = RMT.int_st.val;
+		BaseType_t HPTaskAwoken = pdFALSE;
+
+		for(int channel = 0; channel < 8; channel += FASTLED_RMT_MEM_BLOCKS) {
+			ESP32RMTController *pController = channelOwner(channel);
+			if(pController == NULL) { continue; }
+
+			uint32_t tx_next_bit = BIT(channel + 24);
+			uint32_t tx_done_bit = BIT(channel * 3);
+
+			if(intr_st & tx_next_bit) {
+				RMT.int_clr.val = tx_next_bit;
+				pController->fillHalf();
+			}
+
+			if(intr_st & tx_done_bit) {
+				RMT.int_clr.val = tx_done_bit;
+				pController->mSending = false;
+				xSemaphoreGiveFromISR(pController->mTXDone, &HPTaskAwoken);
+			}
+		}
+
+		if(HPTaskAwoken == pdTRUE) {
+			portYIELD_FROM_ISR();
+		}
+	}
+
+public:
+	ESP32RMTController() : mPin(-1), mChannel(RMT_CHANNEL_0), mRMTMem(NULL), mTXDone(NULL), mBusy(false), mSending(false),
+		mT1(0), mT2(0), mT3(0), mLatchUs(0), mApbMHz(0), mClockLock(true), mLoadNextByte(NULL) {}
+};
+
+template <int DATA_PIN, int T1, int T2, int T3, EOrder RGB_ORDER = RGB, int XTRA0 = 0, bool FLIP = false, int WAIT_TIME = 5>
+class ClocklessController : public CPixelLEDController<RGB_ORDER>, public ESP32RMTController {
+	// our own copy of the pixel controller, it has to outlive the call to showPixels
+	PixelController<RGB_ORDER> *mPixels;
+	int mRGBByte;
+#ifdef FASTLED_RMT_CACHE_FRAMES
+	uint8_t *mCache;
+	int mCacheLen;
+	int mCachePos;
+	uint32_t mCacheHash;
+#endif
+public:
+#ifdef FASTLED_RMT_CACHE_FRAMES
+	ClocklessController() : mPixels(NULL), mCache(NULL), mCacheLen(0), mCachePos(0), mCacheHash(0) { this->initFlip(FLIP); }
+#else
+	ClocklessController() : mPixels(NULL) { this->initFlip(FLIP); }
+#endif
+
+	virtual void init() {
+		initRMT(DATA_PIN, T1, T2, T3, WAIT_TIME, loadNextByte);
+	}
+
+	virtual uint16_t getMaxRefreshRate() const { return 400; }
+
+	virtual void waitFully() { waitRMT(); }
+
+	virtual bool isShowing() { return mSending; }
+
+protected:
+
+	virtual void showPixels(PixelController<RGB_ORDER> & pixels) {
+		// make sure the previous frame is out before touching the copy the interrupt is reading from
+		waitRMT();
+		if(mPixels == NULL) {
+			mPixels = new PixelController<RGB_ORDER>(pixels);
+		} else {
+			*mPixels = pixels;
+		}
+		mRGBByte = 0;
+#ifdef FASTLED_RMT_CACHE_FRAMES
+		updateCache();
+#endif
+		startRMT();
+		#ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
+		_frame_cnt++;
+		#endif
+	}
+
+#ifdef FASTLED_RMT_CACHE_FRAMES
+	/// FNV-1a hash over everything that goes into the output bytes - the led data, the scale and the
+	/// dithering state.  The data is walked through a copy of the pixel controller, in the same order it gets encoded in.
+	static uint32_t hashPixels(PixelController<RGB_ORDER> & pixels) {
+		uint32_t hash = 2166136261UL;
+		PixelController<RGB_ORDER> walk(pixels);
+		for(int i = 0; i < pixels.size(); i++) {
+			const uint8_t *pData = walk.mData;
+			hash = (hash ^ pData[0]) * 16777619UL;
+			hash = (hash ^ pData[1]) * 16777619UL;
+			hash = (hash ^ pData[2]) * 16777619UL;
+			if(pixels.hasWhite()) { hash = (hash ^ pData[3]) * 16777619UL; }
+			walk.advanceData();
+		}
+		for(int i = 0; i < 3; i++) {
+			hash = (hash ^ pixels.mScale.raw[i]) * 16777619UL;
+			hash = (hash ^ pixels.d[i]) * 16777619UL;
+			hash = (hash ^ pixels.e[i]) * 16777619UL;
+		}
+#if (FASTLED_GAMMA_OUTPUT == 1)
+		for(int i = 0; i < 3; i++) { hash = (hash ^ (uint32_t)(uintptr_t)pixels.mGamma[i]) * 16777619UL; }
+#endif
+#if (FASTLED_SPATIAL_DITHER == 1)
+		if(pixels.mSpatial) {
+			for(int i = 0; i < SPATIAL_DITHER_STEPS * 3; i++) { hash = (hash ^ pixels.mSpatialD[i]) * 16777619UL; }
+		}
+#endif
+		if(pixels.hasWhite()) {
+			hash = (hash ^ pixels.mScaleW) * 16777619UL;
+			hash = (hash ^ pixels.dW) * 16777619UL;
+			hash = (hash ^ pixels.eW) * 16777619UL;
+		}
+		return hash;
+	}
+
+	/// Re-encode the cached output bytes, unless the new frame hashes the same as the cached one
+	void updateCache() {
+		int len = mPixels->size() * (mPixels->hasWhite() ? 4 : 3);
+		mCachePos = 0;
+#if (FASTLED_PIXEL_GENERATORS == 1)
+		// generated leds only exist once they're encoded, so those frames always are - and there's no led array to
+		// hash, only the tile
+		uint32_t hash = mPixels->mGenerator ? mCacheHash + 1 : hashPixels(*mPixels);
+#else
+		uint32_t hash = hashPixels(*mPixels);
+#endif
+		if(mCache != NULL && len == mCacheLen && hash == mCacheHash) { return; }
+
+		if(len != mCacheLen) {
+			delete [] mCache;
+			mCache = new uint8_t[len];
+			mCacheLen = len;
+		}
+		mCacheHash = hash;
+
+		if(mPixels->rawCopy()) {
+			memcpy(mCache, mPixels->mData, len);
+			return;
+		}
+		switch(mPixels->work()) {
+			case PIXEL_RAW: encodeCache<PIXEL_RAW>(); break;
+			case PIXEL_DITHER: encodeCache<PIXEL_DITHER>(); break;
+			case PIXEL_SCALE: encodeCache<PIXEL_SCALE>(); break;
+			default: encodeCache<PIXEL_DITHER_SCALE>(); break;
+		}
+	}
+
+	/// encode the frame into the cache, doing only the work the frame needs (see PixelController::work)
+	template<int WORK> void encodeCache() {
+		PixelController<RGB_ORDER> & pixels = *mPixels;
+		uint8_t *pCache = mCache;
+		while(pixels.has(1)) {
+			*pCache++ = pixels.template loadAndScale<0, WORK>(pixels);
+			*pCache++ = pixels.template loadAndScale<1, WORK>(pixels);
+			*pCache++ = pixels.template loadAndScale<2, WORK>(pixels);
+			if(pixels.hasWhite()) {
+				*pCache++ = pixels.template loadAndScaleW<WORK>();
+				if(WORK & PIXEL_DITHER) { pixels.stepWhiteDithering(); }
+			}
+			pixels.advanceData();
+			if(WORK & PIXEL_DITHER) { pixels.stepDithering(); }
+		}
+	}
+
+	// Called from the RMT interrupt as the channel memory drains.  The extra XTRA0 bits following each
+	// byte are sent as 1's, same as the bit-banged output.
+	static FASTLED_IRAM int loadNextByte(ESP32RMTController *pRMT, uint32_t & bits) {
+		ClocklessController *pThis = static_cast<ClocklessController*>(pRMT);
+		if(pThis->mCachePos >= pThis->mCacheLen) { return 0; }
+		bits = (((uint32_t)pThis->mCache[pThis->mCachePos++]) << 24) | (((1 << XTRA0) - 1) << (24 - XTRA0));
+		return 8 + XTRA0;
+	}
+#else
+	// Called from the RMT interrupt as the channel memory drains.  The extra XTRA0 bits following each
+	// byte are sent as 1's, same as the bit-banged output.  Branches rather than a switch, whose jump table would
+	// be in flash.
+	static FASTLED_IRAM int loadNextByte(ESP32RMTController *pRMT, uint32_t & bits) {
+		ClocklessController *pThis = static_cast<ClocklessController*>(pRMT);
+		PixelController<RGB_ORDER> *pPixels = pThis->mPixels;
+		if(!pPixels->has(1)) { return 0; }
+
+		uint32_t b;
+		if(pThis->mRGBByte == 0) {
+			b = pPixels->loadAndScale0(); pThis->mRGBByte = 1;
+		} else if(pThis->mRGBByte == 1) {
+			b = pPixels->loadAndScale1(); pThis->mRGBByte = 2;
+		} else if(pThis->mRGBByte == 2) {
+			b = pPixels->loadAndScale2();
+			if(pPixels->hasWhite()) {
+				pThis->mRGBByte = 3;
+			} else {
+				pThis->mRGBByte = 0;
+				pPixels->advanceData();
+				pPixels->stepDithering();
+			}
+		} else {
+			b = pPixels->loadAndScaleW(); pThis->mRGBByte = 0;
+			pPixels->stepWhiteDithering();
+			pPixels->advanceData();
+			pPixels->stepDithering();
+		}
+
+		bits = (b << 24) | (((1 << XTRA0) - 1) << (24 - XTRA0));
+		return 8 + XTRA0;
+	}
+#endif
+};
+
+/// The RMT clockless output with its pin, timings and color order taken at runtime instead of as template parameters -
+/// for pins and chipsets that come from a configuration, and for builds with many strips, which then share a single
+/// copy of the encoding code instead of one per ClocklessController instantiation.  Everything else works like
+/// ClocklessController, apart from FASTLED_RMT_CACHE_FRAMES, which it doesn't do.  Add it with
+/// FastLED.addLeds(&controller, leds, nLeds); it has to stay around.
+class RuntimeClocklessController : public CPixelLEDController<RGB>, public ESP32RMTController {
+	int mDataPin;
+	int mRT1, mRT2, mRT3;
+	EOrder mOrder;
+	int mXtra0;
+	int mWaitTime;
+	// our own copy of the pixel controller, it has to outlive the call to showPixels
+	PixelController<RGB> *mPixels;
+	// the current pixel's bytes (red, green, blue, white), and which of them goes out next
+	uint8_t mPixel[4];
+	int mRGBByte;
+	int mPixelBytes;
+
+public:
+	/// @param pin the gpio the leds are on
+	/// @param t1, t2, t3 the chipset's timings, in cpu clocks at F_CPU - the numbers the chipset controllers in
+	/// chipsets.h pass ClocklessController (e.g. NS(250), NS(625), NS(375) for a WS2812)
+	/// @param order the order the chipset takes the color bytes in
+	/// @param xtra0 the number of extra 1 bits after every byte
+	/// @param flip start out with the led order reversed, the chipset controllers' FLIP (see CLEDController::initFlip)
+	/// @param waitTime the latch/reset time after a frame, in microseconds
+	RuntimeClocklessController(int pin, int t1, int t2, int t3, EOrder order = RGB, int xtra0 = 0, bool flip = false, int waitTime = 5)
+		: mDataPin(pin), mRT1(t1), mRT2(t2), mRT3(t3), mOrder(order), mXtra0(xtra0), mWaitTime(waitTime), mPixels(NULL), mRGBByte(0), mPixelBytes(0) {
+		this->initFlip(flip);
+	}
+
+	virtual void init() {
+		initRMT(mDataPin, mRT1, mRT2, mRT3, mWaitTime, loadNextByte);
+	}
+
+	virtual uint16_t getMaxRefreshRate() const { return 400; }
+
+	virtual void waitFully() { waitRMT(); }
+
+	virtual bool isShowing() { return mSending; }
+
+protected:
+
+	virtual void showPixels(PixelController<RGB> & pixels) {
+		// make sure the previous frame is out before touching the copy the interrupt is reading from
+		waitRMT();
+		if(mPixels == NULL) {
+			mPixels = new PixelController<RGB>(pixels);
+		} else {
+			*mPixels = pixels;
+		}
+		mRGBByte = mPixelBytes = 0;
+		startRMT();
+		#ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
+		_frame_cnt++;
+		#endif
+	}
+
+	// Called from the RMT interrupt as the channel memory drains.  A pixel's bytes are loaded (in rgb order) all at
+	// once, and handed out in the chipset's order.  The extra bits following each byte are sent as 1's, same as the
+	// bit-banged output.
+	static FASTLED_IRAM int loadNextByte(ESP32RMTController *pRMT, uint32_t & bits) {
+		RuntimeClocklessController *pThis = static_cast<RuntimeClocklessController*>(pRMT);
+		PixelController<RGB> *pPixels = pThis->mPixels;
+		if(pThis->mRGBByte == pThis->mPixelBytes) {
+			if(!pPixels->has(1)) { return 0; }
+			pThis->mPixel[0] = pPixels->loadAndScale0();
+			pThis->mPixel[1] = pPixels->loadAndScale1();
+			pThis->mPixel[2] = pPixels->loadAndScale2();
+			pThis->mPixelBytes = 3;
+			if(pPixels->hasWhite()) {
+				pThis->mPixel[3] = pPixels->loadAndScaleW();
+				pPixels->stepWhiteDithering();
+				pThis->mPixelBytes = 4;
+			}
+			pPixels->advanceData();
+			pPixels->stepDithering();
+			pThis->mRGBByte = 0;
+		}
+
+		int n = pThis->mRGBByte++;
+		uint32_t b = pThis->mPixel[(n < 3) ? RGB_BYTE(pThis->mOrder, n) : 3];
+		bits = (b << 24) | (((1 << pThis->mXtra0) - 1) << (24 - pThis->mXtra0));
+		return 8 + pThis->mXtra0;
+	}
+};
+
+FASTLED_NAMESPACE_END
@@ -0,0 +1,226 @@
+#ifndef __INC_DMX_ESP32_H
+#define __INC_DMX_ESP32_H
+
+///@file dmx_esp32.h
+/// DMX output for the ESP32: over a DMX line from one of the UARTs, and as E1.31 (sACN) or Art-Net over the
+/// network, for driving remote pixel nodes.  All of them encode whole universes (see CDMXUniverseController) and send
+/// each one off in a single write.
+
+extern "C" {
+#include "driver/uart.h"
+#include "esp_system.h"
+#include "lwip/sockets.h"
+}
+
+/// How long the break at the start of every DMX packet is, and the mark after it, in µs
+#ifndef FASTLED_DMX_BREAK_US
+#define FASTLED_DMX_BREAK_US 92
+#endif
+#ifndef FASTLED_DMX_MAB_US
+#define FASTLED_DMX_MAB_US 12
+#endif
+
+FASTLED_NAMESPACE_BEGIN
+
+/// A DMX line driven by one of the ESP32's UARTs (1 or 2, UART 0 is usually the serial console).  A DMX line carries
+/// a single universe, so only the first 170 leds go out - use a controller per line, each on its own part of the
+/// led array, for more.  The packet is handed to the UART driver in one write, its interrupts feed the fifo from
+/// there while show returns; the next show waits for the packet to be out before starting the next one.
+template <int UART_NUM, int TX_PIN, EOrder RGB_ORDER = RGB>
+class DMXUartController : public CDMXUniverseController<RGB_ORDER> {
+	// the start code, then the channels
+	uint8_t mPacket[1 + DMX_UNIVERSE_CHANNELS];
+
+public:
+	DMXUartController() { memset(mPacket, 0, sizeof(mPacket)); }
+
+	virtual void init() {
+		uart_config_t config;
+		memset(&config, 0, sizeof(config));
+		config.baud_rate = 250000;
+		config.data_bits = UART_DATA_8_BITS;
+		config.parity = UART_PARITY_DISABLE;
+		config.stop_bits = UART_STOP_BITS_2;
+		config.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+		uart_param_config((uart_port_t)UART_NUM, &config);
+		uart_set_pin((uart_port_t)UART_NUM, TX_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+		// a tx buffer with room for a whole packet, so the write never blocks
+		uart_driver_install((uart_port_t)UART_NUM, 256, 2 * sizeof(mPacket), 0, NULL, 0);
+	}
+
+	virtual bool isShowing() { return uart_wait_tx_done((uart_port_t)UART_NUM, 0) != ESP_OK; }
+
+	virtual void waitFully() { uart_wait_tx_done((uart_port_t)UART_NUM, portMAX_DELAY); }
+
+protected:
+	virtual uint8_t *beginUniverse(uint16_t universe) { return mPacket + 1; }
+
+	virtual void endUniverse(uint16_t universe, uint16_t nChannels) {
+		// unused channels are left at 0, and the whole universe always goes out - not every fixture copes with
+		// short packets
+		memset(mPacket + 1 + nChannels, 0, DMX_UNIVERSE_CHANNELS - nChannels);
+		waitFully();
+		// the break and the mark after it, by holding the line low
+		uart_set_line_inverse((uart_port_t)UART_NUM, UART_INVERSE_TXD);
+		delayMicroseconds(FASTLED_DMX_BREAK_US);
+		uart_set_line_inverse((uart_port_t)UART_NUM, UART_INVERSE_DISABLE);
+		delayMicroseconds(FASTLED_DMX_MAB_US);
+		uart_write_bytes((uart_port_t)UART_NUM, (const char*)mPacket, sizeof(mPacket));
+	}
+
+	virtual uint16_t maxUniverses() { return 1; }
+};
+
+/// Base for the controllers that send universes over udp.  The packet buffer holds a HEADER byte header, subclasses
+/// fill that in for each universe and the channels get encoded in right behind it.  The socket is only opened at
+/// the first show, the network doesn't need to be up by the time the controller is added.
+template <EOrder RGB_ORDER, int HEADER>
+class CUdpUniverseController : public CDMXUniverseController<RGB_ORDER> {
+	int mSocket;
+	struct sockaddr_in mAddress;
+	bool mMulticast;
+
+protected:
+	uint16_t mFirstUniverse;
+	uint8_t mSequence;
+	uint8_t mPacket[HEADER + DMX_UNIVERSE_CHANNELS];
+
+	CUdpUniverseController(uint16_t port, uint16_t firstUniverse) : mSocket(-1), mMulticast(false), mFirstUniverse(firstUniverse), mSequence(0) {
+		memset(&mAddress, 0, sizeof(mAddress));
+		mAddress.sin_family = AF_INET;
+		mAddress.sin_port = htons(port);
+		memset(mPacket, 0, sizeof(mPacket));
+	}
+
+	/// fill in the header for a universe of nChannels channels, numbered from the first universe
+	/// @returns the number of channels to send, which may have been padded out
+	virtual uint16_t header(uint16_t universe, uint16_t nChannels) = 0;
+
+	/// the address of a multicast group for a universe
+	virtual uint32_t multicastAddress(uint16_t universe) { return 0; }
+
+	virtual uint8_t *beginUniverse(uint16_t universe) { return mPacket + HEADER; }
+
+	virtual void endUniverse(uint16_t universe, uint16_t nChannels) {
+		if(mSocket < 0) {
+			mSocket = socket(AF_INET, SOCK_DGRAM, 0);
+			if(mSocket < 0) { return; }
+			// without it, lwip drops packets to broadcast addresses (the Art-Net default)
+			int broadcast = 1;
+			setsockopt(mSocket, SOL_SOCKET, SO_BROADCAST, &broadcast, sizeof(broadcast));
+		}
+		universe += mFirstUniverse;
+		if(mMulticast) { mAddress.sin_addr.s_addr = htonl(multicastAddress(universe)); }
+		nChannels = header(universe, nChannels);
+		sendto(mSocket, mPacket, HEADER + nChannels, 0, (struct sockaddr*)&mAddress, sizeof(mAddress));
+	}
+
+	virtual void showPixels(PixelController<RGB_ORDER> & pixels) {
+		CDMXUniverseController<RGB_ORDER>::showPixels(pixels);
+		// every universe of a frame goes out with the same sequence number
+		mSequence++;
+	}
+
+public:
+	virtual void init() {}
+
+	/// send to the given address - a node, or a broadcast address
+	void setDestination(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+		mMulticast = false;
+		mAddress.sin_addr.s_addr = htonl(((uint32_t)a << 24) | ((uint32_t)b << 16) | ((uint32_t)c << 8) | d);
+	}
+
+	/// send every universe to its own multicast group, where the protocol has them
+	void setMulticast() { mMulticast = true; }
+
+	/// the universe number the first of the controller's universes goes out as
+	void setFirstUniverse(uint16_t universe) { mFirstUniverse = universe; }
+};
+
+#define E131_HEADER 126
+
+/// E1.31 (streaming ACN) output.  Universes are sent to their multicast groups (239.255.x.y) unless a destination
+/// is set, and numbered from 1 unless told otherwise.
+template <EOrder RGB_ORDER = RGB>
+class E131Controller : public CUdpUniverseController<RGB_ORDER, E131_HEADER> {
+	typedef CUdpUniverseController<RGB_ORDER, E131_HEADER> Base;
+
+	static void put16(uint8_t *p, uint16_t v) { p[0] = v >> 8; p[1] = v & 0xFF; }
+
+public:
+	/// @param firstUniverse the number the first universe goes out as
+	/// @param priority the priority the universes are sent at, receivers go with the highest priority source
+	E131Controller(uint16_t firstUniverse = 1, uint8_t priority = 100) : Base(5568, firstUniverse) {
+		uint8_t *p = this->mPacket;
+		// root layer: preamble and postamble sizes, acn packet identifier, vector, and the source's cid - made
+		// unique from the mac address
+		put16(p, 0x0010);
+		memcpy(p + 4, "ASC-E1.17\0\0\0", 12);
+		p[21] = 0x04;
+		memcpy(p + 22, "FastLED\0\0\0", 10);
+		esp_efuse_mac_get_default(p + 32);
+		// framing layer: vector, source name, priority
+		p[43] = 0x02;
+		strcpy((char*)p + 44, "FastLED");
+		p[108] = priority;
+		// dmp layer: vector, address and data type, first property address and increment
+		p[117] = 0x02;
+		p[118] = 0xA1;
+		put16(p + 121, 0x0001);
+		this->setMulticast();
+	}
+
+protected:
+	virtual uint32_t multicastAddress(uint16_t universe) { return 0xEFFF0000 | universe; }
+
+	virtual uint16_t header(uint16_t universe, uint16_t nChannels) {
+		uint8_t *p = this->mPacket;
+		uint16_t length = E131_HEADER + nChannels;
+		// the flags and lengths of the three layers
+		put16(p + 16, 0x7000 | (length - 16));
+		put16(p + 38, 0x7000 | (length - 38));
+		put16(p + 115, 0x7000 | (length - 115));
+		p[111] = this->mSequence;
+		put16(p + 113, universe);
+		// the start code counts as a property value
+		put16(p + 123, nChannels + 1);
+		return nChannels;
+	}
+};
+
+#define ARTNET_HEADER 18
+
+/// Art-Net (ArtDmx) output.  Universes go to the broadcast address unless a destination is set, and are numbered
+/// from 0 (the 15 bit port address) unless told otherwise.
+template <EOrder RGB_ORDER = RGB>
+class ArtNetController : public CUdpUniverseController<RGB_ORDER, ARTNET_HEADER> {
+	typedef CUdpUniverseController<RGB_ORDER, ARTNET_HEADER> Base;
+
+public:
+	/// @param firstUniverse the port address the first universe goes out as
+	ArtNetController(uint16_t firstUniverse = 0) : Base(6454, firstUniverse) {
+		uint8_t *p = this->mPacket;
+		// id, the ArtDmx opcode (little endian) and protocol version 14
+		memcpy(p, "Art-Net", 8);
+		p[9] = 0x50;
+		p[11] = 14;
+		this->setDestination(255, 255, 255, 255);
+	}
+
+protected:
+	virtual uint16_t header(uint16_t universe, uint16_t nChannels) {
+		uint8_t *p = this->mPacket;
+		// the channel count has to be even
+		if(nChannels & 1) { p[ARTNET_HEADER + nChannels] = 0; nChannels++; }
+		p[12] = this->mSequence ? this->mSequence : 1;
+		p[14] = universe & 0xFF;
+		p[15] = (universe >> 8) & 0x7F;
+		p[16] = nChannels >> 8;
+		p[17] = nChannels & 0xFF;
+		return nChannels;
+	}
+};
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -3,5 +3,14 @@
 #include "bitswap.h"
 #include "fastled_delay.h"
 #include "fastpin_esp32.h"
+#include "fastspi_esp32.h"
+#include "clock_esp32.h"
+#ifdef FASTLED_ESP32_FORCE_BITBANG
 #include "clockless_esp32.h"
+#else
+#include "clockless_rmt_esp32.h"
+#endif
 #include "clockless_block_esp32.h"
+#include "hub75_esp32.h"
+#include "dmx_esp32.h"
+#include "framestream_esp32.h"
@@ -8,15 +8,21 @@ struct FASTLED_ESP_IO {
   volatile uint32_t _GPOC;
 };
 
+// GPIOs 0-31 are driven through the first bank of gpio output registers, 32-39 through the second one.  Both
+// banks have the same out/set/clear register layout.
 #define _GPB0 (*(FASTLED_ESP_IO*)(GPIO_OUT_REG))
-// #define _GPB0 (*(FASTLED_ESP_IO*)(DR_REG_GPIO_BASE))
-// #define _GPB1 (*(FASTLED_ESP_IO*)(0x3ff44010))
-//THERE'S a second register for pins 32-39 (33 for outputs) but let's get one working first
-#define OUTPUT_PIN_LIMIT 31
+#define _GPB1 (*(FASTLED_ESP_IO*)(GPIO_OUT1_REG))
+#define _GPI0 (*(volatile uint32_t*)(GPIO_IN_REG))
+#define _GPI1 (*(volatile uint32_t*)(GPIO_IN1_REG))
+
+// GPIOs 34-39 are input only
+#define OUTPUT_PIN_LIMIT 33
 
 
 template<uint8_t PIN, uint32_t MASK> class _ESPPIN {
 
+  inline static FASTLED_ESP_IO & bank() __attribute__ ((always_inline)) { return (PIN < 32) ? _GPB0 : _GPB1; }
+
 public:
   typedef volatile uint32_t * port_ptr_t;
   typedef uint32_t port_t;
@@ -24,33 +30,33 @@ public:
   inline static void setOutput() { pinMode(PIN, OUTPUT); }
   inline static void setInput() { pinMode(PIN, INPUT); }
 
-  inline static void hi() __attribute__ ((always_inline)) { if(PIN < OUTPUT_PIN_LIMIT) { _GPB0._GPOS = MASK; } }
+  inline static void hi() __attribute__ ((always_inline)) { if(PIN <= OUTPUT_PIN_LIMIT) { bank()._GPOS = MASK; } }
   // inline static void hi() __attribute__ ((always_inline)) { gpio_set_level((gpio_num_t)PIN, HIGH); }
 
-  inline static void lo() __attribute__ ((always_inline)) { if (PIN < OUTPUT_PIN_LIMIT){ _GPB0._GPOC = MASK; } }
+  inline static void lo() __attribute__ ((always_inline)) { if(PIN <= OUTPUT_PIN_LIMIT) { bank()._GPOC = MASK; } }
   // inline static void lo() __attribute__ ((always_inline)) { gpio_set_level((gpio_num_t)PIN, LOW); }
-  inline static void set(register port_t val) __attribute__ ((always_inline)) { if (PIN < OUTPUT_PIN_LIMIT){ _GPB0._GPO = val; }}
+  inline static void set(register port_t val) __attribute__ ((always_inline)) { if(PIN <= OUTPUT_PIN_LIMIT) { bank()._GPO = val; } }
   // inline static void set(register port_t val) __attribute__ ((always_inline)) { gpio_set_level((gpio_num_t)PIN, val); }
 
   inline static void strobe() __attribute__ ((always_inline)) { toggle(); toggle(); }
 
-  inline static void toggle() __attribute__ ((always_inline)) { if (PIN < OUTPUT_PIN_LIMIT){ _GPB0._GPO = MASK; } }
+  inline static void toggle() __attribute__ ((always_inline)) { if(PIN <= OUTPUT_PIN_LIMIT) { bank()._GPO ^= MASK; } }
 
   inline static void hi(register port_ptr_t port) __attribute__ ((always_inline)) { hi(); }
   inline static void lo(register port_ptr_t port) __attribute__ ((always_inline)) { lo(); }
   inline static void fastset(register port_ptr_t port, register port_t val) __attribute__ ((always_inline)) { *port = val; }
 
-  inline static port_t hival() __attribute__ ((always_inline)) { if (PIN<OUTPUT_PIN_LIMIT) { return GPIO_OUT_REG | MASK;    }}
-  inline static port_t loval() __attribute__ ((always_inline)) { if (PIN<OUTPUT_PIN_LIMIT) { return GPIO_OUT_REG & ~MASK;   }}
-  inline static port_ptr_t port() __attribute__ ((always_inline)) { if(PIN<OUTPUT_PIN_LIMIT) { return &_GPB0._GPO;   }}
-  inline static port_ptr_t sport() __attribute__ ((always_inline)) { if (PIN<OUTPUT_PIN_LIMIT) {return &_GPB0._GPOS; }}
-  inline static port_ptr_t cport() __attribute__ ((always_inline)) { if (PIN<OUTPUT_PIN_LIMIT) {return &_GPB0._GPOC; }}
+  inline static port_t hival() __attribute__ ((always_inline)) { return bank()._GPO | MASK; }
+  inline static port_t loval() __attribute__ ((always_inline)) { return bank()._GPO & ~MASK; }
+  inline static port_ptr_t port() __attribute__ ((always_inline)) { return &bank()._GPO; }
+  inline static port_ptr_t sport() __attribute__ ((always_inline)) { return &bank()._GPOS; }
+  inline static port_ptr_t cport() __attribute__ ((always_inline)) { return &bank()._GPOC; }
   inline static port_t mask() __attribute__ ((always_inline)) { return MASK; }
 
-  inline static bool isset() __attribute__ ((always_inline)) { return (0x004 & MASK); }
+  inline static bool isset() __attribute__ ((always_inline)) { return ((PIN < 32) ? _GPI0 : _GPI1) & MASK; }
 };
 
-#define _DEFPIN_ESP32(PIN, REAL_PIN) template<> class FastPin<PIN> : public _ESPPIN<REAL_PIN, (1<<(REAL_PIN & 0xFF))> {};
+#define _DEFPIN_ESP32(PIN, REAL_PIN) template<> class FastPin<PIN> : public _ESPPIN<REAL_PIN, ((uint32_t)1 << ((REAL_PIN) & 31))> {};
 
 
 #ifdef FASTLED_ESP32_RAW_PIN_ORDER
@@ -65,6 +71,9 @@ _DEFPIN_ESP32(23,23); _DEFPIN_ESP32(24,24); _DEFPIN_ESP32(25,25);
 _DEFPIN_ESP32(26,26); _DEFPIN_ESP32(27,27); _DEFPIN_ESP32(28,28);
 _DEFPIN_ESP32(29,29); _DEFPIN_ESP32(30,30); _DEFPIN_ESP32(31,31);
 _DEFPIN_ESP32(32,32); _DEFPIN_ESP32(33,33);
+// input only
+_DEFPIN_ESP32(34,34); _DEFPIN_ESP32(35,35); _DEFPIN_ESP32(36,36);
+_DEFPIN_ESP32(37,37); _DEFPIN_ESP32(38,38); _DEFPIN_ESP32(39,39);
 
 #define PORTA_FIRST_PIN 32
 // The rest of the pins - these are generally not available
@@ -76,4 +85,4 @@ _DEFPIN_ESP32(32,32); _DEFPIN_ESP32(33,33);
 
 #define HAS_HARDWARE_PIN_SUPPORT
 
-#define FASTLED_NAMESPACE_END
+FASTLED_NAMESPACE_END
@@ -0,0 +1,321 @@
+#ifndef __INC_FASTSPI_ESP32_H
+#define __INC_FASTSPI_ESP32_H
+
+///@file fastspi_esp32.h
+/// Hardware SPI output for the ESP32, on the VSPI and HSPI hosts through the esp-idf spi master driver.  Any pair
+/// of output pins can be used (they're routed through the gpio matrix).  Output bytes are gathered into one of two
+/// DMA capable buffers; when a buffer fills up it is queued to the SPI host and filled data goes into the other one,
+/// so the cpu encodes the next block of the frame while the SPI DMA sends the previous one.  waitFully/release send
+/// what's left and wait for the transfers to finish.  Whole frames already encoded into DMA capable memory (see
+/// FASTLED_SPI_BLOCK_WRITES) are queued straight to the host and left to go out in the background.
+///
+/// The first two pin combinations initialized get the two hosts, any others after that fall back to bit-banging.
+
+#ifndef FASTLED_FORCE_SOFTWARE_SPI
+
+#include "fastspi_bitbang.h"
+
+extern "C" {
+#include "esp_heap_caps.h"
+#include "driver/spi_master.h"
+#include "soc/soc_memory_layout.h"
+}
+
+#define FASTLED_ALL_PINS_HARDWARE_SPI
+
+// Chipsets encode whole frames into DMA capable memory, which the SPI host sends without any copying
+#define FASTLED_SPI_BLOCK_WRITES
+#define FASTLED_SPI_BLOCK_MALLOC(len) heap_caps_malloc(len, MALLOC_CAP_DMA)
+#define FASTLED_SPI_BLOCK_FREE(ptr) heap_caps_free(ptr)
+
+FASTLED_NAMESPACE_BEGIN
+
+// Size of each of the two DMA buffers a SPI host uses.  One DMA descriptor covers up to 4092 bytes.
+#ifndef FASTLED_ESP32_SPI_BUFFER_SIZE
+#define FASTLED_ESP32_SPI_BUFFER_SIZE 4092
+#endif
+
+// The most bytes sent in one transfer straight from a block of the caller's memory
+#ifndef FASTLED_ESP32_SPI_MAX_TRANSFER
+#define FASTLED_ESP32_SPI_MAX_TRANSFER 32768
+#endif
+
+// How many transfers can be queued up on a host at once
+#ifndef FASTLED_ESP32_SPI_QUEUE_SIZE
+#define FASTLED_ESP32_SPI_QUEUE_SIZE 8
+#endif
+
+// The fastest clock the gpio matrix can route out
+#define FASTLED_ESP32_SPI_MAX_HZ 40000000L
+
+/// Hand out the SPI hosts, VSPI first, then HSPI.  Returns -1 once both are taken.
+inline int fastled_esp32_claim_spi_host() {
+	static int sNextHost = 0;
+	switch(sNextHost++) {
+		case 0: return VSPI_HOST;
+		case 1: return HSPI_HOST;
+		default: return -1;
+	}
+}
+
+template <uint8_t DATA_PIN, uint8_t CLOCK_PIN, uint8_t SPI_SPEED>
+class ESP32SPIOutput {
+	typedef AVRSoftwareSPIOutput<DATA_PIN, CLOCK_PIN, SPI_SPEED> SoftwareSPI;
+
+	// Everything is kept per pin combination - the static methods (e.g. writeBytesValueRaw, which the chipset
+	// adjusters call) need to get at the buffers too
+	struct SPIState {
+		spi_device_handle_t mDevice;
+		uint8_t *mBuffers[2];
+		bool mBufferBusy[2];
+		int mCur;
+		int mBits;
+		spi_transaction_t mTransactions[FASTLED_ESP32_SPI_QUEUE_SIZE];
+		int mNextTransaction;
+		int mInFlight;
+		bool mInitialized;
+		SoftwareSPI mSoftware;
+	};
+
+	static SPIState & state() {
+		static SPIState sState;
+		return sState;
+	}
+
+	Selectable *m_pSelect;
+
+	/// Wait for the oldest queued transfer to finish.  If it was sent from one of the byte buffers, that buffer
+	/// is free again.
+	static void collectTransfer() {
+		SPIState & s = state();
+		spi_transaction_t *pDone;
+		spi_device_get_trans_result(s.mDevice, &pDone, portMAX_DELAY);
+		if(pDone->user != NULL) { s.mBufferBusy[(int)(intptr_t)pDone->user - 1] = false; }
+		s.mInFlight--;
+	}
+
+	/// Queue a transfer of bits bits from data, from byte buffer buf (or -1 for the caller's own memory)
+	static void queueTransfer(const void *data, int bits, int buf) {
+		SPIState & s = state();
+		if(s.mInFlight == FASTLED_ESP32_SPI_QUEUE_SIZE) { collectTransfer(); }
+
+		spi_transaction_t & t = s.mTransactions[s.mNextTransaction];
+		s.mNextTransaction = (s.mNextTransaction + 1) % FASTLED_ESP32_SPI_QUEUE_SIZE;
+		memset(&t, 0, sizeof(t));
+		t.length = bits;
+		t.tx_buffer = data;
+		t.user = (void*)(intptr_t)(buf + 1);
+		if(buf >= 0) { s.mBufferBusy[buf] = true; }
+		spi_device_queue_trans(s.mDevice, &t, portMAX_DELAY);
+		s.mInFlight++;
+	}
+
+	/// Queue up the current byte buffer, and switch to the other one once it's free
+	static void flushBuffer() {
+		SPIState & s = state();
+		if(s.mBits == 0) { return; }
+
+		queueTransfer(s.mBuffers[s.mCur], s.mBits, s.mCur);
+		s.mCur ^= 1;
+		s.mBits = 0;
+		while(s.mBufferBusy[s.mCur]) { collectTransfer(); }
+	}
+
+	/// Queue len bytes of the caller's DMA capable memory, after anything already written
+	static void queueBlock(const uint8_t *data, int len) {
+		flushBuffer();
+		while(len > 0) {
+			int n = (len > FASTLED_ESP32_SPI_MAX_TRANSFER) ? FASTLED_ESP32_SPI_MAX_TRANSFER : len;
+			queueTransfer(data, n * 8, -1);
+			data += n;
+			len -= n;
+		}
+	}
+
+	// whether an adjuster passes the bytes through as they are
+	static bool isNop(DATA_NOP *) { return true; }
+	template<class D> static bool isNop(D *) { return false; }
+
+	static bool hardware() __attribute__((always_inline)) { return state().mDevice != NULL; }
+
+	/// Append the top n bits of b to the buffer
+	static void writeBitsRaw(uint8_t b, int n) {
+		SPIState & s = state();
+		while(n--) {
+			uint8_t *p = s.mBuffers[s.mCur] + (s.mBits >> 3);
+			uint8_t mask = 0x80 >> (s.mBits & 0x07);
+			if(b & 0x80) { *p |= mask; } else { *p &= ~mask; }
+			b <<= 1;
+			if(++s.mBits == FASTLED_ESP32_SPI_BUFFER_SIZE * 8) { flushBuffer(); }
+		}
+	}
+
+public:
+	ESP32SPIOutput() { m_pSelect = NULL; }
+	ESP32SPIOutput(Selectable *pSelect) { m_pSelect = pSelect; }
+	void setSelect(Selectable *pSelect) { m_pSelect = pSelect; }
+
+	void init() {
+		SPIState & s = state();
+		if(s.mInitialized) { return; }
+		s.mInitialized = true;
+
+		int host = fastled_esp32_claim_spi_host();
+		if(host == -1) {
+			s.mSoftware.init();
+			return;
+		}
+
+		spi_bus_config_t bus;
+		memset(&bus, 0, sizeof(bus));
+		bus.mosi_io_num = DATA_PIN;
+		bus.miso_io_num = -1;
+		bus.sclk_io_num = CLOCK_PIN;
+		bus.quadwp_io_num = -1;
+		bus.quadhd_io_num = -1;
+		bus.max_transfer_sz = FASTLED_ESP32_SPI_MAX_TRANSFER;
+		spi_bus_initialize((spi_host_device_t)host, &bus, (host == VSPI_HOST) ? 2 : 1);
+
+		spi_device_interface_config_t dev;
+		memset(&dev, 0, sizeof(dev));
+		uint32_t hz = SPI_SPEED ? (F_CPU / SPI_SPEED) : FASTLED_ESP32_SPI_MAX_HZ;
+		dev.clock_speed_hz = (hz > FASTLED_ESP32_SPI_MAX_HZ) ? FASTLED_ESP32_SPI_MAX_HZ : hz;
+		dev.mode = 0;
+		dev.spics_io_num = -1;
+		dev.queue_size = FASTLED_ESP32_SPI_QUEUE_SIZE;
+		dev.flags = SPI_DEVICE_HALFDUPLEX | SPI_DEVICE_NO_DUMMY;
+		spi_bus_add_device((spi_host_device_t)host, &dev, &s.mDevice);
+
+		s.mBuffers[0] = (uint8_t*)heap_caps_malloc(FASTLED_ESP32_SPI_BUFFER_SIZE, MALLOC_CAP_DMA);
+		s.mBuffers[1] = (uint8_t*)heap_caps_malloc(FASTLED_ESP32_SPI_BUFFER_SIZE, MALLOC_CAP_DMA);
+		s.mBufferBusy[0] = s.mBufferBusy[1] = false;
+		s.mCur = 0;
+		s.mBits = 0;
+		s.mNextTransaction = 0;
+		s.mInFlight = 0;
+	}
+
+	// stop the SPI output.  Nothing to do, the host is idle between transfers
+	static void stop() { }
+
+	// wait until the SPI subsystem is ready for more data to write.  A NOP, writes only go into the buffer
+	static void wait() __attribute__((always_inline)) { }
+
+	// send everything written so far, and wait for it to be out
+	static void waitFully() {
+		if(!hardware()) { return; }
+		flushBuffer();
+		while(state().mInFlight) { collectTransfer(); }
+	}
+
+	// whether anything queued is still going out, collecting the transfers that are done on the way
+	static bool busy() {
+		if(!hardware()) { return false; }
+		SPIState & s = state();
+		spi_transaction_t *pDone;
+		while(s.mInFlight && spi_device_get_trans_result(s.mDevice, &pDone, 0) == ESP_OK) {
+			if(pDone->user != NULL) { s.mBufferBusy[(int)(intptr_t)pDone->user - 1] = false; }
+			s.mInFlight--;
+		}
+		return s.mInFlight != 0;
+	}
+
+	static void writeByteNoWait(uint8_t b) __attribute__((always_inline)) { writeByte(b); }
+	static void writeBytePostWait(uint8_t b) __attribute__((always_inline)) { writeByte(b); }
+
+	static void writeWord(uint16_t w) __attribute__((always_inline)) { writeByte(w>>8); writeByte(w&0xFF); }
+
+	static void writeByte(uint8_t b) __attribute__((always_inline)) {
+		if(!hardware()) { SoftwareSPI::writeByte(b); return; }
+		SPIState & s = state();
+		if(s.mBits & 0x07) { writeBitsRaw(b, 8); return; }
+		s.mBuffers[s.mCur][s.mBits >> 3] = b;
+		s.mBits += 8;
+		if(s.mBits == FASTLED_ESP32_SPI_BUFFER_SIZE * 8) { flushBuffer(); }
+	}
+
+	template <uint8_t BIT> inline static void writeBit(uint8_t b) {
+		if(!hardware()) { SoftwareSPI::template writeBit<BIT>(b); return; }
+		writeBitsRaw((b & (1 << BIT)) ? 0x80 : 0x00, 1);
+	}
+
+	void select() { if(m_pSelect != NULL) { m_pSelect->select(); } }
+
+	void release() {
+		waitFully();
+		if(m_pSelect != NULL) { m_pSelect->release(); }
+	}
+
+	// Write out len bytes of the given value out over SPI.  Useful for quickly flushing, say, a line of 0's down the line.
+	void writeBytesValue(uint8_t value, int len) {
+		select();
+		writeBytesValueRaw(value, len);
+		release();
+	}
+
+	static void writeBytesValueRaw(uint8_t value, int len) {
+		while(len--) { writeByte(value); }
+	}
+
+	// write a block of len uint8_ts out, passing each one through the adjuster D
+	template <class D> void writeBytes(register uint8_t *data, int len) {
+		select();
+		uint8_t *end = data + len;
+		while(data != end) {
+			writeByte(D::adjust(*data++));
+		}
+		D::postBlock(len);
+		release();
+	}
+
+	// default version of writing a block of data out to the SPI port, with no data modifications being made.  If the
+	// data is in DMA capable memory it is sent straight from there without being copied - and without waiting for
+	// it to go out, so the caller must leave the data alone until waitFully returns.  That lets controllers on
+	// separate hosts send their frames at the same time.
+	void writeBytes(register uint8_t *data, int len) {
+		if(!hardware() || !FASTLED_DMA_CAPABLE(data)) { writeBytes<DATA_NOP>(data, len); return; }
+
+		select();
+		queueBlock(data, len);
+		if(m_pSelect != NULL) {
+			waitFully();
+			m_pSelect->release();
+		}
+	}
+
+	// write a block of uint8_ts out in groups of three, see AVRSoftwareSPIOutput::writePixels.  Led data that goes out
+	// as it is (see PixelController::rawCopy) from DMA capable memory (see allocateLeds) is sent straight from the
+	// leds, with the cpu waiting on the host rather than copying bytes into the buffers.
+	template <uint8_t FLAGS, class D, EOrder RGB_ORDER> __attribute__((noinline)) void writePixels(PixelController<RGB_ORDER> pixels) {
+		if(!hardware()) { state().mSoftware.template writePixels<FLAGS, D, RGB_ORDER>(pixels); return; }
+
+		select();
+		if(FLAGS == 0 && isNop((D*)NULL) && pixels.rawCopy() && FASTLED_DMA_CAPABLE(pixels.mData)) {
+			queueBlock(pixels.mData, pixels.mLen * 3);
+			D::postBlock(pixels.mLen);
+			release();
+			return;
+		}
+		int len = pixels.mLen;
+		CSPIYield<(FLAGS & FLAG_YIELD) ? FASTLED_SPI_CHUNK_LEDS : 0> chunk;
+		while(pixels.has(1)) {
+			if(FLAGS & FLAG_START_BIT) {
+				writeBit<0>(1);
+			}
+			writeByte(D::adjust(pixels.loadAndScale0()));
+			writeByte(D::adjust(pixels.loadAndScale1()));
+			writeByte(D::adjust(pixels.loadAndScale2()));
+			pixels.advanceData();
+			pixels.stepDithering();
+			chunk.step();
+		}
+		D::postBlock(len);
+		release();
+	}
+};
+
+FASTLED_NAMESPACE_END
+
+#endif
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef __INC_FRAMESTREAM_ESP32_H
+#define __INC_FRAMESTREAM_ESP32_H
+
+///@file framestream_esp32.h
+/// memory mapping flash partitions on the ESP32, for playing frame streams (see CFrameStream) straight out of flash
+
+extern "C" {
+#include "esp_partition.h"
+}
+
+FASTLED_NAMESPACE_BEGIN
+
+/// A data partition mapped into the address space, so that its contents can be read like memory - e.g. a frame
+/// stream flashed into a partition of its own:
+///
+///     CFramePartition partition("show");
+///     CFrameStream stream(partition.data(), partition.size());
+///
+/// The mapping is undone when the object goes away.
+class CFramePartition {
+	const void *m_pData;
+	uint32_t m_nBytes;
+	spi_flash_mmap_handle_t m_Handle;
+
+public:
+	/// map the data partition with the given label (from the partition table)
+	CFramePartition(const char *label) : m_pData(NULL), m_nBytes(0), m_Handle(0) {
+		const esp_partition_t *pPartition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+		if(pPartition && esp_partition_mmap(pPartition, 0, pPartition->size, SPI_FLASH_MMAP_DATA, &m_pData, &m_Handle) == ESP_OK) {
+			m_nBytes = pPartition->size;
+		} else {
+			m_pData = NULL;
+		}
+	}
+
+	~CFramePartition() { if(m_pData) { spi_flash_munmap(m_Handle); } }
+
+	/// the start of the partition's contents, NULL if the partition couldn't be found or mapped
+	const uint8_t *data() const { return (const uint8_t*)m_pData; }
+
+	/// the size of the partition
+	uint32_t size() const { return m_nBytes; }
+};
+
+FASTLED_NAMESPACE_END
+
+#endif
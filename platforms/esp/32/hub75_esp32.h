@@ -0,0 +1,379 @@
+#ifndef __INC_HUB75_ESP32_H
+#define __INC_HUB75_ESP32_H
+
+///@file hub75_esp32.h
+/// HUB75 led matrix panel output for the ESP32, driving the panel from one of the I2S peripherals in LCD (parallel)
+/// mode.  Every 16 bit I2S sample holds one clock's worth of the panel's inputs - the upper and lower half's rgb
+/// bits, the row address, latch and output enable - and the I2S word clock is the panel's pixel clock.
+///
+/// The panel is refreshed by the dma on its own, endlessly, out of a ring of descriptors, so the frame buffer it
+/// refreshes from *is* the bit-plane buffer: there's no copy into a separate back buffer and no separate pass turning
+/// rgb into bit planes.  For each row pair of the panel and each bit plane of color depth, the ring holds:
+///   - one shift: the plane's bits for every column, with the output blanked, latched on the last column
+///   - the plane's hold: a run of samples with the output enabled for the row, 2^plane units long.  The lowest
+///     OE_PLANES planes are shorter than a row's worth of samples - they get a single run with the output enabled
+///     for part of it - the others repeat a full run as many times as they need.
+/// The holds never change, so one set of them is shared by everything; the shifts are double buffered.
+
+#include <assert.h>
+
+extern "C" {
+#include "esp_heap_caps.h"
+#include "esp_intr_alloc.h"
+#include "driver/gpio.h"
+#include "driver/periph_ctrl.h"
+#include "rom/gpio.h"
+#include "rom/lldesc.h"
+#include "soc/gpio_sig_map.h"
+#include "soc/i2s_struct.h"
+#include "freertos/semphr.h"
+}
+
+/// The GPIOs wired to the panel's R1, G1, B1, R2, G2, B2, A, B, C, D, E, LAT and OE inputs, in that order.  Define
+/// this (as a brace enclosed list) before including FastLED.h to pick your own pins.  E is only used by panels
+/// with 32 row pairs (1/32 scan), set it to -1 if the panel doesn't have it.
+#ifndef FASTLED_ESP32_HUB75_PINS
+#define FASTLED_ESP32_HUB75_PINS { 25, 26, 27, 14, 12, 13, 23, 19, 5, 17, -1, 4, 15 }
+#endif
+
+/// The GPIO wired to the panel's CLK input
+#ifndef FASTLED_ESP32_HUB75_CLK_PIN
+#define FASTLED_ESP32_HUB75_CLK_PIN 16
+#endif
+
+/// Which I2S peripheral to use.  The parallel clockless output takes I2S0 first, so this defaults to the other one.
+/// Each peripheral goes to one controller only (see fastled_esp32_claim_i2s).
+#ifndef FASTLED_ESP32_HUB75_I2S
+#define FASTLED_ESP32_HUB75_I2S 1
+#endif
+
+/// The pixel clock is 80Mhz / FASTLED_ESP32_HUB75_CLKM_DIV.  Most panels are happy at 10Mhz, long chains of them
+/// or long cables may need it slower.
+#ifndef FASTLED_ESP32_HUB75_CLKM_DIV
+#define FASTLED_ESP32_HUB75_CLKM_DIV 8
+#endif
+
+FASTLED_NAMESPACE_BEGIN
+
+/// A HUB75 panel, or a chain of them, driven from the dma.  There are two ways of getting pixels onto it:
+///   - add it to FastLED with a led array of WIDTH * HEIGHT leds laid out row by row, as in
+///     FastLED.addLeds(&panel, leds, WIDTH * HEIGHT).  Show writes the array straight into the bit planes, scaled
+///     and dithered the way every other controller's is, and then flips.
+///   - draw into the bit planes directly with panel(x, y) = color, or drawPixel, and flip() when done.  This skips
+///     the led array entirely, but the colors go out as they're given - no brightness scaling, correction or
+///     dithering.  The buffer being drawn into is the one that was shown two flips ago, so every pixel needs to be
+///     redrawn each frame.
+///
+/// @tparam WIDTH the width of the panel (or of the whole chain of panels) in pixels
+/// @tparam HEIGHT the height of the panel in pixels, twice the number of row pairs it scans
+/// @tparam DEPTH the color depth, the number of bit planes per color, 1 to 8.  Fewer planes shorten the refresh.
+/// @tparam OE_PLANES how many of the lowest planes get their shorter display time by enabling the output for part
+/// of a row's worth of samples rather than by repeating a row's worth.  More of them means fewer descriptors and a
+/// faster refresh, but dimmer lowest planes that aren't as even.
+template<int WIDTH, int HEIGHT, int DEPTH = 8, int OE_PLANES = 3, EOrder RGB_ORDER = RGB>
+class HUB75Controller : public CPixelLEDController<RGB_ORDER> {
+	static_assert(DEPTH >= 1 && DEPTH <= 8, "The HUB75 color depth must be 1 to 8 bit planes");
+	static_assert(OE_PLANES >= 0 && OE_PLANES < DEPTH, "OE_PLANES must be less than the color depth");
+	static_assert((WIDTH >> OE_PLANES) >= 2, "The panel is too narrow for that many OE_PLANES");
+	static_assert(WIDTH * 2 <= 4092, "A row of samples has to fit in one dma descriptor");
+	static_assert((WIDTH & 1) == 0 && (HEIGHT & 1) == 0, "The panel's width and height have to be even");
+	static_assert(HEIGHT <= 64, "The HUB75 address lines can select at most 32 row pairs");
+
+	enum {
+		ROWS = HEIGHT / 2,
+		// panel input bits in each sample
+		R1 = 0, ADDR = 6, LAT = 1 << 11, OE = 1 << 12,
+		// descriptors for each row pair: a shift for every plane, one hold for each of the lowest planes,
+		// 2^(plane - OE_PLANES) for each of the others
+		DESCS_PER_ROW = DEPTH + OE_PLANES + ((1 << (DEPTH - OE_PLANES)) - 1),
+		DESCS = ROWS * DESCS_PER_ROW,
+		SHIFT_SAMPLES = ROWS * DEPTH * WIDTH,
+		HOLD_RUNS = OE_PLANES + 1
+	};
+
+	i2s_dev_t *mI2S;
+	intr_handle_t mIntrHandle;
+	SemaphoreHandle_t mFlipped;
+	// the I2S clock comes from the apb, which frequency scaling would otherwise slow under the refresh
+	ESP32ClockLock mClockLock;
+
+	// the shift samples of both buffers, and the hold runs of every row pair (the fully enabled run last)
+	uint16_t *mShift[2];
+	uint16_t *mHold;
+	lldesc_t *mDescriptors[2];
+
+	// the buffer the dma refreshes the panel from, and the one that's drawn into
+	uint8_t mFront;
+	volatile bool mFlipping;
+
+	// in 16 bit mode the I2S sends the two samples in each 32 bit word high half first
+	static int sample(int x) { return x ^ 1; }
+
+	uint16_t *shift(uint8_t buffer, int row, int plane) { return mShift[buffer] + ((row * DEPTH) + plane) * WIDTH; }
+	uint16_t *hold(int row, int run) { return mHold + ((row * HOLD_RUNS) + run) * WIDTH; }
+
+public:
+	/// The color of one pixel of the buffer being drawn into, see HUB75Controller::operator()
+	class Pixel {
+		uint16_t *mSample;
+		uint8_t mShiftBits;
+	public:
+		Pixel(uint16_t *pSample, uint8_t shiftBits) : mSample(pSample), mShiftBits(shiftBits) {}
+
+		/// write a color into the bit planes
+		Pixel & operator=(const CRGB & rgb) {
+			uint16_t *pSample = mSample;
+			for(int plane = 0; plane < DEPTH; plane++) {
+				uint8_t bit = 8 - DEPTH + plane;
+				uint16_t v = ((rgb.r >> bit) & 0x01) | (((rgb.g >> bit) & 0x01) << 1) | (((rgb.b >> bit) & 0x01) << 2);
+				*pSample = (*pSample & ~(0x07 << mShiftBits)) | (v << mShiftBits);
+				pSample += WIDTH;
+			}
+			return *this;
+		}
+
+		/// read a color back out of the bit planes, the bits below the color depth are 0
+		operator CRGB() const {
+			CRGB rgb(0, 0, 0);
+			const uint16_t *pSample = mSample;
+			for(int plane = 0; plane < DEPTH; plane++) {
+				uint8_t bit = 8 - DEPTH + plane;
+				uint16_t v = *pSample >> mShiftBits;
+				rgb.r |= (v & 0x01) << bit;
+				rgb.g |= ((v >> 1) & 0x01) << bit;
+				rgb.b |= ((v >> 2) & 0x01) << bit;
+				pSample += WIDTH;
+			}
+			return rgb;
+		}
+	};
+
+	HUB75Controller() : mI2S(NULL), mIntrHandle(NULL), mFlipped(NULL), mClockLock(true), mHold(NULL), mFront(0), mFlipping(false) {
+		mShift[0] = mShift[1] = NULL;
+		mDescriptors[0] = mDescriptors[1] = NULL;
+	}
+
+	/// the panel's width in pixels
+	static int width() { return WIDTH; }
+
+	/// the panel's height in pixels
+	static int height() { return HEIGHT; }
+
+	/// the pixel at (x,y) of the buffer being drawn into.  No range checking is done.
+	Pixel operator()(int x, int y) {
+		return Pixel(shift(mFront ^ 1, y % ROWS, 0) + sample(x), R1 + ((y >= ROWS) ? 3 : 0));
+	}
+
+	/// write a color into the pixel at (x,y) of the buffer being drawn into, if (x,y) is on the panel
+	void drawPixel(int x, int y, const CRGB & rgb) {
+		if(x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT) { (*this)(x, y) = rgb; }
+	}
+
+	/// show the buffer that was drawn into, and make the one that was being shown the one to draw into.  Waits for the
+	/// dma to move over to the new buffer, which it does at the end of the current refresh.
+	void flip() {
+		if(mI2S == NULL) { return; }
+		uint8_t back = mFront ^ 1;
+		mFlipping = true;
+		// the front ring runs on into the back one when it comes around to its end, and back into itself
+		// from then on
+		mDescriptors[mFront][DESCS - 1].qe.stqe_next = &mDescriptors[back][0];
+		mDescriptors[back][DESCS - 1].qe.stqe_next = &mDescriptors[back][0];
+		xSemaphoreTake(mFlipped, portMAX_DELAY);
+		mFront = back;
+	}
+
+	virtual void init() {
+		// the I2S peripheral may be taken already, by a block controller: the panel is left alone
+		bool claimed = fastled_esp32_claim_i2s(FASTLED_ESP32_HUB75_I2S);
+		assert(claimed && "the HUB75 I2S peripheral is in use already");
+		if(!claimed) { return; }
+		// all the dma memory up front - without it the panel is left alone, and mI2S NULL keeps show and flip from
+		// touching it
+		mHold = (uint16_t*)heap_caps_malloc(ROWS * HOLD_RUNS * WIDTH * 2, MALLOC_CAP_DMA);
+		for(int b = 0; b < 2; b++) {
+			mShift[b] = (uint16_t*)heap_caps_malloc(SHIFT_SAMPLES * 2, MALLOC_CAP_DMA);
+			mDescriptors[b] = (lldesc_t*)heap_caps_malloc(DESCS * sizeof(lldesc_t), MALLOC_CAP_DMA);
+		}
+		if(mHold == NULL || mShift[0] == NULL || mShift[1] == NULL || mDescriptors[0] == NULL || mDescriptors[1] == NULL) {
+			heap_caps_free(mHold); mHold = NULL;
+			for(int b = 0; b < 2; b++) {
+				heap_caps_free(mShift[b]); mShift[b] = NULL;
+				heap_caps_free(mDescriptors[b]); mDescriptors[b] = NULL;
+			}
+			return;
+		}
+
+		mI2S = (FASTLED_ESP32_HUB75_I2S == 0) ? &I2S0 : &I2S1;
+		periph_module_enable((FASTLED_ESP32_HUB75_I2S == 0) ? PERIPH_I2S0_MODULE : PERIPH_I2S1_MODULE);
+		// in 16 bit lcd mode the samples come out on data outputs 8 to 23
+		int sigBase = ((FASTLED_ESP32_HUB75_I2S == 0) ? I2S0O_DATA_OUT0_IDX : I2S1O_DATA_OUT0_IDX) + 8;
+
+		static const int sPins[] = FASTLED_ESP32_HUB75_PINS;
+		for(int i = 0; i < (int)(sizeof(sPins)/sizeof(sPins[0])); i++) {
+			if(sPins[i] < 0) { continue; }
+			pinMode(sPins[i], OUTPUT);
+			gpio_matrix_out(sPins[i], sigBase + i, false, false);
+		}
+		// the word clock is the pixel clock, inverted so the data is settled on the rising edge
+		pinMode(FASTLED_ESP32_HUB75_CLK_PIN, OUTPUT);
+		gpio_matrix_out(FASTLED_ESP32_HUB75_CLK_PIN, (FASTLED_ESP32_HUB75_I2S == 0) ? I2S0O_WS_OUT_IDX : I2S1O_WS_OUT_IDX, true, false);
+
+		resetI2S();
+
+		// Parallel (lcd) mode, 16 bit samples
+		mI2S->conf.tx_msb_right = 0;
+		mI2S->conf.tx_mono = 0;
+		mI2S->conf.tx_short_sync = 0;
+		mI2S->conf.tx_msb_shift = 0;
+		mI2S->conf.tx_right_first = 0;
+		mI2S->conf.tx_slave_mod = 0;
+
+		mI2S->conf2.val = 0;
+		mI2S->conf2.lcd_en = 1;
+		mI2S->conf2.lcd_tx_wrx2_en = 0;
+		mI2S->conf2.lcd_tx_sdx2_en = 0;
+
+		mI2S->sample_rate_conf.val = 0;
+		mI2S->sample_rate_conf.tx_bits_mod = 16;
+		mI2S->sample_rate_conf.tx_bck_div_num = 1;
+
+		mI2S->clkm_conf.val = 0;
+		mI2S->clkm_conf.clka_en = 0;
+		mI2S->clkm_conf.clkm_div_a = 1;
+		mI2S->clkm_conf.clkm_div_b = 0;
+		mI2S->clkm_conf.clkm_div_num = FASTLED_ESP32_HUB75_CLKM_DIV;
+
+		mI2S->fifo_conf.val = 0;
+		mI2S->fifo_conf.tx_fifo_mod_force_en = 1;
+		mI2S->fifo_conf.tx_fifo_mod = 1;
+		mI2S->fifo_conf.tx_data_num = 32;
+		mI2S->fifo_conf.dscr_en = 1;
+
+		mI2S->conf1.val = 0;
+		mI2S->conf1.tx_stop_en = 0;
+		mI2S->conf1.tx_pcm_bypass = 1;
+
+		mI2S->conf_chan.val = 0;
+		mI2S->conf_chan.tx_chan_mod = 1;
+
+		mI2S->timing.val = 0;
+
+		// the hold runs: the output enabled for 2^plane units of WIDTH >> OE_PLANES samples, or for all but the last
+		// sample of the fully enabled run, so the address never changes with the output on
+		for(int row = 0; row < ROWS; row++) {
+			uint16_t addr = row << ADDR;
+			for(int run = 0; run < HOLD_RUNS; run++) {
+				int on = (run < OE_PLANES) ? ((WIDTH >> OE_PLANES) << run) : (WIDTH - 1);
+				uint16_t *pHold = hold(row, run);
+				for(int x = 0; x < WIDTH; x++) { pHold[sample(x)] = addr | ((x < on) ? 0 : OE); }
+			}
+		}
+
+		for(int b = 0; b < 2; b++) {
+			// blank shifts, latched on their last column
+			for(int row = 0; row < ROWS; row++) {
+				for(int plane = 0; plane < DEPTH; plane++) {
+					uint16_t *pShift = shift(b, row, plane);
+					for(int x = 0; x < WIDTH; x++) { pShift[sample(x)] = (row << ADDR) | OE | ((x == WIDTH - 1) ? LAT : 0); }
+				}
+			}
+
+			lldesc_t *pDesc = mDescriptors[b];
+			for(int row = 0; row < ROWS; row++) {
+				for(int plane = 0; plane < DEPTH; plane++) {
+					link(pDesc++, shift(b, row, plane));
+					if(plane < OE_PLANES) {
+						link(pDesc++, hold(row, plane));
+					} else {
+						for(int rep = 1 << (plane - OE_PLANES); rep > 0; rep--) { link(pDesc++, hold(row, OE_PLANES)); }
+					}
+				}
+			}
+			// each ring loops back on itself, the first descriptor marks the dma having moved into a ring
+			mDescriptors[b][DESCS - 1].qe.stqe_next = &mDescriptors[b][0];
+			mDescriptors[b][0].eof = 1;
+		}
+
+		mFront = 0;
+		mFlipped = xSemaphoreCreateBinary();
+		esp_intr_alloc((FASTLED_ESP32_HUB75_I2S == 0) ? ETS_I2S0_INTR_SOURCE : ETS_I2S1_INTR_SOURCE, FASTLED_ESP32_INTR_FLAGS, interruptHandler, this, &mIntrHandle);
+		// the refresh never stops, so neither does the lock
+		mClockLock.acquire();
+		startI2S();
+	}
+
+	/// the panel is refreshed from the dma all the time, so there's never any output to wait for
+	virtual bool isShowing() { return false; }
+
+protected:
+
+	virtual void showPixels(PixelController<RGB_ORDER> & pixels) {
+		if(mI2S == NULL) { return; }
+
+		// straight from the pixels into the bit planes of the buffer that isn't being refreshed from
+		pixels.preStepFirstByteDithering();
+		for(int y = 0; y < HEIGHT && pixels.has(1); y++) {
+			for(int x = 0; x < WIDTH && pixels.has(1); x++) {
+				CRGB rgb(pixels.loadAndScale0(), pixels.loadAndScale1(), pixels.loadAndScale2());
+				(*this)(x, y) = rgb;
+				pixels.advanceData();
+				pixels.stepDithering();
+			}
+		}
+		flip();
+	}
+
+	static void link(lldesc_t *pDesc, uint16_t *pBuf) {
+		pDesc->length = WIDTH * 2;
+		pDesc->size = WIDTH * 2;
+		pDesc->owner = 1;
+		pDesc->sosf = 0;
+		pDesc->eof = 0;
+		pDesc->offset = 0;
+		pDesc->buf = (uint8_t*)pBuf;
+		pDesc->qe.stqe_next = pDesc + 1;
+	}
+
+	void resetI2S() {
+		mI2S->lc_conf.in_rst = 1; mI2S->lc_conf.out_rst = 1; mI2S->lc_conf.ahbm_rst = 1; mI2S->lc_conf.ahbm_fifo_rst = 1;
+		mI2S->lc_conf.in_rst = 0; mI2S->lc_conf.out_rst = 0; mI2S->lc_conf.ahbm_rst = 0; mI2S->lc_conf.ahbm_fifo_rst = 0;
+		mI2S->conf.tx_reset = 1; mI2S->conf.tx_fifo_reset = 1; mI2S->conf.rx_reset = 1; mI2S->conf.rx_fifo_reset = 1;
+		mI2S->conf.tx_reset = 0; mI2S->conf.tx_fifo_reset = 0; mI2S->conf.rx_reset = 0; mI2S->conf.rx_fifo_reset = 0;
+	}
+
+	void startI2S() {
+		resetI2S();
+		mI2S->lc_conf.val = 0;
+		mI2S->lc_conf.out_data_burst_en = 1;
+		mI2S->lc_conf.outdscr_burst_en = 1;
+		mI2S->out_link.addr = (uint32_t)mDescriptors[mFront];
+		mI2S->out_link.start = 1;
+		mI2S->int_clr.val = mI2S->int_raw.val;
+		mI2S->int_ena.val = 0;
+		mI2S->int_ena.out_eof = 1;
+		mI2S->conf.tx_start = 1;
+	}
+
+	static FASTLED_IRAM void interruptHandler(void *arg) {
+		HUB75Controller *pController = (HUB75Controller*)arg;
+		i2s_dev_t *i2s = pController->mI2S;
+
+		if(i2s->int_st.out_eof) {
+			i2s->int_clr.val = i2s->int_raw.val;
+
+			// once the dma has moved into the back ring the front one is free to be drawn into
+			lldesc_t *pDone = (lldesc_t*)i2s->out_eof_des_addr;
+			if(pController->mFlipping && pDone == pController->mDescriptors[pController->mFront ^ 1]) {
+				pController->mFlipping = false;
+				BaseType_t HPTaskAwoken = pdFALSE;
+				xSemaphoreGiveFromISR(pController->mFlipped, &HPTaskAwoken);
+				if(HPTaskAwoken == pdTRUE) { portYIELD_FROM_ISR(); }
+			}
+		}
+	}
+};
+
+FASTLED_NAMESPACE_END
+
+#endif
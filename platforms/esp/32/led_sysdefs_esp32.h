@@ -29,5 +29,174 @@ typedef bool boolean;
 // These can be overridden
 #   define FASTLED_ESP32_RAW_PIN_ORDER
 
+// Clockless output goes through the RMT peripheral by default.  Define this to go back to the
+// cycle counted, interrupts-off bit-banging output instead.
+// #define FASTLED_ESP32_FORCE_BITBANG
+
+// Define this to run FastLED.show on a dedicated FreeRTOS task pinned to the other core (1 by default),
+// keeping the led output (and any interrupts-off windows it needs) away from the WiFi/network stack on
+// core 0.  show/showAsync hand the frame to the task and waitShow/isShowing wait on it.  Since FastLED.cpp
+// has to see it, set this here or as a compiler flag rather than in a sketch.
+// #define FASTLED_ESP32_SHOW_TASK
+
+#ifdef FASTLED_ESP32_SHOW_TASK
+extern "C" {
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+}
+#ifndef FASTLED_ESP32_SHOW_TASK_CORE
+#define FASTLED_ESP32_SHOW_TASK_CORE 1
+#endif
+#ifndef FASTLED_ESP32_SHOW_TASK_PRIORITY
+#define FASTLED_ESP32_SHOW_TASK_PRIORITY (configMAX_PRIORITIES - 1)
+#endif
+#ifndef FASTLED_ESP32_SHOW_TASK_STACK
+#define FASTLED_ESP32_SHOW_TASK_STACK 2048
+#endif
+#endif
+
+// The output features controller.h leaves off by default, all on here: each costs a check per pixel on the way out
+// unless it says otherwise.  Set any of them to 0 (here or as a compiler flag, all of the library has to agree) to
+// turn it off.
+
+// gamma tables applied as the leds are written out, see CLEDController::setGamma - a table read per byte
+#ifndef FASTLED_GAMMA_OUTPUT
+#define FASTLED_GAMMA_OUTPUT 1
+#endif
+
+// led data generated as it's written out, see CLEDController::setGenerator
+#ifndef FASTLED_PIXEL_GENERATORS
+#define FASTLED_PIXEL_GENERATORS 1
+#endif
+
+// reversed, mirrored and rotated output, see CLEDController::setReverse
+#ifndef FASTLED_OUTPUT_MAPPING
+#define FASTLED_OUTPUT_MAPPING 1
+#endif
+
+// block controller lanes of their own lengths, see CLEDController::setLaneLengths - a check per byte
+#ifndef FASTLED_LANE_LENGTHS
+#define FASTLED_LANE_LENGTHS 1
+#endif
+
+// segments with color adjustments of their own, see CLEDController::setSegments
+#ifndef FASTLED_SEGMENTS
+#define FASTLED_SEGMENTS 1
+#endif
+
+// dithering over neighbouring leds as well as over time, see SPATIAL_DITHER
+#ifndef FASTLED_SPATIAL_DITHER
+#define FASTLED_SPATIAL_DITHER 1
+#endif
+
+// Let the *_parallel effect functions (see parallel.h) split their work between both cores, running half of it on
+// a worker task pinned to the core the caller isn't on.  Set to 0 (here or as a compiler flag) to run them inline.
+#ifndef FASTLED_PARALLEL
+# ifdef CONFIG_FREERTOS_UNICORE
+#  define FASTLED_PARALLEL 0
+# else
+#  define FASTLED_PARALLEL 1
+# endif
+#endif
+#if (FASTLED_PARALLEL == 1)
+// The workers' priority: above the default Arduino/IDF application tasks, so the caller isn't left waiting on
+// them, but below the WiFi and network stack tasks
+#ifndef FASTLED_ESP32_PARALLEL_PRIORITY
+#define FASTLED_ESP32_PARALLEL_PRIORITY 5
+#endif
+#ifndef FASTLED_ESP32_PARALLEL_STACK
+#define FASTLED_ESP32_PARALLEL_STACK 2048
+#endif
+#endif
+
+// Keep 256 entry expansions of recently used CRGBPalette16s, so that ColorFromPalette lookups with LINEARBLEND
+// are a table read instead of an interpolation.  Costs 768 bytes of ram per slot.  Set to 0 (here or as a
+// compiler flag, all of the library has to agree) to turn it off.
+#ifndef FASTLED_PALETTE16_CACHE
+#define FASTLED_PALETTE16_CACHE 1
+#endif
+#ifndef FASTLED_PALETTE16_CACHE_SLOTS
+#define FASTLED_PALETTE16_CACHE_SLOTS 2
+#endif
+
+// Keep the code that writes clockless led data out in internal ram - the bit-banged output (see
+// FASTLED_ESP32_FORCE_BITBANG), the RMT, I2S and HUB75 interrupt handlers and buffer refills, and the PixelController
+// code they run - so a flash cache miss, or the cache being off while something writes to flash, can't stretch the
+// bit timings into a retry or stall the refills.  Costs a few kB of iram per controller type.  Define it as nothing
+// (here or as a compiler flag) to leave that code in flash.
+#if !defined(FASTLED_IRAM)
+#include "esp_attr.h"
+#define FASTLED_IRAM IRAM_ATTR
+#ifndef FASTLED_ESP32_IRAM_INTERRUPTS
+#define FASTLED_ESP32_IRAM_INTERRUPTS 1
+#endif
+#endif
+
+// With the interrupt handlers in iram, they're allocated with ESP_INTR_FLAG_IRAM, so they keep running while the
+// flash cache is off.  They can only read internal ram then: set it to 0 when leds are kept in PSRAM (see
+// CStagedLedBuffer) or a pixel generator reads flash, and flash gets written while frames go out.
+#ifndef FASTLED_ESP32_IRAM_INTERRUPTS
+#define FASTLED_ESP32_IRAM_INTERRUPTS 0
+#endif
+#if (FASTLED_ESP32_IRAM_INTERRUPTS == 1)
+#define FASTLED_ESP32_INTR_FLAGS (ESP_INTR_FLAG_LEVEL3 | ESP_INTR_FLAG_IRAM)
+#else
+#define FASTLED_ESP32_INTR_FLAGS ESP_INTR_FLAG_LEVEL3
+#endif
+
+// Keep the leds of a CStagedLedBuffer in PSRAM (when the board has some), and the tile they get copied into on the way
+// out in internal ram, see stagedleds.h
+#include "esp_heap_caps.h"
+#if !defined(FASTLED_STAGED_LEDS_MALLOC)
+#define FASTLED_STAGED_LEDS_MALLOC(len) heap_caps_malloc(len, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#endif
+#if !defined(FASTLED_STAGED_TILE_MALLOC)
+#define FASTLED_STAGED_TILE_MALLOC(len) heap_caps_malloc(len, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#endif
+#if !defined(FASTLED_STAGED_FREE)
+#define FASTLED_STAGED_FREE(ptr) heap_caps_free(ptr)
+#endif
+
+// Have allocateLeds put leds in DMA capable internal ram, so the SPI output can send them without copying (see
+// pixelset.h).  The SPI host's DMA also needs them word aligned, or the esp-idf driver bounces them through a copy.
+#if !defined(FASTLED_DMA_LEDS_MALLOC)
+#include "esp_heap_caps.h"
+#define FASTLED_DMA_LEDS_MALLOC(len) heap_caps_malloc(len, MALLOC_CAP_DMA | MALLOC_CAP_8BIT)
+#define FASTLED_DMA_LEDS_FREE(ptr) heap_caps_free(ptr)
+#endif
+#if !defined(FASTLED_DMA_CAPABLE)
+#include "soc/soc_memory_layout.h"
+#define FASTLED_DMA_CAPABLE(ptr) (esp_ptr_dma_capable(ptr) && ((((uintptr_t)(ptr)) & 3) == 0))
+#endif
+
+// Put the built-in palettes' 256 color tables (RainbowColors_t etc, see colorpalettes.h) in internal ram, so
+// lookups don't stall on the flash cache.  Only the tables a sketch uses take up any.
+#if !defined(FASTLED_PALETTE_TABLE_ATTR)
+#include "esp_attr.h"
+#define FASTLED_PALETTE_TABLE_ATTR DRAM_ATTR
+#endif
+
+// Keep the noise functions' permutation table in internal ram, doubled up to 512 entries so the hashing doesn't have
+// to wrap its sums to 8 bits, and use full width math for their interpolation rather than the AVR oriented 8/16-bit
+// code.  The noise comes out the same either way.  Set to 0 (here or as a compiler flag) to turn them off.
+#ifndef FASTLED_NOISE_RAM_TABLE
+#define FASTLED_NOISE_RAM_TABLE 1
+#endif
+#ifndef FASTLED_NOISE_32BIT
+#define FASTLED_NOISE_32BIT 1
+#endif
+#if (FASTLED_NOISE_RAM_TABLE == 1) && !defined(FASTLED_NOISE_TABLE_ATTR)
+#include "esp_attr.h"
+#define FASTLED_NOISE_TABLE_ATTR DRAM_ATTR
+#endif
+
+// Info on reading cycle counter from https://github.com/kbeckmann/nodemcu-firmware/blob/ws2812-dual/app/modules/ws2812.c
+__attribute__ ((always_inline)) inline static uint32_t __clock_cycles() {
+  uint32_t cyc;
+  __asm__ __volatile__ ("rsr %0,ccount":"=a" (cyc));
+  return cyc;
+}
+
 // #define cli() os_intr_lock();
 // #define sei() os_intr_lock();
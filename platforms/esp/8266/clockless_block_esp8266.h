@@ -13,8 +13,8 @@ FASTLED_NAMESPACE_BEGIN
 
 #ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
 extern uint32_t _frame_cnt;
-extern uint32_t _retry_cnt;
 #endif
+extern uint32_t _retry_cnt;
 
 template <uint8_t LANES, int FIRST_PIN, int T1, int T2, int T3, EOrder RGB_ORDER = GRB, int XTRA0 = 0, bool FLIP = false, int WAIT_TIME = 5>
 class InlineBlockClocklessController : public CPixelLEDController<RGB_ORDER, LANES, PORT_MASK> {
@@ -25,7 +25,7 @@ class InlineBlockClocklessController : public CPixelLEDController<RGB_ORDER, LAN
 	data_ptr_t mPort;
 	CMinWait<WAIT_TIME> mWait;
 public:
-	virtual int size() { return CLEDController::size() * LANES; }
+	virtual int size() { return CLEDController::laneLeds(LANES); }
 
 	virtual void showPixels(PixelController<RGB_ORDER, LANES, PORT_MASK> & pixels) {
 		// mWait.wait();
@@ -33,9 +33,8 @@ public:
 		int cnt=FASTLED_INTERRUPT_RETRY_COUNT;
 		while(!showRGBInternal(pixels) && cnt--) {
       os_intr_unlock();
-			#ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
 			_retry_cnt++;
-			#endif
+			FASTLED_TRACE_EVENT(TRACE_RETRY, cnt);
       delayMicroseconds(WAIT_TIME * 10);
       os_intr_lock();
     }
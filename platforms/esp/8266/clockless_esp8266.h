@@ -4,8 +4,8 @@ FASTLED_NAMESPACE_BEGIN
 
 #ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
 extern uint32_t _frame_cnt;
-extern uint32_t _retry_cnt;
 #endif
+extern uint32_t _retry_cnt;
 
 // Info on reading cycle counter from https://github.com/kbeckmann/nodemcu-firmware/blob/ws2812-dual/app/modules/ws2812.c
 __attribute__ ((always_inline)) inline static uint32_t __clock_cycles() {
@@ -24,8 +24,15 @@ class ClocklessController : public CPixelLEDController<RGB_ORDER> {
 	data_t mPinMask;
 	data_ptr_t mPort;
 	CMinWait<WAIT_TIME> mWait;
+	CInterruptSpacing mSpacing;
+#if (FASTLED_ESP8266_UART == 1)
+	typedef ESP8266UartClockless<T1, T2, T3, RGB_ORDER, XTRA0, WAIT_TIME> Uart;
+#endif
 public:
 	virtual void init() {
+#if (FASTLED_ESP8266_UART == 1)
+		if(Uart::usable(FastPin<DATA_PIN>::mask())) { Uart::init(); return; }
+#endif
 		FastPin<DATA_PIN>::setOutput();
 		mPinMask = FastPin<DATA_PIN>::mask();
 		mPort = FastPin<DATA_PIN>::port();
@@ -36,16 +43,36 @@ public:
 protected:
 
 	virtual void showPixels(PixelController<RGB_ORDER> & pixels) {
+#if (FASTLED_ESP8266_UART == 1)
+		if(Uart::usable(FastPin<DATA_PIN>::mask())) {
+			mWait.wait();
+			int cnt = FASTLED_INTERRUPT_RETRY_COUNT;
+			while(!Uart::show(pixels) && cnt--) {
+				_retry_cnt++;
+				FASTLED_TRACE_EVENT(TRACE_RETRY, cnt);
+				this->m_Stats.retries++;
+				delayMicroseconds(WAIT_TIME);
+			}
+			mWait.mark();
+			return;
+		}
+#endif
     // mWait.wait();
 		int cnt = FASTLED_INTERRUPT_RETRY_COUNT;
-    while((showRGBInternal(pixels)==0) && cnt--) {
-      #ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
+		bool firstTry = true;
+    while((showRGBInternal(pixels, mSpacing.spacing(), this->m_Stats)==0) && cnt--) {
       _retry_cnt++;
-      #endif
+      FASTLED_TRACE_EVENT(TRACE_RETRY, cnt);
+      this->m_Stats.retries++;
+      // the strip starts over at its first pixel after the latch time, so try again with fewer interrupt windows
+      mSpacing.restarted();
+      firstTry = false;
       os_intr_unlock();
       delayMicroseconds(WAIT_TIME);
       os_intr_lock();
     }
+		mSpacing.finished(firstTry);
+		this->m_Stats.interruptSpacing = mSpacing.spacing();
     // mWait.mark();
   }
 
@@ -70,7 +97,9 @@ protected:
 
 	// This method is made static to force making register Y available to use for data on AVR - if the method is non-static, then
 	// gcc will use register Y for the this pointer.
-	static uint32_t ICACHE_RAM_ATTR showRGBInternal(PixelController<RGB_ORDER> pixels) {
+	// spacing is the number of pixels to write between interrupt windows.  The stretches interrupts are kept off for
+	// go into stats.
+	static uint32_t ICACHE_RAM_ATTR showRGBInternal(PixelController<RGB_ORDER> pixels, uint16_t spacing, LEDControllerStats & stats) {
 		// Setup the pixel controller and load/scale the first byte
 		pixels.preStepFirstByteDithering();
 		register uint32_t b = pixels.loadAndScale0();
@@ -78,6 +107,8 @@ protected:
 		os_intr_lock();
     uint32_t start = __clock_cycles();
 		uint32_t last_mark = start;
+		uint32_t locked = start;
+		uint16_t untilWindow = spacing;
 		while(pixels.has(1)) {
 			// Write first byte, read next byte
 			writeBits<8+XTRA0>(last_mark, b);
@@ -92,20 +123,26 @@ protected:
       b = pixels.advanceAndLoadAndScale0();
 
 			#if (FASTLED_ALLOW_INTERRUPTS == 1)
-			os_intr_unlock();
-			#endif
-
-      pixels.stepDithering();
-
-			#if (FASTLED_ALLOW_INTERRUPTS == 1)
-			os_intr_lock();
-			// if interrupts took longer than 45µs, punt on the current frame
-			if((int32_t)(__clock_cycles()-last_mark) > 0) {
-				if((int32_t)(__clock_cycles()-last_mark) > (T1+T2+T3+((WAIT_TIME-INTERRUPT_THRESHOLD)*CLKS_PER_US))) { sei(); return 0; }
+			if(--untilWindow == 0) {
+				untilWindow = spacing;
+				stats.blocked(__clock_cycles() - locked);
+				os_intr_unlock();
+        pixels.stepDithering();
+				os_intr_lock();
+				locked = __clock_cycles();
+				// if interrupts took longer than 45µs, punt on the current frame
+				if((int32_t)(__clock_cycles()-last_mark) > 0) {
+					if((int32_t)(__clock_cycles()-last_mark) > (T1+T2+T3+((WAIT_TIME-INTERRUPT_THRESHOLD)*CLKS_PER_US))) { sei(); return 0; }
+				}
+			} else {
+        pixels.stepDithering();
 			}
+			#else
+      pixels.stepDithering();
 			#endif
 		};
 
+		stats.blocked(__clock_cycles() - locked);
 		os_intr_unlock();
     #ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
     _frame_cnt++;
@@ -0,0 +1,108 @@
+#pragma once
+
+///@file clockless_uart_esp8266.h
+/// Clockless output on the ESP8266's GPIO2 through UART1, whose tx pin it is.  With the line inverted and the uart
+/// sending 6 bit characters at four times the led bit rate, every character - start bit, six data bits, stop bit -
+/// makes two led bits of four uart bits each: the start bit and the stop bit are always the high start and the low
+/// end of the pair, and the data bits pick the high or low middle of each.  A 0 bit comes out high for a quarter of
+/// the bit time, a 1 bit for three quarters.
+///
+/// The uart's 128 character tx fifo holds a bit over ten pixels, so the fifo gets topped up a pixel at a time with
+/// interrupts left on - WiFi and the rest of the system can interrupt the frame for as long as it takes the fifo to
+/// drain (about 300µs for 800khz leds) without the strip latching part way through.  An interrupt that runs longer
+/// than that starts the frame over, like the bit-banged output does when its interrupt windows run long.
+
+FASTLED_NAMESPACE_BEGIN
+
+#define FASTLED_ESP8266_UART_GPIO 2
+#define FASTLED_ESP8266_UART_FIFO 128
+
+/// Writes clockless led data out of UART1, see clockless_uart_esp8266.h.  ClocklessController uses it for strips on
+/// GPIO2 when FASTLED_ESP8266_UART is set.
+/// @tparam T1, T2, T3 the led timings in cpu clocks at F_CPU, as for ClocklessController - only their sum (the bit
+/// time) is used, the high times are always a quarter and three quarters of it
+template <int T1, int T2, int T3, EOrder RGB_ORDER = RGB, int XTRA0 = 0, int WAIT_TIME = 5>
+class ESP8266UartClockless {
+	// the character for each pair of led bits, the first bit sent in the high bit of the index.  The line is
+	// inverted, so data bits of 0 come out high.
+	static uint8_t encode(uint8_t bits) {
+		static const uint8_t sChars[4] = { 0x37, 0x07, 0x34, 0x04 };
+		return sChars[bits];
+	}
+
+	static uint32_t fifoCount() { return (USS(1) >> USTXC) & 0xFF; }
+
+	// how long a character takes to go out, in ns
+	static uint32_t charNs() { return (2L * (T1 + T2 + T3) * 1000L) / (F_CPU / 1000000L); }
+
+	// queue up a byte's worth of led bits, plus the extra zero bits some chipsets want after each byte
+	static void writeByte(uint8_t b) {
+		USF(1) = encode(b >> 6);
+		USF(1) = encode((b >> 4) & 0x03);
+		USF(1) = encode((b >> 2) & 0x03);
+		USF(1) = encode(b & 0x03);
+		for(int i = 0; i < (XTRA0 / 2); i++) { USF(1) = encode(0); }
+	}
+
+public:
+	/// whether a strip can be written out this way: it has to be on GPIO2, and the extra bits after each byte have
+	/// to make whole characters
+	static bool usable(uint32_t pinMask) { return pinMask == (1 << FASTLED_ESP8266_UART_GPIO) && (XTRA0 % 2) == 0; }
+
+	/// the number of characters each pixel takes
+	static int pixelChars(bool white) { return (white ? 4 : 3) * ((8 + XTRA0) / 2); }
+
+	/// hand GPIO2 over to UART1 and set it up for the led timings: 6N1, tx inverted, four uart bits per led bit
+	static void init() {
+		pinMode(FASTLED_ESP8266_UART_GPIO, SPECIAL);
+		USD(1) = (uint32_t)(((uint64_t)ESP8266_CLOCK * (T1 + T2 + T3)) / (4L * F_CPU));
+		USC0(1) = (1 << UCTXI) | (1 << UCSBN) | (1 << UCBN);
+		USC0(1) |= (1 << UCRXRST) | (1 << UCTXRST);
+		USC0(1) &= ~((1 << UCRXRST) | (1 << UCTXRST));
+		USC1(1) = 0;
+		USIE(1) = 0;
+		USIC(1) = 0xFFFF;
+	}
+
+	/// write a frame out, with interrupts left on
+	/// @returns false if the fifo ran dry for longer than the latch time somewhere along the way, so the strip
+	/// started over part way through the frame
+	static bool show(PixelController<RGB_ORDER> pixels) {
+		const int chars = pixelChars(pixels.hasWhite());
+		// no clockless chipset latches on a gap shorter than 50µs, whatever WAIT_TIME it asks for between frames
+		const uint32_t latchMicros = (WAIT_TIME > 50) ? WAIT_TIME : 50;
+		pixels.preStepFirstByteDithering();
+		uint32_t lastWrite = micros();
+		uint32_t queuedNs = 0;
+		bool first = true;
+		while(pixels.has(1)) {
+			uint8_t b0 = pixels.loadAndScale0();
+			uint8_t b1 = pixels.loadAndScale1();
+			uint8_t b2 = pixels.loadAndScale2();
+			uint8_t bW = 0;
+			if(pixels.hasWhite()) { bW = pixels.loadAndScaleW(); pixels.stepWhiteDithering(); }
+
+			uint32_t count;
+			while((count = fifoCount()) > (uint32_t)(FASTLED_ESP8266_UART_FIFO - chars)) {}
+			// an empty fifo has been idle since some time after the last write - if that could have been longer
+			// than the latch time, the strip took what came since as a new frame
+			if(count == 0 && !first && (micros() - lastWrite) > ((queuedNs / 1000) + latchMicros)) { return false; }
+			writeByte(b0);
+			writeByte(b1);
+			writeByte(b2);
+			if(pixels.hasWhite()) { writeByte(bW); }
+			lastWrite = micros();
+			queuedNs = (count + chars) * charNs();
+			first = false;
+
+			pixels.advanceData();
+			pixels.stepDithering();
+		}
+		// the frame isn't out until the fifo has drained and the last character has left the shift register
+		while(fifoCount()) {}
+		delayMicroseconds((charNs() / 1000) + 1);
+		return true;
+	}
+};
+
+FASTLED_NAMESPACE_END
@@ -3,5 +3,6 @@
 #include "bitswap.h"
 #include "fastled_delay.h"
 #include "fastpin_esp8266.h"
+#include "clockless_uart_esp8266.h"
 #include "clockless_esp8266.h"
 #include "clockless_block_esp8266.h"
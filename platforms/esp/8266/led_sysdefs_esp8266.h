@@ -35,5 +35,12 @@ typedef uint8_t boolean;
 # endif
 #endif
 
+// Write clockless strips on GPIO2 out through UART1 (whose tx pin it is, see clockless_uart_esp8266.h) instead of
+// bit-banging them with interrupts off.  Takes UART1 - Serial1 - for the leds.  Set to 0 (here or as a compiler flag)
+// to bit-bang all pins.
+#ifndef FASTLED_ESP8266_UART
+#define FASTLED_ESP8266_UART 1
+#endif
+
 // #define cli() os_intr_lock();
 // #define sei() os_intr_lock();
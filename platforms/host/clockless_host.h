@@ -0,0 +1,97 @@
+#ifndef __INC_CLOCKLESS_HOST_H
+#define __INC_CLOCKLESS_HOST_H
+
+///@file clockless_host.h
+/// A clockless controller for the host platform, which keeps the bytes of each frame instead of writing them out
+
+FASTLED_NAMESPACE_BEGIN
+
+#define FASTLED_HAS_CLOCKLESS 1
+
+/// Runs the pixel data through the same scaling, dithering and reordering as a real clockless controller and keeps
+/// the resulting bytes - the ones that would go out on the wire - for the most recent frame, along with how long
+/// that frame would take to write out on the target (at F_CPU, see led_sysdefs_host.h).  The controller's own
+/// getStats() has the host cycles (well, micros scaled to F_CPU) the frames took to prepare.
+template <int DATA_PIN, int T1, int T2, int T3, EOrder RGB_ORDER = RGB, int XTRA0 = 0, bool FLIP = false, int WAIT_TIME = 5>
+class ClocklessController : public CPixelLEDController<RGB_ORDER> {
+	uint8_t *mFrame;
+	int mFrameBytes;
+	int mFrameCapacity;
+	uint32_t mFrames;
+	uint32_t mWireCycles;
+	uint64_t mTotalWireCycles;
+	CMinWait<WAIT_TIME> mWait;
+
+public:
+	ClocklessController() : mFrame(NULL), mFrameBytes(0), mFrameCapacity(0), mFrames(0), mWireCycles(0), mTotalWireCycles(0) { this->initFlip(FLIP); }
+	~ClocklessController() { delete [] mFrame; }
+
+	virtual void init() {}
+
+	virtual uint16_t getMaxRefreshRate() const { return 400; }
+	virtual uint16_t latchRemaining() { return mWait.remaining(); }
+
+	/// the bytes of the most recent frame, in the order they'd have been sent
+	const uint8_t *frame() const { return mFrame; }
+
+	/// the number of bytes in the most recent frame
+	int frameBytes() const { return mFrameBytes; }
+
+	/// the number of frames written so far
+	uint32_t frames() const { return mFrames; }
+
+	/// how many cpu cycles (at F_CPU) sending the most recent frame would take on the target, latch time included
+	uint32_t wireCycles() const { return mWireCycles; }
+
+	/// how many cpu cycles (at F_CPU) sending all the frames so far would have taken
+	uint64_t totalWireCycles() const { return mTotalWireCycles; }
+
+protected:
+	/// the frame's bytes, doing only the work the frame needs (see PixelController::work)
+	template<int WORK> static void encode(PixelController<RGB_ORDER> & pixels, uint8_t *pOut) {
+		while(pixels.has(1)) {
+			*pOut++ = pixels.template loadAndScale<0, WORK>(pixels);
+			*pOut++ = pixels.template loadAndScale<1, WORK>(pixels);
+			*pOut++ = pixels.template loadAndScale<2, WORK>(pixels);
+			if(pixels.hasWhite()) {
+				*pOut++ = pixels.template loadAndScaleW<WORK>();
+				if(WORK & PIXEL_DITHER) { pixels.stepWhiteDithering(); }
+			}
+			pixels.advanceData();
+			if(WORK & PIXEL_DITHER) { pixels.stepDithering(); }
+		}
+	}
+
+	virtual void showPixels(PixelController<RGB_ORDER> & pixels) {
+		// hold off for the latch time like the target does, so frames come out with the same spacing
+		mWait.wait();
+		int bytes = pixels.size() * (pixels.hasWhite() ? 4 : 3);
+		if(bytes > mFrameCapacity) {
+			delete [] mFrame;
+			mFrame = new uint8_t[bytes];
+			mFrameCapacity = bytes;
+		}
+		mFrameBytes = bytes;
+
+		pixels.preStepFirstByteDithering();
+		if(pixels.rawCopy()) {
+			memcpy8(mFrame, pixels.mData, bytes);
+		} else {
+			switch(pixels.work()) {
+				case PIXEL_RAW: encode<PIXEL_RAW>(pixels, mFrame); break;
+				case PIXEL_DITHER: encode<PIXEL_DITHER>(pixels, mFrame); break;
+				case PIXEL_SCALE: encode<PIXEL_SCALE>(pixels, mFrame); break;
+				default: encode<PIXEL_DITHER_SCALE>(pixels, mFrame); break;
+			}
+		}
+
+		mWireCycles = (bytes * (8 + XTRA0) * (T1 + T2 + T3)) + (WAIT_TIME * CLKS_PER_US);
+		mTotalWireCycles += mWireCycles;
+		mFrames++;
+		mWait.mark();
+	}
+};
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef __INC_FASTLED_HOST_H
+#define __INC_FASTLED_HOST_H
+
+// Include the host headers
+#include "fastled_delay.h"
+#include "clockless_host.h"
+
+#endif
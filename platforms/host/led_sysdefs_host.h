@@ -0,0 +1,130 @@
+#ifndef __INC_LED_SYSDEFS_HOST_H
+#define __INC_LED_SYSDEFS_HOST_H
+
+///@file led_sysdefs_host.h
+/// Running the library natively on a desktop machine, for profiling and debugging effect code with the host's own
+/// tools (perf, valgrind, sanitizers, a debugger).  Selected by defining FASTLED_HOST, or automatically when
+/// building for x86 outside of the Arduino environment.  The time based functions run off the host's clock, the
+/// pins are plain memory, and clockless controllers record their frames instead of writing them out, see
+/// clockless_host.h.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <thread>
+
+#ifndef FASTLED_HOST
+#define FASTLED_HOST
+#endif
+
+// The clock the cycle estimates in clockless_host.h (and the T1/T2/T3 timings from chipsets.h) are worked out
+// for.  Defaults to that of an esp32, set it to the target's to get that target's numbers.
+#ifndef F_CPU
+#define F_CPU 240000000L
+#endif
+
+#define FASTLED_HAS_MILLIS
+
+#ifndef INTERRUPT_THRESHOLD
+#define INTERRUPT_THRESHOLD 1
+#endif
+
+#ifndef FASTLED_ALLOW_INTERRUPTS
+#define FASTLED_ALLOW_INTERRUPTS 1
+#endif
+
+#if FASTLED_ALLOW_INTERRUPTS == 1
+#define FASTLED_ACCURATE_CLOCK
+#endif
+
+#ifndef FASTLED_USE_PROGMEM
+#define FASTLED_USE_PROGMEM 0
+#endif
+
+// There's nothing to run the *_parallel functions' second half on
+#ifndef FASTLED_PARALLEL
+#define FASTLED_PARALLEL 0
+#endif
+
+// Let controllers generate, reverse, mirror and rotate their led data as it's being written out, give lanes lengths of
+// their own and segments adjustments of their own, and dither spatially, like on the ESP32
+#ifndef FASTLED_PIXEL_GENERATORS
+#define FASTLED_PIXEL_GENERATORS 1
+#endif
+#ifndef FASTLED_OUTPUT_MAPPING
+#define FASTLED_OUTPUT_MAPPING 1
+#endif
+#ifndef FASTLED_LANE_LENGTHS
+#define FASTLED_LANE_LENGTHS 1
+#endif
+#ifndef FASTLED_SEGMENTS
+#define FASTLED_SEGMENTS 1
+#endif
+#ifndef FASTLED_SPATIAL_DITHER
+#define FASTLED_SPATIAL_DITHER 1
+#endif
+
+typedef volatile uint32_t RoReg;
+typedef volatile uint32_t RwReg;
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define cli()
+#define sei()
+#define noInterrupts()
+#define interrupts()
+
+// The pins are bits in a few words of plain memory, so that the pin and software spi code runs unchanged
+#define FASTLED_FORCE_SOFTWARE_PINS
+#define HOST_PIN_PORTS 8
+
+inline volatile uint32_t *hostPortRegister(uint8_t port) {
+	static volatile uint32_t sPorts[HOST_PIN_PORTS];
+	return sPorts + (port % HOST_PIN_PORTS);
+}
+
+#define digitalPinToPort(P) ((uint8_t)((P) / 32))
+#define digitalPinToBitMask(P) ((uint32_t)1 << ((P) % 32))
+#define portOutputRegister(P) hostPortRegister(P)
+#define portInputRegister(P) hostPortRegister(P)
+
+#define INPUT 0
+#define OUTPUT 1
+#define LOW 0
+#define HIGH 1
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t pin, uint8_t val) {
+	if(val) { *portOutputRegister(digitalPinToPort(pin)) |= digitalPinToBitMask(pin); }
+	else { *portOutputRegister(digitalPinToPort(pin)) &= ~digitalPinToBitMask(pin); }
+}
+
+// The time since the program started, off the host's steady clock
+inline std::chrono::steady_clock::time_point hostStartTime() {
+	static const std::chrono::steady_clock::time_point sStart = std::chrono::steady_clock::now();
+	return sStart;
+}
+
+inline uint32_t micros() {
+	return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - hostStartTime()).count();
+}
+
+inline uint32_t millis() {
+	return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - hostStartTime()).count();
+}
+
+inline void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+inline void delayMicroseconds(unsigned int us) {
+	// sleeping is far too coarse for short waits, spin instead
+	uint32_t start = micros();
+	while((micros() - start) < us) {}
+}
+
+inline void yield() { std::this_thread::yield(); }
+
+#endif
@@ -47,14 +47,63 @@ static const uint8_t gMCU_mW  =  25 * 5; // 25mA @ 5v = 125 mW
 static uint8_t  gMaxPowerIndicatorLEDPinNumber = 0; // default = Arduino onboard LED pin.  set to zero to skip this.
 
 
-uint32_t calculate_unscaled_power_mW( const CRGB* ledbuffer, uint16_t numLeds ) //25354
+// the power drawn at brightness = 255 by numLeds leds whose red, green and blue values add up to red32, green32 and blue32
+static uint32_t unscaled_power_mW_for_sums( uint32_t red32, uint32_t green32, uint32_t blue32, uint32_t numLeds)
+{
+    red32   *= gRed_mW;
+    green32 *= gGreen_mW;
+    blue32  *= gBlue_mW;
+
+    red32   >>= 8;
+    green32 >>= 8;
+    blue32  >>= 8;
+
+    return red32 + green32 + blue32 + (gDark_mW * numLeds);
+}
+
+void calculate_channel_sums( const CRGB* ledbuffer, uint16_t numLeds, uint32_t sums[3])
 {
     uint32_t red32 = 0, green32 = 0, blue32 = 0;
-    const CRGB* firstled = &(ledbuffer[0]);
-    uint8_t* p = (uint8_t*)(firstled);
+    const uint8_t* p = (const uint8_t*)(ledbuffer);
 
     uint16_t count = numLeds;
 
+#if !defined(__AVR__) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    // on 32 bit mcus, sum up four leds (three words) at a time, two channels per word in 16 bit lanes.  Only the first
+    // few leds are added up a byte at a time, until p is word aligned.
+    while( count && ((uintptr_t)p & 0x03)) {
+        red32   += *p++;
+        green32 += *p++;
+        blue32  += *p++;
+        count--;
+    }
+
+    // the little endian words of four leds are  r0 g0 b0 r1 | g1 b1 r2 g2 | b2 r3 g3 b3,  so masking out the even and
+    // odd bytes of each leaves the lanes (lo/hi)  rb gr | gr bg | bg rb,  which add up in three accumulators.  Every
+    // lane gets at most 510 per block, so the lanes are emptied into the totals every 128 blocks, before they overflow.
+    typedef uint32_t __attribute__((__may_alias__)) led_word_t;
+    const led_word_t* w = (const led_word_t*)p;
+    while( count >= 4) {
+        uint16_t blocks = count / 4;
+        if( blocks > 128) { blocks = 128; }
+        count -= blocks * 4;
+
+        uint32_t rb = 0, gr = 0, bg = 0;
+        while( blocks--) {
+            uint32_t w0 = w[0], w1 = w[1], w2 = w[2];
+            rb += (w0 & 0x00FF00FF) + ((w2 >> 8) & 0x00FF00FF);
+            gr += ((w0 >> 8) & 0x00FF00FF) + (w1 & 0x00FF00FF);
+            bg += ((w1 >> 8) & 0x00FF00FF) + (w2 & 0x00FF00FF);
+            w += 3;
+        }
+
+        red32   += (rb & 0xFFFF) + (gr >> 16);
+        green32 += (gr & 0xFFFF) + (bg >> 16);
+        blue32  += (bg & 0xFFFF) + (rb >> 16);
+    }
+    p = (const uint8_t*)w;
+#endif
+
     // This loop might benefit from an AVR assembly version -MEK
     while( count) {
         red32   += *p++;
@@ -63,17 +112,25 @@ uint32_t calculate_unscaled_power_mW( const CRGB* ledbuffer, uint16_t numLeds )
         count--;
     }
 
-    red32   *= gRed_mW;
-    green32 *= gGreen_mW;
-    blue32  *= gBlue_mW;
+    sums[0] = red32;
+    sums[1] = green32;
+    sums[2] = blue32;
+}
 
-    red32   >>= 8;
-    green32 >>= 8;
-    blue32  >>= 8;
+uint32_t calculate_power_mW( const uint32_t sums[3], uint16_t numLeds, const CRGB & scale)
+{
+    uint32_t red32   = ((sums[0] * gRed_mW)   >> 8) * scale.r;
+    uint32_t green32 = ((sums[1] * gGreen_mW) >> 8) * scale.g;
+    uint32_t blue32  = ((sums[2] * gBlue_mW)  >> 8) * scale.b;
 
-    uint32_t total = red32 + green32 + blue32 + (gDark_mW * numLeds);
+    return ((red32 + green32 + blue32) >> 8) + (gDark_mW * (uint32_t)numLeds);
+}
 
-    return total;
+uint32_t calculate_unscaled_power_mW( const CRGB* ledbuffer, uint16_t numLeds ) //25354
+{
+    uint32_t sums[3];
+    calculate_channel_sums( ledbuffer, numLeds, sums);
+    return unscaled_power_mW_for_sums( sums[0], sums[1], sums[2], numLeds);
 }
 
 
@@ -103,7 +160,11 @@ uint8_t calculate_max_brightness_for_power_mW( uint8_t target_brightness, uint32
 
     CLEDController *pCur = CLEDController::head();
 	while(pCur) {
-        total_mW += calculate_unscaled_power_mW( pCur->leds(), pCur->size());
+        // the channel sums get reused by FastLED.show, so the leds aren't read again just to measure their power
+        if(pCur->leds()) {
+            const uint32_t *sums = pCur->channelSums();
+            total_mW += unscaled_power_mW_for_sums( sums[0], sums[1], sums[2], pCur->outputSize());
+        }
 		pCur = pCur->next();
 	}
 
@@ -53,6 +53,11 @@ void delay_at_max_brightness_for_power( uint16_t ms);
 
 // Power Control internal helper functions
 
+/// calculate_channel_sums adds up the red, green and blue values of a
+///   set of leds, the measure the power estimates are made from.  The sums
+///   go into sums[0], sums[1] and sums[2].
+void calculate_channel_sums( const CRGB* ledbuffer, uint16_t numLeds, uint32_t sums[3]);
+
 /// calculate_unscaled_power_mW tells you how many milliwatts the current
 ///   LED data would draw at brightness = 255.
 ///
@@ -74,6 +79,13 @@ uint8_t calculate_max_brightness_for_power_mW(const CRGB* ledbuffer, uint16_t nu
 ///   function will be no higher than the target_brightess you supply, but may be lower.
 uint8_t calculate_max_brightness_for_power_vmA(const CRGB* ledbuffer, uint16_t numLeds, uint8_t target_brightness, uint32_t max_power_V, uint32_t max_power_mA);
 
+/// calculate_power_mW tells you how many milliwatts a set of leds would draw
+///   when written out with the given per color scale (e.g. a controller's
+///   adjustment, which carries its brightness, color correction and color
+///   temperature).  It takes the red, green and blue sums made by
+///   calculate_channel_sums.
+uint32_t calculate_power_mW( const uint32_t sums[3], uint16_t numLeds, const CRGB & scale);
+
 /// calculate_max_brightness_for_power_mW tells you the highest brightness
 ///   level you can use and still stay under the specified power budget.  It
 ///   takes a 'target brightness' which is the brightness you'd ideally like
@@ -81,6 +93,46 @@ uint8_t calculate_max_brightness_for_power_vmA(const CRGB* ledbuffer, uint16_t n
 ///   target_brightess you supply, but may be lower.
 uint8_t  calculate_max_brightness_for_power_mW( uint8_t target_brightness, uint32_t max_power_mW);
 
+/// A power supply feeding one or more controllers, with a limit of its own (see
+///   CLEDController::setPowerRail).  On every FastLED.show the power drawn by
+///   all the controllers on a rail is estimated from their leds, color
+///   correction and color temperature, and if it's over the rail's limit just
+///   those controllers get dimmed - each rail is limited on its own, on top of
+///   any global limit set with FastLED.setMaxPowerInMilliWatts.  Controllers
+///   set up with setPrescaled ignore the brightness and so can't be limited.
+class CPowerRail {
+    uint32_t m_nMaxPower_mW;
+    uint32_t m_nDemand_mW;
+
+public:
+    /// create a rail that can supply max_power_mW milliwatts, 0 for no limit
+    CPowerRail(uint32_t max_power_mW = 0) : m_nMaxPower_mW(max_power_mW), m_nDemand_mW(0) {}
+
+    /// Set the maximum power this rail can supply, in milliwatts, 0 for no limit
+    void setMaxPowerInMilliWatts(uint32_t milliwatts) { m_nMaxPower_mW = milliwatts; }
+
+    /// Set the maximum power this rail can supply, in volts and milliamps
+    void setMaxPowerInVoltsAndMilliamps(uint8_t volts, uint32_t milliamps) { m_nMaxPower_mW = volts * milliamps; }
+
+    /// the maximum power this rail can supply, in milliwatts
+    uint32_t getMaxPowerInMilliWatts() const { return m_nMaxPower_mW; }
+
+    /// the power the controllers on this rail asked for in the last frame, before the rail's limit was applied
+    uint32_t getDemandInMilliWatts() const { return m_nDemand_mW; }
+
+    /// start estimating a new frame, called by FastLED.show
+    void resetDemand() { m_nDemand_mW = 0; }
+
+    /// add the power drawn by one controller on this rail at the brightness its demand is measured at
+    void addDemand(uint32_t milliwatts) { m_nDemand_mW += milliwatts; }
+
+    /// the brightness to use on this rail, no higher than brightness (what its demand was measured at)
+    uint8_t limit(uint8_t brightness) const {
+        if(m_nMaxPower_mW == 0 || m_nDemand_mW <= m_nMaxPower_mW) { return brightness; }
+        return ((uint32_t)brightness * m_nMaxPower_mW) / m_nDemand_mW;
+    }
+};
+
 FASTLED_NAMESPACE_END
 ///@}
 // POWER_MGT_H
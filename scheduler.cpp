@@ -0,0 +1,100 @@
+#define FASTLED_INTERNAL
+#include "FastLED.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+// follow the longest recent time: up to a longer one right away, an eighth of the way down to a shorter one
+static uint32_t trackCost(uint32_t cost, uint32_t t) {
+	return (t >= cost) ? t : cost - ((cost - t + 7) >> 3);
+}
+
+void CFrameScheduler::add(CScheduledTask &task) {
+	for(CScheduledTask *p = m_pHead; p; p = p->m_pNext) {
+		if(p == &task) { return; }
+	}
+	task.m_pNext = m_pHead;
+	m_pHead = &task;
+}
+
+void CFrameScheduler::remove(CScheduledTask &task) {
+	for(CScheduledTask **pp = &m_pHead; *pp; pp = &(*pp)->m_pNext) {
+		if(*pp == &task) {
+			*pp = task.m_pNext;
+			task.m_pNext = NULL;
+			return;
+		}
+	}
+}
+
+CScheduledTask *CFrameScheduler::nextTask(uint32_t budget) {
+	CScheduledTask *pBest = NULL;
+	uint32_t bestOverdue = 0;
+	for(CScheduledTask *p = m_pHead; p; p = p->m_pNext) {
+		uint32_t period = p->m_Timer.getPeriod();
+		uint32_t elapsed = p->m_Timer.getElapsed();
+		if(elapsed < period) { continue; }
+		uint32_t overdue = elapsed - period;
+		bool fits = budget && (p->m_nCost <= budget);
+		bool starved = period && (overdue >= period);
+		if((fits || starved) && (pBest == NULL || overdue > bestOverdue)) {
+			pBest = p;
+			bestOverdue = overdue;
+		}
+	}
+	return pBest;
+}
+
+void CFrameScheduler::runTask(CScheduledTask *pTask) {
+	pTask->m_Timer.reset();
+	uint32_t start = micros();
+	pTask->m_pFunc(pTask->m_pArg);
+	pTask->m_nCost = trackCost(pTask->m_nCost, micros() - start);
+}
+
+void CFrameScheduler::run() {
+	m_bRendering = false;
+
+	if(FastLED.getFramePeriod() == 0) {
+		// no deadline to fit the tasks around, so everything that's due gets its turn
+		for(CScheduledTask *p = m_pHead; p; p = p->m_pNext) {
+			if(p->m_Timer.getElapsed() >= p->m_Timer.getPeriod()) { runTask(p); }
+		}
+		FastLED.waitShow();
+	} else {
+		for(;;) {
+			bool showing = FastLED.isShowing();
+			uint32_t remaining = FastLED.timeUntilNextShow();
+			uint32_t need = m_nRenderCost + m_nMargin;
+			uint32_t budget = (remaining > need) ? remaining - need : 0;
+
+			CScheduledTask *pTask = nextTask(budget);
+			if(pTask) {
+				runTask(pTask);
+				continue;
+			}
+			if(budget == 0 && !showing) { break; }
+
+			// nothing to do for now: sleep through whole milliseconds while there's plenty of time, so other tasks
+			// get the cpu under an rtos (a task falling due in the meantime waits for the end of the millisecond)
+#if defined(ARDUINO)
+			if(!showing && budget >= 3000) { ::delay(1); } else { yield(); }
+#endif
+		}
+	}
+
+	m_nRenderStart = micros();
+	m_bRendering = true;
+}
+
+void CFrameScheduler::rendered() {
+	if(!m_bRendering) { return; }
+	m_nRenderCost = trackCost(m_nRenderCost, micros() - m_nRenderStart);
+	m_bRendering = false;
+}
+
+void CFrameScheduler::show() {
+	rendered();
+	FastLED.show();
+}
+
+FASTLED_NAMESPACE_END
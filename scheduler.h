@@ -0,0 +1,118 @@
+#ifndef __INC_SCHEDULER_H
+#define __INC_SCHEDULER_H
+
+#include "FastLED.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+///@file scheduler.h
+/// running background tasks in the time between frames, without making the frames late
+
+///@defgroup Scheduler Frame scheduling
+///@{
+
+/// A function for a CScheduledTask to run
+typedef void (*scheduled_func)(void *pArg);
+
+/// Something for a CFrameScheduler to run every so often - polling inputs, stepping a palette transition, serving
+/// the network.  Its timing is an EVERY_N_MILLISECONDS timer (CEveryNMillis), and the scheduler times every run of
+/// it to know how much of a gap between frames it needs.
+class CScheduledTask {
+	friend class CFrameScheduler;
+
+	scheduled_func m_pFunc;
+	void *m_pArg;
+	CEveryNMillis m_Timer;
+	uint32_t m_nCost;
+	CScheduledTask *m_pNext;
+
+public:
+	/// @param pFunc the function to run
+	/// @param pArg argument handed to the function
+	/// @param periodMs how often to run it, in ms - 0 to run it whenever there's time
+	/// @param costMicros how long a run takes, for the scheduler to go by until it has timed one
+	CScheduledTask(scheduled_func pFunc, void *pArg, uint32_t periodMs, uint32_t costMicros = 0)
+		: m_pFunc(pFunc), m_pArg(pArg), m_Timer(periodMs), m_nCost(costMicros), m_pNext(NULL) {}
+
+	/// set how often to run the task, in ms
+	void setPeriod(uint32_t periodMs) { m_Timer.setPeriod(periodMs); }
+
+	/// have the task run at the next chance, whether its period is up or not
+	void trigger() { m_Timer.trigger(); }
+
+	/// how long a run takes, in µs: the longest recent run, coming down slowly after a long one
+	uint32_t cost() const { return m_nCost; }
+};
+
+/// Runs tasks in the time between frames, leaving enough of it to render the next frame before the max refresh rate
+/// (see CFastLED::setMaxRefreshRate) lets it go out.  Instead of EVERY_N_MILLISECONDS blocks spread around a loop
+/// that renders, shows and waits in show, the loop hands the wait to run:
+///
+///     CFrameScheduler scheduler;
+///     CScheduledTask buttons(pollButtons, NULL, 10);
+///     CScheduledTask fade(stepPalette, NULL, 40);
+///     ...
+///     scheduler.add(buttons);
+///     scheduler.add(fade);
+///     FastLED.setMaxRefreshRate(60);
+///     ...
+///     void loop() {
+///         scheduler.run();
+///         renderFrame();
+///         scheduler.show();
+///     }
+///
+/// run returns when it's time to start rendering: the time until the next frame is due, less how long rendering
+/// takes (timed from the end of run to show or rendered) and a margin, and not before a frame started with
+/// showAsync is all the way out, since the led data can't be touched until then.  Until that time, it runs the due
+/// task that's been waiting longest and fits in what's left of it, or sleeps.  So with time to spare frames start on
+/// time rather than whenever the loop comes around to show, and when there isn't any, the tasks wait; a task longer
+/// than any gap between frames only runs once its period has gone by a second time, late frame or not, so it
+/// doesn't starve.  Without a max refresh rate there's no time to fit to, and run just runs the tasks that are due.
+///
+/// Task and render times follow the longest recent one, coming down an eighth of the way to the latest every time,
+/// so that one slow frame keeps the scheduler careful for a while.
+class CFrameScheduler {
+	CScheduledTask *m_pHead;
+	uint32_t m_nMargin;
+	uint32_t m_nRenderCost;
+	uint32_t m_nRenderStart;
+	bool m_bRendering;
+
+	/// the due task that's been waiting longest and fits in budget µs, or that's missed a whole period
+	CScheduledTask *nextTask(uint32_t budget);
+
+	/// run a task and time it
+	void runTask(CScheduledTask *pTask);
+
+public:
+	/// @param marginMicros time to leave on top of the render time, for show to get started
+	CFrameScheduler(uint32_t marginMicros = 200) : m_pHead(NULL), m_nMargin(marginMicros), m_nRenderCost(0), m_nRenderStart(0), m_bRendering(false) {}
+
+	/// add a task to run.  The task has to stay around until it's removed.
+	void add(CScheduledTask &task);
+
+	/// remove a task
+	void remove(CScheduledTask &task);
+
+	/// set the time to leave on top of the render time, in µs
+	void setMargin(uint32_t marginMicros) { m_nMargin = marginMicros; }
+
+	/// how long rendering takes, in µs (see CScheduledTask::cost)
+	uint32_t renderCost() const { return m_nRenderCost; }
+
+	/// run tasks until it's time to render the next frame
+	void run();
+
+	/// mark the end of rendering, for loops that go on to call FastLED.showAsync (or show more than once)
+	void rendered();
+
+	/// mark the end of rendering and show the frame
+	void show();
+};
+
+///@}
+
+FASTLED_NAMESPACE_END
+
+#endif
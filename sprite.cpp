@@ -0,0 +1,171 @@
+#define FASTLED_INTERNAL
+#include "FastLED.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+// The part of a bitmap at (x,y) that's on a width x height matrix: bitmap column sx and row sy land on matrix column
+// dx and row dy, for w columns and h rows.  False if none of it is on the matrix.
+struct CBlitClip {
+	uint16_t sx, sy, dx, dy, w, h;
+
+	bool clip(int16_t x, int16_t y, uint16_t bitmapWidth, uint16_t bitmapHeight, uint16_t width, uint16_t height) {
+		int32_t x0 = x, y0 = y;
+		int32_t x1 = x0 + bitmapWidth, y1 = y0 + bitmapHeight;
+		if(x0 < 0) { x0 = 0; }
+		if(y0 < 0) { y0 = 0; }
+		if(x1 > width) { x1 = width; }
+		if(y1 > height) { y1 = height; }
+		if(x0 >= x1 || y0 >= y1) { return false; }
+		sx = x0 - x; sy = y0 - y;
+		dx = x0; dy = y0;
+		w = x1 - x0; h = y1 - y0;
+		return true;
+	}
+};
+
+// The destinations: a led of a row, and a whole run of a row at once
+struct CBlitLayout {
+	CRGB *leds;
+	uint16_t width;
+	TXYLayout layout;
+
+	bool reversed(uint16_t y) const { return (layout == XY_SERPENTINE) && (y & 0x01); }
+
+	CRGB &at(uint16_t x, uint16_t y) const {
+		return leds[(y * width) + (reversed(y) ? (width - 1 - x) : x)];
+	}
+
+	void copy(uint16_t x, uint16_t y, const CRGB *pSrc, uint16_t count) const {
+		if(!reversed(y)) {
+			memcpy8((void*)(leds + (y * width) + x), (const void*)pSrc, count * sizeof(CRGB));
+		} else {
+			// odd serpentine rows run right to left
+			CRGB *pDst = leds + (y * width) + (width - 1 - x);
+			for(uint16_t i = 0; i < count; i++) { *pDst-- = pSrc[i]; }
+		}
+	}
+};
+
+struct CBlitMap {
+	CRGB *leds;
+	const XYMap *map;
+
+	CRGB &at(uint16_t x, uint16_t y) const { return leds[map->row(y)[x]]; }
+
+	void copy(uint16_t x, uint16_t y, const CRGB *pSrc, uint16_t count) const {
+		const uint16_t *pIndex = map->row(y) + x;
+		for(uint16_t i = 0; i < count; i++) { leds[pIndex[i]] = pSrc[i]; }
+	}
+};
+
+// Put a run of pixels onto row y from column x on.  With a transparent color or index, a pixel is left out where
+// skip(i) says so.
+template<class DEST, class SKIP>
+static void blitRun(const DEST &dest, uint16_t x, uint16_t y, const CRGB *pSrc, uint16_t count, const SKIP &skip, bool keyed,
+                    fract8 alpha) {
+	if(alpha == 255 && !keyed) {
+		dest.copy(x, y, pSrc, count);
+		return;
+	}
+	for(uint16_t i = 0; i < count; i++) {
+		if(keyed && skip(i)) { continue; }
+		CRGB &led = dest.at(x + i, y);
+		if(alpha == 255) {
+			led = pSrc[i];
+		} else {
+			nblend(led, pSrc[i], alpha);
+		}
+	}
+}
+
+// the transparency tests of the two kinds of bitmaps
+struct CColorKey {
+	const CRGB *pSrc;
+	CRGB key;
+	bool operator()(uint16_t i) const { return pSrc[i] == key; }
+};
+
+struct CIndexKey {
+	const uint8_t *pIndices;
+	uint8_t key;
+	bool operator()(uint16_t i) const { return pIndices[i] == key; }
+};
+
+template<class DEST>
+static void blitBitmap(const DEST &dest, uint16_t width, uint16_t height, int16_t x, int16_t y, const CRGBBitmap &bitmap,
+                       fract8 alpha) {
+	CBlitClip c;
+	if(alpha == 0 || !c.clip(x, y, bitmap.width(), bitmap.height(), width, height)) { return; }
+
+	// flash has to be read a byte at a time where it isn't in the address space, a tile of the row at a time
+	bool fetch = FASTLED_USE_PROGMEM && bitmap.progmem();
+	uint16_t tile = fetch ? FASTLED_BLIT_TILE : c.w;
+	CRGB row[FASTLED_BLIT_TILE];
+	for(uint16_t j = 0; j < c.h; j++) {
+		const uint8_t *pLine = bitmap.data() + ((((uint32_t)(c.sy + j) * bitmap.width()) + c.sx) * 3);
+		for(uint32_t start = 0; start < c.w; start += tile) {
+			uint16_t n = c.w - start;
+			if(n > tile) { n = tile; }
+			const uint8_t *pData = pLine + ((uint32_t)start * 3);
+			const CRGB *pSrc = (const CRGB*)pData;
+			if(fetch) {
+				uint8_t *pRow = row->raw;
+				for(uint16_t i = 0; i < n * 3; i++) { pRow[i] = FL_PGM_READ_BYTE_NEAR(pData + i); }
+				pSrc = row;
+			}
+			CColorKey skip = { pSrc, bitmap.key() };
+			blitRun(dest, c.dx + start, c.dy + j, pSrc, n, skip, bitmap.keyed(), alpha);
+		}
+	}
+}
+
+template<class DEST>
+static void blitBitmap(const DEST &dest, uint16_t width, uint16_t height, int16_t x, int16_t y, const CIndexBitmap &bitmap,
+                       const CRGB *pPalette, fract8 alpha) {
+	CBlitClip c;
+	if(alpha == 0 || !c.clip(x, y, bitmap.width(), bitmap.height(), width, height)) { return; }
+
+	bool fetch = FASTLED_USE_PROGMEM && bitmap.progmem();
+	CRGB row[FASTLED_BLIT_TILE];
+	uint8_t indices[FASTLED_BLIT_TILE];
+	for(uint16_t j = 0; j < c.h; j++) {
+		const uint8_t *pLine = bitmap.data() + ((uint32_t)(c.sy + j) * bitmap.width()) + c.sx;
+		for(uint32_t start = 0; start < c.w; start += FASTLED_BLIT_TILE) {
+			uint16_t n = c.w - start;
+			if(n > FASTLED_BLIT_TILE) { n = FASTLED_BLIT_TILE; }
+			const uint8_t *pIndices = pLine + start;
+			if(fetch) {
+				for(uint16_t i = 0; i < n; i++) { indices[i] = FL_PGM_READ_BYTE_NEAR(pIndices + i); }
+				pIndices = indices;
+			}
+			for(uint16_t i = 0; i < n; i++) { row[i] = pPalette[pIndices[i]]; }
+			CIndexKey skip = { pIndices, bitmap.key() };
+			blitRun(dest, c.dx + start, c.dy + j, row, n, skip, bitmap.keyed(), alpha);
+		}
+	}
+}
+
+void blit(CRGB *leds, const XYMap &map, int16_t x, int16_t y, const CRGBBitmap &bitmap, fract8 alpha) {
+	CBlitMap dest = { leds, &map };
+	blitBitmap(dest, map.width(), map.height(), x, y, bitmap, alpha);
+}
+
+void blit(CRGB *leds, uint16_t width, uint16_t height, TXYLayout layout, int16_t x, int16_t y, const CRGBBitmap &bitmap,
+          fract8 alpha) {
+	CBlitLayout dest = { leds, width, layout };
+	blitBitmap(dest, width, height, x, y, bitmap, alpha);
+}
+
+void blit(CRGB *leds, const XYMap &map, int16_t x, int16_t y, const CIndexBitmap &bitmap, const CRGB *pPalette,
+          fract8 alpha) {
+	CBlitMap dest = { leds, &map };
+	blitBitmap(dest, map.width(), map.height(), x, y, bitmap, pPalette, alpha);
+}
+
+void blit(CRGB *leds, uint16_t width, uint16_t height, TXYLayout layout, int16_t x, int16_t y, const CIndexBitmap &bitmap,
+          const CRGB *pPalette, fract8 alpha) {
+	CBlitLayout dest = { leds, width, layout };
+	blitBitmap(dest, width, height, x, y, bitmap, pPalette, alpha);
+}
+
+FASTLED_NAMESPACE_END
@@ -0,0 +1,108 @@
+#ifndef __INC_SPRITE_H
+#define __INC_SPRITE_H
+
+#include "FastLED.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+///@file sprite.h
+/// drawing bitmaps - icons, fonts, sprites - onto a matrix
+
+///@defgroup Sprites Bitmaps and blitting
+///@{
+
+/// A width x height bitmap of colors, row after row, in ram or in flash.  If the bitmap has a transparent color, the
+/// pixels of that color are left out when it's drawn.
+class CRGBBitmap {
+	const uint8_t *m_pData;
+	uint16_t m_nWidth;
+	uint16_t m_nHeight;
+	bool m_bProgmem;
+	bool m_bKeyed;
+	CRGB m_Key;
+
+public:
+	/// a bitmap over an array of CRGBs in ram
+	CRGBBitmap(const CRGB *pPixels, uint16_t width, uint16_t height)
+		: m_pData(pPixels->raw), m_nWidth(width), m_nHeight(height), m_bProgmem(false), m_bKeyed(false) {}
+
+	/// a bitmap over r, g and b bytes, three per pixel - the way a CRGB array is laid out
+	/// @param inProgmem whether the bytes are an FL_PROGMEM array
+	CRGBBitmap(const uint8_t *pRGB, uint16_t width, uint16_t height, bool inProgmem)
+		: m_pData(pRGB), m_nWidth(width), m_nHeight(height), m_bProgmem(inProgmem), m_bKeyed(false) {}
+
+	/// leave the pixels of a color out when the bitmap is drawn
+	CRGBBitmap &setTransparent(const CRGB &key) { m_Key = key; m_bKeyed = true; return *this; }
+	/// draw all of the pixels again
+	CRGBBitmap &clearTransparent() { m_bKeyed = false; return *this; }
+
+	uint16_t width() const { return m_nWidth; }
+	uint16_t height() const { return m_nHeight; }
+	const uint8_t *data() const { return m_pData; }
+	bool progmem() const { return m_bProgmem; }
+	bool keyed() const { return m_bKeyed; }
+	const CRGB &key() const { return m_Key; }
+};
+
+/// A width x height bitmap of palette indices, a byte per pixel, row after row, in ram or in flash.  If the bitmap
+/// has a transparent index, the pixels with that index are left out when it's drawn.
+class CIndexBitmap {
+	const uint8_t *m_pIndices;
+	uint16_t m_nWidth;
+	uint16_t m_nHeight;
+	bool m_bProgmem;
+	bool m_bKeyed;
+	uint8_t m_nKey;
+
+public:
+	/// @param inProgmem whether the indices are an FL_PROGMEM array
+	CIndexBitmap(const uint8_t *pIndices, uint16_t width, uint16_t height, bool inProgmem = false)
+		: m_pIndices(pIndices), m_nWidth(width), m_nHeight(height), m_bProgmem(inProgmem), m_bKeyed(false), m_nKey(0) {}
+
+	/// leave the pixels with an index out when the bitmap is drawn
+	CIndexBitmap &setTransparent(uint8_t index) { m_nKey = index; m_bKeyed = true; return *this; }
+	/// draw all of the pixels again
+	CIndexBitmap &clearTransparent() { m_bKeyed = false; return *this; }
+
+	uint16_t width() const { return m_nWidth; }
+	uint16_t height() const { return m_nHeight; }
+	const uint8_t *data() const { return m_pIndices; }
+	bool progmem() const { return m_bProgmem; }
+	bool keyed() const { return m_bKeyed; }
+	uint8_t key() const { return m_nKey; }
+};
+
+#ifndef FASTLED_BLIT_TILE
+#if defined(__AVR__)
+#define FASTLED_BLIT_TILE 16
+#else
+#define FASTLED_BLIT_TILE 64
+#endif
+#endif
+
+/// Draw a bitmap onto a matrix with its top left corner at (x,y), which may be off the matrix - the parts of the
+/// bitmap that are off it get clipped.  At an alpha of 255 the bitmap's pixels replace the leds, below that they're
+/// blended over them (see nblend).  A row of a bitmap is fetched from flash (or looked up in the palette) once,
+/// FASTLED_BLIT_TILE pixels at a time into a buffer on the stack, and then written out.
+///
+/// The layout versions walk the led memory directly: an opaque bitmap without a transparent color goes onto a
+/// row-major matrix (and the even rows of a serpentine one) a memcpy per row.  The XYMap versions cover rotated and
+/// arbitrary layouts.
+///@{
+void blit(CRGB *leds, const XYMap &map, int16_t x, int16_t y, const CRGBBitmap &bitmap, fract8 alpha = 255);
+void blit(CRGB *leds, uint16_t width, uint16_t height, TXYLayout layout, int16_t x, int16_t y, const CRGBBitmap &bitmap,
+          fract8 alpha = 255);
+
+/// @param pPalette the colors of the indices, e.g. a CRGBPalette16's or CRGBPalette256's entries - as many of them
+/// as the bitmap uses
+void blit(CRGB *leds, const XYMap &map, int16_t x, int16_t y, const CIndexBitmap &bitmap, const CRGB *pPalette,
+          fract8 alpha = 255);
+void blit(CRGB *leds, uint16_t width, uint16_t height, TXYLayout layout, int16_t x, int16_t y, const CIndexBitmap &bitmap,
+          const CRGB *pPalette, fract8 alpha = 255);
+///@}
+
+///@}
+
+FASTLED_NAMESPACE_END
+
+#endif
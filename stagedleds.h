@@ -0,0 +1,111 @@
+#ifndef __INC_STAGEDLEDS_H
+#define __INC_STAGEDLEDS_H
+
+///@file stagedleds.h
+/// led data kept in external ram (e.g. the ESP32's PSRAM), copied into internal ram a tile at a time on the way out
+
+#include "led_sysdefs.h"
+#include "pixeltypes.h"
+#include "controller.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+#ifndef FASTLED_STAGED_LEDS_MALLOC
+#define FASTLED_STAGED_LEDS_MALLOC(len) malloc(len)
+#endif
+#ifndef FASTLED_STAGED_TILE_MALLOC
+#define FASTLED_STAGED_TILE_MALLOC(len) malloc(len)
+#endif
+#ifndef FASTLED_STAGED_FREE
+#define FASTLED_STAGED_FREE(ptr) free(ptr)
+#endif
+
+/// A CRGB array in memory that's too slow to read from in the middle of writing leds out - external ram, where a cache
+/// miss can stall the encoder long enough to break the bit timings.  Effects draw into it like any led array, and the
+/// controller (see CLEDController::setLeds(CStagedLeds&)) copies it into a small tile in internal ram a chunk at a time
+/// as it goes, so the encoder only ever reads internal ram.  The copies happen where the controller refills its
+/// output: with the ESP32's RMT and I2S output that's in their buffer refill interrupts, with time to spare, so a
+/// tile of 16-64 leds keeps the output fed.  The bit-banged outputs copy in between pixels, where a slow copy can run
+/// into the retry limits - use the others for big external ram frames.
+///
+/// The leds are read while the frame goes out, the same as a CRGB array without double buffering.  Staged leds get
+/// attached as a generator, with what that means for power management and setSkipUnchanged (see
+/// CLEDController::setGenerator).  CStagedLedBuffer allocates its own storage.
+class CStagedLeds {
+protected:
+	CRGB *m_pLeds;
+	int m_nLeds;
+	CRGB *m_pTile;
+	uint16_t m_nTileLeds;
+
+public:
+	/// stage led data from caller provided storage
+	/// @param pLeds the leds, nLeds of them (at most 65535), wherever they are
+	/// @param nLeds the number of leds
+	/// @param pTile storage in internal ram for the leds being written out, a few at a time
+	/// @param nTileLeds the size of the tile, in leds
+	CStagedLeds(CRGB *pLeds, int nLeds, CRGB *pTile, uint16_t nTileLeds) : m_pLeds(pLeds), m_nLeds(nLeds), m_pTile(pTile), m_nTileLeds(nTileLeds) {}
+
+	/// the number of leds
+	int size() const { return m_nLeds; }
+
+	/// the leds - what effects draw into
+	CRGB *leds() { return m_pLeds; }
+
+	/// a led
+	CRGB & operator[](int n) { return m_pLeds[n]; }
+
+	/// the tile the leds are copied into on the way out, and its size
+	CRGB *tile() { return m_pTile; }
+	uint16_t tileSize() const { return m_nTileLeds; }
+
+	/// copy count leds from start on into pLeds, a TPixelGenerator over a CStagedLeds.  It runs wherever the output
+	/// refills do, see FASTLED_IRAM.
+	static FASTLED_IRAM void stage(void *pArg, CRGB *pLeds, uint16_t start, uint16_t count) {
+		memcpy((void*)pLeds, (const void*)(((CStagedLeds*)pArg)->m_pLeds + start), count * sizeof(CRGB));
+	}
+};
+
+/// CStagedLeds that allocate their own storage: the leds with FASTLED_STAGED_LEDS_MALLOC (on the ESP32, in PSRAM),
+/// falling back to malloc when that fails, and the tile with FASTLED_STAGED_TILE_MALLOC (internal ram).  Check that
+/// leds() isn't NULL before use.
+class CStagedLedBuffer : public CStagedLeds {
+	static CRGB *allocateLeds(int nLeds) {
+		CRGB *p = (CRGB*)FASTLED_STAGED_LEDS_MALLOC(nLeds * sizeof(CRGB));
+		if(p == NULL) { p = (CRGB*)malloc(nLeds * sizeof(CRGB)); }
+		if(p != NULL) { memset((void*)p, 0, nLeds * sizeof(CRGB)); }
+		return p;
+	}
+
+	// not copyable, the buffers are owned
+	CStagedLedBuffer(const CStagedLedBuffer &);
+	CStagedLedBuffer & operator=(const CStagedLedBuffer &);
+
+public:
+	/// allocate the leds and the tile
+	/// @param nLeds the number of leds
+	/// @param nTileLeds the size of the tile, in leds - multi lane controllers split it between their lanes
+	CStagedLedBuffer(int nLeds, uint16_t nTileLeds = 32) : CStagedLeds(allocateLeds(nLeds), nLeds, (CRGB*)FASTLED_STAGED_TILE_MALLOC(nTileLeds * sizeof(CRGB)), nTileLeds) {
+		if(m_pLeds == NULL || m_pTile == NULL) {
+			if(m_pLeds != NULL) { FASTLED_STAGED_FREE(m_pLeds); m_pLeds = NULL; }
+			if(m_pTile != NULL) { FASTLED_STAGED_FREE(m_pTile); m_pTile = NULL; }
+			m_nLeds = 0;
+			m_nTileLeds = 0;
+		}
+	}
+
+	~CStagedLedBuffer() {
+		if(m_pLeds != NULL) { FASTLED_STAGED_FREE(m_pLeds); }
+		if(m_pTile != NULL) { FASTLED_STAGED_FREE(m_pTile); }
+	}
+};
+
+#if (FASTLED_PIXEL_GENERATORS == 1)
+inline CLEDController & CLEDController::setLeds(CStagedLeds & leds) {
+	return setGenerator(&CStagedLeds::stage, (void*)&leds, leds.size(), leds.tile(), leds.tileSize());
+}
+#endif
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -0,0 +1,56 @@
+#define FASTLED_INTERNAL
+#include "FastLED.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+CSharedClock FastLEDClock;
+
+#if (FASTLED_SHARED_TIMEBASE == 1)
+uint32_t shared_millis() { return FastLEDClock.millis(); }
+#endif
+
+// Move an offset toward a sample of it: a sample with less delay in it than the offset (a later master time) is
+// taken right away, one with more is only slewed to, unless it's far enough off that the master's clock has changed.
+// The slew moves at least one unit, so the millis offset still gets there once it's within 8ms.
+static uint32_t trackOffset(uint32_t offset, uint32_t sample, int32_t reset) {
+	int32_t d = (int32_t)(sample - offset);
+	if(d >= 0 || d < -reset) { return sample; }
+	int32_t step = d / 8;
+	return offset + (step ? step : -1);
+}
+
+void CSharedClock::sync(uint32_t masterMillis, uint32_t masterMicros, uint32_t latencyMicros) {
+	uint32_t localMicros = ::micros();
+	uint32_t localMillis = ::millis();
+	uint32_t microsSample = masterMicros + latencyMicros - localMicros;
+	uint32_t millisSample = masterMillis + ((latencyMicros + 500) / 1000) - localMillis;
+	if(!m_bSynced) {
+		m_nMicrosOffset = microsSample;
+		m_nMillisOffset = millisSample;
+		m_bSynced = true;
+	} else {
+		m_nMicrosOffset = trackOffset(m_nMicrosOffset, microsSample, SYNC_RESET_MICROS);
+		m_nMillisOffset = trackOffset(m_nMillisOffset, millisSample, SYNC_RESET_MICROS / 1000);
+	}
+}
+
+uint32_t CSharedClock::showAt(uint32_t atMicros) {
+	uint32_t remaining;
+	while((remaining = until(atMicros)) > 0) {
+#if defined(ARDUINO)
+		// whole milliseconds can oversleep by a tick, so the last one and a bit is spun through
+		if(remaining >= 2000) { ::delay((remaining / 1000) - 1); }
+#endif
+	}
+	uint32_t late = micros() - atMicros;
+	FastLED.showAsync();
+	return late;
+}
+
+bool CSharedClock::tryShowAt(uint32_t atMicros) {
+	if(until(atMicros)) { return false; }
+	FastLED.showAsync();
+	return true;
+}
+
+FASTLED_NAMESPACE_END
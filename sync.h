@@ -0,0 +1,102 @@
+#ifndef __INC_SYNC_H
+#define __INC_SYNC_H
+
+#include "FastLED.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+///@file sync.h
+/// a timebase shared by the nodes of a distributed installation, and showing frames at a time on it
+
+///@defgroup Sync Multi-node synchronisation
+///@{
+
+/// A clock that runs the same on every node of an installation: the local millis and micros, plus the offsets to
+/// a master's.  The master sends its clock's time out every so often, over whatever the nodes share - udp
+/// broadcast, ESP-NOW, a serial bus - and every node feeds what it receives to sync.  The transport is up to the
+/// sketch; all the clock needs is the two times the master sent and, if it's known, how long the message takes.
+///
+/// Messages only ever get held up on the way, so the sample with the least delay is the best one: the offset jumps
+/// to a sample that puts the master's clock later than it had it, and only comes down to one that puts it earlier
+/// an eighth of the way at a time (or straight away if it's more than SYNC_RESET_MICROS off, e.g. when the master
+/// has restarted).  A message every few hundred ms keeps crystal drift well under a millisecond.
+///
+/// With FASTLED_SHARED_TIMEBASE set to 1 the beat generators and EVERY_N timers read the clock's millis, so
+/// beatsin16 and friends agree across the nodes.  showAt starts frames at a time on the clock, so every node latches
+/// the same frame together:
+///
+///     // master, every 250ms
+///     uint32_t msg[2] = { FastLEDClock.millis(), FastLEDClock.micros() };
+///     udp.broadcast(msg, sizeof(msg));
+///
+///     // node
+///     void onPacket(const uint32_t *msg) { FastLEDClock.sync(msg[0], msg[1], 300); }
+///     void loop() {
+///         renderFrame();
+///         FastLEDClock.showAt(nextFrame);   // nextFrame from the master, or a multiple of the frame period
+///     }
+class CSharedClock {
+	uint32_t m_nMillisOffset;
+	uint32_t m_nMicrosOffset;
+	bool m_bSynced;
+
+public:
+	CSharedClock() : m_nMillisOffset(0), m_nMicrosOffset(0), m_bSynced(false) {}
+
+	/// the shared clock's time, in ms
+	uint32_t millis() const { return ::millis() + m_nMillisOffset; }
+
+	/// the shared clock's time, in µs.  It wraps around every 71 minutes, like micros.
+	uint32_t micros() const { return ::micros() + m_nMicrosOffset; }
+
+	/// take in the master's time: what its clock read when it sent the message
+	/// @param masterMillis the master's FastLEDClock.millis()
+	/// @param masterMicros the master's FastLEDClock.micros()
+	/// @param latencyMicros how long a message takes from the master's clock being read to the call to sync, at
+	/// the least - 0 if it isn't known, which leaves every node that much behind the master (but in step with each
+	/// other, given the same transport)
+	void sync(uint32_t masterMillis, uint32_t masterMicros, uint32_t latencyMicros = 0);
+
+	/// have the clock go back to the local time until it's synced again
+	void reset() { m_nMillisOffset = 0; m_nMicrosOffset = 0; m_bSynced = false; }
+
+	/// whether sync has been called since the clock was made or reset
+	bool synced() const { return m_bSynced; }
+
+	/// the shared clock's time less the local one, in µs
+	int32_t offset() const { return m_nMicrosOffset; }
+
+	/// how long until the shared clock gets to a time, in µs - 0 if it's there already.  Times up to half the wrap
+	/// around (35 minutes) ahead count as in the future, the rest as in the past.
+	uint32_t until(uint32_t atMicros) const {
+		int32_t d = (int32_t)(atMicros - micros());
+		return (d > 0) ? d : 0;
+	}
+
+	/// wait until the shared clock gets to a time, then start the frame going out with FastLED.showAsync.  The
+	/// wait sleeps through whole milliseconds, handing the cpu to other tasks, and spins for the last one.  The
+	/// frame goes out through the max refresh rate (see CFastLED::setMaxRefreshRate), so that should let frames
+	/// through at least as fast as they get scheduled.
+	/// @param atMicros when to start the frame, on micros
+	/// @returns how late the frame was started, in µs - more than 0 if the time had already gone by
+	uint32_t showAt(uint32_t atMicros);
+
+	/// start the frame with FastLED.showAsync if the shared clock has got to a time, otherwise don't wait at all -
+	/// for loops that poll, see CFastLED::tryShow
+	/// @returns true if the frame was started
+	bool tryShowAt(uint32_t atMicros);
+};
+
+/// a sample more than this many µs earlier than the clock has the master isn't slewed to, the clock jumps to it
+#ifndef SYNC_RESET_MICROS
+#define SYNC_RESET_MICROS 50000
+#endif
+
+/// the clock shared by the nodes
+extern CSharedClock FastLEDClock;
+
+///@}
+
+FASTLED_NAMESPACE_END
+
+#endif
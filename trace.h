@@ -0,0 +1,150 @@
+#ifndef __INC_TRACE_H
+#define __INC_TRACE_H
+
+#include "led_sysdefs.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+///@file trace.h
+/// cycle stamped events from inside show, for timelines of where a frame's time goes
+
+///@defgroup Trace Event tracing
+///@{
+
+/// What happened, see TraceEvent
+enum ETraceEvent {
+	TRACE_SHOW_BEGIN = 0,		///< a frame's show started, before the max refresh rate wait - arg is the show groups
+	TRACE_THROTTLE_END = 1,		///< the max refresh rate let the frame through
+	TRACE_POWER_BEGIN = 2,		///< the power limit calculation for the frame started
+	TRACE_POWER_END = 3,		///< and finished - arg is the brightness it came to
+	TRACE_CONTROLLER_BEGIN = 4,	///< a controller started encoding and writing out its leds - arg is its index
+	TRACE_CONTROLLER_END = 5,	///< and returned, its frame either all out or going out in the background
+	TRACE_WIRE_END = 6,			///< a frame going out in the background was found to be out - arg is the controller
+	TRACE_RETRY = 7,			///< an interrupt ran too long in the middle of a frame, which is being started over -
+								///< arg is how many more retries there are.  Traced with interrupts off.
+	TRACE_SHOW_END = 8,			///< every controller's been started on the frame
+	TRACE_WAIT_BEGIN = 9,		///< waiting for the frames going out in the background
+	TRACE_WAIT_END = 10,		///< and they're all out
+	TRACE_USER = 16				///< and up: the sketch's own events, see traceEvent
+};
+
+/// A trace point: what happened, and when, on the same cycle counter the controller stats use
+struct TraceEvent {
+	uint32_t cycles;	///< the cycle count when it happened - micros() * (F_CPU / 1000000) where there's no counter
+	uint8_t event;		///< what happened, an ETraceEvent
+	uint8_t reserved;
+	uint16_t arg;		///< the event's detail
+};
+
+/// A function that gets the trace events, see setTrace.  It's called right from inside show (and, for TRACE_RETRY,
+/// with interrupts off), so it has to be quick - copy the event somewhere, like CTraceRing::record does.
+typedef void (*trace_func)(const TraceEvent & event, void *pArg);
+
+#if (FASTLED_TRACE == 1)
+extern trace_func fastled_trace_func;
+extern void *fastled_trace_arg;
+void fastled_trace(uint8_t event, uint16_t arg);
+
+/// trace an event, if there's anything to send it to.  Compiles out to nothing without FASTLED_TRACE.
+#define FASTLED_TRACE_EVENT(EVENT, ARG) do { if(fastled_trace_func) { fastled_trace((EVENT), (ARG)); } } while(0)
+#else
+#define FASTLED_TRACE_EVENT(EVENT, ARG) do {} while(0)
+#endif
+
+/// send the trace events to a function, NULL to stop tracing.  Without FASTLED_TRACE set to 1 there are no events.
+#if (FASTLED_TRACE == 1)
+inline void setTrace(trace_func pFunc, void *pArg = NULL) {
+	fastled_trace_func = NULL;
+	fastled_trace_arg = pArg;
+	fastled_trace_func = pFunc;
+}
+#else
+inline void setTrace(trace_func, void * = NULL) {}
+#endif
+
+/// trace one of the sketch's own events, TRACE_USER and up, e.g. around wifi or other tasks' work, to line them up
+/// with the frames
+#if (FASTLED_TRACE == 1)
+inline void traceEvent(uint8_t event, uint16_t arg = 0) { FASTLED_TRACE_EVENT(event, arg); }
+#else
+inline void traceEvent(uint8_t, uint16_t = 0) {}
+#endif
+
+/// The last few trace events, in caller provided storage.  When it's full the oldest events make room for the new
+/// ones.  Hand it to setTrace with CTraceRing::record, and read it back in between frames:
+///
+///     CTraceBuffer<64> trace;
+///     setTrace(CTraceRing::record, &trace);
+///     ...
+///     TraceEvent e;
+///     while(trace.pop(e)) { Serial.printf("%u %u %u\n", e.cycles, e.event, e.arg); }
+///
+/// Events go in from wherever show runs, so reading them back from anywhere else (another core, or a show task - see
+/// FASTLED_ESP32_SHOW_TASK) has to wait for the frame to be out, see CFastLED::waitShow.
+class CTraceRing {
+	TraceEvent *m_pEvents;
+	uint16_t m_nCapacity;
+	uint16_t m_nHead;
+	uint16_t m_nCount;
+	uint32_t m_nDropped;
+
+public:
+	/// @param pEvents storage for the events
+	/// @param capacity how many events fit in it
+	CTraceRing(TraceEvent *pEvents, uint16_t capacity) : m_pEvents(pEvents), m_nCapacity(capacity), m_nHead(0), m_nCount(0), m_nDropped(0) {}
+
+	/// add an event
+	void add(const TraceEvent & event) {
+		if(m_nCapacity == 0) { return; }
+		uint16_t tail = m_nHead + m_nCount;
+		if(tail >= m_nCapacity) { tail -= m_nCapacity; }
+		m_pEvents[tail] = event;
+		if(m_nCount < m_nCapacity) {
+			m_nCount++;
+		} else {
+			if(++m_nHead == m_nCapacity) { m_nHead = 0; }
+			m_nDropped++;
+		}
+	}
+
+	/// take the oldest event out
+	/// @returns false if there aren't any
+	bool pop(TraceEvent & event) {
+		if(m_nCount == 0) { return false; }
+		event = m_pEvents[m_nHead];
+		if(++m_nHead == m_nCapacity) { m_nHead = 0; }
+		m_nCount--;
+		return true;
+	}
+
+	/// the events in it
+	uint16_t size() const { return m_nCount; }
+
+	/// the nth oldest event in it
+	const TraceEvent & operator[](uint16_t n) const {
+		uint16_t i = m_nHead + n;
+		return m_pEvents[(i >= m_nCapacity) ? (i - m_nCapacity) : i];
+	}
+
+	/// how many events have been pushed out to make room for newer ones
+	uint32_t dropped() const { return m_nDropped; }
+
+	/// empty it out
+	void clear() { m_nHead = 0; m_nCount = 0; m_nDropped = 0; }
+
+	/// a trace_func that adds the events to the CTraceRing pArg
+	static void record(const TraceEvent & event, void *pArg) { ((CTraceRing*)pArg)->add(event); }
+};
+
+/// A CTraceRing with its own storage for CAPACITY events
+template<uint16_t CAPACITY> class CTraceBuffer : public CTraceRing {
+	TraceEvent m_Events[CAPACITY];
+public:
+	CTraceBuffer() : CTraceRing(m_Events, CAPACITY) {}
+};
+
+///@}
+
+FASTLED_NAMESPACE_END
+
+#endif
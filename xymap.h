@@ -0,0 +1,100 @@
+#ifndef __INC_XYMAP_H
+#define __INC_XYMAP_H
+
+///@file xymap.h
+/// a description of how the leds of a 2D matrix are laid out in the led array, for the 2D functions in colorutils
+/// and noise
+
+#include "led_sysdefs.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+///@defgroup XYMap Matrix layouts
+///@{
+
+/// How the rows of a matrix are laid out in the led array
+///   XY_ROW_MAJOR  - every row runs left to right, row after row
+///   XY_SERPENTINE - even rows run left to right, odd rows right to left
+typedef enum { XY_ROW_MAJOR=0, XY_SERPENTINE=1 } TXYLayout;
+
+/// The quarter turns (clockwise) between the way a matrix is wired up and the way it's drawn on
+typedef enum { XY_ROTATE_0=0, XY_ROTATE_90=1, XY_ROTATE_180=2, XY_ROTATE_270=3 } TXYRotation;
+
+/// Maps the x/y coordinates of a matrix to led indices through a precomputed table, so a lookup is a single table
+/// read no matter how the matrix is wired.  The table is either filled in from a layout and rotation, or supplied
+/// by the sketch for arbitrary layouts.  Widths and heights aren't limited to 255.
+///
+/// The table needs width * height uint16_t entries, see CXYMap for a map that carries its own.
+class XYMap {
+	uint16_t m_nWidth;
+	uint16_t m_nHeight;
+	const uint16_t *m_pTable;
+
+public:
+	/// create a map over a table supplied by the sketch, entry y * width + x holding the led index of (x,y)
+	XYMap(uint16_t width, uint16_t height, const uint16_t *pTable) : m_nWidth(width), m_nHeight(height), m_pTable(pTable) {}
+
+	/// create a map by filling in caller provided storage from a layout
+	/// @param width, height the size of the matrix as it's drawn on, i.e. after rotation
+	/// @param pTable storage for width * height entries
+	/// @param layout how the rows of the matrix are wired
+	/// @param rotation how the matrix is turned, relative to its wiring
+	XYMap(uint16_t width, uint16_t height, uint16_t *pTable, TXYLayout layout, TXYRotation rotation = XY_ROTATE_0)
+		: m_nWidth(width), m_nHeight(height), m_pTable(pTable) {
+		fill(pTable, layout, rotation);
+	}
+
+	/// the width of the matrix
+	uint16_t width() const { return m_nWidth; }
+	/// the height of the matrix
+	uint16_t height() const { return m_nHeight; }
+	/// the number of leds in the matrix
+	uint16_t size() const { return m_nWidth * m_nHeight; }
+
+	/// the table entries for row y, one per column
+	const uint16_t *row(uint16_t y) const { return m_pTable + (y * m_nWidth); }
+
+	/// the led index of (x,y).  No range checking is done.
+	uint16_t operator()(uint16_t x, uint16_t y) const { return m_pTable[(y * m_nWidth) + x]; }
+
+	/// the led index of (x,y), or size() (one past the last led) if (x,y) is outside of the matrix
+	uint16_t safe(uint16_t x, uint16_t y) const { return (x < m_nWidth && y < m_nHeight) ? (*this)(x,y) : size(); }
+
+private:
+	void fill(uint16_t *pTable, TXYLayout layout, TXYRotation rotation) {
+		// the size of the matrix the way it's wired
+		bool turned = rotation & 0x01;
+		uint16_t wiredWidth = turned ? m_nHeight : m_nWidth;
+		uint16_t w1 = m_nWidth - 1;
+		uint16_t h1 = m_nHeight - 1;
+
+		for(uint16_t y = 0; y < m_nHeight; y++) {
+			for(uint16_t x = 0; x < m_nWidth; x++) {
+				uint16_t wx, wy;
+				switch(rotation) {
+					case XY_ROTATE_90:  wx = y;      wy = w1 - x; break;
+					case XY_ROTATE_180: wx = w1 - x; wy = h1 - y; break;
+					case XY_ROTATE_270: wx = h1 - y; wy = x;      break;
+					default:            wx = x;      wy = y;      break;
+				}
+				if(layout == XY_SERPENTINE && (wy & 0x01)) { wx = wiredWidth - 1 - wx; }
+				*pTable++ = (wy * wiredWidth) + wx;
+			}
+		}
+	}
+};
+
+/// An XYMap that carries the storage for its table with it
+/// @tparam WIDTH, HEIGHT the size of the matrix as it's drawn on
+template<uint16_t WIDTH, uint16_t HEIGHT>
+class CXYMap : public XYMap {
+	uint16_t m_Table[WIDTH * HEIGHT];
+public:
+	CXYMap(TXYLayout layout = XY_SERPENTINE, TXYRotation rotation = XY_ROTATE_0) : XYMap(WIDTH, HEIGHT, m_Table, layout, rotation) {}
+};
+
+///@}
+
+FASTLED_NAMESPACE_END
+
+#endif